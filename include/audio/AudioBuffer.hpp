@@ -4,9 +4,6 @@
 #include <audio/AudioBufferPacket.hpp>
 
 #include <atomic>
-#include <condition_variable>
-#include <mutex>
-#include <thread>
 
 // pulled from an implementation i saw a long ass time ago.
 // source is probably cited on that music visualizer i made a couple years ago.
@@ -16,18 +13,21 @@
 namespace monkeysworld {
 namespace audio {
 
+class AudioDecodePool;
+
 /**
  *  Inheritable class for audio buffers.
  *  Used by AudioManager to source audio samples from file.
  *  Typically: manager will construct on demand, then choose to populate from cache.
- *  Then, it will start the write thread, which will take care of writing from there.
- *  Only one thread (the file writer thread) will write at a time,
+ *  Then, it will hand it to an AudioDecodePool, which will take care of writing from there.
+ *  Only one thread (whichever decode worker is refilling it) will write at a time,
  *  and only one thread will read at a time.
  */ 
 class AudioBuffer {
  public:
   /**
-   *  Creates new AudioBuffer with capacity `size` bytes
+   *  Creates new AudioBuffer with capacity `size` bytes.
+   *  Capacity is rounded up to a power of two, so the ring can be indexed with a mask.
    */ 
   AudioBuffer(int capacity);
 
@@ -57,6 +57,7 @@ class AudioBuffer {
   /**
    *  Same as readadd, but samples are interleaved in output.
    *  output must be capable of storing 2 * n samples.
+   *  This is what the mixer calls -- it's vectorized, and reads the ring in at most two spans.
    */ 
   int ReadAddInterleaved(int n, float* output);
 
@@ -93,11 +94,6 @@ class AudioBuffer {
    */ 
   void SetGain(float db);
 
-  /**
-   *  Starts up the thread which writes to the buffer from a file.
-   */
-  bool StartWriteThread(); 
-
   /**
    *  Implementation-defined function which reads
    *  `n` bytes from the buffer file at the sample currently represented  
@@ -115,15 +111,14 @@ class AudioBuffer {
     return bytes_written_.load(std::memory_order_acquire);
   }
 
-  /**
-   *  Terminates the write thread.
-   */ 
-  void DestroyWriteThread();
+  uint64_t GetBytesRead() {
+    return bytes_read_.load(std::memory_order_acquire);
+  }
 
   /**
    *  Audio buffer dtor.
-   *  NOTE: Since the write thread makes use of resources allocated by subclasses,
-   *  it is necessary for implementations to clean up the write thread themselves.
+   *  NOTE: Buffers are kept alive by the decode pool while it's filling them, so nothing is
+   *  writing to a buffer once it's being destroyed.
    * 
    *  Cool trick: https://stackoverflow.com/questions/461203/when-to-use-virtual-destructors
    *  Virtual dtors are intended for polymorphic use cases -- ie when we have pointers to subclasses
@@ -159,31 +154,37 @@ class AudioBuffer {
 
 
  private:
+  friend class AudioDecodePool;
+
   int capacity_;
+  int mask_;                            // capacity_ - 1
   float* buffer_l_;                     // left buffer
   float* buffer_r_;                     // right buffer
 
   char CACHE_BREAK_R_[CACHE_LINE];        // separates read from buffer
   std::atomic<uint64_t> bytes_read_;      // read header
   uint64_t last_write_polled_;            // last write value polled
-  std::atomic<float> gain_;               // gain of this buffer, in dB.
+  std::atomic<float> gain_;               // gain of this buffer, as an amplitude -- converted from dB when set
 
   char CACHE_BREAK_W_[CACHE_LINE];        // separates write from read
   std::atomic<uint64_t> bytes_written_;   // write header
   uint64_t last_read_polled_;             // last read value polled
 
-  std::condition_variable write_cv_;    // cv used to signal write thread
-  std::thread write_thread_;            // write thread 
-  std::atomic_bool running_;            // true if thread is running
-  std::atomic_flag write_thread_flag_;  // flag which signals early termination of write thread
-  std::mutex write_lock_;               // lock used by wait func on write thread
+  std::atomic<AudioDecodePool*> decode_pool_;  // pool filling this buffer, or null
+  std::atomic_bool refill_queued_;            // true while a refill is queued or running
   
   bool looped_;
 
   /**
-   *  Function which writes to the buffer.
+   *  Asks the decode pool to top up the buffer, unless it's been asked already. Lock-free.
+   */ 
+  void RequestRefill();
+
+  /**
+   *  Fills the buffer from its file, as far as it'll go. Called by the decode pool.
+   *  @returns the number of samples written, or -1 if the file is exhausted.
    */ 
-  void WriteThreadFunc();
+  int Refill();
   float GetGainAsAmplitude();
 
 };
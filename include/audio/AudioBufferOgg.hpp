@@ -5,6 +5,7 @@
 #include <_stb_libs/stb_vorbis.h>
 
 #include <atomic>
+#include <string>
 
 namespace monkeysworld {
 namespace audio {
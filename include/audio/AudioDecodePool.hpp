@@ -0,0 +1,172 @@
+#ifndef AUDIO_DECODE_POOL_H_
+#define AUDIO_DECODE_POOL_H_
+
+#include <audio/AudioBuffer.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace monkeysworld {
+namespace audio {
+
+/**
+ *  A handful of threads which keep every playing buffer topped up from its file.
+ *
+ *  Buffers ask to be refilled once they drop below half full. Requests come from the audio callback,
+ *  so they're handed over through a lock-free queue -- the callback never waits on a lock, and so never wakes anyone.
+ *  Instead, one idle worker sleeps until a playing buffer should have asked for more, and checks the queue then.
+ *  Workers service whichever buffer will run dry soonest.
+ */
+class AudioDecodePool {
+ public:
+  /**
+   *  Creates a new decode pool.
+   *  @param thread_count - number of worker threads.
+   *  @param sample_rate - rate buffers are played back at, used to tell how soon they'll run dry.
+   */
+  AudioDecodePool(int thread_count, int sample_rate);
+
+  /**
+   *  @returns a thread count which scales with the number of cores, while leaving most of them alone.
+   */
+  static int GetDefaultThreadCount();
+
+  /**
+   *  Starts filling a buffer from its file. The pool keeps the buffer alive until it's removed,
+   *  or its file runs out. A buffer which was removed mid-refill isn't touched again until that refill is done.
+   *  @param buffer - the buffer being filled.
+   */
+  void AddBuffer(std::shared_ptr<AudioBuffer> buffer);
+
+  /**
+   *  Stops filling a buffer.
+   *  @param buffer - the buffer being removed.
+   */
+  void RemoveBuffer(AudioBuffer* buffer);
+
+  /**
+   *  @returns the number of buffers being filled.
+   */
+  size_t GetBufferCount();
+
+  /**
+   *  @returns the number of worker threads.
+   */
+  int GetThreadCount() const;
+
+  /**
+   *  Stops the workers, and detaches any buffers which are left.
+   *  Nothing should be reading from those buffers once this is called.
+   */
+  ~AudioDecodePool();
+  AudioDecodePool& operator=(const AudioDecodePool& other) = delete;
+  AudioDecodePool& operator=(AudioDecodePool&& other) = delete;
+  AudioDecodePool(const AudioDecodePool& other) = delete;
+  AudioDecodePool(AudioDecodePool&& other) = delete;
+
+ private:
+  friend class AudioBuffer;
+
+  typedef std::chrono::steady_clock Clock;
+
+  // room for a request from every buffer -- each buffer has at most one queued
+  static const size_t READY_QUEUE_SIZE = 1024;
+  // longest the watching worker sleeps before checking the queue again -- catches buffers which
+  // started playing some time after they were filled, so their requests weren't expected.
+  static const int FALLBACK_WAKE_MS = 20;
+
+  struct ready_cell {
+    std::atomic<size_t> sequence;
+    AudioBuffer* buffer;
+  };
+
+  struct registration {
+    std::shared_ptr<AudioBuffer> buffer;
+    uint64_t id;                  // tells apart a buffer which was removed, then added again
+  };
+
+  struct refill_request {
+    Clock::time_point deadline;   // when the buffer runs dry
+    AudioBuffer* buffer;
+
+    bool operator>(const refill_request& other) const {
+      return deadline > other.deadline;
+    }
+  };
+
+  /**
+   *  Queues a buffer to be refilled. Lock-free, and doesn't wake anyone, so it's safe to call
+   *  from the audio callback -- the watching worker picks the request up within FALLBACK_WAKE_MS.
+   *  @returns false if the queue was full.
+   */
+  bool QueueRefill(AudioBuffer* buffer);
+
+  /**
+   *  @returns the next buffer in the ready queue, or nullptr if it's empty.
+   */
+  AudioBuffer* PopReady();
+
+  /**
+   *  Moves everything in the ready queue onto the heap, ordered by when each buffer runs dry.
+   *  Expects lock_ to be held.
+   */
+  void DrainReadyQueue();
+
+  /**
+   *  Notes when a buffer which was just refilled should next be checked on -- once it's down to a quarter full,
+   *  if it keeps playing. It asks for more at half, so its request should be waiting by then.
+   *  Wakes the watching worker if it would otherwise sleep past that. Expects lock_ to be held.
+   */
+  void WatchBuffer(AudioBuffer* buffer);
+
+  /**
+   *  Sleeps until there might be something to do. Expects lock_ to be held.
+   *  Only one idle worker at a time waits on a timer -- the rest wait to be woken.
+   */
+  void WaitForWork(std::unique_lock<std::mutex>& lock);
+
+  void WorkerFunc();
+
+  // bounded MPMC queue -- each cell's sequence says whether it's ready to be written or read
+  ready_cell ready_queue_[READY_QUEUE_SIZE];
+  char CACHE_BREAK_ENQUEUE_[CACHE_LINE];
+  std::atomic<size_t> enqueue_pos_;
+  char CACHE_BREAK_DEQUEUE_[CACHE_LINE];
+  std::atomic<size_t> dequeue_pos_;
+  char CACHE_BREAK_POOL_[CACHE_LINE];
+
+  int sample_rate_;
+  std::vector<std::thread> threads_;
+
+  // guards everything below
+  std::mutex lock_;
+  std::condition_variable worker_cv_;
+  // wakes the watching worker early, when a refill adds a sooner deadline
+  std::condition_variable watch_cv_;
+  bool running_;
+  // true while a worker is sleeping on a timer, to check the ready queue
+  bool watching_;
+  // when the watching worker is due to wake
+  Clock::time_point watch_until_;
+  // when refilled buffers should have asked for more, soonest first
+  std::priority_queue<Clock::time_point, std::vector<Clock::time_point>, std::greater<Clock::time_point>> watches_;
+  uint64_t next_id_;
+  // buffers being filled, by address
+  std::unordered_map<AudioBuffer*, registration> buffers_;
+  // buffers a worker is refilling right now, and whether another request came in for them meanwhile.
+  // kept apart from buffers_, since a buffer can be removed and added again mid-refill.
+  std::unordered_map<AudioBuffer*, bool> refilling_;
+  std::priority_queue<refill_request, std::vector<refill_request>, std::greater<refill_request>> requests_;
+};
+
+}
+}
+
+#endif  // AUDIO_DECODE_POOL_H_
@@ -5,9 +5,11 @@
 #include <memory>
 #include <mutex>
 #include <queue>
+#include <thread>
 #include <vector>
 
 #include <audio/AudioBuffer.hpp>
+#include <audio/AudioDecodePool.hpp>
 #include <portaudio.h>
 
 #define AUDIO_MGR_MAX_BUFFER_COUNT 256
@@ -100,6 +102,13 @@ class AudioManager {
    */ 
   buffer_info* GetOpenBufferSpot(int& index);
 
+  /**
+   *  Hands a slot over to the callback, once its buffer is ready to play.
+   *  Safe to call from any thread.
+   *  @param index - index of the slot.
+   */ 
+  void QueueVoice(int index);
+
   /**
    *  Function called by portaudio.
    */ 
@@ -119,6 +128,15 @@ class AudioManager {
   buffer_info buffers_[AUDIO_MGR_MAX_BUFFER_COUNT];
   std::mutex buffer_info_write_lock_;
 
+  // slots which started playing since the last callback, one bit each
+  std::atomic<uint64_t> pending_voices_[AUDIO_MGR_MAX_BUFFER_COUNT / 64];
+  // slots being played, in no particular order -- only touched by the callback
+  int active_voices_[AUDIO_MGR_MAX_BUFFER_COUNT];
+  int active_count_;
+
+  // keeps every playing buffer filled
+  std::unique_ptr<AudioDecodePool> decode_pool_;
+
   std::queue<queue_info> buffer_creation_queue_;    // queue of buffers to set up
   std::mutex buffer_queue_lock_;                    // lock for queue
   std::thread buffer_creation_thread_;              // thread to handle buffer creation
@@ -6,7 +6,9 @@
 #include <model/Mesh.hpp>
 #include <storage/VertexPacketTypes.hpp>
 
+#include <atomic>
 #include <memory>
+#include <vector>
 
 namespace monkeysworld {
 namespace critter {
@@ -35,9 +37,53 @@ class Model : public GameObject {
    */ 
   std::shared_ptr<const model::Mesh<>> GetMesh();
 
+  /**
+   *  Sets a chain of meshes used for level of detail.
+   *  @param lods - list of meshes, from most to least detailed, ex. from CachedFileLoader::LoadModelLODs.
+   *                The first entry is treated as the base mesh.
+   */ 
+  void SetMeshLODs(const std::vector<std::shared_ptr<const model::Mesh<>>>& lods);
+
+  /**
+   *  Picks the LOD level drawn this frame, based on how much of the screen this model covers.
+   *  Also picks up our mesh's new LOD chain and bounds, if it's been hot-reloaded.
+   *  Called by the engine once per frame, before the shadow pass.
+   *  @param rc - render context containing the active camera.
+   */ 
+  void SelectLOD(const engine::RenderContext& rc);
+
+  /**
+   *  @returns the LOD level which will be drawn. 0 is the base mesh.
+   */ 
+  int GetLODLevel() const;
+
+  /**
+   *  Computes a bounding sphere for this model in world space.
+   *  @param center - output param for the center of the sphere.
+   *  @returns the radius of the sphere.
+   */ 
+  float GetWorldBoundingSphere(glm::vec3* center) const;
+
+  /**
+   *  @returns the number of triangles drawn by all models since the last call,
+   *           and resets the count. Shadow passes aren't included.
+   */ 
+  static uint64_t ResetTriangleCount();
+
+  /**
+   *  @returns the number of triangles drawn into shadow maps by all models since the last call,
+   *           and resets the count.
+   */ 
+  static uint64_t ResetShadowTriangleCount();
+
   void PrepareAttributes() override;
   void Draw() override;
 
+  /**
+   *  Draws the model into a shadow map. Same as Draw, but counted separately.
+   */ 
+  void DrawShadow();
+
   Model(const Model& other);
   Model(Model&& other);
   Model& operator=(const Model& other);
@@ -54,7 +100,35 @@ class Model : public GameObject {
   // same as above, but ignore context
   static std::shared_ptr<model::Mesh<>> FromObjFile(const std::string& path);
  private:
+  /**
+   *  @returns the mesh which should be drawn, given the current LOD.
+   */ 
+  const std::shared_ptr<const model::Mesh<>>& GetDrawnMesh() const;
+
+  /**
+   *  Updates the bounding sphere used to estimate screen coverage.
+   */ 
+  void UpdateBounds();
+
+  /**
+   *  Fetches our mesh's LOD chain again after a reload, and updates our bounds.
+   */ 
+  void RefreshMesh();
+
   std::shared_ptr<const model::Mesh<>> mesh_;
+  std::vector<std::shared_ptr<const model::Mesh<>>> lods_;
+  int lod_;
+  // model reload count when our mesh was last fetched
+  uint64_t reload_count_;
+
+  // bounding sphere of the base mesh, in model space
+  glm::vec3 bound_center_;
+  float bound_radius_;
+
+  // triangles drawn since the last call to ResetTriangleCount
+  static std::atomic<uint64_t> tri_count_;
+  // triangles drawn into shadow maps since the last call to ResetShadowTriangleCount
+  static std::atomic<uint64_t> shadow_tri_count_;
 };
 
 } // namespace critter
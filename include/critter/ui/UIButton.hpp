@@ -20,6 +20,13 @@ class UIButton : public font::UITextObject {
 
   void DrawUI(glm::vec2 xyMin, glm::vec2 xyMax, shader::Canvas canvas) override;
   bool OnClick(const input::MouseEvent& e) override;
+
+ protected:
+  /**
+   *  The button shader works in gl_FragCoord, so it needs a framebuffer of its own.
+   */ 
+  bool SupportsDirectDraw() override { return false; }
+
  private:
   shader::materials::ButtonMaterial mat_;
 
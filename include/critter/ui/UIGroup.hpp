@@ -2,9 +2,12 @@
 #define UI_GROUP_H_
 
 #include <critter/ui/UIObject.hpp>
+#include <critter/ui/layout/LayoutGraph.hpp>
+#include <font/TextBatch.hpp>
 #include <model/Mesh.hpp>
 
 #include <shader/materials/UIGroupMaterial.hpp>
+#include <utils/ShelfPacker.hpp>
 
 namespace monkeysworld {
 namespace critter {
@@ -12,10 +15,19 @@ namespace ui {
 
 /**
  *  UIGroups are the parts which actually contain other components.
+ *
+ *  Children are copied into a single atlas texture and composited in one draw.
+ *  The draw order and quads are cached, and only rebuilt when children are added or removed,
+ *  or when a child's z-index, position, size or opacity changes.
+ *
+ *  Children which are drawn direct (see UIObject::IsDrawnDirect) skip the atlas,
+ *  and draw straight into this group's framebuffer in z-order. Runs of direct text
+ *  are batched, and drawn with one call per glyph atlas.
  */ 
 class UIGroup : public UIObject {
  public:
   UIGroup(engine::Context* ctx);
+  ~UIGroup();
 
 
   std::shared_ptr<Object> GetChild(uint64_t id) override;
@@ -43,19 +55,97 @@ class UIGroup : public UIObject {
    */ 
   void DrawUI(glm::vec2 min, glm::vec2 max, shader::Canvas canvas) override;
 
+  /**
+   *  @param enabled - if false, direct text children draw themselves one at a time. On by default.
+   */ 
+  void SetTextBatching(bool enabled);
+
+  UIGroup(const UIGroup& other) = delete;
+  UIGroup& operator=(const UIGroup& other) = delete;
+
  private:
   struct UIGroupPacket {
     glm::vec2 pos;            // vertex positions
     glm::vec2 texcoord;       // texture coordinates
-    float index;              // index of child being drawn
+    float opacity;            // opacity of child being drawn
 
     static void Bind();
   };
 
+  /**
+   *  A child, and where it lives in the atlas.
+   */ 
+  struct batch_entry {
+    std::shared_ptr<UIObject> child;
+    int64_t z_index;            // state the quad was built from
+    glm::ivec2 pos;
+    glm::ivec2 size;
+    float opacity;
+    bool direct;                // true if the child draws straight into our framebuffer
+    bool visible;               // false if the child is outside the group
+    glm::ivec2 atlas_pos;       // bottom left corner of the child's region in the atlas
+    size_t batch;               // which fill of the atlas this child is part of
+    size_t quad;                // index of this child's quad in the group mesh
+    uint64_t copied_count;      // child's draw count when it was last copied into the atlas
+    bool copied;
+  };
+
+  /**
+   *  @returns true if the draw order or quads are out of date.
+   */ 
+  bool IsBatchStale();
+
+  /**
+   *  Sorts children, packs them into the atlas and rebuilds the group mesh.
+   */ 
+  void RebuildBatch();
+
+  /**
+   *  Resizes the atlas texture, reallocating it if necessary.
+   */ 
+  void ResizeAtlas(glm::ivec2 size);
+
+  /**
+   *  Copies children into the atlas.
+   *  @param batch - the atlas fill being copied.
+   *  @param force - if true, copy children even if they haven't redrawn since they were last copied.
+   */ 
+  void CopyToAtlas(size_t batch, bool force);
+
+  /**
+   *  Draws a range of quads from the group mesh.
+   *  @param start - first quad.
+   *  @param end - one past the last quad.
+   */ 
+  void DrawQuads(size_t start, size_t end);
+
+  /**
+   *  Has a direct child draw itself into our framebuffer.
+   *  @param min, max - our damaged region.
+   */ 
+  void DrawDirect(batch_entry& entry, glm::vec2 min, glm::vec2 max, shader::Canvas canvas);
+
+  /**
+   *  Draws any text batched so far. Called before anything else is drawn, to keep z-order intact.
+   */ 
+  void FlushText();
+
   std::vector<std::shared_ptr<UIObject>> children_;   // children of this layer
+  std::vector<batch_entry> batch_;                    // one entry per child, in draw order
+  size_t atlas_batches_;                              // number of times the atlas is filled per draw
+  glm::ivec2 batch_dims_;                             // group size the quads were built for
+  bool batch_dirty_;                                  // true if children were added or removed
   model::Mesh<UIGroupPacket> mesh_;                   // group mesh
-  GLint max_textures_;
+  GLint max_atlas_size_;
+  GLuint atlas_;
+  glm::ivec2 atlas_size_;
+  utils::ShelfPacker packer_;
   shader::materials::UIGroupMaterial mat_;
+  font::TextBatch text_batch_;                        // direct text children, waiting to be drawn
+  bool text_batching_;
+  layout::LayoutGraph layout_graph_;                  // persists between layouts
+  std::vector<std::shared_ptr<UIObject>> layout_nodes_;   // children, in the order the graph knows them
+  bool layout_dirty_;                                 // true if the graph needs new nodes
   
 };
 
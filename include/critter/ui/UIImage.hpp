@@ -27,6 +27,13 @@ class UIImage : public UIObject {
    *  TODO: Setup canvas so that it can draw images from a texture.
    */ 
   void DrawUI(glm::vec2, glm::vec2, shader::Canvas canvas);
+
+ protected:
+  /**
+   *  Images are a single quad -- draw them straight into the parent.
+   */ 
+  bool SupportsDirectDraw() override { return true; }
+
  private:
   std::shared_ptr<const shader::Texture> tex_;
   shader::materials::TextureXferMaterial mat_;
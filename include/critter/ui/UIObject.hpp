@@ -19,6 +19,10 @@
 #include <mutex>
 
 namespace monkeysworld {
+namespace font {
+class TextBatch;
+}
+
 namespace critter {
 namespace ui {
 
@@ -153,6 +157,13 @@ class UIObject : public Object, public std::enable_shared_from_this<UIObject> {
    */ 
   void DrawToScreen();
 
+  /**
+   *  @returns true if this object skips its own framebuffer, and is drawn straight into its parent's instead.
+   *           This is the case for leaves which support it, as long as they're fully opaque --
+   *           anything else needs an offscreen target to be composited from.
+   */ 
+  bool IsDrawnDirect();
+
   // also deprecated
   void Draw() override {}
 
@@ -172,9 +183,9 @@ class UIObject : public Object, public std::enable_shared_from_this<UIObject> {
    *    for instance by using the resolution to transform components in-shader.
    *  
    *  The parameters to this method represent the minimally invalidated bounding box
-   *  for this component -- implementors can use these args to save performance
-   *  by only updating a part of the screen, instead of the whole thing. This only really applies
-   *  to groups, so do what you want, for the most part.
+   *  for this component. The clear, and any draws made in DrawUI, are scissored to this box,
+   *  so pixels outside of it keep what was drawn last time. Implementors can use these args
+   *  to skip work which falls entirely outside of the box.
    * 
    *  @param minXY, the minXY of the invalid bounding box, origin top left.
    *  @param maxXY, the maxXY of the invalid bounding box, origin top left.
@@ -188,6 +199,15 @@ class UIObject : public Object, public std::enable_shared_from_this<UIObject> {
    */ 
   void Invalidate();
 
+  /**
+   *  Invalidates part of the framebuffer. Only this region will be cleared and redrawn,
+   *  along with any other regions invalidated before the next render pass.
+   *  The region is passed up to our parent, so that it only recomposites the part of us which changed.
+   *  @param minXY - the minXY of the invalid region, origin top left.
+   *  @param maxXY - the maxXY of the invalid region, origin top left.
+   */ 
+  void Invalidate(glm::vec2 minXY, glm::vec2 maxXY);
+
   /**
    *  @returns the descriptor for the color attachment to our UI framebuffer.
    */ 
@@ -213,10 +233,34 @@ class UIObject : public Object, public std::enable_shared_from_this<UIObject> {
  protected:
 
   /**
-   *  @returns true if the UIObject is still valid, false otherwise.
+   *  @returns true if neither this UIObject, nor any of its descendants, needs to be redrawn.
    */ 
   bool IsValid();
 
+  /**
+   *  Override to return true if this object can be drawn straight into its parent's framebuffer.
+   * 
+   *  When drawn direct, DrawUI is called with the parent's framebuffer bound, and the viewport
+   *  covering this object's region of it -- so clip space works exactly as it does offscreen.
+   *  Only opt in if DrawUI doesn't depend on gl_FragCoord, doesn't use the canvas,
+   *  and doesn't apply its own opacity.
+   */ 
+  virtual bool SupportsDirectDraw() { return false; }
+
+  /**
+   *  Override to add this object to a text batch, instead of drawing it with DrawUI.
+   *  Only called on objects which are drawn direct -- the batch is drawn into the parent's framebuffer,
+   *  with the parent's viewport.
+   *  @param batch - the batch being built.
+   *  @param scale - maps this object's clip space onto its parent's...
+   *  @param offset - ...as `pos * scale + offset`.
+   *  @param clip_min - minimum corner of the region this object may draw to, in the parent's clip space.
+   *  @param clip_max - maximum corner of that region.
+   *  @returns true if the object added itself to the batch, false if it should be drawn with DrawUI.
+   */ 
+  virtual bool DrawBatched(font::TextBatch& batch, glm::vec2 scale, glm::vec2 offset,
+                           glm::vec2 clip_min, glm::vec2 clip_max) { return false; }
+
   /**
    *  Draws the UI object, as a fullscreen quadrilateral, to the screen.
    *  Useful for transferring (for instance) a texture directly to the UIObject's framebuffer.
@@ -229,8 +273,12 @@ class UIObject : public Object, public std::enable_shared_from_this<UIObject> {
   std::weak_ptr<UIObject> parent_;                      // parent object if valid
   glm::ivec2 pos_;                                       // offset of this component relative to parent
   glm::ivec2 size_;                                      // size of ui object, pixels wide/tall
-  std::atomic_bool valid_;                              // whether or not the view has been invalidated.
+  std::atomic_bool valid_;                              // false if this object or any descendant has been invalidated.
+  std::mutex damage_lock_;
+  glm::ivec2 damage_min_;                               // region which needs to be redrawn, if invalid
+  glm::ivec2 damage_max_;
   float opacity_;
+  uint64_t draw_count_;                                 // number of times DrawUI has run -- lets groups skip stale copies
 
   std::shared_ptr<shader::Framebuffer> fb_;
 
@@ -246,11 +294,16 @@ class UIObject : public Object, public std::enable_shared_from_this<UIObject> {
   layout::UILayoutParams layout_; // layout params for this layer
 
   /**
-   *  Calculates the minimal bounding box which needs to be updated.
+   *  Fetches the minimal bounding box which needs to be updated, and marks this object as valid.
    *  @param xyMin - output parameter for min XY
    *  @param xyMax - output parameter for max XY
    */ 
   void GetInvalidatedBoundingBox(glm::vec2* xyMin, glm::vec2* xyMax);
+
+  /**
+   *  Tells our parent that the region we cover needs to be recomposited.
+   */ 
+  void InvalidateParent();
 };
 
 }
@@ -0,0 +1,121 @@
+#ifndef LAYOUT_GRAPH_H_
+#define LAYOUT_GRAPH_H_
+
+#include <critter/ui/layout/BoundingBox.hpp>
+#include <critter/ui/layout/UILayoutParams.hpp>
+
+#include <glm/glm.hpp>
+
+#include <cinttypes>
+#include <unordered_map>
+#include <vector>
+
+namespace monkeysworld {
+namespace critter {
+namespace ui {
+namespace layout {
+
+/**
+ *  Solves the margin layout for the children of a group, and remembers the result.
+ *
+ *  Nodes are anchored to one another (or to the group) through their layout params.
+ *  The anchor graph and its topological order are only rebuilt when nodes are added or removed,
+ *  or when an anchor changes. Otherwise, only nodes whose inputs changed -- and the nodes
+ *  anchored to them, transitively -- are solved again.
+ *
+ *  Nodes are referred to by index, in the order passed to SetNodes.
+ */
+class LayoutGraph {
+ public:
+  LayoutGraph();
+
+  /**
+   *  Replaces every node in the graph. Every node will be solved on the next call to Solve.
+   *  @param group_id - the ID of the group containing the nodes.
+   *  @param ids - the ID of each node.
+   */
+  void SetNodes(uint64_t group_id, const std::vector<uint64_t>& ids);
+
+  /**
+   *  Sets the size of the containing group.
+   */
+  void SetGroupDimensions(glm::vec2 dims);
+
+  /**
+   *  Updates the inputs for a node. Does nothing if they haven't changed.
+   *  @param index - the node being updated.
+   *  @param params - the node's layout params.
+   *  @param pos - the node's current position, used for any edge which isn't anchored.
+   *  @param dims - the node's current size, used for any edge which isn't anchored.
+   */
+  void SetNode(size_t index, const UILayoutParams& params, glm::vec2 pos, glm::vec2 dims);
+
+  /**
+   *  Solves every node whose inputs have changed, and everything downstream of them.
+   *  @returns the number of nodes which were solved, or -1 if the layout is invalid.
+   */
+  int Solve();
+
+  /**
+   *  @returns the nodes whose bounding boxes differ from the position and size they were given,
+   *           as of the last call to Solve. The caller is expected to apply these.
+   */
+  const std::vector<size_t>& GetChangedNodes() const;
+
+  /**
+   *  @returns the bounding box of a node, as of the last call to Solve.
+   */
+  const BoundingBox& GetBoundingBox(size_t index) const;
+
+  /**
+   *  @returns the number of nodes in the graph, not including the group.
+   */
+  size_t GetNodeCount() const;
+
+ private:
+  static const uint32_t NO_ANCHOR = 0xFFFFFFFF;
+
+  /**
+   *  Resolves anchors to indices, and rebuilds the topological order.
+   *  @returns false if an anchor is missing, or the anchors form a cycle.
+   */
+  bool RebuildOrder();
+
+  /**
+   *  Computes the bounding box of a node from its inputs and its anchors' boxes.
+   */
+  BoundingBox SolveNode(uint32_t index) const;
+
+  uint64_t group_id_;
+  std::vector<uint64_t> ids_;
+  std::unordered_map<uint64_t, uint32_t> index_;    // only used when rebuilding the order
+
+  // inputs, by index. the group is the last entry in boxes_.
+  // kept as given -- boxes are only rounded once they're solved.
+  std::vector<UILayoutParams> params_;
+  std::vector<glm::vec2> pos_;
+  std::vector<glm::vec2> dims_;
+
+  // outputs
+  std::vector<BoundingBox> boxes_;
+  std::vector<size_t> changed_;
+
+  // anchors, four per node -- top, bottom, left, right
+  std::vector<uint32_t> anchors_;
+  // nodes anchored to each node (CSR), including the group
+  std::vector<uint32_t> dependent_start_;
+  std::vector<uint32_t> dependents_;
+  // topological order, excluding the group
+  std::vector<uint32_t> order_;
+  std::vector<uint8_t> dirty_;
+
+  bool order_dirty_;
+  bool valid_;
+};
+
+}
+}
+}
+}
+
+#endif  // LAYOUT_GRAPH_H_
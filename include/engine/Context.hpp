@@ -8,6 +8,7 @@
 #include <engine/Executor.hpp>
 #include <engine/EngineExecutor.hpp>
 #include <shader/Framebuffer.hpp>
+#include <shader/UniformRing.hpp>
 
 #define GLFW_INCLUDE_NONE
 #include <GLFW/glfw3.h>
@@ -24,6 +25,11 @@ class Context {
   virtual std::shared_ptr<audio::AudioManager> GetAudioManager() = 0;
   virtual std::shared_ptr<Executor<EngineExecutor>> GetExecutor() = 0;
 
+  /**
+   *  @returns the ring which materials suballocate their per-draw uniform blocks from.
+   */ 
+  virtual std::shared_ptr<shader::UniformRing> GetUniformRing() = 0;
+
   /**
    *  @returns the last rendered frame, as a framebuffer object.
    */ 
@@ -76,6 +76,8 @@ class EngineContext : public Context {
 
   std::shared_ptr<Executor<EngineExecutor>> GetExecutor() override;
 
+  std::shared_ptr<shader::UniformRing> GetUniformRing() override;
+
   std::shared_ptr<shader::Framebuffer> GetLastFrame() override;
 
   /**
@@ -110,10 +112,17 @@ class EngineContext : public Context {
   ~EngineContext();
 
  private:
+  /**
+   *  If hot reload is compiled in, polls our loader for changed files every frame,
+   *  and rebuilds anything which depends on them.
+   */ 
+  void WatchForChanges();
+
   std::shared_ptr<file::CachedFileLoader> file_loader_;
   std::shared_ptr<input::WindowEventManager> event_mgr_;
   std::shared_ptr<audio::AudioManager> audio_mgr_;
   std::shared_ptr<EngineExecutor> executor_;
+  std::shared_ptr<shader::UniformRing> uniform_ring_;
   Scene* scene_;
   GLFWwindow* window_;
   // the current scene
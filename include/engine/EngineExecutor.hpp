@@ -6,6 +6,7 @@
 #include <future>
 #include <mutex>
 #include <queue>
+#include <vector>
 
 namespace monkeysworld {
 namespace engine {
@@ -59,6 +60,15 @@ class EngineExecutor : public Executor<EngineExecutor> {
     return std::move(p->get_future());
   }
 
+  /**
+   *  Calls `func` once per frame, on the main thread, until it returns true.
+   *  Polls run at the start of `RunTasks`, and aren't subject to its time limit.
+   */ 
+  void PollOnMainThread(std::function<bool()> func) {
+    std::unique_lock<std::mutex> lock(poll_mutex_);
+    poll_queue_.push_back(func);
+  }
+
   // todo: create a version which does not have to return a value :)
 
   /**
@@ -76,6 +86,9 @@ class EngineExecutor : public Executor<EngineExecutor> {
  private:
   std::mutex queue_mutex_;
   std::queue<std::function<void()>> func_queue_; // queue of functions which will be executed
+  std::mutex poll_mutex_;
+  std::vector<std::function<bool()>> poll_queue_;   // functions polled every frame until they return true
+  std::vector<std::function<bool()>> polling_;      // polls which are currently being run
   std::thread::id main_thread_id_;
 };
 
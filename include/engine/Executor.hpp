@@ -36,6 +36,16 @@ class Executor {
     return that->ScheduleOnMainThread(func);
   }
 
+  /**
+   *  Calls a function on the main thread once per frame, until it returns true.
+   *  Useful for waiting on GPU work without blocking.
+   *  @param func - the function which will be polled.
+   */ 
+  void PollOnMainThread(std::function<bool()> func) {
+    Derived* that = static_cast<Derived*>(this);
+    that->PollOnMainThread(func);
+  }
+
 };
 
 }
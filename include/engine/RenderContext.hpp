@@ -36,7 +36,7 @@ class RenderContext {
   /**
    *  Creates a new render context
    */ 
-  RenderContext() {}
+  RenderContext() : shadow_atlas_(0), rp_(RenderPass::RENDER) {}
 
   /**
    *  Returns a reference to the game camera.
@@ -53,13 +53,22 @@ class RenderContext {
    */ 
   RenderPass GetRenderPass() const;
 
+  /**
+   *  Returns the depth texture containing every spotlight's shadow map.
+   *  Sample it as a sampler2DShadow, at the region given by each spotlight's `fd.rect`.
+   *  @returns the atlas texture, or 0 if shadows are unavailable.
+   */ 
+  GLuint GetShadowAtlas() const;
+
   // setters
   void SetActiveCamera(std::shared_ptr<critter::Camera> cam);
   void SetSpotlights(const std::vector<shader::light::spotlight_info>& spotlights);
   void SetRenderPass(RenderPass rp);
+  void SetShadowAtlas(GLuint atlas);
  private:
   std::vector<shader::light::spotlight_info> spotlights_;
   critter::camera_info cam_info_;
+  GLuint shadow_atlas_;
   RenderPass rp_;
 
 };
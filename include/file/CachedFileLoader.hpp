@@ -7,6 +7,7 @@
 #include <file/CachedLoader.hpp>
 #include <file/ModelLoader.hpp>
 #include <file/FileLoader.hpp>
+#include <file/FileWatcher.hpp>
 #include <file/FontLoader.hpp>
 #include <file/TextureLoader.hpp>
 #include <file/CubeMapLoader.hpp>
@@ -39,6 +40,12 @@ class CachedFileLoader {
   static const uint32_t CACHE_MAGIC = 0x4D534657;   // WFSM
   static const uint64_t CACHE_DATA_START = 12;
 
+  /**
+   *  @returns the directory where caches are kept, including the trailing slash.
+   *           Glyph atlases and program binaries are stored here as well.
+   */ 
+  static std::string GetCacheDirectory();
+
   /**
    *  Constructs a new CachedFileLoader.
    *  The CachedFileLoader will use the cache file located in resources/cache/<cache_name>.filecache.
@@ -73,6 +80,21 @@ class CachedFileLoader {
    */ 
   std::shared_ptr<const model::Mesh<storage::VertexPacket3D>> LoadModel(const std::string& path);
 
+  /**
+   *  Loads a model's LOD chain from cache.
+   *  @param path - path to desired model.
+   *  @returns - list of meshes, from most to least detailed.
+   *             The first entry is identical to the result of LoadModel.
+   */ 
+  std::vector<std::shared_ptr<const model::Mesh<storage::VertexPacket3D>>> LoadModelLODs(const std::string& path);
+
+  /**
+   *  Looks up the current LOD chain for a model loaded from here. Used to pick up hot-reloaded models.
+   *  @param base - the model's base mesh.
+   *  @returns - list of meshes, from most to least detailed, or an empty list if `base` wasn't loaded here.
+   */ 
+  std::vector<std::shared_ptr<const model::Mesh<storage::VertexPacket3D>>> FindModelLODs(const model::Mesh<storage::VertexPacket3D>* base);
+
   std::shared_ptr<const font::Font> LoadFont(const std::string& path);
 
   std::shared_ptr<const shader::Texture> LoadTexture(const std::string& path);
@@ -87,6 +109,27 @@ class CachedFileLoader {
                                                      const std::string& z_pos,
                                                      const std::string& z_neg);
 
+  /**
+   *  Starts watching every file, model and texture loaded from here on, so they can be hot-reloaded.
+   *  Call before loading anything.
+   */ 
+  void EnableHotReload();
+
+  /**
+   *  Starts watching a file without loading it -- for files whose contents are cached somewhere else.
+   *  Does nothing unless hot reload is enabled.
+   */ 
+  void WatchFile(const std::string& path);
+
+  /**
+   *  Reloads files, models and textures which have changed on disk since the last call.
+   *  Textures are updated in place. Models are read on the loader threads, and swapped in by a later call.
+   *  Main thread only.
+   *  Fonts, cubemaps and audio are not reloaded.
+   *  @returns the paths which changed -- empty if hot reload is disabled.
+   */ 
+  std::vector<std::string> ReloadChangedFiles();
+
   ~CachedFileLoader();
   CachedFileLoader(const CachedFileLoader& other) = delete;
   CachedFileLoader(CachedFileLoader&& other) = delete;
@@ -107,6 +150,8 @@ class CachedFileLoader {
   std::unique_ptr<FontLoader> font_loader_;
   std::unique_ptr<TextureLoader> texture_loader_;
   std::unique_ptr<CubeMapLoader> cubemap_loader_;
+  // null unless hot reload is enabled
+  std::unique_ptr<FileWatcher> watcher_;
 };
 
 } // namespace file
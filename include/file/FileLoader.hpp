@@ -24,6 +24,12 @@ class FileLoader : public CachedLoader<CacheStreambuf, FileLoader> {
              std::vector<cache_record> cache);
 
   CacheStreambuf LoadFile(const std::string& path);
+
+  /**
+   *  Re-reads a cached file from disk. Streambufs created before the reload keep the old contents.
+   *  @returns true if the file was cached.
+   */ 
+  bool ReloadFile(const std::string& path);
   std::vector<cache_record> GetCache() override;
   loader_progress GetLoaderProgress() override;
   void WaitUntilLoaded() override;
@@ -0,0 +1,61 @@
+#ifndef FILE_WATCHER_H_
+#define FILE_WATCHER_H_
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace monkeysworld {
+namespace file {
+
+/**
+ *  Reports files which have been modified on disk.
+ *
+ *  Uses inotify on linux -- watches are placed on the directories containing each file,
+ *  so editors which save by writing a temp file and renaming it are still picked up.
+ *  On other platforms, the watcher does nothing.
+ *
+ *  Thread safe. `PollChanges` never blocks.
+ */
+class FileWatcher {
+ public:
+  /**
+   *  Creates a new file watcher.
+   */
+  FileWatcher();
+
+  /**
+   *  @returns true if files can be watched on this platform.
+   */
+  static bool IsSupported();
+
+  /**
+   *  Starts watching a file. Does nothing if the file is already being watched.
+   *  @param path - path to the file, as it will be reported by `PollChanges`.
+   */
+  void Watch(const std::string& path);
+
+  /**
+   *  @returns every watched file which has changed since the last call, without duplicates.
+   */
+  std::vector<std::string> PollChanges();
+
+  ~FileWatcher();
+  FileWatcher(const FileWatcher& other) = delete;
+  FileWatcher& operator=(const FileWatcher& other) = delete;
+ private:
+  int fd_;
+  std::mutex watch_lock_;
+  // watch descriptor -> directory prefix
+  std::unordered_map<int, std::string> dirs_;
+  // directory prefix -> watch descriptor
+  std::unordered_map<std::string, int> dir_watches_;
+  std::unordered_set<std::string> files_;
+};
+
+}
+}
+
+#endif  // FILE_WATCHER_H_
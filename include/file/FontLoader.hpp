@@ -2,6 +2,7 @@
 #define FONT_LOADER_H_
 
 #include <font/Font.hpp>
+#include <font/GlyphAtlasCache.hpp>
 #include <file/LoaderThreadPool.hpp>
 #include <file/CachedLoader.hpp>
 
@@ -21,8 +22,15 @@ namespace file {
  */ 
 class FontLoader : public CachedLoader<std::shared_ptr<font::Font>, FontLoader> {
  public:
+  /**
+   *  Creates a new font loader.
+   *  @param thread_pool - thread pool shared across loaders.
+   *  @param cache - a list of cached files previously associated with this loader.
+   *  @param cache_dir - directory where glyph atlases are stored, including the trailing slash.
+   */ 
   FontLoader(std::shared_ptr<LoaderThreadPool> thread_pool,
-             std::vector<cache_record> cache);
+             std::vector<cache_record> cache,
+             const std::string& cache_dir);
 
   std::shared_ptr<font::Font> LoadFile(const std::string& path);
   std::vector<cache_record> GetCache() override;
@@ -30,6 +38,11 @@ class FontLoader : public CachedLoader<std::shared_ptr<font::Font>, FontLoader>
   void WaitUntilLoaded() override;
 
   bool IsCached(const std::string& path) override;
+
+  /**
+   *  Stores the glyph atlas of every loaded font which has changed, so the next launch can skip rasterizing.
+   */ 
+  void StoreAtlases();
  private:
   void LoadFontToCache(cache_record& record);
 
@@ -38,6 +51,7 @@ class FontLoader : public CachedLoader<std::shared_ptr<font::Font>, FontLoader>
   std::shared_timed_mutex cache_mutex_;
   std::unordered_map<std::string, std::shared_ptr<font::Font>> font_cache_;
   std::condition_variable load_cond_var_;
+  font::GlyphAtlasCache atlas_cache_;
 };
 
 }
@@ -30,6 +30,11 @@ class LoaderThreadPool {
    */ 
   void AddTaskToQueue(std::function<void()> func);
 
+  /**
+   *  @returns the number of threads in this pool.
+   */ 
+  int GetThreadCount() const;
+
   ~LoaderThreadPool();
   LoaderThreadPool& operator=(const LoaderThreadPool& other) = delete;
   LoaderThreadPool(const LoaderThreadPool& other) = delete;
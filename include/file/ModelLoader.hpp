@@ -6,6 +6,7 @@
 #include <file/LoaderThreadPool.hpp>
 #include <file/CachedLoader.hpp>
 
+#include <atomic>
 #include <condition_variable>
 #include <future>
 #include <memory>
@@ -49,15 +50,65 @@ class ModelLoader : public CachedLoader<std::shared_ptr<model::Mesh<storage::Ver
    */ 
   std::shared_ptr<model::Mesh<storage::VertexPacket3D>> LoadFile(const std::string& path);
 
+  /**
+   *  Returns the LOD chain generated for a model, loading the model if necessary.
+   *  @param path - path to the desired model.
+   *  @returns list of meshes, from most to least detailed. The first entry is the base mesh.
+   */ 
+  std::vector<std::shared_ptr<model::Mesh<storage::VertexPacket3D>>> LoadLODs(const std::string& path);
+
+  /**
+   *  Starts re-reading a cached model on the loader threads. The new geometry and LODs are swapped in
+   *  by the next call to FinishReloads.
+   *  @returns true if the model was cached.
+   */ 
+  bool ReloadFile(const std::string& path);
+
+  /**
+   *  Swaps in every reload which has finished since the last call.
+   *  The new geometry is moved into the base mesh we've already handed out, and the rest of the LOD chain
+   *  is replaced. Models pick up the new chain the next time they select an LOD.
+   *  Main thread only, since meshes may be drawing.
+   *  @returns the number of models swapped.
+   */ 
+  size_t FinishReloads();
+
+  /**
+   *  Looks up the LOD chain for a cached model.
+   *  @param base - the base mesh, ex. the first entry from LoadLODs.
+   *  @returns the model's current LOD chain, or an empty list if `base` isn't cached here.
+   */ 
+  std::vector<std::shared_ptr<model::Mesh<storage::VertexPacket3D>>> FindLODs(const model::Mesh<storage::VertexPacket3D>* base);
+
+  /**
+   *  @returns the number of models swapped by FinishReloads, across all loaders.
+   *           Lets models tell cheaply whether their LOD chain might be stale.
+   */ 
+  static uint64_t GetReloadCount();
+
   bool IsCached(const std::string& path) override;
  protected:
  
  private:
+  // max number of simplified meshes generated per model
+  static const int LOD_LEVELS = 3;
+
   struct model_record {
     std::shared_ptr<model::Mesh<>> ptr;
+    // simplified versions of `ptr`, starting with `ptr` itself
+    std::vector<std::shared_ptr<model::Mesh<>>> lods;
     uint64_t size;
+    // the latest reload swapped into this record -- 0 if it's never been reloaded
+    uint64_t reload_id;
   };
 
+  /**
+   *  Creates a cache record for a freshly loaded mesh, generating its LODs.
+   *  @param mesh - the base mesh.
+   *  @param size - size of the file which the mesh was loaded from.
+   */ 
+  static model_record CreateRecord(std::shared_ptr<model::Mesh<>> mesh, uint64_t size);
+
 
   /**
    *  Similar to above, but populates the cache directly instead of returning a promise.
@@ -70,6 +121,12 @@ class ModelLoader : public CachedLoader<std::shared_ptr<model::Mesh<storage::Ver
   std::unordered_map<std::string, model_record> model_cache_;
   std::condition_variable load_cond_var_;
 
+  // reloads which have been parsed, but not swapped in yet
+  std::mutex reload_mutex_;
+  std::unordered_map<std::string, model_record> reloads_;
+  uint64_t next_reload_id_;
+
+  static std::atomic<uint64_t> reload_count_;
 
 
 };
@@ -28,6 +28,13 @@ class TextureLoader : public CachedLoader<std::shared_ptr<shader::Texture>, Text
   
   std::shared_ptr<shader::Texture> LoadFile(const std::string& path);
 
+  /**
+   *  Reloads a cached texture in place, so everyone holding it sees the new image.
+   *  Main thread only.
+   *  @returns true if the texture was cached.
+   */ 
+  bool ReloadFile(const std::string& path);
+
   bool IsCached(const std::string& path) override;
  
  private:
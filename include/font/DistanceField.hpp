@@ -0,0 +1,66 @@
+#ifndef DISTANCE_FIELD_H_
+#define DISTANCE_FIELD_H_
+
+#include <glm/glm.hpp>
+
+#include <cinttypes>
+#include <vector>
+
+namespace monkeysworld {
+namespace font {
+
+/**
+ *  Converts high resolution coverage bitmaps into low resolution signed distance fields.
+ *
+ *  Uses an exact euclidean distance transform (Felzenszwalb + Huttenlocher) on the high resolution
+ *  bitmap, and samples it at the center of each output pixel. The vertical pass runs a row at a
+ *  time, four pixels per step with SSE -- the horizontal pass only runs on rows which are sampled.
+ *
+ *  Scratch space is kept between calls -- use one instance per thread.
+ */
+class DistanceField {
+ public:
+  /**
+   *  Generates a distance field.
+   *  @param coverage - 8 bit coverage bitmap, top row first.
+   *  @param size - size of the coverage bitmap, in pixels.
+   *  @param pitch - bytes between the start of each row.
+   *  @param origin - position of the bitmap's top left corner within the output, in high res pixels.
+   *  @param upsample - number of high res pixels per output pixel, on each axis.
+   *  @param spread - distance from the edge, in output pixels, at which the field saturates.
+   *  @param out_size - size of the output, in output pixels.
+   *  @param out - output, row major. 128 lies on the edge, higher values are inside the glyph.
+   */
+  void Generate(const uint8_t* coverage, glm::ivec2 size, int pitch, glm::ivec2 origin,
+                int upsample, int spread, glm::ivec2 out_size, uint8_t* out);
+
+ private:
+  /**
+   *  Computes squared distances to the nearest feature pixel, for each sampled pixel.
+   *  @param inside - if true, features are covered pixels. Otherwise, they're uncovered pixels.
+   *  @param result - squared distance for each output pixel, in high res pixels.
+   */
+  void Transform(bool inside, int upsample, glm::ivec2 out_size, std::vector<float>& result);
+
+  /**
+   *  1D squared distance transform of a sampled function, into row_dist_.
+   */
+  void Transform1D(const double* f, int n);
+
+  glm::ivec2 grid_size_;
+  std::vector<uint8_t> mask_;           // high res, 1 for covered pixels
+  std::vector<float> column_;           // vertical distance to nearest feature, high res
+  std::vector<float> dist_inside_;      // squared distance to nearest covered pixel, per output pixel
+  std::vector<float> dist_outside_;     // squared distance to nearest uncovered pixel, per output pixel
+
+  // lower envelope scratch
+  std::vector<double> row_;
+  std::vector<double> row_dist_;
+  std::vector<int> hull_vertex_;
+  std::vector<double> hull_bound_;
+};
+
+}
+}
+
+#endif
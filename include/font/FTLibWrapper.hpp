@@ -4,6 +4,9 @@
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
+#include <memory>
+#include <mutex>
+
 namespace monkeysworld {
 namespace font {
 class FTLibWrapper {
@@ -22,8 +25,26 @@ class FTLibWrapper {
       // complain again i guess?
     }
   }
-  
+
+  /**
+   *  FT_Library isn't thread safe, so every thread gets one of its own.
+   *  It sticks around for as long as something is holding onto it -- faces made from it included.
+   *  @returns the calling thread's library.
+   */
+  static std::shared_ptr<FTLibWrapper> GetThreadLibrary() {
+    static thread_local std::weak_ptr<FTLibWrapper> thread_lib;
+    auto res = thread_lib.lock();
+    if (!res) {
+      res = std::make_shared<FTLibWrapper>();
+      thread_lib = res;
+    }
+
+    return res;
+  }
+
   FT_Library lib;
+  // faces may be freed on another thread -- hold this while creating or destroying them
+  std::mutex lock;
 };
 }
 }
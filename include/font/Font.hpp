@@ -4,16 +4,24 @@
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
+#include <file/LoaderThreadPool.hpp>
+
 #include <font/FTLibWrapper.hpp>
+#include <font/GlyphRasterizer.hpp>
+#include <font/Shaper.hpp>
 #include <font/TextFormat.hpp>  
 
 #include <glad/glad.h>
 
 #include <model/Mesh.hpp>
 #include <storage/VertexPacketTypes.hpp>
+#include <utils/ShelfPacker.hpp>
 
+#include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace monkeysworld {
 namespace font {
@@ -30,27 +38,100 @@ struct glyph_info {
   // dist to advance origin by for next char (horiz only for now)
   float advance;
 
-  // start of glyph on x axis in texture coords
-  float origin_x;
+  // top left corner of glyph in the atlas, in pixels. distance fields have a margin around this.
+  int atlas_x;
+  int atlas_y;
+
+  // last time this glyph was used -- least recently used glyphs are evicted first
+  uint64_t last_used;
 
-  // false for characters which did not load correctly
+  // false for characters which did not load correctly, or didn't fit in the atlas
   bool valid;
 };
 
+/**
+ *  A glyph placed by ShapeText, before alignment is applied.
+ */ 
+struct shaped_glyph {
+  FT_UInt glyph;
+  // top left corner of the quad, and its dimensions, in object space
+  glm::vec2 origin;
+  glm::vec2 size;
+  uint32_t line;
+};
+
+/**
+ *  Shaping state after a codepoint has been consumed, so that strings sharing a prefix
+ *  can pick up from where it ends. Doubles as a list of caret stops.
+ *  Shapers which look at a whole run leave these between clusters, but can only be resumed between runs.
+ */ 
+struct shape_checkpoint {
+  // bytes consumed
+  size_t offset;
+  // bytes which had some say in the shaping thus far -- malformed UTF-8 and kerning peek ahead
+  size_t safe_end;
+  glm::vec2 pen;
+  uint32_t glyph_count;
+  uint32_t line;
+  float y_min;
+  float y_max;
+};
+
+/**
+ *  Text which has been laid out -- positions and glyphs, but no texcoords.
+ *  Stays valid as the atlas changes, so it can be reused across frames.
+ */ 
+struct shaped_text {
+  std::string text;
+  float size_pt;
+  TextFormat format;
+  std::vector<shaped_glyph> glyphs;
+  std::vector<shape_checkpoint> checkpoints;
+  // alignment, subtracted from glyph positions
+  std::vector<float> line_offsets;
+  float y_offset;
+};
+
+/**
+ *  Extents of laid out text, in the same space as its geometry.
+ */ 
+struct text_metrics {
+  glm::vec2 min;
+  glm::vec2 max;
+  uint32_t line_count;
+};
+
+class GlyphAtlasCache;
+
 /**
  *  Represents a font and all of its glyphs, returning information pertaining to textures, etc.
+ *
+ *  Glyphs are rasterized the first time they're used, and packed into a shared atlas.
+ *  The atlas grows as it fills up -- once it can't grow any further, the least recently used glyphs
+ *  are evicted to make room. Only the regions which changed are uploaded.
  */ 
 class Font {
  public:
+  // tallest the glyph atlas can grow, in px
+  static const int MAX_ATLAS_HEIGHT = 4096;
+
   /**
    *  Creates a new Font object.
    *  @param font_name - the path to the desired font.
+   *  @param mode - how glyphs should be stored. Distance field fonts rasterize printable ASCII
+   *                up front, since each glyph costs a bit more to generate.
+   *  @param pool - if provided, up front rasterization is split across its threads. The calling thread
+   *                pitches in too, so this is safe to call from one of the pool's own tasks.
+   *  @param atlas_cache - if provided, the atlas is read back from here if this font has been stored before,
+   *                      and only glyphs which are missing are rasterized. May be null.
    */ 
-  Font(const std::string& font_path);
+  Font(const std::string& font_path, GlyphMode mode = GlyphMode::SDF,
+       std::shared_ptr<file::LoaderThreadPool> pool = nullptr,
+       const GlyphAtlasCache* atlas_cache = nullptr);
 
   /**
    *  Generates and returns geometry from text. Initial origin is always <0, 0, 0>, and the glyphs are projected onto the XY plane.
-   *  @param text - the message being read.
+   *  @param text - the message being read, in UTF-8.
    *  @param size_pt - the size of the text, in pt.
    *  @returns A 3D mesh corresponding with the desired text. Texture coordinates correspond with the
    *           glyph atlas (see GetGlyphAtlas()).
@@ -70,54 +151,259 @@ class Font {
   model::Mesh<storage::VertexPacket2D> GetTextGeometry(const std::string& text, float size_pt, TextFormat opts) const;
 
   /**
-   *  Gets the glyph atlas associated with this font.
+   *  Lays out a string, or fetches it from the font's shaping cache.
+   *  Text is broken into runs at line breaks and control characters, and each run is passed to the shaper.
+   *  @param text - the message being read, in UTF-8.
+   *  @param size_pt - the size of the text, in pt.
+   *  @param opts - formatting options.
+   *  @param hint - text previously shaped by this font. If it shares a prefix with `text`,
+   *                shaping resumes from where the prefix ends. May be null.
+   *  @returns the laid out text. Shared with anyone else asking for the same string.
+   */ 
+  std::shared_ptr<const shaped_text> ShapeText(const std::string& text, float size_pt, TextFormat opts,
+                                               const shaped_text* hint = nullptr) const;
+
+  /**
+   *  Writes geometry for shaped text, four vertices per glyph, in the same order as GetTextGeometry.
+   *  Glyphs should be drawn as two triangles, (0, 1, 2) and (2, 3, 0).
+   *  @param shaped - text shaped by this font.
+   *  @param out - destination, with room for 4 * shaped.glyphs.size() vertices.
+   */ 
+  void WriteTextGeometry(const shaped_text& shaped, storage::VertexPacket2D* out) const;
+
+  /**
+   *  Starts a batch of text. Until the matching EndBatch, every glyph shaped or written counts as in use,
+   *  so nothing written earlier in the batch is evicted to make room for what comes later.
+   *  Batches nest.
+   */ 
+  void BeginBatch() const;
+
+  /**
+   *  Ends a batch started by BeginBatch.
+   */ 
+  void EndBatch() const;
+
+  /**
+   *  Measures shaped text, without building any geometry.
+   *  @param shaped - text shaped by this font.
+   *  @returns the bounds of its glyphs. Zero if nothing is drawn.
+   */ 
+  text_metrics MeasureText(const shaped_text& shaped) const;
+
+  /**
+   *  Measures a string. Shares its layout with ShapeText, so nothing is allocated if it's been seen before.
+   */ 
+  text_metrics MeasureText(const std::string& text, float size_pt, TextFormat opts) const;
+
+  /**
+   *  Finds where a caret would sit.
+   *  @param shaped - text shaped by this font.
+   *  @param offset - byte offset of the caret within the text.
+   *  @returns the caret's position on the baseline, in the same space as the text's geometry.
+   */ 
+  glm::vec2 GetCaretPosition(const shaped_text& shaped, size_t offset) const;
+
+  /**
+   *  Finds where lines should be broken so that none are wider than `max_width`.
+   *  Lines are broken at spaces and tabs. Words which won't fit on a line of their own are left to overflow.
+   *  @param shaped - text shaped by this font.
+   *  @param max_width - widest a line may be, in the same space as the text's geometry.
+   *  @param breaks - replaced with the offset of each whitespace byte which should become a line break.
+   */ 
+  void FindLineBreaks(const shaped_text& shaped, float max_width, std::vector<size_t>* breaks) const;
+
+  /**
+   *  Word wraps a string. Whitespace is swapped for line breaks, so byte offsets don't change.
+   *  @param text - the message being read, in UTF-8.
+   *  @param size_pt - the size of the text, in pt.
+   *  @param opts - formatting options.
+   *  @param max_width - widest a line may be, in the same space as the text's geometry.
+   *  @returns the wrapped text.
+   */ 
+  std::string WrapText(const std::string& text, float size_pt, TextFormat opts, float max_width) const;
+
+  /**
+   *  Gets the glyph atlas associated with this font, uploading any glyphs rasterized since the last call.
+   *  Must be called on the GL thread.
    *  @returns a GL descriptor associated with the underlying font atlas.
    */ 
   GLuint GetGlyphAtlas() const;
 
+  /**
+   *  @returns a counter which changes whenever glyphs move around in the atlas, or the atlas is resized.
+   *           Geometry generated before it changed has stale texture coordinates.
+   */ 
+  uint64_t GetAtlasGeneration() const;
+
+  /**
+   *  @returns how this font's glyphs are stored -- distance field atlases need a different shader.
+   */ 
+  GlyphMode GetGlyphMode() const;
+
+  /**
+   *  @returns the current size of the glyph atlas, in pixels.
+   */ 
+  glm::ivec2 GetAtlasDimensions() const;
+
+  /**
+   *  Replaces the shaper used to lay out text. Fonts start out with a HarfBuzzShaper if it was built,
+   *  and a KerningShaper otherwise. Clears the shaping cache -- text shaped beforehand keeps its old layout,
+   *  so this should be done before the font is used.
+   *  @param shaper - the new shaper.
+   */ 
+  void SetShaper(std::unique_ptr<Shaper> shaper);
+
+  /**
+   *  Stores the glyph atlas, so that later loads can skip rasterizing.
+   *  @param cache - where the atlas is stored.
+   *  @returns true if the atlas was written -- false if it failed, or nothing changed since it was loaded or stored.
+   */ 
+  bool StoreAtlas(const GlyphAtlasCache& cache) const;
+
+  /**
+   *  @returns the size of the font file, in bytes.
+   */ 
+  size_t GetFileSize() const;
+
   ~Font();
   Font(const Font& other) = delete;
   Font& operator=(const Font& other) = delete;
   Font(Font&& other);
   Font& operator=(Font&& other);
  private:
-  // bounds for glyphs
-  const char glyph_lower_ = 0x20;
-  const char glyph_upper_ = 0x7e;
   // size of loader glyphs
-  const int bitmap_desired_scale = 256;
-
-  /**
-   *  MANAGING A LIBRARY
-   *  
-   *  From here, we have no concept of consistent threads, forcing us to use locks
-   *  to access a shared FT_Library across all font instances.
-   * 
-   *  However, this is difficult to actually do.
-   * 
-   *  What we want is an RAII singleton class which wraps `FT_Library`,
-   *  and (i guess?) a static weak_ptr which stores it (wrapping init_freetype and any cleanup funcs)
-   * 
-   *  - Why a weak ptr?
-   *    - seems like a better way to ensure that we initialize it when we get there, and de-initialize when we leave.
-   * 
-   *  First, we grab a mutex lock, and attempt to lock the ptr.
-   *  If that fails, then we create a new instance of `Library,` and continue using the lock.
-   *  If it succeeds, then we store the resulting shared ptr in the class.
-   */ 
-  // weak ptr to static shared lib
-  static std::weak_ptr<FTLibWrapper> lib_singleton_;
-  // local shared ptr to lib
+  static const int BITMAP_SCALE = 256;
+  // distance fields are rasterized at SDF_SCALE * SDF_UPSAMPLE, and downsampled
+  static const int SDF_SCALE = 48;
+  static const int SDF_UPSAMPLE = 4;
+  // margin around distance field glyphs, in pixels -- the field saturates at this distance
+  static const int SDF_SPREAD = 4;
+
+  // atlas is a fixed width, and grows in height (powers of two) as glyphs are added
+  static const int BITMAP_ATLAS_WIDTH = 2048;
+  static const int SDF_ATLAS_WIDTH = 512;
+  static const int MIN_ATLAS_HEIGHT = 256;
+
+  // number of shaped strings kept around
+  static const size_t SHAPE_CACHE_SIZE = 512;
+
+  struct shape_cache_entry {
+    std::shared_ptr<const shaped_text> shaped;
+    uint64_t last_used;
+  };
+
+  /**
+   *  Fetches a glyph, rasterizing it if it isn't in the atlas. Expects glyph_lock_ to be held.
+   *  @param glyph_index - index of the glyph in our face.
+   *  @returns the glyph's info. Stays valid until the glyph is evicted, though it may move within the atlas.
+   */ 
+  glyph_info* GetGlyph(FT_UInt glyph_index) const;
+
+  /**
+   *  Rasterizes a glyph into the atlas. Expects glyph_lock_ to be held.
+   */ 
+  glyph_info RasterizeGlyph(FT_UInt glyph_index) const;
+
+  /**
+   *  Packs a rendered glyph into the atlas. Expects glyph_lock_ to be held.
+   */ 
+  glyph_info PackGlyph(const rendered_glyph& rendered) const;
+
+  /**
+   *  Rasterizes a batch of glyphs into the atlas, split across a thread pool.
+   *  Each thread renders from a face of its own, sharing the font's file data.
+   */ 
+  void RasterizeGlyphs(const std::vector<FT_UInt>& glyphs, std::shared_ptr<file::LoaderThreadPool> pool);
+
+  /**
+   *  Replaces the atlas with one stored earlier.
+   *  @returns true if a matching atlas was found.
+   */ 
+  bool LoadAtlas(const GlyphAtlasCache& cache);
+
+  /**
+   *  @returns the key this font's atlas is stored under. Expects glyph_lock_ to be held.
+   */ 
+  uint64_t GetAtlasKey() const;
+
+  /**
+   *  Evicts the least recently used half of the atlas, and repacks what's left.
+   *  Glyphs stamped with the current tick are never evicted -- if they can't all be repacked, nothing is.
+   *  @returns true if anything was evicted.
+   */ 
+  bool EvictGlyphs() const;
+
+  /**
+   *  Marks a region of the atlas as needing upload.
+   */ 
+  void MarkDirty(glm::ivec2 min, glm::ivec2 max) const;
+
+  /**
+   *  Lays out text from scratch, or from the longest usable prefix of `hint`. Expects glyph_lock_ to be held.
+   */ 
+  void Shape(const shaped_text* hint, shaped_text* res) const;
+
+  /**
+   *  Shapes the run gathered in run_codepoints_, and places its glyphs. Expects glyph_lock_ to be held.
+   *  @param context_end - end of the bytes which can affect the run's last glyph.
+   *  @param state - shaping state, advanced past the run.
+   */ 
+  void PlaceRun(size_t context_end, shaped_text* res, shape_checkpoint* state) const;
+
+  // library of the thread which created the face. FreeType libraries aren't thread safe, so each thread has its own --
+  // this keeps fonts loading on different threads from waiting on one another.
   std::shared_ptr<FTLibWrapper> ft_lib_;
-  // static mutex for shared commands
-  static std::mutex ft_lib_lock_;
-  glyph_info* glyph_cache_;
-  // TBA: stores glyphs in-memory so they can be xfer'd to GPU all at once
-  char* memory_cache_;
-  GLuint glyph_texture_;
-
-  int atlas_width;
-  int atlas_height;
+  // contents of the font file, shared read-only by every face opened on it
+  std::shared_ptr<const std::vector<FT_Byte>> font_data_;
+  // kept open so glyphs can be rasterized later on
+  FT_Face face_;
+
+  // guards the face, and everything below
+  mutable std::mutex glyph_lock_;
+  // glyphs in the atlas, by glyph index
+  mutable std::unordered_map<FT_UInt, glyph_info> glyph_cache_;
+  // CPU copy of the atlas -- only as tall as the rows which have been packed
+  mutable std::vector<uint8_t> atlas_data_;
+  mutable utils::ShelfPacker packer_;
+  mutable int atlas_height_;
+  mutable uint64_t use_tick_;
+  // open batches -- use_tick_ stays put while there are any
+  mutable int batch_depth_;
+  mutable uint64_t generation_;
+  // set when glyphs are added or moved, since the atlas was last loaded or stored
+  mutable bool atlas_changed_;
+  mutable uint64_t atlas_key_;
+  mutable bool atlas_key_valid_;
+
+  // region of the atlas which hasn't been uploaded
+  mutable glm::ivec2 dirty_min_;
+  mutable glm::ivec2 dirty_max_;
+  mutable GLuint glyph_texture_;
+  mutable int texture_height_;
+
+  GlyphMode mode_;
+  // size glyphs are stored at, in px
+  int glyph_scale_;
+  // size glyphs are rasterized at, relative to glyph_scale_
+  int upsample_;
+  // margin around each glyph in the atlas
+  int glyph_padding_;
+  int atlas_width_;
+  mutable std::unique_ptr<GlyphRasterizer> rasterizer_;
+  mutable rendered_glyph render_scratch_;
+
+  // shaped strings, by hash of their text, size and format
+  mutable std::unordered_multimap<uint64_t, shape_cache_entry> shape_cache_;
+  mutable uint64_t shape_tick_;
+  mutable std::vector<glyph_info*> quad_scratch_;
+
+  std::unique_ptr<Shaper> shaper_;
+  // run being shaped, with the offset past each codepoint and the bytes read to decode it
+  mutable std::vector<uint32_t> run_codepoints_;
+  mutable std::vector<std::pair<size_t, size_t>> run_ends_;
+  mutable std::vector<run_glyph> run_glyphs_;
+
+  float space_advance_;
 
   // height of a line (1/64th px)
   float line_height_;
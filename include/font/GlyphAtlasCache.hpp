@@ -0,0 +1,87 @@
+#ifndef GLYPH_ATLAS_CACHE_H_
+#define GLYPH_ATLAS_CACHE_H_
+
+#include <font/Font.hpp>
+#include <utils/ShelfPacker.hpp>
+
+#include <cinttypes>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace monkeysworld {
+namespace font {
+
+/**
+ *  A font's glyph atlas, as it's stored on disk.
+ */
+struct baked_atlas {
+  int width;
+  // height of the texture, not the data
+  int height;
+  // rows which have been packed, `width` bytes each
+  std::vector<uint8_t> data;
+  std::vector<std::pair<FT_UInt, glyph_info>> glyphs;
+  std::vector<utils::ShelfPacker::shelf> shelves;
+};
+
+/**
+ *  Stores rasterized glyph atlases on disk, so that successive launches can skip FreeType.
+ *
+ *  Atlases are keyed by a hash of the font file, and everything which changes how its glyphs are stored
+ *  (mode, size, margins). Changing the font file on disk just means it's rasterized again.
+ */
+class GlyphAtlasCache {
+ public:
+  static const uint32_t ATLAS_MAGIC = 0x4146534D;   // MSFA
+  // bump when the file layout, or how glyphs are rasterized, changes
+  static const uint32_t ATLAS_VERSION = 1;
+
+  /**
+   *  Creates a new atlas cache.
+   *  @param cache_dir - directory where atlases are stored, including the trailing slash.
+   */
+  GlyphAtlasCache(const std::string& cache_dir);
+
+  /**
+   *  Computes the key for an atlas.
+   *  @param font_data - contents of the font file.
+   *  @param mode - how glyphs are stored.
+   *  @param glyph_scale - size glyphs are stored at, in px.
+   *  @param upsample - size glyphs are rasterized at, relative to glyph_scale.
+   *  @param padding - margin around each glyph, in px.
+   *  @param atlas_width - width of the atlas, in px.
+   *  @returns a key identifying this atlas.
+   */
+  static uint64_t GetAtlasKey(const std::vector<FT_Byte>& font_data, GlyphMode mode,
+                              int glyph_scale, int upsample, int padding, int atlas_width);
+
+  /**
+   *  Reads an atlas from disk.
+   *  @param key - the key associated with the atlas.
+   *  @param atlas - output param for the atlas.
+   *  @returns true if a valid atlas was found, false otherwise.
+   */
+  bool ReadAtlas(uint64_t key, baked_atlas* atlas) const;
+
+  /**
+   *  Writes an atlas to disk.
+   *  @param key - the key associated with the atlas.
+   *  @param atlas - the atlas being written.
+   *  @returns true if the atlas was written, false otherwise.
+   */
+  bool WriteAtlas(uint64_t key, const baked_atlas& atlas) const;
+
+ private:
+  /**
+   *  @returns the path where the atlas for `key` is stored.
+   */
+  std::string GetAtlasPath(uint64_t key) const;
+
+  std::string cache_dir_;
+};
+
+}
+}
+
+#endif  // GLYPH_ATLAS_CACHE_H_
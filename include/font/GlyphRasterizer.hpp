@@ -0,0 +1,76 @@
+#ifndef GLYPH_RASTERIZER_H_
+#define GLYPH_RASTERIZER_H_
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <font/DistanceField.hpp>
+
+#include <glm/glm.hpp>
+
+#include <cinttypes>
+#include <vector>
+
+namespace monkeysworld {
+namespace font {
+
+/**
+ *  How glyphs are stored in the atlas.
+ */
+enum class GlyphMode {
+  BITMAP,   // coverage, rasterized at a large size -- blurry when scaled down
+  SDF       // signed distance field, rasterized small -- crisp at any size
+};
+
+/**
+ *  A glyph in the form it's stored in the atlas, waiting to be packed.
+ */
+struct rendered_glyph {
+  FT_UInt glyph;
+  // false if the glyph couldn't be loaded
+  bool valid;
+  // 1/64 px, at the size glyphs are stored at
+  float advance;
+  // offset of the glyph's top left corner from the pen, in px
+  int bearing_x;
+  int bearing_y;
+  // size of the glyph, margin included
+  glm::ivec2 size;
+  // size.x * size.y pixels, row major
+  std::vector<uint8_t> pixels;
+};
+
+/**
+ *  Renders glyphs from a face into the format they're stored in.
+ *
+ *  Doesn't touch anything shared, so several can run at once on different faces.
+ *  Scratch space is kept between calls -- use one instance per thread.
+ */
+class GlyphRasterizer {
+ public:
+  /**
+   *  @param mode - format glyphs are rendered in.
+   *  @param upsample - size of the face, relative to the size glyphs are stored at.
+   *  @param padding - margin left around distance field glyphs, in px. The field saturates at this distance.
+   */
+  GlyphRasterizer(GlyphMode mode, int upsample, int padding);
+
+  /**
+   *  Renders a glyph.
+   *  @param face - face to render from, already sized.
+   *  @param glyph_index - glyph to render.
+   *  @param out - written with the result. Its pixel buffer is reused.
+   */
+  void Render(FT_Face face, FT_UInt glyph_index, rendered_glyph* out);
+
+ private:
+  GlyphMode mode_;
+  int upsample_;
+  int padding_;
+  DistanceField sdf_;
+};
+
+}
+}
+
+#endif
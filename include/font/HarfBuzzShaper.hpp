@@ -0,0 +1,43 @@
+#ifndef HARF_BUZZ_SHAPER_H_
+#define HARF_BUZZ_SHAPER_H_
+
+#ifdef MONKEYSWORLD_HARFBUZZ
+
+#include <font/Shaper.hpp>
+
+#include <hb.h>
+
+namespace monkeysworld {
+namespace font {
+
+/**
+ *  Shapes runs with HarfBuzz -- GPOS kerning, ligatures, marks and complex scripts.
+ *  Script and direction are guessed per run. Only built with the harfbuzz option enabled.
+ */
+class HarfBuzzShaper : public Shaper {
+ public:
+  HarfBuzzShaper();
+  int GetLookahead() const override;
+  void ShapeRun(FT_Face face, const uint32_t* codepoints, size_t count, std::vector<run_glyph>* out) override;
+
+  ~HarfBuzzShaper();
+  HarfBuzzShaper(const HarfBuzzShaper& other) = delete;
+  HarfBuzzShaper& operator=(const HarfBuzzShaper& other) = delete;
+
+ private:
+  // face which font_ wraps
+  FT_Face face_;
+  // face's scale when font_ last read it -- sizes are set on the face, so font_ has to be told
+  FT_Fixed x_scale_;
+  FT_Fixed y_scale_;
+  hb_font_t* font_;
+  // reused between runs
+  hb_buffer_t* buffer_;
+};
+
+}
+}
+
+#endif
+
+#endif
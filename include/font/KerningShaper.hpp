@@ -0,0 +1,34 @@
+#ifndef KERNING_SHAPER_H_
+#define KERNING_SHAPER_H_
+
+#include <font/Shaper.hpp>
+
+#include <unordered_map>
+
+namespace monkeysworld {
+namespace font {
+
+/**
+ *  Default shaper -- one glyph per codepoint, advanced by the face's metrics and pulled together
+ *  by its kerning pairs. Only the legacy 'kern' table is read: GPOS kerning, ligatures and
+ *  complex scripts need HarfBuzzShaper.
+ */
+class KerningShaper : public Shaper {
+ public:
+  int GetLookahead() const override;
+  void ShapeRun(FT_Face face, const uint32_t* codepoints, size_t count, std::vector<run_glyph>* out) override;
+
+ private:
+  /**
+   *  @returns the advance of a glyph, in 1/64 px.
+   */
+  int32_t GetAdvance(FT_Face face, FT_UInt glyph);
+
+  // advances by glyph index -- a font's face never changes size
+  std::unordered_map<FT_UInt, int32_t> advances_;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef SHAPER_H_
+#define SHAPER_H_
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <glm/glm.hpp>
+
+#include <cinttypes>
+#include <vector>
+
+namespace monkeysworld {
+namespace font {
+
+/**
+ *  A glyph placed by a shaper. Distances are in 1/64 px, at the size the face is set to.
+ */
+struct run_glyph {
+  FT_UInt glyph;
+  // index of the first codepoint in the run which this glyph came from
+  uint32_t cluster;
+  // distance to move the pen afterwards, kerning included
+  int32_t advance;
+  // where the glyph sits relative to the pen
+  glm::ivec2 offset;
+};
+
+/**
+ *  Turns runs of codepoints into glyphs, and works out where they go.
+ *
+ *  A run is a stretch of text without line breaks or control characters -- Font deals with those.
+ *  Each font owns its shaper, and only calls it on its own face, with its glyph lock held.
+ */
+class Shaper {
+ public:
+  /**
+   *  @returns how many codepoints past a glyph can affect where it lands, or a negative number if
+   *           the whole run can (ligatures, complex scripts). Font only reuses shaped prefixes which
+   *           can't have seen a change. Shapers with a bounded lookahead must output exactly one
+   *           glyph per codepoint, in order.
+   */
+  virtual int GetLookahead() const = 0;
+
+  /**
+   *  Shapes a run.
+   *  @param face - the font's face, set to the size glyphs are rasterized at.
+   *  @param codepoints - the run, in logical order.
+   *  @param count - number of codepoints in the run.
+   *  @param out - replaced with the run's glyphs, in visual order.
+   */
+  virtual void ShapeRun(FT_Face face, const uint32_t* codepoints, size_t count, std::vector<run_glyph>* out) = 0;
+
+  virtual ~Shaper() {}
+};
+
+}
+}
+
+#endif
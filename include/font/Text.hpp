@@ -31,11 +31,11 @@ class Text {
   /**
    *  Returns the font object associated with this text.
    */ 
-  std::shared_ptr<const Font> GetFont();
+  std::shared_ptr<const Font> GetFont() const;
 
   /**
    *  Set the text associated with this text object.
-   *  For now: only supports chars in range [0x30, 0x7e]
+   *  Text is UTF-8 -- characters missing from the font draw as its fallback glyph.
    *  @param text - the new text which should be displayed.
    */ 
   void SetText(const std::string& text);
@@ -74,12 +74,31 @@ class Text {
    */ 
   GLuint GetTexture() const;
 
+  /**
+   *  Modifies the alignment and spacing of outputted text.
+   *  @param format - the new format.
+   */ 
   void SetTextFormat(TextFormat format);
 
   TextFormat GetTextFormat() const {
     return format_;
   }
 
+  /**
+   *  Word wraps text, breaking lines at whitespace.
+   *  @param width - widest a line may be, in the same space as the text's geometry. 0 turns wrapping off.
+   */ 
+  void SetWrapWidth(float width);
+
+  float GetWrapWidth() const {
+    return wrap_width_;
+  }
+
+  /**
+   *  @returns the text's layout -- enough to measure it, or place a caret, without building any geometry.
+   */ 
+  std::shared_ptr<const shaped_text> GetLayout() const;
+
   /**
    *  @returns geometry corresponding with the text.
    */ 
@@ -93,8 +112,16 @@ class Text {
   std::shared_ptr<const Font> font_;
   float size_;
   bool mesh_valid_;
+  uint64_t atlas_generation_;
   std::shared_ptr<model::Mesh<storage::VertexPacket2D>> mesh_;
   TextFormat format_;
+  float wrap_width_;
+  // current layout -- also used as a hint when the text changes
+  mutable std::shared_ptr<const shaped_text> shaped_;
+  mutable bool layout_valid_;
+  // swapped with the mesh's buffers on each rebuild, so their allocations stick around
+  mutable std::vector<storage::VertexPacket2D> vertices_;
+  mutable std::vector<unsigned int> indices_;
 };
 
 }
@@ -0,0 +1,156 @@
+#ifndef TEXT_BATCH_H_
+#define TEXT_BATCH_H_
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+#include <engine/Context.hpp>
+#include <font/Font.hpp>
+#include <font/Text.hpp>
+#include <shader/materials/TextBatchMaterial.hpp>
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace monkeysworld {
+namespace font {
+
+/**
+ *  Collects the glyphs of many Text objects, and draws them with one draw call per glyph atlas.
+ *
+ *  Each text object gets a transform (scale + offset into clip space) and a clip rectangle,
+ *  stored in a shader storage buffer. Glyph quads carry their color, and the index of their transform,
+ *  so nothing needs to be rebound between objects. Each atlas streams its quads into its own
+ *  vertex buffer, which is orphaned when it fills up -- same as UniformRing.
+ *
+ *  Text objects are drawn in the order they were added, within each atlas.
+ *  Text in different fonts can draw out of order, if it overlaps.
+ *
+ *  Main thread only.
+ */ 
+class TextBatch {
+ public:
+  /**
+   *  Vertex format for batched glyphs.
+   */ 
+  struct TextBatchPacket {
+    glm::vec2 position;       // glyph position, before the object's transform
+    glm::vec2 texcoord;       // atlas coordinates
+    uint32_t color;           // RGBA8
+    uint32_t transform;       // index into the transform buffer
+    static void Bind();
+  };
+
+  /**
+   *  Per-object data, as laid out in text-batch.vert (std430).
+   */ 
+  struct text_transform {
+    glm::vec4 scale_offset;   // xy scales positions, zw offsets them
+    glm::vec4 clip;           // xy min, zw max, in clip space
+  };
+
+  // shader storage binding for transforms
+  static const GLuint TRANSFORM_BINDING = 4;
+
+  TextBatch(engine::Context* ctx);
+
+  /**
+   *  Packs a color into RGBA8, in memory order. Channels are clamped to [0, 1].
+   */ 
+  static uint32_t PackColor(const glm::vec4& color);
+
+  /**
+   *  Converts a block of text's geometry to batched vertices.
+   *  @param mesh - the text's geometry.
+   *  @param color - the text's color, from PackColor.
+   *  @param transform - index of the text's transform.
+   *  @param out - output param. Vertices are appended to the end.
+   */ 
+  static void AppendVertices(const model::Mesh<storage::VertexPacket2D>& mesh, uint32_t color, uint32_t transform,
+                             std::vector<TextBatchPacket>* out);
+
+  /**
+   *  Adds a block of text to the batch.
+   *  Geometry is read when the batch is flushed -- `text` must stay alive until then.
+   *  @param text - the text being drawn.
+   *  @param scale - scale applied to the text's geometry.
+   *  @param offset - offset applied to the scaled geometry, in clip space.
+   *  @param clip_min - minimum corner of the region this text may draw to, in clip space.
+   *  @param clip_max - maximum corner of the region this text may draw to, in clip space.
+   */ 
+  void Add(Text& text, glm::vec2 scale, glm::vec2 offset, glm::vec2 clip_min, glm::vec2 clip_max);
+
+  /**
+   *  @returns true if nothing has been added since the last flush.
+   */ 
+  bool IsEmpty() const;
+
+  /**
+   *  Draws everything added since the last flush, into the bound framebuffer.
+   *  @returns the number of draw calls issued.
+   */ 
+  size_t Flush();
+
+  ~TextBatch();
+  TextBatch(const TextBatch& other) = delete;
+  TextBatch& operator=(const TextBatch& other) = delete;
+ private:
+  // atlases which go unused for this many flushes give up their buffers
+  static const int MAX_IDLE_FLUSHES = 120;
+  // initial size of each atlas's vertex stream
+  static const GLsizeiptr MIN_STREAM_SIZE = 64 * 1024;
+
+  struct batch_entry {
+    Text* text;
+    uint32_t transform;
+  };
+
+  /**
+   *  Everything drawn from one glyph atlas.
+   */ 
+  struct atlas_stream {
+    std::shared_ptr<const Font> font;
+    std::vector<batch_entry> entries;
+    GLuint vao;
+    GLuint vbo;
+    GLsizeiptr capacity;
+    GLsizeiptr head;
+    int idle_flushes;
+  };
+
+  /**
+   *  Copies a stream's glyphs into `vertices_`.
+   *  @returns the number of quads written.
+   */ 
+  size_t GatherVertices(atlas_stream& stream);
+
+  /**
+   *  Writes `vertices_` to the stream's buffer.
+   *  @returns the index of the first vertex written.
+   */ 
+  GLint Upload(atlas_stream& stream);
+
+  /**
+   *  Makes sure the shared index buffer covers at least `quads` quads.
+   */ 
+  void ReserveQuads(size_t quads);
+
+  std::unordered_map<const Font*, atlas_stream> streams_;
+  std::vector<text_transform> transforms_;
+  std::vector<TextBatchPacket> vertices_;
+
+  GLuint transform_buffer_;
+  GLsizeiptr transform_capacity_;
+  // quad indices, shared by every stream
+  GLuint index_buffer_;
+  size_t index_quads_;
+
+  shader::materials::TextBatchMaterial mat_;
+};
+
+}
+}
+
+#endif
@@ -2,6 +2,7 @@
 #define UI_TEXT_OBJECT_H_
 
 #include <font/Text.hpp>
+#include <font/TextBatch.hpp>
 #include <critter/ui/UIObject.hpp>
 
 #include <shader/materials/TextMaterial.hpp>
@@ -90,6 +91,18 @@ class UITextObject : public critter::ui::UIObject {
    */ 
   glm::vec2 GetMinimumBoundingDims() const;
 
+ protected:
+  /**
+   *  Text is drawn in clip space, so it can go straight into the parent.
+   */ 
+  bool SupportsDirectDraw() override { return true; }
+
+  /**
+   *  Adds our glyphs to the parent's text batch.
+   */ 
+  bool DrawBatched(TextBatch& batch, glm::vec2 scale, glm::vec2 offset,
+                   glm::vec2 clip_min, glm::vec2 clip_max) override;
+
  private:
 
   /**
@@ -98,6 +111,11 @@ class UITextObject : public critter::ui::UIObject {
    */ 
   glm::vec2 GetScaleFactor() const;
 
+  /**
+   *  Computes the transform from text geometry into our clip space, as `pos * scale + offset`.
+   */ 
+  void GetTextTransform(glm::vec2* scale, glm::vec2* offset);
+
   shader::materials::TextMaterial mat_;
   Text text_;
 
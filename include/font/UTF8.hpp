@@ -0,0 +1,74 @@
+#ifndef UTF8_H_
+#define UTF8_H_
+
+#include <cinttypes>
+#include <string>
+
+namespace monkeysworld {
+namespace font {
+
+// substituted for anything which can't be decoded
+const uint32_t REPLACEMENT_CHAR = 0xFFFD;
+
+/**
+ *  Decodes the UTF-8 codepoint starting at `*index`, and advances `*index` past it.
+ *  Malformed sequences (overlong, truncated, surrogates, out of range) decode to
+ *  REPLACEMENT_CHAR, consuming a single byte.
+ *  @param text - the string being decoded.
+ *  @param index - position of the codepoint. Must be less than text.size().
+ *  @returns the decoded codepoint.
+ */
+inline uint32_t NextCodepoint(const std::string& text, size_t* index) {
+  const unsigned char* c = reinterpret_cast<const unsigned char*>(text.data()) + *index;
+  size_t remaining = text.size() - *index;
+  uint32_t res;
+  size_t len;
+  uint32_t min;
+  if (c[0] < 0x80) {
+    (*index)++;
+    return c[0];
+  } else if ((c[0] & 0xE0) == 0xC0) {
+    res = c[0] & 0x1F;
+    len = 2;
+    min = 0x80;
+  } else if ((c[0] & 0xF0) == 0xE0) {
+    res = c[0] & 0x0F;
+    len = 3;
+    min = 0x800;
+  } else if ((c[0] & 0xF8) == 0xF0) {
+    res = c[0] & 0x07;
+    len = 4;
+    min = 0x10000;
+  } else {
+    // stray continuation byte, or invalid lead
+    (*index)++;
+    return REPLACEMENT_CHAR;
+  }
+
+  if (remaining < len) {
+    (*index)++;
+    return REPLACEMENT_CHAR;
+  }
+
+  for (size_t i = 1; i < len; i++) {
+    if ((c[i] & 0xC0) != 0x80) {
+      (*index)++;
+      return REPLACEMENT_CHAR;
+    }
+
+    res = (res << 6) | (c[i] & 0x3F);
+  }
+
+  if (res < min || res > 0x10FFFF || (res >= 0xD800 && res <= 0xDFFF)) {
+    (*index)++;
+    return REPLACEMENT_CHAR;
+  }
+
+  *index += len;
+  return res;
+}
+
+}
+}
+
+#endif
@@ -77,6 +77,18 @@ class Mesh {
     dirty_ = true;
   }
 
+  /**
+   *  Swaps this mesh's vertices and indices with the contents of `data` and `indices`.
+   *  Lets callers fill buffers in bulk, and hang onto the old ones for next time.
+   *  @param data - new vertex data. Receives the old vertex data.
+   *  @param indices - new index data, as triangles. Receives the old index data.
+   */ 
+  void SwapData(std::vector<Packet>& data, std::vector<unsigned int>& indices) {
+    data_.swap(data);
+    indices_.swap(indices);
+    dirty_ = true;
+  }
+
   /**
    *  Allows direct access to vertices.
    *  @param index - desired index.
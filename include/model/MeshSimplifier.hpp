@@ -0,0 +1,47 @@
+#ifndef MESH_SIMPLIFIER_H_
+#define MESH_SIMPLIFIER_H_
+
+#include <model/Mesh.hpp>
+#include <storage/VertexPacketTypes.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace monkeysworld {
+namespace model {
+
+/**
+ *  Reduces the triangle count of 3D meshes via quadric edge collapse (Garland-Heckbert).
+ *
+ *  Vertices lying on an open edge of the index topology (mesh borders, as well as UV/normal
+ *  seams, since the OBJ loader splits those into separate vertices) are locked in place,
+ *  so simplified meshes won't crack open along seams. Meshes with lots of seams might
+ *  not reach their target triangle count as a result.
+ */
+class MeshSimplifier {
+ public:
+  /**
+   *  Simplifies the passed mesh.
+   *  @param mesh - the mesh being simplified.
+   *  @param ratio - the fraction of triangles which should remain, in (0, 1].
+   *  @returns a newly allocated mesh containing the simplified geometry.
+   */
+  static std::shared_ptr<Mesh<storage::VertexPacket3D>> Simplify(const Mesh<storage::VertexPacket3D>& mesh,
+                                                                 float ratio);
+
+  /**
+   *  Builds a chain of progressively simplified meshes, each one containing roughly
+   *  half the triangles of the last.
+   *  @param mesh - the base mesh. Not included in the result.
+   *  @param levels - max number of simplified levels to generate.
+   *  @returns list of simplified meshes, from most to least detailed.
+   *           Generation stops early if a level can't be simplified meaningfully.
+   */
+  static std::vector<std::shared_ptr<Mesh<storage::VertexPacket3D>>> BuildLODChain(const Mesh<storage::VertexPacket3D>& mesh,
+                                                                                    int levels);
+};
+
+}
+}
+
+#endif  // MESH_SIMPLIFIER_H_
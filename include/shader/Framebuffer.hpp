@@ -4,6 +4,10 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+#include <shader/FramebufferPool.hpp>
+
+#include <memory>
+
 namespace monkeysworld {
 namespace shader {
 
@@ -28,6 +32,13 @@ class Framebuffer {
    */ 
   Framebuffer();
 
+  /**
+   *  Constructs a new Framebuffer object which borrows its attachments from a pool.
+   *  Pooled attachments may be larger than the framebuffer -- see GetAllocatedDimensions.
+   *  @param pool - the pool to borrow from. Must outlive this framebuffer.
+   */ 
+  explicit Framebuffer(FramebufferPool* pool);
+
   /**
    *  Modifies the dimensions of the framebuffer.
    *  @param size - the new width and height of the framebuffer.
@@ -40,6 +51,13 @@ class Framebuffer {
    */ 
   glm::ivec2 GetDimensions() const;
 
+  /**
+   *  Returns the dimensions of the attachments backing this framebuffer.
+   *  Only the bottom left GetDimensions() pixels are drawn to.
+   *  Equal to GetDimensions() unless the framebuffer is pooled.
+   */ 
+  glm::ivec2 GetAllocatedDimensions() const;
+
   /**
    *  Equivalent to BindFramebuffer(FramebufferTarget::DEFAULT).
    */ 
@@ -77,6 +95,9 @@ class Framebuffer {
   GLuint color_;
   GLuint depth_stencil_;
 
+  FramebufferPool* pool_;                           // null if we own our attachments
+  std::shared_ptr<const render_target> target_;     // borrowed from pool_
+
   glm::ivec2 fb_size_;
   glm::ivec2 fb_size_old_;
 };
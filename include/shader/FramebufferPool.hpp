@@ -0,0 +1,141 @@
+#ifndef FRAMEBUFFER_POOL_H_
+#define FRAMEBUFFER_POOL_H_
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+
+namespace monkeysworld {
+namespace shader {
+
+/**
+ *  A framebuffer and its attachments.
+ */
+struct render_target {
+  GLuint fb;
+  GLuint color;
+  GLuint depth_stencil;
+  glm::ivec2 size;          // allocated size -- may be larger than what's drawn to
+};
+
+/**
+ *  Counters describing how well the pool is doing.
+ */
+struct pool_stats {
+  size_t allocations;       // targets created
+  size_t reuses;            // requests served by an idle target
+  size_t evictions;         // idle targets destroyed to stay under budget
+  size_t bytes_in_use;      // memory held by borrowed targets
+  size_t bytes_idle;        // memory held by idle targets
+};
+
+/**
+ *  Hands out render targets, and takes them back when they're no longer needed.
+ *
+ *  Requested sizes are rounded up into buckets, so that a target which is resized a little
+ *  (or resized back and forth) can keep using the same GL objects instead of reallocating them.
+ *  Targets are reference counted -- once the last reference to a target is dropped, it's
+ *  returned to the pool rather than deleted. Idle targets are evicted, least recently used first,
+ *  whenever the pool goes over its memory budget. Targets which are still borrowed are never evicted.
+ *
+ *  Thread safe, though the GL pool should only be used from the main thread.
+ */
+class FramebufferPool {
+ public:
+  typedef std::function<render_target(glm::ivec2)> alloc_func;
+  typedef std::function<void(const render_target&)> free_func;
+
+  /**
+   *  @returns the process-wide pool, backed by GL.
+   */
+  static FramebufferPool& GetInstance();
+
+  /**
+   *  Creates a new pool.
+   *  @param budget - memory, in bytes, which the pool may hold before evicting idle targets.
+   *  @param alloc - creates a target of the given size.
+   *  @param free - destroys a target.
+   */
+  FramebufferPool(size_t budget, alloc_func alloc, free_func free);
+
+  /**
+   *  Borrows a target.
+   *  @param size - the minimum size of the target.
+   *  @returns a target at least as large as `size`. It returns to the pool once every reference is gone.
+   *           Its contents are undefined.
+   */
+  std::shared_ptr<const render_target> Acquire(glm::ivec2 size);
+
+  /**
+   *  Changes the memory budget, evicting idle targets if we're now over it.
+   */
+  void SetBudget(size_t budget);
+
+  /**
+   *  Destroys every idle target.
+   */
+  void Clear();
+
+  /**
+   *  @returns counters for this pool.
+   */
+  pool_stats GetStats();
+
+  /**
+   *  @returns the size which targets of size `size` are allocated at.
+   */
+  static glm::ivec2 GetBucket(glm::ivec2 size);
+
+  /**
+   *  @returns the memory used by a target of the given size -- RGBA8 color, plus 24/8 depth stencil.
+   */
+  static size_t GetTargetBytes(glm::ivec2 size);
+
+  /**
+   *  Creates a complete framebuffer with RGBA8 color and depth/stencil attachments.
+   *  Framebuffer bindings are left as they were.
+   */
+  static render_target CreateGLTarget(glm::ivec2 size);
+
+  /**
+   *  Deletes a target's framebuffer and attachments.
+   */
+  static void DestroyGLTarget(const render_target& target);
+
+  ~FramebufferPool();
+  FramebufferPool(const FramebufferPool& other) = delete;
+  FramebufferPool& operator=(const FramebufferPool& other) = delete;
+ private:
+  // shared with outstanding targets, so they can find their way home (or not, if the pool is gone).
+  struct pool_state {
+    std::mutex lock;
+    alloc_func alloc;
+    free_func free;
+    std::list<render_target> idle;      // most recently used at the front
+    size_t budget;
+    pool_stats stats;
+  };
+
+  /**
+   *  Returns a target to the pool.
+   */
+  static void Release(std::weak_ptr<pool_state> state, free_func free, render_target* target);
+
+  /**
+   *  Evicts idle targets until the pool fits within its budget, or nothing is idle.
+   *  Expects the state's lock to be held.
+   *  @returns the targets which should be destroyed.
+   */
+  static std::list<render_target> Trim(pool_state& state);
+
+  std::shared_ptr<pool_state> state_;
+};
+
+}
+}
+
+#endif  // FRAMEBUFFER_POOL_H_
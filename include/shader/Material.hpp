@@ -20,8 +20,15 @@ class Material {
  public:
   /**
    *  Prepares openGL to draw with this material by passing all uniforms.
+   *  @returns false if the material isn't ready (see IsReady). Nothing is bound, so the caller must skip its draw.
    */ 
-  virtual void UseMaterial() = 0;
+  virtual bool UseMaterial() = 0;
+
+  /**
+   *  @returns true if the material can be drawn with.
+   *           Materials whose programs are still compiling return false until they're ready.
+   */ 
+  virtual bool IsReady() { return true; }
 };
 
 } // namespace shader
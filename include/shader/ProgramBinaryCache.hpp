@@ -0,0 +1,97 @@
+#ifndef PROGRAM_BINARY_CACHE_H_
+#define PROGRAM_BINARY_CACHE_H_
+
+#include <glad/glad.h>
+
+#include <cinttypes>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace monkeysworld {
+namespace shader {
+
+/**
+ *  Stores linked shader programs on disk, so that successive launches can skip compilation.
+ *
+ *  Programs are keyed by a hash of their fully expanded sources, and the driver which built them.
+ *  Drivers are free to reject binaries (after an update, for instance) -- when that happens,
+ *  `LoadProgram` returns 0 and the caller should compile from source as usual.
+ *
+ *  GL functions must be called from the main thread.
+ */ 
+class ProgramBinaryCache {
+ public:
+  static const uint32_t BINARY_MAGIC = 0x4E42534D;   // MSBN
+
+  /**
+   *  Creates a new program cache.
+   *  @param cache_dir - directory where binaries are stored, including the trailing slash.
+   */ 
+  ProgramBinaryCache(const std::string& cache_dir);
+
+  /**
+   *  Computes the key for a program.
+   *  @param driver - string identifying the driver, see GetDriverString.
+   *  @param sources - (stage, expanded source) for each stage in the program.
+   *  @returns a key identifying this program.
+   */ 
+  static uint64_t GetProgramKey(const std::string& driver, const std::vector<std::pair<GLenum, std::string>>& sources);
+
+  /**
+   *  @returns a string identifying the current GL driver.
+   */ 
+  static std::string GetDriverString();
+
+  /**
+   *  @returns true if the current driver can save + load program binaries.
+   */ 
+  static bool IsSupported();
+
+  /**
+   *  Attempts to create a program from a cached binary.
+   *  @param key - the key associated with the program.
+   *  @returns a linked program, or 0 if the binary is missing or was rejected.
+   */ 
+  GLuint LoadProgram(uint64_t key);
+
+  /**
+   *  Stores a linked program in the cache.
+   *  The program should have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set.
+   *  @param key - the key associated with the program.
+   *  @param prog - the program being stored.
+   *  @returns true if the program was written, false otherwise.
+   */ 
+  bool StoreProgram(uint64_t key, GLuint prog);
+
+  /**
+   *  Reads a binary from disk.
+   *  @param key - the key associated with the binary.
+   *  @param format - output param for the binary's format.
+   *  @param data - output param for the binary itself.
+   *  @returns true if a valid binary was found, false otherwise.
+   */ 
+  bool ReadBinary(uint64_t key, GLenum* format, std::vector<char>* data);
+
+  /**
+   *  Writes a binary to disk.
+   *  @param key - the key associated with the binary.
+   *  @param format - the binary's format.
+   *  @param data - the binary itself.
+   *  @returns true if the binary was written, false otherwise.
+   */ 
+  bool WriteBinary(uint64_t key, GLenum format, const std::vector<char>& data);
+
+ private:
+  /**
+   *  @returns the path where the binary for `key` is stored.
+   */ 
+  std::string GetBinaryPath(uint64_t key);
+
+  std::string cache_dir_;
+};
+
+}
+}
+
+#endif  // PROGRAM_BINARY_CACHE_H_
@@ -0,0 +1,162 @@
+#ifndef PROGRAM_REGISTRY_H_
+#define PROGRAM_REGISTRY_H_
+
+#include <shader/ShaderProgram.hpp>
+#include <shader/ShaderProgramBuilder.hpp>
+#include <file/CachedFileLoader.hpp>
+
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace monkeysworld {
+
+namespace engine {
+class Context;
+}
+
+namespace shader {
+
+/**
+ *  Describes a program by the paths of its stages, and any defines injected into them.
+ *  Stages which are left empty are skipped.
+ */
+struct program_info {
+  std::string vertex_path;
+  std::string geometry_path;
+  std::string fragment_path;
+  std::map<std::string, std::string> defines;
+};
+
+/**
+ *  Process-wide table of linked programs, so that materials which share shaders share one program.
+ *
+ *  Programs are handed out as shared pointers, and the registry only holds weak references --
+ *  a program is deleted once the last material using it goes away, and rebuilt if requested again.
+ *  If several threads request the same program at once, it's built once and all of them receive it.
+ *
+ *  Thread safe. Builds are run on the main thread via the context's executor.
+ *  `GetProgramAsync` doesn't wait on the driver -- with KHR_parallel_shader_compile, every
+ *  program can be compiling at once, while the main thread keeps drawing frames.
+ */
+class ProgramRegistry {
+ public:
+  typedef std::shared_future<std::shared_ptr<ShaderProgram>> build_future;
+
+  /**
+   *  @returns the registry.
+   */
+  static ProgramRegistry& GetInstance();
+
+  /**
+   *  Fetches a program, building it if no live copy exists.
+   *  @param ctx - context used to load + build the program. If null, the program is built
+   *               immediately with fstreams, so the caller must be on the main thread.
+   *  @param info - the program we want.
+   *  @returns a handle to the program.
+   *  @throws InvalidShaderException or LinkFailedException if the program can't be built.
+   */
+  std::shared_ptr<ShaderProgram> GetProgram(engine::Context* ctx, const program_info& info);
+
+  /**
+   *  Shorthand for a vertex + fragment program with no defines.
+   */
+  std::shared_ptr<ShaderProgram> GetProgram(engine::Context* ctx,
+                                            const std::string& vertex_path,
+                                            const std::string& fragment_path);
+
+  /**
+   *  Fetches a program without blocking. Compilation is started on the main thread,
+   *  and polled once per frame until the driver is done with it.
+   *  @param ctx - context used to load + build the program. If null, the program is built immediately.
+   *  @param info - the program we want.
+   *  @returns a future which resolves to the program, or to the exception thrown while building it.
+   */
+  build_future GetProgramAsync(engine::Context* ctx, const program_info& info);
+
+  /**
+   *  Fetches the program associated with `key`, calling `build` to create it if no live copy exists.
+   *  Concurrent calls with the same key wait on a single build.
+   *  Exceptions thrown by `build` are passed to every waiting caller, and the next call tries again.
+   */
+  std::shared_ptr<ShaderProgram> GetOrBuild(const std::string& key,
+                                            const std::function<std::shared_ptr<ShaderProgram>()>& build);
+
+  /**
+   *  Rebuilds every live program which uses one of the changed files, directly or through an include.
+   *  New programs are moved into the existing handles, so materials pick them up on their next draw.
+   *  Programs which fail to build are left as they were. Main thread only.
+   *  @param changed_paths - files which have changed on disk.
+   *  @returns the number of programs rebuilt.
+   */
+  size_t ReloadPrograms(const std::vector<std::string>& changed_paths);
+
+  /**
+   *  @returns the number of programs which are currently alive.
+   */
+  size_t GetProgramCount();
+
+  /**
+   *  @returns the registry key for a program description.
+   */
+  static std::string GetKey(const program_info& info);
+
+  ProgramRegistry(const ProgramRegistry& other) = delete;
+  ProgramRegistry& operator=(const ProgramRegistry& other) = delete;
+ private:
+  ProgramRegistry() = default;
+
+  /**
+   *  Everything we need to rebuild a program.
+   */
+  struct program_source {
+    program_info info;
+    std::weak_ptr<file::CachedFileLoader> loader;
+  };
+
+  /**
+   *  Records where a program came from, so that it can be rebuilt, and has `loader` watch its shaders.
+   *  Programs outlive scenes, so the newest loader replaces any earlier one.
+   */
+  void RecordSource(const std::string& key, const program_info& info, std::shared_ptr<file::CachedFileLoader> loader);
+
+  /**
+   *  A program which is compiling in the background.
+   */
+  struct async_build {
+    program_info info;
+    std::shared_ptr<file::CachedFileLoader> loader;
+    std::shared_ptr<ShaderProgramBuilder> builder;    // null until the build is started
+    std::promise<std::shared_ptr<ShaderProgram>> promise;
+    build_future future;
+    bool done;
+  };
+
+  /**
+   *  Submits an async build to the driver, if that hasn't happened yet. Main thread only.
+   */
+  void StartAsync(const std::string& key, std::shared_ptr<async_build> build);
+
+  /**
+   *  Collects the result of an async build, blocking if the driver isn't done. Main thread only.
+   */
+  void FinishAsync(const std::string& key, std::shared_ptr<async_build> build);
+
+  std::mutex registry_lock_;
+  std::unordered_map<std::string, std::weak_ptr<ShaderProgram>> programs_;
+  // builds which are currently underway
+  std::unordered_map<std::string, build_future> builds_;
+  // async builds which are currently underway
+  std::unordered_map<std::string, std::shared_ptr<async_build>> async_builds_;
+  std::unordered_map<std::string, program_source> sources_;
+};
+
+}
+}
+
+#endif  // PROGRAM_REGISTRY_H_
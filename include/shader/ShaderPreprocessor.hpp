@@ -0,0 +1,130 @@
+#ifndef SHADER_PREPROCESSOR_H_
+#define SHADER_PREPROCESSOR_H_
+
+#include <file/CachedFileLoader.hpp>
+
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace monkeysworld {
+namespace shader {
+
+/**
+ *  Expands `#include "path"` directives in GLSL sources, and caches the results.
+ *
+ *  Each file is read and tokenized once. Expanded sources are memoized by path + define block,
+ *  so materials which share shaders never touch the disk after the first build.
+ *  Include paths are relative to the including file.
+ *
+ *  The include graph is recorded as files are parsed -- `GetDependents` lists every file
+ *  which would change if a given file did, and `Invalidate` drops them all from the cache.
+ *
+ *  Thread safe. Files are read without holding the lock, so builds on other threads don't queue up
+ *  behind one another's disk reads -- if two threads read the same file, the first to finish is cached.
+ */
+class ShaderPreprocessor {
+ public:
+  /**
+   *  @returns the process-wide preprocessor.
+   */
+  static ShaderPreprocessor& GetInstance();
+
+  ShaderPreprocessor() = default;
+
+  /**
+   *  Fetches the expanded contents of a shader.
+   *  @param path - path to the shader.
+   *  @param defines - block of `#define` lines, inserted after the `#version` line. May be empty.
+   *  @param loader - loader used to read files, or null to read with fstreams.
+   *  @returns the expanded source. Empty if the file could not be read.
+   *  @throws InvalidShaderException if the shader includes itself, directly or not.
+   */
+  std::string GetSource(const std::string& path,
+                        const std::string& defines,
+                        std::shared_ptr<file::CachedFileLoader> loader);
+
+  /**
+   *  @returns every file included by `path`, directly or not. Only valid once `path` has been expanded.
+   */
+  std::set<std::string> GetDependencies(const std::string& path);
+
+  /**
+   *  @returns every file which includes `path`, directly or not.
+   */
+  std::set<std::string> GetDependents(const std::string& path);
+
+  /**
+   *  Drops `path`, and every file which includes it, from the cache.
+   *  They'll be re-read the next time they're requested.
+   */
+  void Invalidate(const std::string& path);
+
+  /**
+   *  Collapses "." and ".." segments, so that each file has a single key.
+   */
+  static std::string NormalizePath(const std::string& path);
+
+  /**
+   *  A file, split into raw text and include directives.
+   *  text.size() == includes.size() + 1 -- text[i] comes before includes[i].
+   */
+  struct parsed_file {
+    std::vector<std::string> text;
+    std::vector<std::string> includes;    // normalized paths
+  };
+
+  /**
+   *  Splits a file's contents on its include directives.
+   *  @param contents - the file's contents.
+   *  @param local_dir - directory containing the file, with its trailing slash.
+   */
+  static parsed_file Tokenize(const std::string& contents, const std::string& local_dir);
+
+  ShaderPreprocessor(const ShaderPreprocessor& other) = delete;
+  ShaderPreprocessor& operator=(const ShaderPreprocessor& other) = delete;
+ private:
+  /**
+   *  Reads and tokenizes a file if it isn't already cached. Takes the lock itself.
+   *  @param epoch - value of invalidations_ when the read started. Nothing is cached if a file was invalidated since.
+   *  @returns the parsed file, or null if it couldn't be read.
+   */
+  std::shared_ptr<const parsed_file> GetParsedFile(const std::string& path,
+                                                   std::shared_ptr<file::CachedFileLoader> loader,
+                                                   uint64_t epoch);
+
+  /**
+   *  Expands `path` onto the end of `output`.
+   *  @param stack - files currently being expanded, for cycle detection.
+   *  @param epoch - passed on to GetParsedFile.
+   */
+  void Expand(const std::string& path,
+              std::shared_ptr<file::CachedFileLoader> loader,
+              uint64_t epoch,
+              std::vector<std::string>& stack,
+              std::string& output);
+
+  /**
+   *  Reads the contents of a file.
+   *  @returns false if the file could not be read.
+   */
+  static bool ReadFile(const std::string& path, std::shared_ptr<file::CachedFileLoader> loader, std::string* output);
+
+  std::mutex preprocessor_lock_;
+  // shared, so expansions can keep reading a file after letting go of the lock
+  std::unordered_map<std::string, std::shared_ptr<const parsed_file>> files_;
+  // path -> (define block -> expanded source)
+  std::unordered_map<std::string, std::unordered_map<std::string, std::string>> expanded_;
+  // files which directly include each file
+  std::unordered_map<std::string, std::set<std::string>> included_by_;
+  // bumped by Invalidate, so reads which started before it don't cache what they found
+  uint64_t invalidations_ = 0;
+};
+
+}
+}
+
+#endif  // SHADER_PREPROCESSOR_H_
@@ -3,6 +3,8 @@
 
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 #include <glad/glad.h>
 
 #include <shader/ShaderProgram.hpp>
@@ -11,23 +13,11 @@
 namespace monkeysworld {
 namespace shader {
 
-/**
- *  FDs associated with shaders
- *  (no tesselation shader because i dont think im gonna use that)
- */ 
-struct ShaderPacket {
-  // fd for vertex shader
-  GLuint vertex_shader;
-
-  // fd for fragment shader
-  GLuint fragment_shader;
-
-  // fd for geometry shader
-  GLuint geometry_shader;
-};
-
 /**
  *  Class for building shader programs from individual shaders.
+ *
+ *  Linked programs are cached on disk (see ProgramBinaryCache), keyed by their
+ *  expanded sources. Shaders are only compiled if no usable binary exists.
  */ 
 class ShaderProgramBuilder {
 
@@ -48,8 +38,47 @@ class ShaderProgramBuilder {
   ShaderProgramBuilder& WithVertexShader(const std::string& vertex_path);
   ShaderProgramBuilder& WithGeometryShader(const std::string& geometry_path);
   ShaderProgramBuilder& WithFragmentShader(const std::string& fragment_path);
+
+  /**
+   *  Adds a `#define` to every stage, directly after its `#version` line.
+   *  @param name - name of the macro.
+   *  @param value - its value, if any.
+   */ 
+  ShaderProgramBuilder& WithDefine(const std::string& name, const std::string& value = "");
+
+  /**
+   *  Builds the program, loading it from the program cache if possible.
+   *  Blocks until the driver has finished compiling.
+   *  @throws InvalidShaderException if a stage fails to compile.
+   *  @throws LinkFailedException if the program fails to link.
+   */ 
   ShaderProgram Build();
 
+  /**
+   *  Starts building the program, without waiting on the driver.
+   *  Poll `IsBuildComplete`, then call `FinishBuild` to retrieve the program.
+   */ 
+  void StartBuild();
+
+  /**
+   *  @returns true if the driver is done with the program started by `StartBuild`.
+   *           Always true if KHR_parallel_shader_compile isn't available --
+   *           `FinishBuild` will just block instead.
+   */ 
+  bool IsBuildComplete();
+
+  /**
+   *  Checks the result of a build started with `StartBuild`, and hands over the program.
+   *  @throws InvalidShaderException if a stage fails to compile.
+   *  @throws LinkFailedException if the program fails to link.
+   */ 
+  ShaderProgram FinishBuild();
+
+  /**
+   *  @returns true if the driver can compile shaders in the background (KHR_parallel_shader_compile).
+   */ 
+  static bool IsParallelCompileSupported();
+
   ShaderProgramBuilder(const ShaderProgramBuilder& other) = delete;
   ShaderProgramBuilder& operator=(const ShaderProgramBuilder& other) = delete;
 
@@ -59,29 +88,44 @@ class ShaderProgramBuilder {
 
  private:
   /**
-   *  Compiles and verifies proper functionality, before attaching it to the program.
+   *  Records a stage, to be expanded + compiled when the program is built.
    */ 
-  GLuint CreateShaderFromFile(const std::string& shader_path, GLenum shader_type);
+  void AddStage(const std::string& shader_path, GLenum shader_type);
 
   /**
-   *  Parses the contents of a shader file.
+   *  Submits every stage for compilation, and links the program, without checking the results.
    */ 
-  std::string GetFileContents(const std::string& shader_path);
+  GLuint StartProgram();
 
   /**
-   *  Attaches the shader if its value is non-zero.
+   *  Verifies that the program started by `StartProgram` compiled and linked.
    */ 
-  void AttachIfNonZero(GLuint prog, GLuint shader);
+  void FinishProgram();
 
   /**
-   *  Deletes non-zero shaders. Will only be called from dtor, so setting to 0
-   *  should not matter
+   *  Detaches and deletes our shader objects.
    */ 
-  void DeleteIfNonZero(GLuint shader);
+  void ReleaseShaders();
 
-  // contains the program being created
+  /**
+   *  Verifies that a single stage compiled properly.
+   */ 
+  void CheckShader(const std::string& shader_path, GLuint shader, GLenum shader_type);
+
+  // (stage, expanded source) for each stage, in the order they were added
+  std::vector<std::pair<GLenum, std::string>> sources_;
+  // paths associated with each stage, for error reporting
+  std::vector<std::string> paths_;
+  // (name, value) for each define
+  std::vector<std::pair<std::string, std::string>> defines_;
+
+  // program currently being built, and its stages
   GLuint prog_;
-  ShaderPacket shaders_;
+  std::vector<GLuint> shaders_;
+
+  uint64_t cache_key_;
+  bool cache_supported_;
+  bool from_cache_;
 
   // cache loader
   std::shared_ptr<file::CachedFileLoader> loader_;
@@ -51,6 +51,13 @@ class Texture {
    */ 
   GLuint GetTextureDescriptor() const;
 
+  /**
+   *  Re-reads the image at `path` into this texture, keeping the same descriptor.
+   *  Main thread only.
+   *  @returns false if the image could not be read -- the texture is left untouched.
+   */ 
+  bool Reload(const std::string& path);
+
   int GetWidth() const {
     return width_;
   }
@@ -75,6 +82,11 @@ class Texture {
   Texture(Texture&& other) = delete;
   Texture& operator=(Texture&& other) = delete;
  private:
+  /**
+   *  Uploads `tex_cache_` to the currently bound texture, then frees it.
+   */ 
+  void UploadImage() const;
+
   // stores the texture before being loaded by GL.
   unsigned char* tex_cache_;
   GLuint tex_;
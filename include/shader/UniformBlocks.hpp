@@ -0,0 +1,46 @@
+#ifndef UNIFORM_BLOCKS_H_
+#define UNIFORM_BLOCKS_H_
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cinttypes>
+
+namespace monkeysworld {
+namespace shader {
+
+/**
+ *  Binding points for the uniform blocks shared by all materials.
+ *  Matches the bindings in resources/glsl/common.
+ */ 
+static const GLuint FRAME_BLOCK_BINDING = 0;
+static const GLuint OBJECT_BLOCK_BINDING = 1;
+
+/**
+ *  Data which is constant across a frame. Uploaded once by the engine before drawing.
+ *  Matches `FrameData` in frame-data.glsl (std140).
+ */ 
+struct frame_uniforms {
+  glm::mat4 view_matrix;        // camera view matrix
+  glm::mat4 persp_matrix;       // camera projection matrix
+  glm::mat4 vp_matrix;          // view + projection
+  glm::vec4 camera_position;    // xyz: camera position in world space
+  uint32_t cluster_grid[4];     // x, y, z light cluster counts, light count
+  float cluster_depth[4];       // near, far, slice scale, slice bias
+};
+
+/**
+ *  Per-draw data. Suballocated from the context's UniformRing for every draw.
+ *  Matches `ObjectData` in object-data.glsl (std140).
+ */ 
+struct object_uniforms {
+  glm::mat4 model_matrix;       // model transform
+  glm::mat4 normal_matrix;      // inverse transpose of the model matrix (upper 3x3 is used)
+  glm::mat4 vp_matrix;          // view + projection this object is drawn with
+  glm::vec4 color;              // surface color, text color, etc.
+};
+
+}
+}
+
+#endif  // UNIFORM_BLOCKS_H_
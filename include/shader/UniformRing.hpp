@@ -0,0 +1,67 @@
+#ifndef UNIFORM_RING_H_
+#define UNIFORM_RING_H_
+
+#include <glad/glad.h>
+
+namespace monkeysworld {
+namespace shader {
+
+/**
+ *  A large uniform buffer which per-draw uniform blocks are suballocated from.
+ *
+ *  Each call to `Bind` copies a block to the next aligned offset in the buffer,
+ *  and binds that range to the requested binding point. When the buffer fills up,
+ *  it's orphaned and we start over from the front -- draws which were already issued
+ *  keep reading the old storage, so nothing needs to wait on the GPU.
+ *
+ *  Blocks are only valid until the next call to `Bind` -- don't use this for data
+ *  which needs to stay bound across draws.
+ *
+ *  The GL buffer is created on first use. Main thread only.
+ */ 
+class UniformRing {
+ public:
+  /**
+   *  Creates a new UniformRing.
+   *  @param size - size of the buffer, in bytes.
+   */ 
+  UniformRing(GLsizeiptr size);
+
+  /**
+   *  Copies a block into the ring, and binds it.
+   *  @param binding - the uniform block binding to bind the block to.
+   *  @param data - the contents of the block.
+   *  @param size - the size of the block, in bytes.
+   */ 
+  void Bind(GLuint binding, const void* data, GLsizeiptr size);
+
+  /**
+   *  Copies a block into the ring, and binds it.
+   *  @param binding - the uniform block binding to bind the block to.
+   *  @param block - the block. Must match its std140 layout in GLSL.
+   */ 
+  template <typename T>
+  void Bind(GLuint binding, const T& block) {
+    Bind(binding, &block, sizeof(T));
+  }
+
+  /**
+   *  @returns the number of times this ring has wrapped around.
+   */ 
+  int GetWrapCount() const;
+
+  ~UniformRing();
+  UniformRing(const UniformRing& other) = delete;
+  UniformRing& operator=(const UniformRing& other) = delete;
+ private:
+  GLuint buffer_;
+  GLsizeiptr size_;
+  GLsizeiptr head_;
+  GLint align_;
+  int wrap_count_;
+};
+
+}
+}
+
+#endif  // UNIFORM_RING_H_
@@ -0,0 +1,158 @@
+#ifndef LIGHT_CLUSTERS_H_
+#define LIGHT_CLUSTERS_H_
+
+#include <glad/glad.h>
+
+#include <critter/Camera.hpp>
+#include <shader/UniformBlocks.hpp>
+#include <shader/light/LightTypes.hpp>
+
+#include <glm/glm.hpp>
+
+#include <cinttypes>
+#include <vector>
+
+namespace monkeysworld {
+namespace shader {
+namespace light {
+
+/**
+ *  GPU representation of a spotlight. Matches `SpotLight` in clustered-lights.glsl (std430).
+ */
+struct gpu_spotlight {
+  glm::vec4 position;         // xyz: world space position, w: range
+  glm::vec4 direction;        // xyz: direction, w: cosine of the cone's half angle
+  glm::vec4 color;            // rgb: color, a: diffuse intensity
+  glm::vec4 attenuation;      // x: quad, y: linear, z: const, w: specular intensity
+  glm::mat4 light_matrix;     // view-projection matrix of the light
+  glm::vec4 shadow_rect;      // region of the shadow atlas used by this light -- zero if none
+};
+
+/**
+ *  Assigns spotlights to a grid of view-space clusters, for clustered forward shading.
+ *
+ *  The view frustum is split into GRID_X * GRID_Y tiles in screen space, and GRID_Z slices
+ *  spaced exponentially in depth. Each light is bounded by a sphere around its cone,
+ *  and added to every cluster that sphere touches. Shaders find their cluster from
+ *  the fragment position, then only loop over the lights in that cluster.
+ *
+ *  `Assign` is CPU only. `Upload` pushes the results to three SSBOs, bound at
+ *  LIGHT_BINDING, CLUSTER_BINDING and INDEX_BINDING -- main thread only.
+ *  The grid dimensions are passed through the per-frame uniform block, see `GetFrameUniforms`.
+ */
+class LightClusters {
+ public:
+  static const int GRID_X = 16;
+  static const int GRID_Y = 9;
+  static const int GRID_Z = 24;
+  static const int CLUSTER_COUNT = GRID_X * GRID_Y * GRID_Z;
+
+  static const GLuint LIGHT_BINDING = 1;
+  static const GLuint CLUSTER_BINDING = 2;
+  static const GLuint INDEX_BINDING = 3;
+
+  // lights are clamped to this range -- matches the far plane of the spotlight matrix
+  static const float MAX_LIGHT_RANGE;
+
+  /**
+   *  Creates a new cluster grid. No GL objects are created until the first upload.
+   */
+  LightClusters();
+
+  /**
+   *  Assigns lights to clusters.
+   *  @param cam - the camera we're drawing from.
+   *  @param lights - all spotlights in the scene.
+   */
+  void Assign(const critter::camera_info& cam, const std::vector<spotlight_info>& lights);
+
+  /**
+   *  Uploads the results of the last `Assign` call, and binds our buffers.
+   */
+  void Upload();
+
+  /**
+   *  Fills in the cluster fields of the per-frame uniform block.
+   *  @param frame - the block to fill in.
+   */
+  void GetFrameUniforms(frame_uniforms* frame) const;
+
+  /**
+   *  @returns the number of lights assigned to the cluster at (x, y, z).
+   */
+  uint32_t GetLightCount(int x, int y, int z) const;
+
+  /**
+   *  @returns the index of the `n`th light in the cluster at (x, y, z).
+   */
+  uint32_t GetLight(int x, int y, int z, uint32_t n) const;
+
+  /**
+   *  @returns the total number of light indices across all clusters.
+   */
+  size_t GetIndexCount() const;
+
+  /**
+   *  Computes how far a light reaches before its contribution becomes negligible.
+   */
+  static float GetLightRange(const spotlight_info& light);
+
+  ~LightClusters();
+  LightClusters(const LightClusters& other) = delete;
+  LightClusters& operator=(const LightClusters& other) = delete;
+ private:
+  /**
+   *  Recomputes cluster bounds if the projection has changed.
+   */
+  void UpdateBounds(const glm::mat4& persp);
+
+  /**
+   *  @returns the flat index of the cluster at (x, y, z).
+   */
+  static int GetClusterIndex(int x, int y, int z);
+
+  /**
+   *  @returns the depth slice containing the view-space distance `depth`.
+   */
+  int GetSlice(float depth) const;
+
+  /**
+   *  @returns the tile containing the ndc coordinate `ndc`, along an axis with `count` tiles.
+   */
+  static int GetTile(float ndc, int count);
+
+  /**
+   *  Reallocates `buffer` if `size` exceeds its capacity, then uploads `data`.
+   */
+  static void UploadBuffer(GLuint buffer, GLsizeiptr* capacity, const void* data, GLsizeiptr size);
+
+  glm::mat4 persp_;
+  float near_;
+  float far_;
+
+  // view-space aabbs of each cluster, one array per component so the sphere tests vectorize
+  std::vector<float> min_x_;
+  std::vector<float> min_y_;
+  std::vector<float> min_z_;
+  std::vector<float> max_x_;
+  std::vector<float> max_y_;
+  std::vector<float> max_z_;
+  std::vector<float> slice_depth_;        // view-space distance to the start of each slice
+
+  // reused every frame
+  std::vector<gpu_spotlight> lights_;
+  std::vector<uint32_t> clusters_;        // (offset, count) pairs
+  std::vector<uint32_t> indices_;
+  std::vector<uint32_t> hits_;            // (cluster, light) pairs, before sorting into clusters
+  std::vector<float> dist_;               // per-slice scratch for sphere tests
+  float depth_params_[4];                 // near, far, slice scale, slice bias
+
+  GLuint buffers_[3];
+  GLsizeiptr capacities_[3];
+};
+
+}
+}
+}
+
+#endif  // LIGHT_CLUSTERS_H_
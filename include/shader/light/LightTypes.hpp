@@ -20,7 +20,8 @@ enum LightTypes {
 struct frame_info {
   int width;          // fb width
   int height;         // fb height
-  GLuint map;         // shadow map fd
+  GLuint map;         // shadow map fd -- 0 if this light has no shadow map
+  glm::vec4 rect;     // region of `map` used by this light: (x, y, w, h) in uv coords
 };
 
 /**
@@ -41,6 +42,7 @@ struct spotlight_info {
 
   glm::vec3 direction;                  // direction spotlight is facing
   glm::vec3 position;                   // position of spotlight
+  float angle;                          // full angle of the spotlight's cone, in degrees
 
   // attenuation -- for light falloff
   float atten_quad;
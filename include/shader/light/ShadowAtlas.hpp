@@ -0,0 +1,110 @@
+#ifndef SHADOW_ATLAS_H_
+#define SHADOW_ATLAS_H_
+
+#include <glad/glad.h>
+
+#include <critter/Model.hpp>
+#include <shader/light/LightTypes.hpp>
+#include <shader/light/SpotLight.hpp>
+
+#include <glm/glm.hpp>
+
+#include <cinttypes>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace monkeysworld {
+namespace shader {
+namespace light {
+
+/**
+ *  Packs the shadow maps of every spotlight into a single depth texture.
+ *
+ *  The atlas is split into a grid of square tiles, and each light claims a tile
+ *  the first time it's seen. A tile is only re-rendered when its light moves,
+ *  or when the set of casters inside the light's frustum changes (moved, swapped LODs, added, removed).
+ *
+ *  All GL calls -- construct and update on the main thread only.
+ */
+class ShadowAtlas {
+ public:
+  /**
+   *  Creates a new shadow atlas.
+   *  @param atlas_size - width + height of the atlas texture, in px.
+   *  @param tile_size - width + height of each light's shadow map, in px.
+   */
+  ShadowAtlas(int atlas_size, int tile_size);
+
+  /**
+   *  Assigns a tile to each light and re-renders any stale tiles.
+   *  @param lights - all spotlights in the scene.
+   *  @param casters - all models which can cast shadows.
+   *  @param infos - spotlight infos, parallel to `lights`. Each one's frame info
+   *                 is filled in with the light's tile. Lights which couldn't get a tile,
+   *                 or whose shadow program is still compiling, are left with an empty frame info.
+   *  @returns the number of tiles which were re-rendered.
+   */
+  int Update(const std::vector<std::shared_ptr<SpotLight>>& lights,
+             const std::vector<std::shared_ptr<critter::Model>>& casters,
+             std::vector<spotlight_info>& infos);
+
+  /**
+   *  @returns the depth texture backing this atlas.
+   */
+  GLuint GetTexture() const;
+
+  /**
+   *  @returns the max number of lights which can be stored in the atlas.
+   */
+  int GetTileCount() const;
+
+  ~ShadowAtlas();
+  ShadowAtlas(const ShadowAtlas& other) = delete;
+  ShadowAtlas& operator=(const ShadowAtlas& other) = delete;
+ private:
+  struct tile_record {
+    uint64_t light_id;            // light currently using this tile
+    bool in_use;                  // whether a light is using this tile
+    bool seen;                    // whether the light was present this frame
+    bool valid;                   // false if the tile has never been rendered
+    glm::mat4 light_matrix;       // light matrix when this tile was last rendered
+    uint64_t signature;           // hash of all casters in the light's frustum when last rendered
+  };
+
+  /**
+   *  Finds the tile associated with a light, claiming a free one if necessary.
+   *  @returns the index of the tile, or -1 if the atlas is full.
+   */
+  int GetTile(uint64_t light_id);
+
+  /**
+   *  Draws a light's visible casters into its tile.
+   */
+  void RenderTile(int tile,
+                  SpotLight& light,
+                  const glm::mat4& light_matrix,
+                  const std::vector<std::shared_ptr<critter::Model>>& visible);
+
+  int atlas_size_;
+  int tile_size_;
+  int tiles_per_row_;
+
+  GLuint map_;
+  GLuint fb_;
+
+  std::vector<tile_record> tiles_;
+  std::unordered_map<uint64_t, int> light_tiles_;
+
+  // reused between lights to avoid allocating every frame
+  std::vector<std::shared_ptr<critter::Model>> visible_;
+
+  // whether we've already complained about running out of tiles
+  bool full_warned_;
+};
+
+}
+}
+}
+
+#endif  // SHADOW_ATLAS_H_
@@ -59,38 +59,16 @@ class SpotLight : public critter::GameObject, public Light {
   /**
    *  Generates a spotlight_info struct which represents this spotlight within
    *  a render context.
+   *  Frame info is left empty -- the shadow atlas fills it in once the light has a tile.
    */ 
   spotlight_info GetSpotLightInfo();
 
-  materials::ShadowMapMaterial& GetShadowProgram();
-
- protected:
   /**
-   *  Regenerates the framebuffer texture with a new size.
-   *  @param px - new framebuffer width + height
+   *  @returns the material used to draw this light's shadow map.
    */ 
-  void ChangeMapSize(int px);
-
-  /**
-   *  Returns descriptor associated with shadow map.
-   */ 
-  GLuint GetMapDesc();
-
-  /**
-   *  Returns descriptor associated with framebuffer.
-   */ 
-  GLuint GetFramebuffer();
-
-  /**
-   *  @returns the width + height of the map, in px.
-   */ 
-  int GetMapSize();
-
+  materials::ShadowMapMaterial& GetShadowProgram();
 
  private:
-  int map_size_;                      // size of shadow map, in px
-  GLuint map_;                        // descriptor for map
-  GLuint shadow_fb_;                  // framebuffer for shadow map
   materials::ShadowMapMaterial mat_;  // material assc'd with shadow map generation
 
   float angle_;
@@ -13,7 +13,7 @@ namespace materials {
 struct ButtonMaterial : public Material {
   ButtonMaterial(engine::Context* ctx);
 
-  void UseMaterial() override;
+  bool UseMaterial() override;
 
   glm::vec2 resolution;
   float border_width;
@@ -22,7 +22,7 @@ struct ButtonMaterial : public Material {
   glm::vec4 border_color;
 
  private:
-  ShaderProgram prog_;
+  std::shared_ptr<ShaderProgram> prog_;
 };
 
 }
@@ -14,7 +14,7 @@ class FillMaterial : public ::monkeysworld::shader::Material {
  public:
   FillMaterial();
   FillMaterial(engine::Context* context);
-  void UseMaterial() override;
+  bool UseMaterial() override;
   
   /**
    *  Set the color associated with this material.
@@ -23,7 +23,7 @@ class FillMaterial : public ::monkeysworld::shader::Material {
   void SetColor(const glm::vec4& col);
   void SetColor(const color::Gradient& grad);
  private:
-  ShaderProgram fill_prog_;
+  std::shared_ptr<ShaderProgram> fill_prog_;
   bool use_gradient_;
   glm::vec4 color_cache_;
   color::Gradient gradient_;
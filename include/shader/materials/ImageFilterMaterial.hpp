@@ -33,13 +33,13 @@ class ImageFilterMaterial : public Material {
    *  Invalidates any filters that may have been applied in a previous call.
    */ 
   void ClearFilters();
-  void UseMaterial() override;
+  bool UseMaterial() override;
 
   // max number of instances of a particular filter type.
   static const int FILTER_COUNT = 6;
   static const int MAX_FILTERS = 16;
  private:
-  ShaderProgram prog_;
+  std::shared_ptr<ShaderProgram> prog_;
   
   int hsl_filters_count_;
   filter_hsl hsl_filters_[FILTER_COUNT];
@@ -4,8 +4,11 @@
 #include <file/CachedFileLoader.hpp>
 
 #include <shader/Material.hpp>
+#include <shader/ProgramRegistry.hpp>
 #include <shader/ShaderProgram.hpp>
-#include <shader/light/LightDataTemp.hpp>
+#include <shader/UniformBlocks.hpp>
+#include <shader/UniformRing.hpp>
+#include <shader/light/LightTypes.hpp>
 #include <glm/glm.hpp>
 
 #include <engine/Context.hpp>
@@ -27,8 +30,14 @@ class MatteMaterial : public ::monkeysworld::shader::Material {
 
   /**
    *  Makes the material active and passes all uniforms.
+   *  @returns false while our program is still compiling -- skip the draw.
    */ 
-  void UseMaterial() override;
+  bool UseMaterial() override;
+
+  /**
+   *  @returns true once our program has finished compiling.
+   */ 
+  bool IsReady() override;
 
   /**
    *  Passes transform data to the respective uniforms.
@@ -42,12 +51,9 @@ class MatteMaterial : public ::monkeysworld::shader::Material {
   void SetModelTransforms(const glm::mat4& model_matrix);
 
   /**
-   *  Passes light data to its respective uniforms. (deprecated)
-   */ 
-  void SetLights(const std::vector<light::LightData>& lights);
-
-  /**
-   *  Passes spotlights to uniforms.
+   *  Prepares the material to draw with the passed spotlights.
+   *  Lights are shaded from the engine's light clusters (see LightClusters),
+   *  so this only binds the shadow atlas.
    */ 
   void SetSpotlights(const std::vector<light::spotlight_info>& lights);
 
@@ -57,7 +63,11 @@ class MatteMaterial : public ::monkeysworld::shader::Material {
   void SetSurfaceColor(const glm::vec4& color);
 
  private:
-  ShaderProgram matte_prog_;
+  std::shared_ptr<ShaderProgram> matte_prog_;
+  ProgramRegistry::build_future prog_future_;   // resolves to matte_prog_
+  std::shared_ptr<UniformRing> ring_;
+  object_uniforms data_;
+  GLuint shadow_map_;
 };
 
 } // namespace materials
@@ -4,7 +4,10 @@
 #include <file/CachedFileLoader.hpp>
 
 #include <shader/Material.hpp>
+#include <shader/ProgramRegistry.hpp>
 #include <shader/ShaderProgram.hpp>
+#include <shader/UniformBlocks.hpp>
+#include <shader/UniformRing.hpp>
 
 #include <engine/Context.hpp>
 
@@ -24,13 +27,21 @@ class ShadowMapMaterial : public ::monkeysworld::shader::Material {
    */ 
   ShadowMapMaterial(engine::Context* ctx);
 
-  void UseMaterial() override;
+  bool UseMaterial() override;
+
+  /**
+   *  @returns true once our program has finished compiling.
+   */ 
+  bool IsReady() override;
 
   void SetCameraTransforms(const glm::mat4& vp_matrix);
   void SetModelTransforms(const glm::mat4& model_matrix);
 
  private:
-  ShaderProgram shadow_prog_;
+  std::shared_ptr<ShaderProgram> shadow_prog_;
+  ProgramRegistry::build_future prog_future_;   // resolves to shadow_prog_
+  std::shared_ptr<UniformRing> ring_;
+  object_uniforms data_;
 };
 
 }
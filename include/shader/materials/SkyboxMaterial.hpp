@@ -3,6 +3,8 @@
 
 #include <shader/Material.hpp>
 #include <shader/ShaderProgram.hpp>
+#include <shader/UniformBlocks.hpp>
+#include <shader/UniformRing.hpp>
 
 #include <engine/Context.hpp>
 
@@ -14,7 +16,7 @@ class SkyboxMaterial : public shader::Material {
  public:
   SkyboxMaterial(engine::Context* context);
 
-  void UseMaterial() override;
+  bool UseMaterial() override;
 
   /**
    *  Sets the view matrix.
@@ -24,7 +26,7 @@ class SkyboxMaterial : public shader::Material {
   /**
    *  Sets the perspective matrix.
    */ 
-  void SetCameraPersp(const glm::mat4& model_mat);
+  void SetCameraPersp(const glm::mat4& persp_mat);
 
   /**
    *  Sets the cube map.
@@ -33,10 +35,11 @@ class SkyboxMaterial : public shader::Material {
 
  private:
   glm::mat4 view_mat_;
-  glm::mat4 model_mat_;
+  glm::mat4 persp_mat_;
   GLuint cube_map_;
   
-  ShaderProgram skybox_prog_;
+  std::shared_ptr<ShaderProgram> skybox_prog_;
+  std::shared_ptr<UniformRing> ring_;
 };
 
 }
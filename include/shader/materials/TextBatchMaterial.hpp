@@ -0,0 +1,53 @@
+#ifndef TEXT_BATCH_MATERIAL_H_
+#define TEXT_BATCH_MATERIAL_H_
+
+#include <shader/Material.hpp>
+
+#include <engine/Context.hpp>
+
+#include <shader/ShaderProgram.hpp>
+
+namespace monkeysworld {
+namespace shader {
+namespace materials {
+
+/**
+ *  Draws batches of glyph quads built by font::TextBatch.
+ *  Color and transform come from each vertex, so a whole batch shares one set of uniforms.
+ */ 
+class TextBatchMaterial : public Material {
+ public:
+  /**
+   *  Creates the TextBatchMaterial.
+   */ 
+  TextBatchMaterial(engine::Context* ctx);
+
+  /**
+   *  Sets the glyph atlas which quads are read from.
+   *  @param texture - descriptor for the atlas.
+   */ 
+  void SetGlyphTexture(GLuint texture);
+
+  /**
+   *  @param sdf - true if the glyph texture holds distance fields, false if it holds coverage.
+   */ 
+  void SetDistanceField(bool sdf);
+
+  /**
+   *  Uses the underlying program.
+   */ 
+  bool UseMaterial() override;
+ private:
+  engine::Context* ctx_;
+  std::shared_ptr<ShaderProgram> prog_;
+  // built the first time a distance field font is drawn
+  std::shared_ptr<ShaderProgram> sdf_prog_;
+  bool sdf_;
+  GLuint texture_;
+};
+
+}
+}
+}
+
+#endif
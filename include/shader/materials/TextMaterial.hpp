@@ -6,6 +6,8 @@
 #include <shader/Material.hpp>
 #include <shader/ShaderProgram.hpp>
 #include <shader/ShaderProgramBuilder.hpp>
+#include <shader/UniformBlocks.hpp>
+#include <shader/UniformRing.hpp>
 
 #include <engine/Context.hpp>
 
@@ -20,7 +22,7 @@ class TextMaterial : public ::monkeysworld::shader::Material {
    */ 
   TextMaterial(engine::Context* context);
 
-  void UseMaterial() override;
+  bool UseMaterial() override;
 
   void SetCameraTransforms(const glm::mat4& vp_matrix);
   void SetModelTransforms(const glm::mat4& model_matrix);
@@ -28,8 +30,19 @@ class TextMaterial : public ::monkeysworld::shader::Material {
   void SetTextColor(const glm::vec4& color);
   void SetGlyphTexture(GLuint tex);
 
+  /**
+   *  @param sdf - true if the glyph texture holds distance fields, false if it holds coverage.
+   */ 
+  void SetDistanceField(bool sdf);
+
  private:
-  ShaderProgram text_prog_;
+  engine::Context* ctx_;
+  std::shared_ptr<ShaderProgram> text_prog_;
+  // built the first time a distance field font is drawn
+  std::shared_ptr<ShaderProgram> sdf_prog_;
+  bool sdf_;
+  std::shared_ptr<UniformRing> ring_;
+  object_uniforms data_;
   GLuint texture_;
 };
 
@@ -17,7 +17,7 @@ class TextureXferMaterial : public shader::Material {
  public:
   TextureXferMaterial(engine::Context* context);
 
-  void UseMaterial() override;
+  bool UseMaterial() override;
 
   /**
    *  Sets the texture which will be drawn onto the screen.
@@ -28,7 +28,7 @@ class TextureXferMaterial : public shader::Material {
  private:
   GLuint tex_;
   float opac_;
-  ShaderProgram xfer_prog_;
+  std::shared_ptr<ShaderProgram> xfer_prog_;
 };
 
 }
@@ -1,8 +1,6 @@
 #ifndef UI_GROUP_MATERIAL_H_
 #define UI_GROUP_MATERIAL_H_
 
-#define TEXTURES_PER_CALL 4
-
 #include <shader/Material.hpp>
 
 #include <engine/Context.hpp>
@@ -13,6 +11,10 @@ namespace monkeysworld {
 namespace shader {
 namespace materials {
 
+/**
+ *  Composites the children of a UI group into the group's framebuffer.
+ *  Children are read from a single atlas texture -- each vertex carries its own opacity.
+ */ 
 class UIGroupMaterial : public Material {
  public:
   /**
@@ -21,29 +23,22 @@ class UIGroupMaterial : public Material {
   UIGroupMaterial(engine::Context* ctx);
 
   /**
-   *  Sets textures for this call.
-   *  @param textures - array of textures sent to the material.
-   */ 
-  void SetTextures(GLuint textures[TEXTURES_PER_CALL]);
-
-  /**
-   *  Sets the opacity of each UI group represented in the material.
-   *  @param opacities - array of opacities sent to material.
+   *  Sets the atlas texture which children are read from.
+   *  @param texture - descriptor for the atlas.
    */ 
-  void SetOpacity(float opacities[TEXTURES_PER_CALL]);
+  void SetTexture(GLuint texture);
 
   /**
    *  Uses the underlying program.
    */ 
-  void UseMaterial() override;
+  bool UseMaterial() override;
  private:
-  ShaderProgram prog_;
-  GLuint textures_[TEXTURES_PER_CALL];
-  float opacities_[TEXTURES_PER_CALL];
+  std::shared_ptr<ShaderProgram> prog_;
+  GLuint texture_;
 };
 
 }
 }
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -20,6 +20,13 @@ namespace fileutils {
  */ 
 uint32_t CalculateCRCHash(std::istream& input, std::streamoff offset);
 
+/**
+ *  Counts the bytes left in a stream, without moving its read head.
+ *  @param input - the istream we are reading from.
+ *  @returns the number of bytes between the read head and the end of the stream, or -1 if it can't seek.
+ */
+std::streamoff GetRemainingLength(std::istream& input);
+
 /**
  *  Writes to a file as bytes.
  *  @param <input_type>: The type being written.
@@ -0,0 +1,39 @@
+#ifndef FRUSTUM_H_
+#define FRUSTUM_H_
+
+#include <glm/glm.hpp>
+
+namespace monkeysworld {
+namespace utils {
+
+/**
+ *  A view frustum, represented as six inward-facing planes.
+ *  Used for culling objects against cameras and lights.
+ */
+class Frustum {
+ public:
+  /**
+   *  Extracts the frustum planes from a view-projection matrix.
+   *  Planes are in whatever space the matrix transforms from (i.e. world space for a VP matrix).
+   *  @param vp_matrix - the matrix describing this frustum.
+   */
+  Frustum(const glm::mat4& vp_matrix);
+
+  /**
+   *  @param center - center of the sphere.
+   *  @param radius - radius of the sphere.
+   *  @returns true if the sphere is at least partially contained in the frustum, false otherwise.
+   *           Conservative: spheres near the corners may report true when they're outside.
+   */
+  bool IntersectsSphere(const glm::vec3& center, float radius) const;
+
+ private:
+  // normalized planes, (a, b, c, d) where ax + by + cz + d >= 0 inside the frustum.
+  // left, right, bottom, top, near, far.
+  glm::vec4 planes_[6];
+};
+
+}
+}
+
+#endif  // FRUSTUM_H_
@@ -0,0 +1,47 @@
+#ifndef HASH_UTILS_H_
+#define HASH_UTILS_H_
+
+#include <cinttypes>
+#include <cstddef>
+
+namespace monkeysworld {
+namespace utils {
+namespace hashutils {
+
+// fnv-1a, 64 bit
+static const uint64_t FNV_OFFSET = 0xcbf29ce484222325ULL;
+static const uint64_t FNV_PRIME = 0x100000001b3ULL;
+
+/**
+ *  Hashes a block of bytes with FNV-1a. Stable between runs and platforms, so it's safe to use for keys on disk.
+ *  @param hash - the hash so far, or FNV_OFFSET to start a new one.
+ *  @param data - the bytes being hashed.
+ *  @param len - number of bytes.
+ *  @returns the new hash.
+ */
+inline uint64_t HashBytes(uint64_t hash, const void* data, size_t len) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < len; i++) {
+    hash ^= bytes[i];
+    hash *= FNV_PRIME;
+  }
+
+  return hash;
+}
+
+/**
+ *  Mixes `value` into `seed`.
+ *  @param seed - the hash so far.
+ *  @param value - the value being added to the hash.
+ *  @returns the new hash.
+ */
+inline uint64_t HashCombine(uint64_t seed, uint64_t value) {
+  // boost's hash_combine, widened
+  return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 12) + (seed >> 4));
+}
+
+} // namespace hashutils
+} // namespace utils
+} // namespace monkeysworld
+
+#endif  // HASH_UTILS_H_
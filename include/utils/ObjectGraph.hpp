@@ -3,7 +3,7 @@
 
 #include <cinttypes>
 #include <unordered_map>
-#include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace monkeysworld {
@@ -13,6 +13,9 @@ namespace utils {
  *  An ObjectGraph is a directed, unweighted graph which 
  *  represents objects in our component hierarchy as nodes,
  *  and the connections between them as edges.
+ *
+ *  Nodes are given dense indices in the order they're added. Edges are appended to a flat list,
+ *  and packed into compressed rows (with duplicates removed) the next time they're needed.
  */ 
 class ObjectGraph {
 
@@ -59,9 +62,38 @@ class ObjectGraph {
    *  If a topological sort cannot be found, returns an empty vector.
    */ 
   std::vector<uint64_t> TopoSort();
+
+  /**
+   *  Performs a topological sort on the contents of this graph, without allocating
+   *  once the graph and `out` have grown to size.
+   *  @param out - cleared, then filled with the sorted nodes. Left empty if there's no valid sort.
+   *  @returns true if a topological sort was found.
+   */ 
+  bool TopoSort(std::vector<uint64_t>& out);
  private:
-  // stores nodes and their children
-  std::unordered_map<uint64_t, std::unordered_set<uint64_t>> nodes_;
+  /**
+   *  @returns the dense index for `node`, adding it if necessary.
+   */ 
+  uint32_t GetIndex(uint64_t node);
+
+  /**
+   *  Packs pending edges into rows, if any were added since the last pack.
+   */ 
+  void BuildRows();
+
+  std::unordered_map<uint64_t, uint32_t> index_;    // node ID -> dense index
+  std::vector<uint64_t> ids_;                       // dense index -> node ID
+
+  std::vector<std::pair<uint32_t, uint32_t>> edges_;    // parent, child -- may contain duplicates
+  bool rows_dirty_;
+
+  // children of node i are children_[row_start_[i]] up to children_[row_start_[i + 1]]
+  std::vector<uint32_t> row_start_;
+  std::vector<uint32_t> children_;
+
+  // scratch space for the sort, kept around so repeated sorts don't allocate
+  std::vector<uint32_t> in_degree_;
+  std::vector<uint32_t> queue_;
 };
 
 }
@@ -0,0 +1,82 @@
+#ifndef SHELF_PACKER_H_
+#define SHELF_PACKER_H_
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+namespace monkeysworld {
+namespace utils {
+
+/**
+ *  Packs rectangles into a fixed-size 2D region, row by row.
+ *
+ *  Each rectangle goes onto the first shelf which is tall enough and has room left,
+ *  and a new shelf is opened above the last one otherwise. Wastes a bit of space
+ *  when heights vary a lot, but packing is cheap and stable -- good enough for atlases
+ *  which are rebuilt from scratch when they fill up.
+ */
+class ShelfPacker {
+ public:
+  struct shelf {
+    int y;          // bottom of the shelf
+    int height;     // tallest rectangle the shelf can hold
+    int x;          // next free column
+  };
+
+  /**
+   *  Creates a new packer.
+   *  @param size - size of the region we are packing into.
+   *  @param padding - space left between each rectangle, and between rectangles and the edge.
+   */
+  ShelfPacker(glm::ivec2 size, int padding = 1);
+
+  /**
+   *  Places a rectangle.
+   *  @param size - size of the rectangle.
+   *  @param pos - output parameter for the rectangle's min corner.
+   *  @returns true if the rectangle was placed, false if there was no room for it.
+   */
+  bool Pack(glm::ivec2 size, glm::ivec2* pos);
+
+  /**
+   *  Frees every rectangle.
+   */
+  void Clear();
+
+  /**
+   *  Changes the size of the region. Frees every rectangle.
+   */
+  void SetDimensions(glm::ivec2 size);
+
+  /**
+   *  @returns the size of the region we are packing into.
+   */
+  glm::ivec2 GetDimensions() const;
+
+  /**
+   *  @returns the height of the region used so far.
+   */
+  int GetUsedHeight() const;
+
+  /**
+   *  @returns every shelf opened so far, bottom first -- enough to pick up packing where it left off.
+   */
+  const std::vector<shelf>& GetShelves() const;
+
+  /**
+   *  Replaces every shelf, say with ones saved from another packer of the same size.
+   *  @param shelves - shelves to use, bottom first.
+   */
+  void SetShelves(const std::vector<shelf>& shelves);
+
+ private:
+  std::vector<shelf> shelves_;
+  glm::ivec2 size_;
+  int padding_;
+};
+
+}
+}
+
+#endif  // SHELF_PACKER_H_
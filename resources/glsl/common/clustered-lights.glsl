@@ -0,0 +1,106 @@
+// shared by all materials which receive spotlights.
+// buffers are filled + bound by LightClusters, once per frame.
+
+#ifndef CLUSTERED_LIGHTS_GLSL_
+#define CLUSTERED_LIGHTS_GLSL_
+
+#include "frame-data.glsl"
+
+struct SpotLight {
+  vec4 position;          // xyz: world space position, w: range
+  vec4 direction;         // xyz: direction, w: cosine of the cone's half angle
+  vec4 color;             // rgb: color, a: diffuse intensity
+  vec4 attenuation;       // x: quad, y: linear, z: const, w: specular intensity
+  mat4 light_matrix;      // view-projection matrix of the light
+  vec4 shadow_rect;       // region of the shadow atlas used by this light -- zero if none
+};
+
+layout(std430, binding = 1) readonly buffer SpotLightData {
+  SpotLight spotlights[];
+};
+
+// grid dimensions + depth slicing live in FrameData
+layout(std430, binding = 2) readonly buffer ClusterData {
+  uvec2 clusters[];       // (offset, count) into light_indices
+};
+
+layout(std430, binding = 3) readonly buffer LightIndexData {
+  uint light_indices[];
+};
+
+layout(binding = 0) uniform sampler2DShadow shadow_map;
+
+/**
+ *  Returns the (offset, count) of the cluster containing a world space position.
+ */
+uvec2 GetCluster(vec4 world_pos) {
+  vec4 clip = frame_vp_matrix * world_pos;
+  vec2 ndc = clip.xy / clip.w;
+  float depth = -(frame_view_matrix * world_pos).z;
+
+  uvec3 cell;
+  cell.xy = uvec2(clamp(ivec2((ndc * 0.5 + 0.5) * vec2(cluster_grid.xy)), ivec2(0), ivec2(cluster_grid.xy) - 1));
+  cell.z = uint(clamp(int(floor(log(max(depth, cluster_depth.x)) * cluster_depth.z + cluster_depth.w)), 0, int(cluster_grid.z) - 1));
+  return clusters[(cell.z * cluster_grid.y + cell.y) * cluster_grid.x + cell.x];
+}
+
+/**
+ *  Returns how lit a world space position is by a light's shadow map, from 0 to 1.
+ */
+float GetShadow(SpotLight light, vec4 world_pos) {
+  if (light.shadow_rect.z <= 0.0) {
+    return 1.0;
+  }
+
+  vec4 light_pos = light.light_matrix * world_pos;
+  vec3 proj = (light_pos.xyz / light_pos.w) * 0.5 + 0.5;
+  if (proj.x < 0.0 || proj.x > 1.0 || proj.y < 0.0 || proj.y > 1.0 || proj.z > 1.0) {
+    // outside of the light's frustum
+    return 1.0;
+  }
+
+  vec2 uv = light.shadow_rect.xy + proj.xy * light.shadow_rect.zw;
+  return texture(shadow_map, vec3(uv, proj.z - 0.0005));
+}
+
+/**
+ *  Returns the diffuse contribution of a light at a world space position.
+ */
+vec3 GetSpotLightDiffuse(SpotLight light, vec4 world_pos, vec3 normal) {
+  vec3 light_vector = light.position.xyz - world_pos.xyz;
+  float dist = length(light_vector);
+  if (dist > light.position.w) {
+    return vec3(0.0);
+  }
+
+  light_vector /= dist;
+  float cos_angle = dot(-light_vector, light.direction.xyz);
+  // soften the last few degrees of the cone
+  float cone = smoothstep(light.direction.w, mix(light.direction.w, 1.0, 0.1), cos_angle);
+  if (cone <= 0.0) {
+    return vec3(0.0);
+  }
+
+  float falloff = dot(light.attenuation.xyz, vec3(dist * dist, dist, 1.0));
+  float atten = (falloff > 0.0 ? 1.0 / falloff : 1.0);
+  // fade out at the edge of our range, so the cluster cutoff isn't visible
+  atten *= clamp((light.position.w - dist) / (0.1 * light.position.w), 0.0, 1.0);
+
+  float n_b = max(dot(light_vector, normal), 0.0);
+  return light.color.rgb * (light.color.a * n_b * cone * atten * GetShadow(light, world_pos));
+}
+
+/**
+ *  Sums the diffuse contribution of every spotlight affecting a world space position.
+ */
+vec3 GetClusteredDiffuse(vec4 world_pos, vec3 normal) {
+  uvec2 cluster = GetCluster(world_pos);
+  vec3 res = vec3(0.0);
+  for (uint i = 0; i < cluster.y; i++) {
+    res += GetSpotLightDiffuse(spotlights[light_indices[cluster.x + i]], world_pos, normal);
+  }
+
+  return res;
+}
+
+#endif
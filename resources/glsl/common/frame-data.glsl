@@ -0,0 +1,15 @@
+// per-frame data -- uploaded once by the engine, see frame_uniforms in UniformBlocks.hpp
+
+#ifndef FRAME_DATA_GLSL_
+#define FRAME_DATA_GLSL_
+
+layout(std140, binding = 0) uniform FrameData {
+  mat4 frame_view_matrix;       // camera view matrix
+  mat4 frame_persp_matrix;      // camera projection matrix
+  mat4 frame_vp_matrix;         // view + projection
+  vec4 frame_camera_position;   // xyz: camera position in world space
+  uvec4 cluster_grid;           // x, y, z light cluster counts, light count
+  vec4 cluster_depth;           // near, far, slice scale, slice bias
+};
+
+#endif
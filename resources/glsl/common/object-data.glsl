@@ -0,0 +1,13 @@
+// per-draw data -- suballocated from the engine's uniform ring, see object_uniforms in UniformBlocks.hpp
+
+#ifndef OBJECT_DATA_GLSL_
+#define OBJECT_DATA_GLSL_
+
+layout(std140, binding = 1) uniform ObjectData {
+  mat4 model_matrix;            // model transform
+  mat4 normal_matrix;           // inverse transpose of the model matrix (upper 3x3 is used)
+  mat4 vp_matrix;               // view + projection this object is drawn with
+  vec4 object_color;            // surface color, text color, etc.
+};
+
+#endif
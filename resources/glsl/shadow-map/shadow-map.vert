@@ -1,10 +1,10 @@
 #version 430 core
 
-layout (location = 0) in vec4 position;
+#include "../common/object-data.glsl"
 
-layout (location = 0) uniform mat4 model_mat;
-layout (location = 1) uniform mat4 light_mat;
+layout (location = 0) in vec4 position;
 
 void main() {
-  gl_Position = light_mat * model_mat * position;
-}
\ No newline at end of file
+  // vp_matrix holds the light matrix
+  gl_Position = vp_matrix * model_matrix * position;
+}
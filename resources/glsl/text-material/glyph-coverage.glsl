@@ -0,0 +1,17 @@
+// converts a sample from a glyph atlas into coverage.
+// define DISTANCE_FIELD if the atlas stores signed distance fields.
+
+#ifndef GLYPH_COVERAGE_GLSL_
+#define GLYPH_COVERAGE_GLSL_
+
+float GlyphCoverage(float texval) {
+#ifdef DISTANCE_FIELD
+  // edge sits at 0.5 -- antialias over about a screen pixel, whatever size we're drawn at
+  float width = max(0.7f * fwidth(texval), 1e-4f);
+  return smoothstep(0.5f - width, 0.5f + width, texval);
+#else
+  return texval;
+#endif
+}
+
+#endif
@@ -0,0 +1,26 @@
+#version 430 core
+
+#include "glyph-coverage.glsl"
+
+layout(location = 0) in vec2 texcoord;
+layout(location = 1) in vec4 color;
+layout(location = 2) in vec2 clip_position;
+layout(location = 3) flat in vec4 clip;
+
+layout(binding = 0) uniform sampler2D glyph_texture;
+
+layout(location = 0) out vec4 fragColor;
+
+void main() {
+  // stands in for the scissor each object would have drawn with
+  if (any(lessThan(clip_position, clip.xy)) || any(greaterThanEqual(clip_position, clip.zw))) {
+    discard;
+  }
+
+  float texval = GlyphCoverage(texture(glyph_texture, texcoord).r);
+  if (texval < 0.05f) {
+    discard;
+  }
+
+  fragColor = texval * color;
+}
@@ -0,0 +1,31 @@
+#version 430 core
+
+// one entry per batched text object -- see text_transform in TextBatch.hpp
+struct TextTransform {
+  vec4 scale_offset;          // xy scales glyph positions, zw offsets them
+  vec4 clip;                  // xy min, zw max of the region which may be drawn to, in clip space
+};
+
+layout(std430, binding = 4) readonly buffer TextTransformData {
+  TextTransform transforms[];
+};
+
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec2 texcoord;
+layout(location = 2) in vec4 color;
+layout(location = 3) in uint transform;
+
+layout(location = 0) out vec2 texcoord_output;
+layout(location = 1) out vec4 color_output;
+layout(location = 2) out vec2 clip_position;
+layout(location = 3) flat out vec4 clip_output;
+
+void main() {
+  TextTransform tf = transforms[transform];
+  vec2 pos = position * tf.scale_offset.xy + tf.scale_offset.zw;
+  texcoord_output = texcoord;
+  color_output = color;
+  clip_position = pos;
+  clip_output = tf.clip;
+  gl_Position = vec4(pos, 0.0, 1.0);
+}
@@ -1,25 +1,103 @@
 #include <audio/AudioBuffer.hpp>
+#include <audio/AudioDecodePool.hpp>
 #include <boost/log/trivial.hpp>
 
+#include <algorithm>
+#include <cmath>
+
+// built with -mavx (see the avx option), or SSE, which every x86-64 target has
+#if defined(__AVX__)
+#define AUDIO_MIX_AVX
+#include <immintrin.h>
+#elif defined(__SSE__) || defined(_M_X64)
+#define AUDIO_MIX_SSE
+#include <xmmintrin.h>
+#endif
+
 namespace monkeysworld {
 namespace audio {
 
-AudioBuffer::AudioBuffer(int capacity) : capacity_(capacity) {
-  buffer_l_ = new float[capacity];
-  buffer_r_ = new float[capacity];
+/**
+ *  Scales a span of left and right samples by `gain`, and adds them to interleaved `output`.
+ */
+static void MixAddInterleaved(const float* left, const float* right, float gain, int n, float* output) {
+  int i = 0;
+#if defined(AUDIO_MIX_AVX)
+  __m256 g = _mm256_set1_ps(gain);
+  for (; i + 8 <= n; i += 8) {
+    __m256 l = _mm256_mul_ps(_mm256_loadu_ps(left + i), g);
+    __m256 r = _mm256_mul_ps(_mm256_loadu_ps(right + i), g);
+    // unpack interleaves within each 128-bit half -- permute puts the halves back in order
+    __m256 lo = _mm256_unpacklo_ps(l, r);
+    __m256 hi = _mm256_unpackhi_ps(l, r);
+    float* out = output + 2 * i;
+    _mm256_storeu_ps(out, _mm256_add_ps(_mm256_loadu_ps(out), _mm256_permute2f128_ps(lo, hi, 0x20)));
+    _mm256_storeu_ps(out + 8, _mm256_add_ps(_mm256_loadu_ps(out + 8), _mm256_permute2f128_ps(lo, hi, 0x31)));
+  }
+#elif defined(AUDIO_MIX_SSE)
+  __m128 g = _mm_set1_ps(gain);
+  for (; i + 4 <= n; i += 4) {
+    __m128 l = _mm_mul_ps(_mm_loadu_ps(left + i), g);
+    __m128 r = _mm_mul_ps(_mm_loadu_ps(right + i), g);
+    float* out = output + 2 * i;
+    _mm_storeu_ps(out, _mm_add_ps(_mm_loadu_ps(out), _mm_unpacklo_ps(l, r)));
+    _mm_storeu_ps(out + 4, _mm_add_ps(_mm_loadu_ps(out + 4), _mm_unpackhi_ps(l, r)));
+  }
+#endif
+
+  for (; i < n; i++) {
+    output[2 * i] += left[i] * gain;
+    output[2 * i + 1] += right[i] * gain;
+  }
+}
+
+/**
+ *  Scales a span of samples by `gain`, and adds them to `output`.
+ */
+static void MixAdd(const float* input, float gain, int n, float* output) {
+  for (int i = 0; i < n; i++) {
+    output[i] += input[i] * gain;
+  }
+}
+
+/**
+ *  Scales a span of samples by `gain`, and writes them to `output`.
+ */
+static void Scale(const float* input, float gain, int n, float* output) {
+  for (int i = 0; i < n; i++) {
+    output[i] = input[i] * gain;
+  }
+}
+
+/**
+ *  @returns the smallest power of two which is at least `n`.
+ */
+static int NextPowerOfTwo(int n) {
+  int res = 1;
+  while (res < n) {
+    res <<= 1;
+  }
+
+  return res;
+}
+
+AudioBuffer::AudioBuffer(int capacity) : capacity_(NextPowerOfTwo(capacity)) {
+  mask_ = capacity_ - 1;
+  buffer_l_ = new float[capacity_];
+  buffer_r_ = new float[capacity_];
   looped_ = false;
   bytes_read_ = 0;
   bytes_written_ = 0;
   last_write_polled_ = 0;
   last_read_polled_ = 0;
-  running_ = false;
-  write_thread_flag_.test_and_set();
+  decode_pool_ = nullptr;
+  refill_queued_ = false;
 
-  gain_.store(0.0f);
+  gain_.store(1.0f);
 }
 
 float AudioBuffer::GetGainAsAmplitude() {
-  return std::pow(10.0f, gain_.load() / 20.0f);
+  return gain_.load(std::memory_order_relaxed);
 }
 
 
@@ -41,13 +119,14 @@ int AudioBuffer::ReadAddInterleaved(int n, float* output) {
   float gain = GetGainAsAmplitude();
 
   n = std::min(n, read_size);
-  for (int i = 0; i < n; i++) {
-    *(output++) += buffer_l_[read_head % capacity_] * gain;
-    *(output++) += buffer_r_[read_head++ % capacity_] * gain;
-  }
+  // up to the end of the ring, then the rest from its start
+  int start = static_cast<int>(read_head & mask_);
+  int first = std::min(n, capacity_ - start);
+  MixAddInterleaved(buffer_l_ + start, buffer_r_ + start, gain, first, output);
+  MixAddInterleaved(buffer_l_, buffer_r_, gain, n - first, output + 2 * first);
 
   if (read_size < (capacity_ / 2)) {
-    write_cv_.notify_all();
+    RequestRefill();
   }
 
   bytes_read_.fetch_add(n, std::memory_order_release);
@@ -66,16 +145,18 @@ int AudioBuffer::ReadAdd(int n, float* output_left, float* output_right) {
   float gain = GetGainAsAmplitude();
 
   n = std::min(n, read_size);
-  for (int i = 0; i < n; i++) {
-    output_right[i] += buffer_r_[read_head % capacity_] * gain;
-    output_left[i] += buffer_l_[read_head++ % capacity_] * gain;
-  }
+  int start = static_cast<int>(read_head & mask_);
+  int first = std::min(n, capacity_ - start);
+  MixAdd(buffer_l_ + start, gain, first, output_left);
+  MixAdd(buffer_r_ + start, gain, first, output_right);
+  MixAdd(buffer_l_, gain, n - first, output_left + first);
+  MixAdd(buffer_r_, gain, n - first, output_right + first);
 
   if (read_size < (capacity_ / 2)) {
-    write_cv_.notify_all();
+    RequestRefill();
   }
 
-  bytes_read_.fetch_add(read_size, std::memory_order_release);
+  bytes_read_.fetch_add(n, std::memory_order_release);
   return n;
 }
 
@@ -91,13 +172,15 @@ int AudioBuffer::Peek(int n, float* output_left, float* output_right) {
   float gain = GetGainAsAmplitude();
 
   n = std::min(n, read_size);
-  for (int i = 0; i < n; i++) {
-    output_right[i] = buffer_r_[read_head % capacity_] * gain;
-    output_left[i] = buffer_l_[read_head++ % capacity_] * gain;
-  }
+  int start = static_cast<int>(read_head & mask_);
+  int first = std::min(n, capacity_ - start);
+  Scale(buffer_l_ + start, gain, first, output_left);
+  Scale(buffer_r_ + start, gain, first, output_right);
+  Scale(buffer_l_, gain, n - first, output_left + first);
+  Scale(buffer_r_, gain, n - first, output_right + first);
 
   if (read_size < (capacity_ / 2)) {
-    write_cv_.notify_all();
+    RequestRefill();
   }
 
   return n;
@@ -112,12 +195,14 @@ int AudioBuffer::Write(int n, float* input_left, float* input_right) {
   int read_size = static_cast<int>(last_read_polled_ + capacity_ - write_head);
 
   n = std::min(n, read_size);
-  for (int i = 0; i < n; i++) {
-    buffer_r_[write_head % capacity_] = input_right[i];
-    buffer_l_[write_head++ % capacity_] = input_left[i];
-  }
-
-  bytes_written_.store(write_head, std::memory_order_release);
+  int start = static_cast<int>(write_head & mask_);
+  int first = std::min(n, capacity_ - start);
+  std::copy(input_left, input_left + first, buffer_l_ + start);
+  std::copy(input_right, input_right + first, buffer_r_ + start);
+  std::copy(input_left + first, input_left + n, buffer_l_);
+  std::copy(input_right + first, input_right + n, buffer_r_);
+
+  bytes_written_.store(write_head + n, std::memory_order_release);
   SeekFileToWriteHead();
 
   return n;
@@ -132,38 +217,35 @@ bool AudioBuffer::IsLooped() {
 }
 
 void AudioBuffer::SetGain(float db) {
-  gain_.store(db);
+  // once here, rather than on every read
+  gain_.store(std::pow(10.0f, db / 20.0f));
+}
+
+void AudioBuffer::RequestRefill() {
+  AudioDecodePool* pool = decode_pool_.load(std::memory_order_acquire);
+  if (pool == nullptr || refill_queued_.exchange(true, std::memory_order_acq_rel)) {
+    return;
+  }
+
+  if (!pool->QueueRefill(this)) {
+    // try again on the next read
+    refill_queued_.store(false, std::memory_order_release);
+  }
 }
 
-void AudioBuffer::WriteThreadFunc() {
-  uint64_t bw_local;
-  // someone has to clear this to shut it up
-  while (write_thread_flag_.test_and_set()) {
-    std::unique_lock<std::mutex> threadlock(write_lock_);
-    bw_local = bytes_written_.load(std::memory_order_acquire);
-    // buffer is full -- get up to date data
-    if (bw_local == (last_read_polled_ + capacity_)) {
-      last_read_polled_ = bytes_read_.load(std::memory_order_acquire);
-      // after update: still full
-      if (bw_local == (last_read_polled_ + capacity_)) {
-        // wait until notified
-        // edge cond: the buffer is killed while waiting here
-        // use dtor to grab lock, clear flag, then notify, then release.
-        // because the lock is grabbed: we're guaranteed to be in this state when that
-        // happens, or done completely.
-        write_cv_.wait(threadlock);
-        continue;
-      }
-    }
-
-    // once we get here: we definitely have capacity -- if WriteFromFile returns <= 0, then the file is exhausted.
-    uint64_t w_len = capacity_ - (bw_local - last_read_polled_);
-    // only one thread will write at a time!
-    if (this->WriteFromFile(static_cast<int>(w_len)) <= 0) {
-      // we obviously have capacity, so the file is exhausted or broken.
-      break;
-    }
+int AudioBuffer::Refill() {
+  uint64_t bw_local = bytes_written_.load(std::memory_order_acquire);
+  last_read_polled_ = bytes_read_.load(std::memory_order_acquire);
+  int w_len = static_cast<int>(capacity_ - (bw_local - last_read_polled_));
+  int res = 0;
+  // if WriteFromFile returns <= 0 with space to fill, the file is exhausted or broken.
+  if (w_len > 0 && (res = this->WriteFromFile(w_len)) <= 0) {
+    res = -1;
   }
+
+  // done writing -- the reader can ask again
+  refill_queued_.store(false, std::memory_order_release);
+  return res;
 }
 
 AudioBufferPacket AudioBuffer::GetBufferSpace(uint64_t n) {
@@ -176,12 +258,12 @@ AudioBufferPacket AudioBuffer::GetBufferSpace(uint64_t n) {
 
   read_size = std::min(n, read_size);
 
-  if ((write_head % capacity_) + read_size > capacity_) {
-    read_size = capacity_ - (write_head % capacity_);
+  if ((write_head & mask_) + read_size > capacity_) {
+    read_size = capacity_ - (write_head & mask_);
   }
 
-  float* l_offset = &buffer_l_[write_head % capacity_];
-  float* r_offset = &buffer_r_[write_head % capacity_];
+  float* l_offset = &buffer_l_[write_head & mask_];
+  float* r_offset = &buffer_r_[write_head & mask_];
 
   return {l_offset, r_offset, read_size};
 }
@@ -190,22 +272,6 @@ void AudioBuffer::IncrementWriteHead(int n) {
   bytes_written_.fetch_add(n, std::memory_order_release);
 }
 
-/**
- *  True if the thread could be spun up, false otherwise.
- */ 
-bool AudioBuffer::StartWriteThread() {
-  std::unique_lock<std::mutex> threadlock(write_lock_);
-  if (running_) {
-    return false;
-  }
-
-  write_thread_flag_.test_and_set();
-  running_ = true;
-  write_thread_ = std::thread(&AudioBuffer::WriteThreadFunc, this);
-  write_thread_.detach();
-  return true;
-}
-
 AudioBuffer::~AudioBuffer() {
   if (buffer_l_ != nullptr) {
     delete[] buffer_l_;
@@ -217,8 +283,6 @@ AudioBuffer::~AudioBuffer() {
 }
 
 AudioBuffer& AudioBuffer::operator=(AudioBuffer&& other) {
-  // killing write thread is the responsibility of the implementor
-
   if (buffer_l_ != nullptr) {
     delete[] buffer_l_;
   }
@@ -227,11 +291,10 @@ AudioBuffer& AudioBuffer::operator=(AudioBuffer&& other) {
     delete[] buffer_r_;
   }
 
-  // kill other's write thread
-  other.DestroyWriteThread();
-
   // copy fields
   capacity_ = other.capacity_;
+  mask_ = other.mask_;
+  gain_ = other.gain_.load();
   buffer_l_ = other.buffer_l_;
   buffer_r_ = other.buffer_r_;
   other.buffer_l_ = other.buffer_r_ = nullptr;
@@ -239,18 +302,16 @@ AudioBuffer& AudioBuffer::operator=(AudioBuffer&& other) {
   last_write_polled_ = other.last_write_polled_;
   bytes_written_ = other.bytes_written_.load(std::memory_order_seq_cst);
   last_read_polled_ = other.last_read_polled_;
-  write_thread_ = std::move(other.write_thread_);
-  // start up write thread again if it was already up in the moved elem
-  if (other.running_) {
-    StartWriteThread();
-  }
-
+  // buffers being filled by a decode pool are owned by it, and don't move
+  decode_pool_ = nullptr;
+  refill_queued_ = false;
   return *this;
 }
 
 AudioBuffer::AudioBuffer(AudioBuffer&& other) : capacity_(other.capacity_) {
   // copy fields
-  other.DestroyWriteThread();
+  mask_ = other.mask_;
+  gain_ = other.gain_.load();
   buffer_l_ = other.buffer_l_;
   buffer_r_ = other.buffer_r_;
   other.buffer_l_ = other.buffer_r_ = nullptr;
@@ -258,23 +319,9 @@ AudioBuffer::AudioBuffer(AudioBuffer&& other) : capacity_(other.capacity_) {
   last_write_polled_ = other.last_write_polled_;
   bytes_written_ = other.bytes_written_.load(std::memory_order_seq_cst);
   last_read_polled_ = other.last_read_polled_;
-  write_thread_ = std::move(other.write_thread_);
-  // start up write thread again if it was already up in the moved elem
-  if (other.running_) {
-    StartWriteThread();
-  }
+  decode_pool_ = nullptr;
+  refill_queued_ = false;
 }
 
-void AudioBuffer::DestroyWriteThread() {
-  if (running_) {
-    std::unique_lock<std::mutex> moved_thread_lock(write_lock_);
-    running_ = false;
-    write_thread_flag_.clear();
-    write_cv_.notify_all();
-    moved_thread_lock.unlock();
-    // no guarantee that the thread has spun down already
-  }
 }
-
 }
-}
\ No newline at end of file
@@ -141,7 +141,6 @@ void AudioBufferOgg::SeekFileToWriteHead() {
 }
 
 AudioBufferOgg::~AudioBufferOgg() {
-  DestroyWriteThread();
   if (vorbis_file_ != nullptr) {
     stb_vorbis_close(vorbis_file_);
   }
@@ -150,7 +149,6 @@ AudioBufferOgg::~AudioBufferOgg() {
 }
 
 AudioBufferOgg& AudioBufferOgg::operator=(AudioBufferOgg&& other) {
-  DestroyWriteThread();
   AudioBuffer::operator=(std::move(other));
   this->vorbis_file_ = other.vorbis_file_;
   other.vorbis_file_ = nullptr;
@@ -0,0 +1,249 @@
+#include <audio/AudioDecodePool.hpp>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace monkeysworld {
+namespace audio {
+
+AudioDecodePool::AudioDecodePool(int thread_count, int sample_rate) {
+  for (size_t i = 0; i < READY_QUEUE_SIZE; i++) {
+    ready_queue_[i].sequence.store(i, std::memory_order_relaxed);
+    ready_queue_[i].buffer = nullptr;
+  }
+
+  enqueue_pos_ = 0;
+  dequeue_pos_ = 0;
+  sample_rate_ = sample_rate;
+  running_ = true;
+  watching_ = false;
+  next_id_ = 0;
+  for (int i = 0; i < thread_count; i++) {
+    threads_.push_back(std::thread(&AudioDecodePool::WorkerFunc, this));
+  }
+}
+
+int AudioDecodePool::GetDefaultThreadCount() {
+  // decoding is light -- half the cores, up to four, is plenty
+  int cores = static_cast<int>(std::thread::hardware_concurrency());
+  return std::max(1, std::min(4, cores / 2));
+}
+
+void AudioDecodePool::AddBuffer(std::shared_ptr<AudioBuffer> buffer) {
+  AudioBuffer* key = buffer.get();
+  {
+    std::unique_lock<std::mutex> lock(lock_);
+    if (buffers_.find(key) != buffers_.end()) {
+      return;
+    }
+
+    buffers_[key] = {std::move(buffer), next_id_++};
+    key->refill_queued_.store(true, std::memory_order_relaxed);
+    key->decode_pool_.store(this, std::memory_order_release);
+    // nothing's played yet, so it doesn't wait behind anyone
+    requests_.push({Clock::now(), key});
+    if (watching_) {
+      // the watcher's awake anyway -- the others might all be busy
+      watch_cv_.notify_one();
+      return;
+    }
+  }
+
+  worker_cv_.notify_one();
+}
+
+void AudioDecodePool::RemoveBuffer(AudioBuffer* buffer) {
+  // released after the lock, in case it's the last reference
+  std::shared_ptr<AudioBuffer> removed;
+  std::unique_lock<std::mutex> lock(lock_);
+  auto i = buffers_.find(buffer);
+  if (i == buffers_.end()) {
+    return;
+  }
+
+  // any requests left in the queue are skipped once they're popped
+  buffer->decode_pool_.store(nullptr, std::memory_order_release);
+  removed = std::move(i->second.buffer);
+  buffers_.erase(i);
+}
+
+size_t AudioDecodePool::GetBufferCount() {
+  std::unique_lock<std::mutex> lock(lock_);
+  return buffers_.size();
+}
+
+int AudioDecodePool::GetThreadCount() const {
+  return static_cast<int>(threads_.size());
+}
+
+bool AudioDecodePool::QueueRefill(AudioBuffer* buffer) {
+  ready_cell* cell;
+  size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+  for (;;) {
+    cell = &ready_queue_[pos & (READY_QUEUE_SIZE - 1)];
+    size_t seq = cell->sequence.load(std::memory_order_acquire);
+    intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+    if (diff == 0) {
+      if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      // full
+      return false;
+    } else {
+      pos = enqueue_pos_.load(std::memory_order_relaxed);
+    }
+  }
+
+  cell->buffer = buffer;
+  cell->sequence.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+AudioBuffer* AudioDecodePool::PopReady() {
+  ready_cell* cell;
+  size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+  for (;;) {
+    cell = &ready_queue_[pos & (READY_QUEUE_SIZE - 1)];
+    size_t seq = cell->sequence.load(std::memory_order_acquire);
+    intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+    if (diff == 0) {
+      if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      // empty
+      return nullptr;
+    } else {
+      pos = dequeue_pos_.load(std::memory_order_relaxed);
+    }
+  }
+
+  AudioBuffer* res = cell->buffer;
+  cell->sequence.store(pos + READY_QUEUE_SIZE, std::memory_order_release);
+  return res;
+}
+
+void AudioDecodePool::DrainReadyQueue() {
+  AudioBuffer* buffer;
+  Clock::time_point now = Clock::now();
+  while ((buffer = PopReady()) != nullptr) {
+    if (buffers_.find(buffer) == buffers_.end()) {
+      // removed since it was queued -- might not even exist anymore
+      continue;
+    }
+
+    // everything plays back at the same rate, so the emptiest buffer runs dry first
+    uint64_t buffered = buffer->GetBytesWritten() - buffer->GetBytesRead();
+    auto remaining = std::chrono::microseconds(buffered * 1000000 / sample_rate_);
+    requests_.push({now + remaining, buffer});
+  }
+}
+
+void AudioDecodePool::WatchBuffer(AudioBuffer* buffer) {
+  uint64_t buffered = buffer->GetBytesWritten() - buffer->GetBytesRead();
+  uint64_t margin = static_cast<uint64_t>(buffer->capacity_ / 4);
+  uint64_t until = (buffered > margin ? buffered - margin : 0);
+  Clock::time_point due = Clock::now() + std::chrono::microseconds(until * 1000000 / sample_rate_);
+  watches_.push(due);
+  if (watching_ && due < watch_until_) {
+    watch_cv_.notify_one();
+  }
+}
+
+void AudioDecodePool::WaitForWork(std::unique_lock<std::mutex>& lock) {
+  Clock::time_point now = Clock::now();
+  while (!watches_.empty() && watches_.top() <= now) {
+    watches_.pop();
+  }
+
+  if (watching_ || buffers_.empty()) {
+    // someone else is keeping an eye on the queue, or there's nobody to ask for a refill
+    worker_cv_.wait(lock);
+    return;
+  }
+
+  Clock::time_point wake = now + std::chrono::milliseconds(FALLBACK_WAKE_MS);
+  if (!watches_.empty()) {
+    wake = std::min(wake, watches_.top());
+  }
+
+  watching_ = true;
+  watch_until_ = wake;
+  watch_cv_.wait_until(lock, wake);
+  watching_ = false;
+}
+
+void AudioDecodePool::WorkerFunc() {
+  std::unique_lock<std::mutex> lock(lock_);
+  while (running_) {
+    DrainReadyQueue();
+    if (requests_.empty()) {
+      WaitForWork(lock);
+      continue;
+    }
+
+    refill_request request = requests_.top();
+    requests_.pop();
+    auto i = buffers_.find(request.buffer);
+    if (i == buffers_.end()) {
+      continue;
+    }
+
+    auto r = refilling_.find(request.buffer);
+    if (r != refilling_.end()) {
+      // removed and added again while a worker was still refilling it -- go again once that's done
+      r->second = true;
+      continue;
+    }
+
+    // one request per registration, and none run alongside a refill, so nobody else is writing to it
+    AudioBuffer* key = request.buffer;
+    registration reg = i->second;
+    refilling_[key] = false;
+    if (!watching_) {
+      // hand the queue off to someone idle while we're busy
+      worker_cv_.notify_one();
+    }
+
+    lock.unlock();
+    int written = reg.buffer->Refill();
+    lock.lock();
+    bool requeue = refilling_[key];
+    refilling_.erase(key);
+    i = buffers_.find(key);
+    if (i == buffers_.end()) {
+      continue;
+    }
+
+    if (requeue) {
+      requests_.push({Clock::now(), key});
+    } else if (written < 0 && i->second.id == reg.id) {
+      // file's exhausted -- nothing left to do
+      key->decode_pool_.store(nullptr, std::memory_order_release);
+      buffers_.erase(i);
+    } else {
+      WatchBuffer(key);
+    }
+  }
+}
+
+AudioDecodePool::~AudioDecodePool() {
+  {
+    std::unique_lock<std::mutex> lock(lock_);
+    running_ = false;
+  }
+
+  worker_cv_.notify_all();
+  watch_cv_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+
+  for (auto& buffer : buffers_) {
+    buffer.second.buffer->decode_pool_.store(nullptr, std::memory_order_release);
+  }
+}
+
+}
+}
@@ -5,6 +5,8 @@
 
 #include <boost/log/trivial.hpp>
 
+#include <algorithm>
+
 #define SAMPLE_RATE 44100
 
 namespace monkeysworld {
@@ -25,6 +27,13 @@ AudioManager::AudioManager() {
     buffers_[i].buffer = nullptr;
   }
 
+  for (auto& pending : pending_voices_) {
+    pending = 0;
+  }
+
+  active_count_ = 0;
+  decode_pool_ = std::make_unique<AudioDecodePool>(AudioDecodePool::GetDefaultThreadCount(), SAMPLE_RATE);
+
   PaStreamParameters* out = new PaStreamParameters();
   out->channelCount = 2;
   out->device = Pa_GetDefaultOutputDevice();
@@ -65,6 +74,12 @@ AudioManager::buffer_info* AudioManager::GetOpenBufferSpot(int& index) {
     return nullptr;
   }
 
+  if (info->buffer != nullptr) {
+    // whatever played here last is done -- stop filling it
+    decode_pool_->RemoveBuffer(info->buffer.get());
+    info->buffer = nullptr;
+  }
+
   return info;
 }
 
@@ -93,10 +108,15 @@ AudioStream AudioManager::AddBuffer(std::shared_ptr<AudioBuffer> buffer) {
 
   info->buffer = buffer;
   info->status = USED;
-  info->buffer->StartWriteThread();
+  decode_pool_->AddBuffer(info->buffer);
+  QueueVoice(index);
   return { index };
 }
 
+void AudioManager::QueueVoice(int index) {
+  pending_voices_[index / 64].fetch_or(1ULL << (index % 64), std::memory_order_release);
+}
+
 void AudioManager::QueueThreadfunc() {
   queue_info info_queue;
   while (buffer_thread_flag_.test_and_set()) {
@@ -125,7 +145,8 @@ void AudioManager::QueueThreadfunc() {
       case OGG:
         info_buffer->buffer = std::make_shared<AudioBufferOgg>(4096, info_queue.filename);
         info_buffer->status = USED;
-        info_buffer->buffer->StartWriteThread();
+        decode_pool_->AddBuffer(info_buffer->buffer);
+        QueueVoice(info_queue.index);
         break;
       default:
         BOOST_LOG_TRIVIAL(error) << "Unknown buffer type received -- " << info_queue.type;
@@ -144,10 +165,13 @@ int AudioManager::RemoveFileFromBuffer(AudioStream stream) {
   switch (info->status) {
     case AVAILABLE:
       if (info->buffer != nullptr) {
+        decode_pool_->RemoveBuffer(info->buffer.get());
         info->buffer = nullptr;
       }
       break;
     case USED:
+      // the callback might still be reading -- it just won't be refilled
+      decode_pool_->RemoveBuffer(info->buffer.get());
       info->status = DELETING;
       break;
   }
@@ -164,25 +188,42 @@ int AudioManager::CallbackFunc(const void* input,
   AudioManager* mgr = reinterpret_cast<AudioManager*>(userData);
   buffer_info* info;
   int samples_read;
-  for (unsigned int i = 0; i < frameCount; i++) {
-    output_buffer[2 * i] = output_buffer[2 * i + 1] = 0.0f;
+  std::fill(output_buffer, output_buffer + 2 * frameCount, 0.0f);
+
+  // pick up voices which started since the last callback
+  for (int i = 0; i < AUDIO_MGR_MAX_BUFFER_COUNT / 64; i++) {
+    uint64_t pending = mgr->pending_voices_[i].exchange(0, std::memory_order_acquire);
+    for (int bit = 0; pending != 0; bit++, pending >>= 1) {
+      if (pending & 1) {
+        mgr->active_voices_[mgr->active_count_++] = i * 64 + bit;
+      }
+    }
   }
 
-  for (int i = 0; i < AUDIO_MGR_MAX_BUFFER_COUNT; i++) {
-    info = &mgr->buffers_[i];
+  int i = 0;
+  while (i < mgr->active_count_) {
+    info = &mgr->buffers_[mgr->active_voices_[i]];
+    bool done;
     switch (info->status) {
-      case DELETING:
-        info->status = AVAILABLE;
-      case AVAILABLE:
-        break;
       case USED:
         // essentially reads zeroes if the sample cannot be fetched :)
         samples_read = info->buffer->ReadAddInterleaved(frameCount, output_buffer);
-        if (samples_read == 0 && info->buffer->EndOfFile()) {
+        done = (samples_read == 0 && info->buffer->EndOfFile());
+        if (done) {
           info->status = AVAILABLE;
         }
-      default:
         break;
+      case DELETING:
+        info->status = AVAILABLE;
+      default:
+        done = true;
+    }
+
+    if (done) {
+      // order doesn't matter -- fill the gap from the end
+      mgr->active_voices_[i] = mgr->active_voices_[--mgr->active_count_];
+    } else {
+      i++;
     }
   }
 
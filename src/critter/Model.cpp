@@ -20,6 +20,17 @@ using model::Mesh;
 using boost::lexical_cast;
 
 using engine::Context;
+using engine::RenderContext;
+
+// min fraction of the viewport height covered by a model before we swap to the next LOD
+static const float LOD_COVERAGE[] = { 0.4f, 0.2f, 0.1f, 0.05f };
+static const int LOD_COVERAGE_COUNT = sizeof(LOD_COVERAGE) / sizeof(float);
+
+// clamps the camera distance used to estimate coverage
+static const float LOD_MIN_DISTANCE = 0.01f;
+
+std::atomic<uint64_t> Model::tri_count_(0);
+std::atomic<uint64_t> Model::shadow_tri_count_(0);
 
 ////////////////////////////////////////////////////////////////////////////////
 //
@@ -86,16 +97,118 @@ static data_type GetDataType(const std::string& line);
 //
 ////////////////////////////////////////////////////////////////////////////////
 
-Model::Model(Context* ctx) : GameObject(ctx) {}
+Model::Model(Context* ctx) : GameObject(ctx), lod_(0), reload_count_(0), bound_center_(0), bound_radius_(0) {}
 
 void Model::SetMesh(const std::shared_ptr<const model::Mesh<>>& mesh) {
   mesh_ = mesh;
+  lods_.clear();
+  lod_ = 0;
+  reload_count_ = file::ModelLoader::GetReloadCount();
+  UpdateBounds();
 }
 
 std::shared_ptr<const Mesh<>> Model::GetMesh() {
   return mesh_;
 }
 
+void Model::SetMeshLODs(const std::vector<std::shared_ptr<const model::Mesh<>>>& lods) {
+  if (lods.empty()) {
+    SetMesh(nullptr);
+    return;
+  }
+
+  SetMesh(lods[0]);
+  lods_ = lods;
+}
+
+void Model::SelectLOD(const RenderContext& rc) {
+  if (reload_count_ != file::ModelLoader::GetReloadCount()) {
+    RefreshMesh();
+  }
+
+  if (lods_.size() <= 1) {
+    lod_ = 0;
+    return;
+  }
+
+  camera_info cam = rc.GetActiveCamera();
+  glm::vec3 center;
+  float radius = GetWorldBoundingSphere(&center);
+  glm::vec4 center_view = cam.view_matrix * glm::vec4(center, 1.0);
+  float dist = glm::max(-center_view.z, LOD_MIN_DISTANCE);
+
+  // persp[1][1] is cot(fov / 2), so this is the radius over the half-height of the frustum at `dist`
+  float coverage = (radius * cam.persp_matrix[1][1]) / dist;
+  int max_lod = static_cast<int>(lods_.size()) - 1;
+  lod_ = 0;
+  while (lod_ < max_lod && lod_ < LOD_COVERAGE_COUNT && coverage < LOD_COVERAGE[lod_]) {
+    lod_++;
+  }
+}
+
+int Model::GetLODLevel() const {
+  return lod_;
+}
+
+float Model::GetWorldBoundingSphere(glm::vec3* center) const {
+  glm::mat4 tf = GetTransformationMatrix();
+  float scale = glm::max(glm::length(glm::vec3(tf[0])),
+                         glm::max(glm::length(glm::vec3(tf[1])), glm::length(glm::vec3(tf[2]))));
+  *center = glm::vec3(tf * glm::vec4(bound_center_, 1.0));
+  return bound_radius_ * scale;
+}
+
+uint64_t Model::ResetTriangleCount() {
+  return tri_count_.exchange(0);
+}
+
+uint64_t Model::ResetShadowTriangleCount() {
+  return shadow_tri_count_.exchange(0);
+}
+
+const std::shared_ptr<const Mesh<>>& Model::GetDrawnMesh() const {
+  return (lods_.empty() ? mesh_ : lods_[lod_]);
+}
+
+void Model::UpdateBounds() {
+  bound_center_ = glm::vec3(0);
+  bound_radius_ = 0.0f;
+  if (mesh_ == nullptr || mesh_->GetVertexCount() == 0) {
+    return;
+  }
+
+  const VertexPacket3D* data = mesh_->GetVertexData();
+  glm::vec3 min_pos = data[0].position;
+  glm::vec3 max_pos = data[0].position;
+  for (size_t i = 1; i < mesh_->GetVertexCount(); i++) {
+    min_pos = glm::min(min_pos, data[i].position);
+    max_pos = glm::max(max_pos, data[i].position);
+  }
+
+  bound_center_ = (min_pos + max_pos) * 0.5f;
+  for (size_t i = 0; i < mesh_->GetVertexCount(); i++) {
+    bound_radius_ = glm::max(bound_radius_, glm::distance(bound_center_, data[i].position));
+  }
+}
+
+void Model::RefreshMesh() {
+  reload_count_ = file::ModelLoader::GetReloadCount();
+  Context* ctx = GetContext();
+  if (!lods_.empty() && mesh_ != nullptr && ctx != nullptr) {
+    auto loader = ctx->GetCachedFileLoader();
+    if (loader) {
+      auto lods = loader->FindModelLODs(mesh_.get());
+      if (!lods.empty()) {
+        lods_ = lods;
+        lod_ = 0;
+      }
+    }
+  }
+
+  // the base mesh is reloaded in place, so this applies with or without LODs
+  UpdateBounds();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 //
 // This code is being migrated over to file/ModelLoader.cpp. Don't use it :)
@@ -313,32 +426,61 @@ static data_type GetDataType(const std::string& line) {
 ////////////////////////////////////////////////////////////////////////////////
 
 void Model::PrepareAttributes() {
-  if (mesh_ != nullptr) {
-    mesh_->PointToVertexAttribs();
+  auto& mesh = GetDrawnMesh();
+  if (mesh != nullptr) {
+    mesh->PointToVertexAttribs();
   }
 }
 
 void Model::Draw() {
-  glDrawElements(GL_TRIANGLES, static_cast<int>(mesh_->GetIndexCount()), GL_UNSIGNED_INT, (void*)0);
+  auto& mesh = GetDrawnMesh();
+  tri_count_ += mesh->GetIndexCount() / 3;
+  glDrawElements(GL_TRIANGLES, static_cast<int>(mesh->GetIndexCount()), GL_UNSIGNED_INT, (void*)0);
+}
+
+void Model::DrawShadow() {
+  auto& mesh = GetDrawnMesh();
+  shadow_tri_count_ += mesh->GetIndexCount() / 3;
+  glDrawElements(GL_TRIANGLES, static_cast<int>(mesh->GetIndexCount()), GL_UNSIGNED_INT, (void*)0);
 }
 
 Model::Model(const Model& other) : GameObject(other) {
   mesh_ = other.mesh_;
+  lods_ = other.lods_;
+  lod_ = other.lod_;
+  reload_count_ = other.reload_count_;
+  bound_center_ = other.bound_center_;
+  bound_radius_ = other.bound_radius_;
 }
 
 Model::Model(Model&& other) : GameObject(other) {
   mesh_ = std::move(other.mesh_);
+  lods_ = std::move(other.lods_);
+  lod_ = other.lod_;
+  reload_count_ = other.reload_count_;
+  bound_center_ = other.bound_center_;
+  bound_radius_ = other.bound_radius_;
 }
 
 Model& Model::operator=(const Model& other) {
   GameObject::operator=(other);
   mesh_ = other.mesh_;
+  lods_ = other.lods_;
+  lod_ = other.lod_;
+  reload_count_ = other.reload_count_;
+  bound_center_ = other.bound_center_;
+  bound_radius_ = other.bound_radius_;
   return *this;
 }
 
 Model& Model::operator=(Model&& other) {
   GameObject::operator=(other);
   mesh_ = std::move(other.mesh_);
+  lods_ = std::move(other.lods_);
+  lod_ = other.lod_;
+  reload_count_ = other.reload_count_;
+  bound_center_ = other.bound_center_;
+  bound_radius_ = other.bound_radius_;
   return *this;
 }
 
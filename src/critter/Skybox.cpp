@@ -59,8 +59,9 @@ void Skybox::RenderMaterial(const engine::RenderContext& rc) {
     mat_.SetCubeMap(cube_map_->GetCubeMapDescriptor());
   }
 
-  mat_.UseMaterial();
-  Draw();
+  if (mat_.UseMaterial()) {
+    Draw();
+  }
 }
 
 void Skybox::Draw() {
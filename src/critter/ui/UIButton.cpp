@@ -49,9 +49,11 @@ void UIButton::DrawUI(glm::vec2 xyMin, glm::vec2 xyMax, shader::Canvas canvas) {
     mat_.button_color.a = mat_.border_color.a = 1.0;
   }
 
-  mat_.UseMaterial();
-  mesh_local_->PointToVertexAttribs();
-  glDrawElements(GL_TRIANGLES, static_cast<int>(mesh_local_->GetIndexCount()), GL_UNSIGNED_INT, (void*)0);
+  if (mat_.UseMaterial()) {
+    mesh_local_->PointToVertexAttribs();
+    glDrawElements(GL_TRIANGLES, static_cast<int>(mesh_local_->GetIndexCount()), GL_UNSIGNED_INT, (void*)0);
+  }
+
   UITextObject::DrawUI(xyMin, xyMax, canvas);
 }
 
@@ -1,20 +1,30 @@
 #include <critter/ui/UIGroup.hpp>
 
-#include <utils/ObjectGraph.hpp>
 #include <critter/ui/layout/BoundingBox.hpp>
 
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+
 namespace monkeysworld {
 namespace critter {
 namespace ui {
 
 using engine::Context;
-using utils::ObjectGraph;
 using namespace layout;
 
 typedef std::shared_ptr<UIObject> child_ptr;
 
-UIGroup::UIGroup(Context* ctx) : UIObject(ctx), mat_(ctx) { 
-  max_textures_ = -1;
+UIGroup::UIGroup(Context* ctx) : UIObject(ctx), packer_(glm::ivec2(0)), mat_(ctx), text_batch_(ctx) { 
+  max_atlas_size_ = -1;
+  atlas_ = 0;
+  atlas_size_ = glm::ivec2(0);
+  batch_dims_ = glm::ivec2(0);
+  atlas_batches_ = 0;
+  batch_dirty_ = true;
+  layout_dirty_ = true;
+  text_batching_ = true;
 }
 
 std::shared_ptr<Object> UIGroup::GetChild(uint64_t id) {
@@ -62,12 +72,20 @@ void UIGroup::AddChild(std::shared_ptr<UIObject> obj) {
 
   obj->parent_ = std::weak_ptr<UIObject>(this->shared_from_this());
   children_.push_back(obj);
+  batch_dirty_ = true;
+  layout_dirty_ = true;
+  // new children haven't drawn anything yet
+  obj->Invalidate();
 }
 
 void UIGroup::RemoveChild(uint64_t id) {
   for (auto ptr = children_.begin(); ptr != children_.end(); ptr++) {
     if ((*ptr)->GetId() == id) {
+      (*ptr)->InvalidateParent();
+      (*ptr)->parent_ = std::weak_ptr<UIObject>();
       children_.erase(ptr);
+      batch_dirty_ = true;
+      layout_dirty_ = true;
       return;
     }
   }
@@ -81,283 +99,369 @@ void UIGroup::RemoveChild(uint64_t id) {
 }
 
 void UIGroup::Layout(glm::vec2 size) {
-  ObjectGraph o;
-  
-  for (auto child : children_) {
-    layout::UILayoutParams param = child->GetLayoutParams();
-
-    int i = 0;
-    for (layout::Margin* m = reinterpret_cast<layout::Margin*>(&param); i < 4; i++, m++) {
-      if (m->anchor_id != 0) {
-        // if we encounter a vertex which is not a child, break out.
-        o.AddEdge(m->anchor_id, child->GetId());
-      }
+  if (layout_dirty_) {
+    // children came or went -- start from scratch
+    layout_nodes_ = children_;
+    std::vector<uint64_t> ids;
+    ids.reserve(layout_nodes_.size());
+    for (auto& child : layout_nodes_) {
+      ids.push_back(child->GetId());
     }
+
+    layout_graph_.SetNodes(GetId(), ids);
+    layout_dirty_ = false;
+  }
+
+  layout_graph_.SetGroupDimensions(GetDimensions());
+  for (size_t i = 0; i < layout_nodes_.size(); i++) {
+    const child_ptr& child = layout_nodes_[i];
+    layout_graph_.SetNode(i, child->GetLayoutParams(), child->GetPosition(), child->GetDimensions());
+  }
+
+  if (layout_graph_.Solve() < 0) {
+    // graph logs the reason
+    return;
+  }
+
+  // only touch children which actually moved
+  for (size_t index : layout_graph_.GetChangedNodes()) {
+    const child_ptr& child = layout_nodes_[index];
+    const BoundingBox& bb = layout_graph_.GetBoundingBox(index);
+    child->SetPosition(glm::vec2(bb.left, bb.top));
+    child->SetDimensions(glm::vec2(bb.right - bb.left, bb.bottom - bb.top));
+  }
+}
+
+void UIGroup::DrawUI(glm::vec2 min, glm::vec2 max, shader::Canvas canvas) {
+  // note: framebuffer is bound if this is being called
+  // plus, all of its children have already been drawn
+  if (max_atlas_size_ < 0) {
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_atlas_size_);
+  }
+
+  if (IsBatchStale()) {
+    RebuildBatch();
   }
 
-  std::vector<uint64_t> sort = o.TopoSort();
-
-  std::unordered_map<uint64_t, layout::BoundingBox> bounding_boxes;
-  glm::vec2 dims_local = GetDimensions();
-  // working box
-  layout::BoundingBox b;
-  // represents the containing group
-  b.left = 0;
-  b.right = dims_local.x;
-  b.top = 0;
-  b.bottom = dims_local.y;
-  bounding_boxes.insert(std::make_pair(GetId(), b));
-  // handle invalid orderings below
-  //  - if we encounter a node in our topo sort which is not a child, or not the group,
-  //    then break run some fallback method which just reads positions + dimensions.
-  //  - only once we have a bounding box for every node will we adjust positions + dimensions.
-  for (auto id : sort) {
-    if (id == GetId()) {
-      // avoid laying out myself
+  // if everything fits in the atlas, children only need to be copied when they redraw.
+  // otherwise, each draw overwrites the last one's children.
+  bool shared_atlas = (atlas_batches_ > 1);
+  bool copied = false;
+  size_t current_batch = 0;
+  // range of quads waiting to be drawn -- direct children break it up, to keep z-order intact
+  size_t quad_start = 0;
+  size_t quad_end = 0;
+  for (auto& entry : batch_) {
+    if (!entry.visible) {
       continue;
     }
-    auto child = std::dynamic_pointer_cast<UIObject>(GetChild(id));
-    if (!child) {
-      BOOST_LOG_TRIVIAL(error) << "current layout invalid -- child with ID " << id << " not found in UIObject ID " << GetId() << "!";
-      return;
+
+    if (entry.direct) {
+      DrawQuads(quad_start, quad_end);
+      quad_start = quad_end;
+      DrawDirect(entry, min, max, canvas);
+      continue;
     }
 
-    auto params = child->GetLayoutParams();
-
-    glm::vec2 child_dims = child->GetDimensions();
-    glm::vec2 child_pos = child->GetPosition();
-
-    // insert default values
-    b.top = child_pos.y;
-    b.left = child_pos.x;
-    b.bottom = b.top + child_dims.y;
-    b.right = b.left + child_dims.x;
-    
-    // top/bottom
-    if (params.top.anchor_id != 0) {
-      const layout::BoundingBox& box = bounding_boxes.at(params.top.anchor_id);
-      switch (params.top.anchor_face) {
-        case Face::BOTTOM:
-          b.top = box.bottom;
-          break;
-        case Face::TOP:
-          b.top = box.top;
-          break;
-        default:
-          BOOST_LOG_TRIVIAL(error) << "Invalid face provided for ID " << id << "'s top margin -- ignoring...";
-        // all others are invalid
-      }
+    if (!copied || entry.batch != current_batch) {
+      DrawQuads(quad_start, quad_end);
+      quad_start = quad_end;
+      CopyToAtlas(entry.batch, shared_atlas);
+      current_batch = entry.batch;
+      copied = true;
+    }
 
-      if (params.bottom.anchor_id == 0) {
-        b.bottom = b.top + child_dims.y;
-      }
+    quad_end = entry.quad + 1;
+  }
+
+  DrawQuads(quad_start, quad_end);
+  FlushText();
+}
+
+void UIGroup::SetTextBatching(bool enabled) {
+  text_batching_ = enabled;
+}
+
+void UIGroup::FlushText() {
+  if (!text_batch_.IsEmpty()) {
+    text_batch_.Flush();
+  }
+}
+
+void UIGroup::CopyToAtlas(size_t batch, bool force) {
+  for (auto& entry : batch_) {
+    if (entry.batch != batch || !entry.visible || entry.direct) {
+      continue;
     }
 
-    if (params.bottom.anchor_id != 0) {
-      const layout::BoundingBox& box = bounding_boxes.at(params.bottom.anchor_id);
-      switch (params.bottom.anchor_face) {
-        case Face::BOTTOM:
-          b.bottom = box.bottom;
-          break;
-        case Face::TOP:
-          b.bottom = box.top;
-          break;
-        default:
-          BOOST_LOG_TRIVIAL(error) << "Invalid face provided for ID " << id << "'s bottom margin -- ignoring...";
-      }
+    GLuint color = entry.child->GetFramebufferColor();
+    if (color == 0) {
+      // child hasn't drawn anything yet
+      continue;
+    }
 
-      if (params.top.anchor_id == 0) {
-        b.top = b.bottom - child_dims.y;
-      }
+    if (force || !entry.copied || entry.copied_count != entry.child->draw_count_) {
+      glCopyImageSubData(color, GL_TEXTURE_2D, 0, 0, 0, 0,
+                         atlas_, GL_TEXTURE_2D, 0, entry.atlas_pos.x, entry.atlas_pos.y, 0,
+                         entry.size.x, entry.size.y, 1);
+      entry.copied = true;
+      entry.copied_count = entry.child->draw_count_;
     }
+  }
+}
 
-    // left/right
-    if (params.left.anchor_id != 0) {
-      const layout::BoundingBox& box = bounding_boxes.at(params.left.anchor_id);
-      switch (params.left.anchor_face) {
-        case Face::LEFT:
-          b.left = box.left;
-          break;
-        case Face::RIGHT:
-          b.left = box.right;
-          break;
-        default:
-          BOOST_LOG_TRIVIAL(error) << "Invalid face provided for ID " << id << "'s left margin -- ignoring...";
-      }
+void UIGroup::DrawQuads(size_t start, size_t end) {
+  // batched text came before these quads
+  FlushText();
+  if (end <= start) {
+    return;
+  }
 
-      if (params.right.anchor_id == 0) {
-        b.right = b.left + child_dims.x;
-      }
+  mesh_.PointToVertexAttribs();
+  mat_.SetTexture(atlas_);
+  if (!mat_.UseMaterial()) {
+    return;
+  }
+
+  glDrawElements(GL_TRIANGLES, static_cast<int>(6 * (end - start)), GL_UNSIGNED_INT, (void*)(6 * start * sizeof(GLuint)));
+}
+
+void UIGroup::DrawDirect(batch_entry& entry, glm::vec2 min, glm::vec2 max, shader::Canvas canvas) {
+  // only draw the part of the child which falls inside the damaged region
+  glm::ivec2 clip_min = glm::max(entry.pos, static_cast<glm::ivec2>(min));
+  glm::ivec2 clip_max = glm::min(entry.pos + entry.size, static_cast<glm::ivec2>(max));
+  if (clip_min.x >= clip_max.x || clip_min.y >= clip_max.y) {
+    return;
+  }
+
+  glm::ivec2 dims = static_cast<glm::ivec2>(GetDimensions());
+  if (text_batching_) {
+    // map the child's clip space, and the region it may draw to, into ours. y is flipped -- clip space points up.
+    glm::vec2 group_dims(dims);
+    glm::vec2 pos(entry.pos);
+    glm::vec2 size(entry.size);
+    glm::vec2 scale = size / group_dims;
+    glm::vec2 offset((2.0f * pos.x + size.x) / group_dims.x - 1.0f, 1.0f - (2.0f * pos.y + size.y) / group_dims.y);
+    glm::vec2 clip_lo(2.0f * clip_min.x / group_dims.x - 1.0f, 1.0f - 2.0f * clip_max.y / group_dims.y);
+    glm::vec2 clip_hi(2.0f * clip_max.x / group_dims.x - 1.0f, 1.0f - 2.0f * clip_min.y / group_dims.y);
+    if (entry.child->DrawBatched(text_batch_, scale, offset, clip_lo, clip_hi)) {
+      entry.child->draw_count_++;
+      return;
     }
+  }
 
-    if (params.right.anchor_id != 0) {
-      const layout::BoundingBox& box = bounding_boxes.at(params.right.anchor_id);
-      switch (params.right.anchor_face) {
-        case Face::LEFT:
-          b.right = box.left;
-          break;
-        case Face::RIGHT:
-          b.right = box.right;
-          break;
-        default:
-          BOOST_LOG_TRIVIAL(error) << "Invalid face provided for ID " << id << "'s right margin -- ignoring...";
-      }
+  // anything else draws now, on top of the text before it
+  FlushText();
 
-      if (params.left.anchor_id == 0) {
-        b.left = b.right - child_dims.x;
-      }
+  // point the viewport at the child, so its clip space lines up with the region it covers.
+  // gl origin is bottom left.
+  glViewport(entry.pos.x, dims.y - entry.pos.y - entry.size.y, entry.size.x, entry.size.y);
+  glScissor(clip_min.x, dims.y - clip_max.y, clip_max.x - clip_min.x, clip_max.y - clip_min.y);
+  entry.child->DrawUI(static_cast<glm::vec2>(clip_min - entry.pos), static_cast<glm::vec2>(clip_max - entry.pos), canvas);
+  entry.child->draw_count_++;
+
+  glm::ivec2 damage_min = static_cast<glm::ivec2>(min);
+  glm::ivec2 damage_max = static_cast<glm::ivec2>(max);
+  glViewport(0, 0, dims.x, dims.y);
+  glScissor(damage_min.x, dims.y - damage_max.y, damage_max.x - damage_min.x, damage_max.y - damage_min.y);
+}
+
+bool UIGroup::IsBatchStale() {
+  if (batch_dirty_ || batch_.size() != children_.size() || batch_dims_ != static_cast<glm::ivec2>(GetDimensions())) {
+    return true;
+  }
+
+  for (size_t i = 0; i < children_.size(); i++) {
+    const batch_entry& entry = batch_[i];
+    const child_ptr& child = children_[i];
+    if (   entry.child != child
+        || entry.z_index != child->z_index
+        || entry.pos != static_cast<glm::ivec2>(child->GetPosition())
+        || entry.size != static_cast<glm::ivec2>(child->GetDimensions())
+        || entry.opacity != child->GetOpacity()
+        || entry.direct != child->IsDrawnDirect()) {
+      return true;
     }
+  }
 
-    // handle autos
-    if (params.top.margin.type == MarginType::AUTO || params.bottom.margin.type == MarginType::AUTO) {
-      // total range
-      float y_range = b.bottom - b.top;
-      // margin shrink on both sides
-      float y_squeeze = (y_range - child_dims.y) / 2;
-      b.top += y_squeeze;
-      b.bottom -= y_squeeze;
-    } else {
-      if (params.top.anchor_id != 0) {
-        b.top += params.top.margin.dist;
-        if (params.bottom.anchor_id == 0) {
-          b.bottom += params.top.margin.dist;
-        }
+  return false;
+}
+
+void UIGroup::RebuildBatch() {
+  // maintain sorted z-index order for children
+  // stable, so that children with equal z-indices don't swap places between rebuilds
+  std::stable_sort(children_.begin(), children_.end(), [&](const child_ptr& a, const child_ptr& b) {
+    return (a->z_index > b->z_index);
+  });
+
+  glm::ivec2 group_dims = static_cast<glm::ivec2>(GetDimensions());
+  std::vector<batch_entry> old_batch;
+  old_batch.swap(batch_);
+  for (auto& child : children_) {
+    batch_entry entry;
+    entry.child = child;
+    entry.z_index = child->z_index;
+    entry.pos = static_cast<glm::ivec2>(child->GetPosition());
+    entry.size = static_cast<glm::ivec2>(child->GetDimensions());
+    entry.opacity = child->GetOpacity();
+    entry.direct = child->IsDrawnDirect();
+    entry.atlas_pos = glm::ivec2(0);
+    entry.batch = 0;
+    entry.quad = 0;
+    entry.copied_count = 0;
+    entry.copied = false;
+    glm::ivec2 max_coord = entry.pos + entry.size;
+    entry.visible = !(entry.pos.x > group_dims.x || entry.pos.y > group_dims.y || max_coord.x < 0 || max_coord.y < 0
+                      || entry.size.x <= 0 || entry.size.y <= 0);
+    batch_.push_back(entry);
+  }
+
+  // pack visible children into the atlas, growing it until everything fits in one draw.
+  // once it can't grow any further, spill over into extra draws.
+  bool needs_atlas = false;
+  for (auto& entry : batch_) {
+    needs_atlas = needs_atlas || (entry.visible && !entry.direct);
+  }
+
+  glm::ivec2 dims = (atlas_size_.x > 0 ? atlas_size_ : glm::ivec2(256));
+  dims = glm::min(dims, glm::ivec2(max_atlas_size_));
+  atlas_batches_ = 0;
+  while (needs_atlas) {
+    packer_.SetDimensions(dims);
+    bool can_grow = (dims.x < max_atlas_size_ || dims.y < max_atlas_size_);
+    bool fits = true;
+    size_t batch = 0;
+    for (auto& entry : batch_) {
+      if (!entry.visible || entry.direct) {
+        // direct children draw themselves, and don't need a spot in the atlas
+        continue;
       }
 
-      if (params.bottom.anchor_id != 0) {
-        b.bottom -= params.bottom.margin.dist;
-        if (params.top.anchor_id == 0) {
-          b.top -= params.bottom.margin.dist;
+      if (!packer_.Pack(entry.size, &entry.atlas_pos)) {
+        if (can_grow) {
+          fits = false;
+          break;
+        }
+
+        batch++;
+        packer_.Clear();
+        if (!packer_.Pack(entry.size, &entry.atlas_pos)) {
+          BOOST_LOG_TRIVIAL(error) << "UIObject ID " << entry.child->GetId() << " is too large to draw!";
+          entry.visible = false;
+          continue;
         }
       }
+
+      entry.batch = batch;
     }
 
-    // BOOST_LOG_TRIVIAL(trace) << b.top << ", " << b.bottom << ", " << b.left << ", " << b.right;
+    if (fits) {
+      atlas_batches_ = batch + 1;
+      break;
+    }
 
-    if (params.left.margin.type == MarginType::AUTO || params.right.margin.type == MarginType::AUTO) {
-      float x_range = b.right - b.left;
-      float x_squeeze = (x_range - child_dims.x) / 2;
-      b.left += x_squeeze;
-      b.right -= x_squeeze;
+    // grow the shorter side, so the atlas stays roughly square
+    if (dims.x <= dims.y && dims.x < max_atlas_size_) {
+      dims.x = std::min(dims.x * 2, static_cast<int>(max_atlas_size_));
     } else {
-      if (params.left.anchor_id != 0) {
-        b.left += params.left.margin.dist;
-        if (params.right.anchor_id == 0) {
-          b.right += params.left.margin.dist;
-        }
-      }
+      dims.y = std::min(dims.y * 2, static_cast<int>(max_atlas_size_));
+    }
+  }
 
-      if (params.right.anchor_id != 0) {
-        b.right -= params.right.margin.dist;
-        if (params.left.anchor_id == 0) {
-          b.left -= params.right.margin.dist;
+  // if everything is direct or offscreen, don't bother allocating an atlas
+  if (atlas_batches_ > 0 && dims != atlas_size_) {
+    ResizeAtlas(dims);
+  } else if (atlas_batches_ == 1) {
+    // children which kept their spot in the atlas don't need to be copied again
+    for (auto& entry : batch_) {
+      for (auto& old_entry : old_batch) {
+        if (old_entry.child == entry.child) {
+          if (old_entry.copied && old_entry.batch == 0 && old_entry.atlas_pos == entry.atlas_pos && old_entry.size == entry.size) {
+            entry.copied = true;
+            entry.copied_count = old_entry.copied_count;
+          }
+
+          break;
         }
       }
     }
-
-    b.top = std::round(b.top);
-    b.bottom = std::round(b.bottom);
-    b.left = std::round(b.left);
-    b.right = std::round(b.right);
-    bounding_boxes.insert(std::make_pair(id, b));
-    // BOOST_LOG_TRIVIAL(trace) << b.top << ", " << b.bottom << ", " << b.left << ", " << b.right;
-  }
-
-  // once this has run for all components, our bounding boxes are defined for every component.
-  // now we can lay them out!
-  for (const auto& e : bounding_boxes) {
-    auto child = std::dynamic_pointer_cast<UIObject>(GetChild(e.first));
-    auto bb = e.second;
-    child->SetPosition(glm::vec2(bb.left, bb.top));
-    child->SetDimensions(glm::vec2(bb.right - bb.left, bb.bottom - bb.top));
   }
-}
 
-void UIGroup::DrawUI(glm::vec2 min, glm::vec2 max, shader::Canvas canvas) {
-  // note: framebuffer is bound if this is being called
-  // plus, all of its children have already been drawn
-  glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &max_textures_);
   UIGroupPacket p;
-  std::shared_ptr<UIObject> child;
-  glm::vec2 group_dims = GetDimensions();
-  GLuint textures[4];
-  float opacities[4];
-  int current_child = 0;
-  int index = 0;
+  glm::vec2 atlas_dims = static_cast<glm::vec2>(atlas_size_);
+  glm::vec2 dims_group = static_cast<glm::vec2>(group_dims);
+  unsigned int index = 0;
   mesh_.Clear();
-  
-  // maintain sorted z-index order for children+
-  std::sort(children_.begin(), children_.end(), [&](child_ptr a, child_ptr b) {
-    return (a->z_index > b->z_index);
-  });
-  
-  while (current_child < children_.size()) {
-    // add shit to our mesh as we go
-    // once we hit 4: draw it
-    // if we're done, and index > 0: draw it
-    child = children_[current_child];
-    glm::vec2 min_coord = child->GetPosition();
-    glm::vec2 max_coord = min_coord + child->GetDimensions();
-    if (min_coord.x > group_dims.x || min_coord.y > group_dims.y || max_coord.x < 0 || max_coord.y < 0) {
-      current_child++;
+  for (auto& entry : batch_) {
+    if (!entry.visible || entry.direct) {
       continue;
     }
 
-    textures[index] = child->GetFramebufferColor();
-    opacities[index] = child->GetOpacity();
-    p.index = static_cast<float>(index);
-
-    glm::vec2 pos = child->GetPosition();
-    glm::vec2 dims = GetDimensions();
-
-    auto dims_child = child->GetDimensions();
+    entry.quad = index;
+    glm::vec2 pos = static_cast<glm::vec2>(entry.pos);
+    glm::vec2 dims_child = static_cast<glm::vec2>(entry.size);
+    glm::vec2 tex_min = glm::vec2(entry.atlas_pos) / atlas_dims;
+    glm::vec2 tex_max = glm::vec2(entry.atlas_pos + entry.size) / atlas_dims;
+    p.opacity = entry.opacity;
 
     // top left
-    p.pos.x = (pos.x / dims.x) * 2 - 1;
-    p.pos.y = 1 - (pos.y / dims.y) * 2;
-
-
-    p.texcoord = glm::vec2(0, 1);
+    p.pos.x = (pos.x / dims_group.x) * 2 - 1;
+    p.pos.y = 1 - (pos.y / dims_group.y) * 2;
+    p.texcoord = glm::vec2(tex_min.x, tex_max.y);
     mesh_.AddVertex(p);
 
     // bottom left
-    p.pos.y -= (dims_child.y / dims.y) * 2;
-    p.texcoord = glm::vec2(0, 0);
+    p.pos.y -= (dims_child.y / dims_group.y) * 2;
+    p.texcoord = tex_min;
     mesh_.AddVertex(p);
 
     // bottom right
-    p.pos.x += (dims_child.x / dims.x) * 2;
-    p.texcoord = glm::vec2(1, 0);
+    p.pos.x += (dims_child.x / dims_group.x) * 2;
+    p.texcoord = glm::vec2(tex_max.x, tex_min.y);
     mesh_.AddVertex(p);
 
     // top right
-    p.pos.y += (dims_child.y / dims.y) * 2;
-    p.texcoord = glm::vec2(1, 1);
+    p.pos.y += (dims_child.y / dims_group.y) * 2;
+    p.texcoord = tex_max;
     mesh_.AddVertex(p);
 
     mesh_.AddPolygon(4 * index, 4 * index + 1, 4 * index + 2);
     mesh_.AddPolygon(4 * index, 4 * index + 2, 4 * index + 3);
-
-    current_child++;
     index++;
+  }
 
-    if (index == 4) {
-      mat_.SetTextures(textures);
-      mat_.SetOpacity(opacities);
-      mesh_.PointToVertexAttribs();
-      mat_.UseMaterial();
-      glDrawElements(GL_TRIANGLES, static_cast<int>(mesh_.GetIndexCount()), GL_UNSIGNED_INT, (void*)0);
-      mesh_.Clear();
-      index = 0;
-    }
+  batch_dims_ = group_dims;
+  batch_dirty_ = false;
+}
+
+void UIGroup::ResizeAtlas(glm::ivec2 size) {
+  if (atlas_ == 0) {
+    glGenTextures(1, &atlas_);
   }
 
-  if (index > 0) {
-    mat_.SetTextures(textures);
-    mat_.SetOpacity(opacities);
-    mesh_.PointToVertexAttribs();
-    mat_.UseMaterial();
-    glDrawElements(GL_TRIANGLES, static_cast<int>(mesh_.GetIndexCount()), GL_UNSIGNED_INT, (void*)0);
+  // clear it out, so children which haven't drawn yet show up as empty
+  std::vector<uint8_t> blank(static_cast<size_t>(size.x) * size.y * 4, 0);
+  glBindTexture(GL_TEXTURE_2D, atlas_);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size.x, size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, blank.data());
+  // children are drawn 1:1, so there's nothing to filter
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  atlas_size_ = size;
+
+  for (auto& entry : batch_) {
+    entry.copied = false;
+  }
+}
+
+UIGroup::~UIGroup() {
+  if (atlas_ != 0) {
+    if (!glfwGetCurrentContext()) {
+      BOOST_LOG_TRIVIAL(error) << "could not delete UI atlas!";
+    } else {
+      glDeleteTextures(1, &atlas_);
+    }
   }
 }
 
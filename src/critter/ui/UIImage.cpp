@@ -9,10 +9,11 @@ UIImage::UIImage(engine::Context* ctx, const std::string& image_path) : UIObject
 }
 
 void UIImage::DrawUI(glm::vec2, glm::vec2, shader::Canvas canvas) {
+  // drawn opaque -- our opacity is applied once, when we're composited onto our parent
   mat_.SetTexture(tex_->GetTextureDescriptor());
-  mat_.SetOpacity(GetOpacity());
-  mat_.UseMaterial();
-  DrawFullscreenQuad();
+  if (mat_.UseMaterial()) {
+    DrawFullscreenQuad();
+  }
 }
 
 }
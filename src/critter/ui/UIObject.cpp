@@ -6,6 +6,7 @@ namespace ui {
 
 using shader::materials::TextureXferMaterial;
 using shader::Framebuffer;
+using shader::FramebufferPool;
 using shader::FramebufferTarget;
 using shader::Canvas;
 
@@ -17,10 +18,13 @@ model::Mesh<storage::VertexPacket2D> UIObject::xfer_mesh_;
 UIObject::UIObject(engine::Context* ctx) : Object(ctx) {
   pos_ = glm::vec2(0, 0);
   size_ = glm::vec2(1, 1);
-  fb_ = std::make_shared<Framebuffer>();
+  // ui elements are resized constantly -- borrow from the pool so that doesn't churn GL objects
+  fb_ = std::make_shared<Framebuffer>(&FramebufferPool::GetInstance());
   opacity_ = 1.0f;
+  draw_count_ = 0;
 
   valid_ = true;
+  damage_min_ = damage_max_ = glm::ivec2(0);
   parent_ = std::weak_ptr<UIObject>();
   z_index = 0;
 
@@ -87,7 +91,13 @@ glm::vec2 UIObject::GetPosition() const {
 }
 
 void UIObject::SetPosition(glm::vec2 pos) {
-  pos_ = static_cast<glm::ivec2>(glm::round(pos));
+  glm::ivec2 new_pos = static_cast<glm::ivec2>(glm::round(pos));
+  if (new_pos != pos_) {
+    // parent needs to recomposite where we were, and where we are now
+    InvalidateParent();
+    pos_ = new_pos;
+    InvalidateParent();
+  }
 }
 
 glm::vec2 UIObject::GetAbsolutePosition() const {
@@ -103,7 +113,12 @@ glm::vec2 UIObject::GetDimensions() const {
 }
 
 void UIObject::SetDimensions(glm::vec2 size) {
-  size_ = static_cast<glm::ivec2>(size);
+  glm::ivec2 new_size = static_cast<glm::ivec2>(size);
+  if (new_size != size_) {
+    InvalidateParent();
+  }
+
+  size_ = new_size;
   if (fb_->GetDimensions() != size_) {
     fb_->SetDimensions(size_);
     // new size requires a redraw
@@ -123,8 +138,16 @@ void UIObject::SetOpacity(float opac) {
   }
 
   if (opacity != opacity_) {
+    bool was_direct = IsDrawnDirect();
     opacity_ = opacity;
-    Invalidate();
+    if (was_direct != IsDrawnDirect()) {
+      // moving between our own framebuffer and our parent's -- draw from scratch
+      Invalidate();
+      InvalidateParent();
+    } else {
+      // our contents haven't changed -- only the way they're composited
+      InvalidateParent();
+    }
   }
 }
 
@@ -141,17 +164,60 @@ void UIObject::SetLayoutParams(const layout::UILayoutParams& params) {
 }
 
 void UIObject::Invalidate() {
-  valid_.store(false);
+  Invalidate(glm::vec2(0), GetDimensions());
+}
+
+void UIObject::Invalidate(glm::vec2 minXY, glm::vec2 maxXY) {
+  glm::ivec2 size = size_;
+  glm::ivec2 min = glm::clamp(static_cast<glm::ivec2>(glm::floor(minXY)), glm::ivec2(0), size);
+  glm::ivec2 max = glm::clamp(static_cast<glm::ivec2>(glm::ceil(maxXY)), glm::ivec2(0), size);
+  if (min.x >= max.x || min.y >= max.y) {
+    return;
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(damage_lock_);
+    if (valid_) {
+      damage_min_ = min;
+      damage_max_ = max;
+    } else if (   min.x >= damage_min_.x && min.y >= damage_min_.y
+               && max.x <= damage_max_.x && max.y <= damage_max_.y) {
+      // already covered -- and our parent already knows about it
+      return;
+    } else {
+      damage_min_ = glm::min(damage_min_, min);
+      damage_max_ = glm::max(damage_max_, max);
+    }
+
+    valid_.store(false);
+  }
+
+  // our parent has to recomposite wherever we changed
+  if (auto parent = parent_.lock()) {
+    glm::ivec2 pos = pos_;
+    parent->Invalidate(glm::vec2(pos + min), glm::vec2(pos + max));
+  }
+}
+
+void UIObject::InvalidateParent() {
+  if (auto parent = parent_.lock()) {
+    glm::vec2 pos = GetPosition();
+    parent->Invalidate(pos, pos + GetDimensions());
+  }
 }
 
 void UIObject::RenderMaterial(const engine::RenderContext& rc) {
-  if (!IsValid()) {
-    // at least one child is invalid
-    // get invalid binding box (while invalidity still applies)
+  if (!IsValid() && IsDrawnDirect()) {
+    // our parent draws us, in whatever region we've damaged on it
+    glm::vec2 min, max;
+    GetInvalidatedBoundingBox(&min, &max);
+  } else if (!IsValid()) {
+    // get invalid binding box, and mark ourselves as valid again.
+    // anything invalidated while we draw will be picked up next frame.
     glm::vec2 min, max;
     GetInvalidatedBoundingBox(&min, &max);
     
-    // render all children first (bottom up rendering)
+    // render invalid children first (bottom up rendering) -- valid ones return immediately
     for (auto child : GetChildren()) {
       auto ui = std::static_pointer_cast<UIObject>(child);
       ui->RenderMaterial(rc);
@@ -160,6 +226,11 @@ void UIObject::RenderMaterial(const engine::RenderContext& rc) {
     fb_->BindFramebuffer(FramebufferTarget::DEFAULT);
     auto size = fb_->GetDimensions();
     glViewport(0, 0, static_cast<uint32_t>(size.x), static_cast<uint32_t>(size.y));
+
+    // only touch the damaged part of the framebuffer (scissor origin is bottom left)
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(static_cast<GLint>(min.x), static_cast<GLint>(size.y - max.y),
+              static_cast<GLsizei>(max.x - min.x), static_cast<GLsizei>(max.y - min.y));
     
     #ifdef DEBUG
       glClearColor(1.0f, 0.0f, 0.0f, 0.2f);
@@ -169,7 +240,8 @@ void UIObject::RenderMaterial(const engine::RenderContext& rc) {
     
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
     DrawUI(min, max, Canvas(fb_));
-    valid_.store(true);
+    glDisable(GL_SCISSOR_TEST);
+    draw_count_++;
   }
 }
 
@@ -195,8 +267,6 @@ void UIObject::DrawToScreen() {
   if (xfer_mesh_.GetVertexCount() == 0) {
     // this will be our sign that the mesh has been prepared
     for (int i = 0; i < 4; i++) {
-      temp.texcoords.x = static_cast<float>(i >= 2 ? 1 : 0);
-      temp.texcoords.y = static_cast<float>(i > 0 && i < 3 ? 0 : 1);
       xfer_mesh_.AddVertex(temp);
     }
 
@@ -204,6 +274,13 @@ void UIObject::DrawToScreen() {
     xfer_mesh_.AddPolygon(0, 2, 3);
   }
 
+  // pooled framebuffers can be larger than we are -- only read the part we drew to
+  glm::vec2 tex_max = glm::vec2(fb_->GetDimensions()) / glm::vec2(fb_->GetAllocatedDimensions());
+  for (int i = 0; i < 4; i++) {
+    xfer_mesh_[i].texcoords.x = (i >= 2 ? tex_max.x : 0.0f);
+    xfer_mesh_[i].texcoords.y = (i > 0 && i < 3 ? 0.0f : tex_max.y);
+  }
+
   glm::ivec2 win;
   GetContext()->GetFramebufferSize(&win.x, &win.y);
 
@@ -226,10 +303,17 @@ void UIObject::DrawToScreen() {
   xfer_mesh_.PointToVertexAttribs();
   xfer_mat_->SetTexture(GetFramebufferColor());
   xfer_mat_->SetOpacity(opacity_);
-  xfer_mat_->UseMaterial();
+  if (!xfer_mat_->UseMaterial()) {
+    return;
+  }
+
   glDrawElements(GL_TRIANGLES, static_cast<uint32_t>(xfer_mesh_.GetIndexCount()), GL_UNSIGNED_INT, (void*)0);
 }
 
+bool UIObject::IsDrawnDirect() {
+  return (opacity_ >= 1.0f && SupportsDirectDraw() && !parent_.expired() && GetChildren().empty());
+}
+
 GLuint UIObject::GetFramebufferColor() {
   return fb_->GetColorAttachment();
 }
@@ -243,58 +327,21 @@ GLuint UIObject::GetFramebuffer() {
 }
 
 bool UIObject::IsValid() {
-  if (valid_) {
-    for (auto child : GetChildren()) {
-      auto ui = std::static_pointer_cast<UIObject>(child);
-      if (!ui->IsValid()) {
-        return false;
-      }
-    }
-
-    // all children are still valid
-    return true;
-  }
-
-  // this uiobject is invalid regardless
-  return false;
+  // invalidations propagate upwards, so if we're valid, so is everything below us
+  return valid_.load();
 }
 
 void UIObject::GetInvalidatedBoundingBox(glm::vec2* xyMin, glm::vec2* xyMax) {
-  if (!valid_) {
-    // invalidate entire screen
+  std::unique_lock<std::mutex> lock(damage_lock_);
+  if (valid_) {
     *xyMin = glm::vec2(0);
-    *xyMax = GetDimensions();
-    return;
-  } else {
-    glm::vec2 min;
-    glm::vec2 max;
-    bool set = false;
-    for (auto child : GetChildren()) {
-      auto ui = std::static_pointer_cast<UIObject>(child);
-      if (!ui->IsValid()) {
-        // the first child defines the region
-        if (!set) {
-          set = true;
-          min = ui->GetPosition();
-          max = min + ui->GetDimensions();
-        } else {
-          min = glm::min(min, ui->GetPosition());
-          max = glm::max(max, ui->GetDimensions() + ui->GetPosition());
-          }
-        }
-    }
-
-    if (!set) {
-      // all children were valid -- no need to draw
-      *xyMin = glm::vec2(0);
-      *xyMax = glm::vec2(0);
-      return;
-    }
-
-    *xyMin = min;
-    *xyMax = max;
+    *xyMax = glm::vec2(0);
     return;
   }
+
+  *xyMin = damage_min_;
+  *xyMax = damage_max_;
+  valid_.store(true);
 }
 
 UIObject::UIObject(const UIObject& other) : Object(other) {
@@ -302,6 +349,9 @@ UIObject::UIObject(const UIObject& other) : Object(other) {
   size_ = other.size_;
 
   valid_ = false;
+  damage_min_ = glm::ivec2(0);
+  damage_max_ = size_;
+  draw_count_ = 0;
   parent_ = std::weak_ptr<UIObject>();
 }
 
@@ -310,6 +360,9 @@ UIObject& UIObject::operator=(const UIObject& other) {
   pos_ = other.pos_;
   size_ = other.size_;
   valid_ = false;
+  damage_min_ = glm::ivec2(0);
+  damage_max_ = size_;
+  draw_count_ = 0;
   return *this;
 }
 
@@ -318,6 +371,9 @@ UIObject::UIObject(UIObject&& other) : Object(other) {
   size_ = std::move(other.size_);
 
   valid_ = other.valid_.load();
+  damage_min_ = other.damage_min_;
+  damage_max_ = other.damage_max_;
+  draw_count_ = other.draw_count_;
   parent_ = std::weak_ptr<UIObject>();
 }
 
@@ -327,6 +383,9 @@ UIObject& UIObject::operator=(UIObject&& other) {
   size_ = std::move(other.size_);
 
   valid_ = other.valid_.load();
+  damage_min_ = other.damage_min_;
+  damage_max_ = other.damage_max_;
+  draw_count_ = other.draw_count_;
   parent_ = std::weak_ptr<UIObject>();
 
   return *this;
@@ -0,0 +1,362 @@
+#include <critter/ui/layout/LayoutGraph.hpp>
+
+#include <boost/log/trivial.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace monkeysworld {
+namespace critter {
+namespace ui {
+namespace layout {
+
+const uint32_t LayoutGraph::NO_ANCHOR;
+
+static bool SameMargin(const Margin& a, const Margin& b) {
+  return (a.anchor_id == b.anchor_id && a.anchor_face == b.anchor_face
+       && a.margin.type == b.margin.type && a.margin.dist == b.margin.dist);
+}
+
+static bool SameBox(const BoundingBox& a, const BoundingBox& b) {
+  return (a.left == b.left && a.right == b.right && a.top == b.top && a.bottom == b.bottom);
+}
+
+LayoutGraph::LayoutGraph() {
+  group_id_ = 0;
+  order_dirty_ = true;
+  valid_ = true;
+  boxes_.resize(1);
+  boxes_[0] = { 0, 0, 0, 0 };
+}
+
+void LayoutGraph::SetNodes(uint64_t group_id, const std::vector<uint64_t>& ids) {
+  BoundingBox group = boxes_.back();
+  size_t n = ids.size();
+  group_id_ = group_id;
+  ids_ = ids;
+  params_.assign(n, UILayoutParams());
+  pos_.assign(n, glm::vec2(0));
+  dims_.assign(n, glm::vec2(0));
+  boxes_.assign(n + 1, group);
+  dirty_.assign(n, 1);
+  changed_.clear();
+  order_dirty_ = true;
+}
+
+void LayoutGraph::SetGroupDimensions(glm::vec2 dims) {
+  BoundingBox b;
+  b.left = 0;
+  b.right = dims.x;
+  b.top = 0;
+  b.bottom = dims.y;
+  BoundingBox& group = boxes_.back();
+  if (SameBox(b, group)) {
+    return;
+  }
+
+  group = b;
+  if (!order_dirty_) {
+    uint32_t group_index = static_cast<uint32_t>(ids_.size());
+    for (uint32_t i = dependent_start_[group_index]; i < dependent_start_[group_index + 1]; i++) {
+      dirty_[dependents_[i]] = 1;
+    }
+  }
+}
+
+void LayoutGraph::SetNode(size_t index, const UILayoutParams& params, glm::vec2 pos, glm::vec2 dims) {
+  const UILayoutParams& old = params_[index];
+  if (   old.top.anchor_id != params.top.anchor_id
+      || old.bottom.anchor_id != params.bottom.anchor_id
+      || old.left.anchor_id != params.left.anchor_id
+      || old.right.anchor_id != params.right.anchor_id) {
+    // edges changed
+    order_dirty_ = true;
+  } else if (   pos == pos_[index] && dims == dims_[index]
+             && SameMargin(old.top, params.top) && SameMargin(old.bottom, params.bottom)
+             && SameMargin(old.left, params.left) && SameMargin(old.right, params.right)) {
+    return;
+  }
+
+  params_[index] = params;
+  pos_[index] = pos;
+  dims_[index] = dims;
+  dirty_[index] = 1;
+}
+
+int LayoutGraph::Solve() {
+  changed_.clear();
+  if (order_dirty_) {
+    valid_ = RebuildOrder();
+    order_dirty_ = false;
+    std::fill(dirty_.begin(), dirty_.end(), 1);
+  }
+
+  if (!valid_) {
+    return -1;
+  }
+
+  int solved = 0;
+  for (uint32_t index : order_) {
+    if (!dirty_[index]) {
+      continue;
+    }
+
+    dirty_[index] = 0;
+    solved++;
+    BoundingBox b = SolveNode(index);
+    if (!SameBox(b, boxes_[index])) {
+      // anything anchored to us was solved against the old box
+      boxes_[index] = b;
+      for (uint32_t i = dependent_start_[index]; i < dependent_start_[index + 1]; i++) {
+        dirty_[dependents_[i]] = 1;
+      }
+    }
+
+    // solving a node against its own result gives the same result, so once the caller
+    // applies it, passing it back through SetNode won't dirty the node again.
+    glm::vec2 pos = glm::vec2(b.left, b.top);
+    glm::vec2 dims = glm::vec2(b.right - b.left, b.bottom - b.top);
+    if (pos != pos_[index] || dims != dims_[index]) {
+      pos_[index] = pos;
+      dims_[index] = dims;
+      changed_.push_back(index);
+    }
+  }
+
+  return solved;
+}
+
+const std::vector<size_t>& LayoutGraph::GetChangedNodes() const {
+  return changed_;
+}
+
+const BoundingBox& LayoutGraph::GetBoundingBox(size_t index) const {
+  return boxes_[index];
+}
+
+size_t LayoutGraph::GetNodeCount() const {
+  return ids_.size();
+}
+
+bool LayoutGraph::RebuildOrder() {
+  uint32_t n = static_cast<uint32_t>(ids_.size());
+  index_.clear();
+  for (uint32_t i = 0; i < n; i++) {
+    index_[ids_[i]] = i;
+  }
+
+  // resolve anchors, and count the dependents of each node
+  anchors_.assign(4 * n, NO_ANCHOR);
+  dependent_start_.assign(n + 2, 0);
+  std::vector<uint32_t> in_degree(n, 0);
+  for (uint32_t i = 0; i < n; i++) {
+    const Margin* margins[4] = { &params_[i].top, &params_[i].bottom, &params_[i].left, &params_[i].right };
+    for (int m = 0; m < 4; m++) {
+      uint64_t id = margins[m]->anchor_id;
+      uint32_t anchor = NO_ANCHOR;
+      if (id == group_id_) {
+        anchor = n;
+      } else if (id != 0) {
+        auto itr = index_.find(id);
+        if (itr == index_.end()) {
+          BOOST_LOG_TRIVIAL(error) << "current layout invalid -- child with ID " << id << " not found in UIObject ID " << group_id_ << "!";
+          return false;
+        }
+
+        anchor = itr->second;
+        in_degree[i]++;
+      }
+
+      anchors_[4 * i + m] = anchor;
+      if (anchor != NO_ANCHOR) {
+        dependent_start_[anchor + 1]++;
+      }
+    }
+  }
+
+  for (uint32_t i = 0; i < n + 1; i++) {
+    dependent_start_[i + 1] += dependent_start_[i];
+  }
+
+  dependents_.resize(dependent_start_[n + 1]);
+  std::vector<uint32_t> cursor(dependent_start_.begin(), dependent_start_.end() - 1);
+  for (uint32_t i = 0; i < n; i++) {
+    for (int m = 0; m < 4; m++) {
+      uint32_t anchor = anchors_[4 * i + m];
+      if (anchor != NO_ANCHOR) {
+        dependents_[cursor[anchor]++] = i;
+      }
+    }
+  }
+
+  // kahn's algorithm -- order_ doubles as the queue
+  order_.clear();
+  order_.reserve(n);
+  for (uint32_t i = 0; i < n; i++) {
+    if (in_degree[i] == 0) {
+      order_.push_back(i);
+    }
+  }
+
+  for (size_t head = 0; head < order_.size(); head++) {
+    uint32_t node = order_[head];
+    for (uint32_t i = dependent_start_[node]; i < dependent_start_[node + 1]; i++) {
+      if (--in_degree[dependents_[i]] == 0) {
+        order_.push_back(dependents_[i]);
+      }
+    }
+  }
+
+  if (order_.size() != n) {
+    BOOST_LOG_TRIVIAL(error) << "current layout invalid -- anchors in UIObject ID " << group_id_ << " form a cycle!";
+    return false;
+  }
+
+  return true;
+}
+
+BoundingBox LayoutGraph::SolveNode(uint32_t index) const {
+  const UILayoutParams& params = params_[index];
+  const uint32_t* anchors = &anchors_[4 * index];
+  uint64_t id = ids_[index];
+  glm::vec2 child_dims = dims_[index];
+  glm::vec2 child_pos = pos_[index];
+
+  // insert default values
+  BoundingBox b;
+  b.top = child_pos.y;
+  b.left = child_pos.x;
+  b.bottom = b.top + child_dims.y;
+  b.right = b.left + child_dims.x;
+
+  // top/bottom
+  if (anchors[0] != NO_ANCHOR) {
+    const BoundingBox& box = boxes_[anchors[0]];
+    switch (params.top.anchor_face) {
+      case Face::BOTTOM:
+        b.top = box.bottom;
+        break;
+      case Face::TOP:
+        b.top = box.top;
+        break;
+      default:
+        BOOST_LOG_TRIVIAL(error) << "Invalid face provided for ID " << id << "'s top margin -- ignoring...";
+      // all others are invalid
+    }
+
+    if (anchors[1] == NO_ANCHOR) {
+      b.bottom = b.top + child_dims.y;
+    }
+  }
+
+  if (anchors[1] != NO_ANCHOR) {
+    const BoundingBox& box = boxes_[anchors[1]];
+    switch (params.bottom.anchor_face) {
+      case Face::BOTTOM:
+        b.bottom = box.bottom;
+        break;
+      case Face::TOP:
+        b.bottom = box.top;
+        break;
+      default:
+        BOOST_LOG_TRIVIAL(error) << "Invalid face provided for ID " << id << "'s bottom margin -- ignoring...";
+    }
+
+    if (anchors[0] == NO_ANCHOR) {
+      b.top = b.bottom - child_dims.y;
+    }
+  }
+
+  // left/right
+  if (anchors[2] != NO_ANCHOR) {
+    const BoundingBox& box = boxes_[anchors[2]];
+    switch (params.left.anchor_face) {
+      case Face::LEFT:
+        b.left = box.left;
+        break;
+      case Face::RIGHT:
+        b.left = box.right;
+        break;
+      default:
+        BOOST_LOG_TRIVIAL(error) << "Invalid face provided for ID " << id << "'s left margin -- ignoring...";
+    }
+
+    if (anchors[3] == NO_ANCHOR) {
+      b.right = b.left + child_dims.x;
+    }
+  }
+
+  if (anchors[3] != NO_ANCHOR) {
+    const BoundingBox& box = boxes_[anchors[3]];
+    switch (params.right.anchor_face) {
+      case Face::LEFT:
+        b.right = box.left;
+        break;
+      case Face::RIGHT:
+        b.right = box.right;
+        break;
+      default:
+        BOOST_LOG_TRIVIAL(error) << "Invalid face provided for ID " << id << "'s right margin -- ignoring...";
+    }
+
+    if (anchors[2] == NO_ANCHOR) {
+      b.left = b.right - child_dims.x;
+    }
+  }
+
+  // handle autos
+  if (params.top.margin.type == MarginType::AUTO || params.bottom.margin.type == MarginType::AUTO) {
+    // total range
+    float y_range = b.bottom - b.top;
+    // margin shrink on both sides
+    float y_squeeze = (y_range - child_dims.y) / 2;
+    b.top += y_squeeze;
+    b.bottom -= y_squeeze;
+  } else {
+    if (anchors[0] != NO_ANCHOR) {
+      b.top += params.top.margin.dist;
+      if (anchors[1] == NO_ANCHOR) {
+        b.bottom += params.top.margin.dist;
+      }
+    }
+
+    if (anchors[1] != NO_ANCHOR) {
+      b.bottom -= params.bottom.margin.dist;
+      if (anchors[0] == NO_ANCHOR) {
+        b.top -= params.bottom.margin.dist;
+      }
+    }
+  }
+
+  if (params.left.margin.type == MarginType::AUTO || params.right.margin.type == MarginType::AUTO) {
+    float x_range = b.right - b.left;
+    float x_squeeze = (x_range - child_dims.x) / 2;
+    b.left += x_squeeze;
+    b.right -= x_squeeze;
+  } else {
+    if (anchors[2] != NO_ANCHOR) {
+      b.left += params.left.margin.dist;
+      if (anchors[3] == NO_ANCHOR) {
+        b.right += params.left.margin.dist;
+      }
+    }
+
+    if (anchors[3] != NO_ANCHOR) {
+      b.right -= params.right.margin.dist;
+      if (anchors[2] == NO_ANCHOR) {
+        b.left -= params.right.margin.dist;
+      }
+    }
+  }
+
+  b.top = std::round(b.top);
+  b.bottom = std::round(b.bottom);
+  b.left = std::round(b.left);
+  b.right = std::round(b.right);
+  return b;
+}
+
+}
+}
+}
+}
@@ -4,10 +4,14 @@
 #include <engine/BaseEngine.hpp>
 #include <engine/RenderContext.hpp>
 
+#include <critter/Model.hpp>
 #include <critter/visitor/ActiveCameraFindVisitor.hpp>
 #include <critter/visitor/LightVisitor.hpp>
 
 #include <shader/light/LightTypes.hpp>
+#include <shader/light/LightClusters.hpp>
+#include <shader/light/ShadowAtlas.hpp>
+#include <shader/UniformBlocks.hpp>
 
 // TODO: create an actual logging setup -- we can config it in init :)
 #include <boost/log/trivial.hpp>
@@ -26,16 +30,25 @@ namespace engine {
 namespace baseengine {
 
 using ::monkeysworld::critter::Camera;
+using ::monkeysworld::critter::Model;
 using ::monkeysworld::critter::visitor::ActiveCameraFindVisitor;
 using ::monkeysworld::critter::visitor::LightVisitor;
 
 using ::monkeysworld::shader::Material;
+using ::monkeysworld::shader::frame_uniforms;
 using ::monkeysworld::shader::light::SpotLight;
 using ::monkeysworld::shader::light::spotlight_info;
+using ::monkeysworld::shader::light::ShadowAtlas;
+using ::monkeysworld::shader::light::LightClusters;
 
 using ::monkeysworld::critter::ui::UIObject;
 
 using ::monkeysworld::engine::RenderContext;
+using ::monkeysworld::engine::RenderPass;
+
+// 16 spotlights at 1024px each
+static const int SHADOW_ATLAS_SIZE = 4096;
+static const int SHADOW_TILE_SIZE = 1024;
 
 /**
  *  Calls create funcs on all objects in the hierarchy.
@@ -52,11 +65,25 @@ static void UpdateObjects(std::shared_ptr<critter::Object>);
  */ 
 static void RenderObjects(std::shared_ptr<critter::Object>, RenderContext&);
 
+/**
+ *  Finds all models nested within the passed root.
+ *  @param obj - the root object.
+ *  @param models - output list which models are appended to.
+ */ 
+static void CollectModels(std::shared_ptr<critter::Object> obj, std::vector<std::shared_ptr<Model>>& models);
+
 /**
  *  Renders all UI objects.
  */ 
 static void RenderUI(std::shared_ptr<critter::Object>, RenderContext&);
 
+/**
+ *  Uploads the per-frame uniform block, and binds it for the rest of the frame.
+ *  @param ubo - the buffer storing the block. Created if 0.
+ *  @param frame - the contents of the block.
+ */ 
+static void UploadFrameUniforms(GLuint* ubo, const frame_uniforms& frame);
+
 // subtype context to enable access to frequent update functions
 // pass supertype to scene
 void GameLoop(std::shared_ptr<engine::EngineContext> ctx, GLFWwindow* window) {
@@ -73,6 +100,11 @@ void GameLoop(std::shared_ptr<engine::EngineContext> ctx, GLFWwindow* window) {
 
   RenderContext rc;
   std::vector<spotlight_info> spotlights;
+  std::vector<std::shared_ptr<Model>> casters;
+  ShadowAtlas shadow_atlas(SHADOW_ATLAS_SIZE, SHADOW_TILE_SIZE);
+  LightClusters light_clusters;
+  frame_uniforms frame_data;
+  GLuint frame_ubo = 0;
 
   glfwSwapInterval(0);
   glEnable(GL_DEPTH_TEST);
@@ -114,39 +146,50 @@ void GameLoop(std::shared_ptr<engine::EngineContext> ctx, GLFWwindow* window) {
     }
 
     UpdateObjects(win->GetRootObject());
-    // for each light:
-    //   - do a depth render from the perspective of our lights
-
-
-    // for now: put the lights by themselves in our render context
-
-    // SHADOW PASS -- get shadow info
-    // add light info to the render context, in appropriate places
-    // shadow pass is still a TODO. :)
-
-    // only spotlights for now -- the goal:
-    //   - see which lights are in the scene
-    //   - run the light pass for each one
-    //   - note: there should be a method which contains all GL calls required to draw the object
-    //   - that way, we can separate material configuration from drawing
-    //   - add a method to Object which accomplishes this
 
     // MEMORY ISSUE: spotlights were never cleared, so the list just builds and builds -- slowdown increases over time because we spend so much time
     // passing around a massive array of spotlights
     spotlights.clear();
     for (auto light : light_visitor.GetSpotLights()) {
-      // no render context needed -- we're just preparing attributes and calling a default shadow func
-      // we want to have the shadow map shader prepared beforehand
-
       spotlights.push_back(light->GetSpotLightInfo());
     }
+
     rc.SetSpotlights(spotlights);
     rc.SetActiveCamera(std::static_pointer_cast<Camera>(cam_visitor.GetActiveCamera()));
+
+    // pick LODs from the main camera up front, so shadows are cast by the same meshes we draw
+    casters.clear();
+    CollectModels(scene->GetGameObjectRoot(), casters);
+    for (auto& model : casters) {
+      model->SelectLOD(rc);
+    }
+
+    // SHADOW PASS -- only redraws the lights whose view changed since last frame
+    rc.SetRenderPass(RenderPass::SHADOW);
+    shadow_atlas.Update(light_visitor.GetSpotLights(), casters, spotlights);
+    rc.SetShadowAtlas(shadow_atlas.GetTexture());
+    BOOST_LOG_TRIVIAL(trace) << "shadow triangles drawn: " << Model::ResetShadowTriangleCount();
+    rc.SetRenderPass(RenderPass::RENDER);
+
+    // bin lights into clusters, and upload them for the frame
+    light_clusters.Assign(rc.GetActiveCamera(), spotlights);
+    light_clusters.Upload();
+
+    // camera + light info, shared by every material for the rest of the frame
+    auto cam_info = rc.GetActiveCamera();
+    frame_data.view_matrix = cam_info.view_matrix;
+    frame_data.persp_matrix = cam_info.persp_matrix;
+    frame_data.vp_matrix = cam_info.vp_matrix;
+    frame_data.camera_position = glm::vec4(cam_info.position, 1.0);
+    light_clusters.GetFrameUniforms(&frame_data);
+    UploadFrameUniforms(&frame_ubo, frame_data);
+
     ctx->GetCurrentFrame()->BindFramebuffer(shader::FramebufferTarget::DEFAULT);
     int w, h;
     ctx->GetFramebufferSize(&w, &h);
     glViewport(0, 0, w, h);
     RenderObjects(scene->GetGameObjectRoot(), rc);
+    BOOST_LOG_TRIVIAL(trace) << "triangles drawn: " << Model::ResetTriangleCount();
 
     
     
@@ -174,6 +217,10 @@ void GameLoop(std::shared_ptr<engine::EngineContext> ctx, GLFWwindow* window) {
     ctx->UpdateContext();
     ctx->GetCurrentFrame()->BindFramebuffer(shader::FramebufferTarget::DEFAULT);
   }
+
+  if (frame_ubo != 0) {
+    glDeleteBuffers(1, &frame_ubo);
+  }
 }
 
 void CreateObjects(std::shared_ptr<critter::Object> obj) {
@@ -210,6 +257,32 @@ void RenderObjects(std::shared_ptr<critter::Object> obj, RenderContext& rc) {
   }
 }
 
+void CollectModels(std::shared_ptr<critter::Object> obj, std::vector<std::shared_ptr<Model>>& models) {
+  if (!obj) {
+    return;
+  }
+
+  if (auto model = std::dynamic_pointer_cast<Model>(obj)) {
+    models.push_back(model);
+  }
+
+  for (auto child : obj->GetChildren()) {
+    CollectModels(child, models);
+  }
+}
+
+void UploadFrameUniforms(GLuint* ubo, const frame_uniforms& frame) {
+  if (*ubo == 0) {
+    glGenBuffers(1, ubo);
+  }
+
+  glBindBuffer(GL_UNIFORM_BUFFER, *ubo);
+  // orphan every frame so we never wait on last frame's draws
+  glBufferData(GL_UNIFORM_BUFFER, sizeof(frame_uniforms), &frame, GL_STREAM_DRAW);
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+  glBindBufferBase(GL_UNIFORM_BUFFER, shader::FRAME_BLOCK_BINDING, *ubo);
+}
+
 void RenderUI(std::shared_ptr<critter::Object> obj, RenderContext& rc) {
   if (!obj) {
     return;
@@ -1,6 +1,9 @@
 #include <engine/EngineContext.hpp>
 #include <engine/Scene.hpp>
 #include <engine/SceneSwap.hpp>
+#include <shader/ProgramRegistry.hpp>
+
+#include <boost/log/trivial.hpp>
 
 namespace monkeysworld {
 namespace engine {
@@ -8,12 +11,17 @@ namespace engine {
 using file::CachedFileLoader;
 using input::EventManager;
 using audio::AudioManager;
+using shader::UniformRing;
+
+// ~16k draws before the ring wraps
+static const GLsizeiptr UNIFORM_RING_SIZE = 4 * 1024 * 1024;
 
 EngineContext::EngineContext(GLFWwindow* window, Scene* scene) {
   file_loader_ = std::make_shared<CachedFileLoader>(scene->GetSceneIdentifier());
   event_mgr_ = std::make_shared<input::WindowEventManager>(window, this);
   audio_mgr_ = std::make_shared<AudioManager>();
   executor_ = std::make_shared<EngineExecutor>();
+  uniform_ring_ = std::make_shared<UniformRing>(UNIFORM_RING_SIZE);
 
   window_ = window;
 
@@ -30,6 +38,8 @@ EngineContext::EngineContext(GLFWwindow* window, Scene* scene) {
   fb_b_ = std::make_shared<shader::Framebuffer>();
 
   a_front_ = false;
+
+  WatchForChanges();
 }
 
 void EngineContext::InitializeScene() {
@@ -67,6 +77,10 @@ std::shared_ptr<Executor<>> EngineContext::GetExecutor() {
   return executor_;
 }
 
+std::shared_ptr<UniformRing> EngineContext::GetUniformRing() {
+  return uniform_ring_;
+}
+
 std::shared_ptr<shader::Framebuffer> EngineContext::GetLastFrame() {
   if (a_front_) {
     return fb_a_;
@@ -148,6 +162,7 @@ EngineContext::EngineContext(const EngineContext& other, Scene* scene) {
   audio_mgr_ = other.audio_mgr_;
   window_ = other.window_;
   executor_ = other.executor_;
+  uniform_ring_ = other.uniform_ring_;
 
   initialized_ = false;
 
@@ -162,6 +177,32 @@ EngineContext::EngineContext(const EngineContext& other, Scene* scene) {
   fb_b_ = other.fb_b_;
 
   scene_ = scene;
+
+  WatchForChanges();
+}
+
+void EngineContext::WatchForChanges() {
+#ifdef MONKEYSWORLD_HOT_RELOAD
+  file_loader_->EnableHotReload();
+  std::weak_ptr<CachedFileLoader> weak_loader = file_loader_;
+
+  // runs between frames, so nothing is mid-draw when we swap things out
+  executor_->PollOnMainThread([weak_loader] {
+    auto loader = weak_loader.lock();
+    if (!loader) {
+      // our scene is gone -- the next one has its own poll
+      return true;
+    }
+
+    auto changed = loader->ReloadChangedFiles();
+    if (!changed.empty()) {
+      size_t rebuilt = shader::ProgramRegistry::GetInstance().ReloadPrograms(changed);
+      BOOST_LOG_TRIVIAL(info) << "Hot reload: " << changed.size() << " files changed, " << rebuilt << " programs rebuilt";
+    }
+
+    return false;
+  });
+#endif
 }
 
 
@@ -13,6 +13,21 @@ void EngineExecutor::RunTasks(double time) {
   auto start = std::chrono::high_resolution_clock::now();
   auto end = start;
   std::chrono::duration<double, std::ratio<1L, 1L>> dur = end - start;
+
+  {
+    std::unique_lock<std::mutex> lock(poll_mutex_);
+    polling_.swap(poll_queue_);
+  }
+
+  // run without the lock held, so polls can queue up new polls
+  for (auto& poll : polling_) {
+    if (!poll()) {
+      std::unique_lock<std::mutex> lock(poll_mutex_);
+      poll_queue_.push_back(poll);
+    }
+  }
+
+  polling_.clear();
   
   bool read;
   std::unique_lock<std::mutex> lock(queue_mutex_);
@@ -20,6 +20,10 @@ RenderPass RenderContext::GetRenderPass() const {
   return rp_;
 }
 
+GLuint RenderContext::GetShadowAtlas() const {
+  return shadow_atlas_;
+}
+
 void RenderContext::SetActiveCamera(std::shared_ptr<Camera> cam) {
   if (cam) {
     cam_info_ = cam->GetCameraInfo();
@@ -45,5 +49,9 @@ void RenderContext::SetRenderPass(RenderPass rp) {
   rp_ = rp;
 }
 
+void RenderContext::SetShadowAtlas(GLuint atlas) {
+  shadow_atlas_ = atlas;
+}
+
 }
 }
\ No newline at end of file
@@ -15,14 +15,18 @@ namespace file {
 using utils::fileutils::WriteAsBytes;
 using utils::fileutils::ReadAsBytes;
 
+std::string CachedFileLoader::GetCacheDirectory() {
+  return "resources/cache/";
+}
+
 CachedFileLoader::CachedFileLoader(const std::string& cache_name) {
-  cache_path_ = "resources/cache/" + cache_name + ".cache";
+  cache_path_ = GetCacheDirectory() + cache_name + ".cache";
   auto cache = ReadCacheFileToVector(cache_path_);
   thread_pool_ = std::make_shared<LoaderThreadPool>(8);
   audio_loader_ = std::make_unique<AudioLoader>(thread_pool_, cache);
   file_loader_ = std::make_unique<FileLoader>(thread_pool_, cache);
   model_loader_ = std::make_unique<ModelLoader>(thread_pool_, cache);
-  font_loader_ = std::make_unique<FontLoader>(thread_pool_, cache);
+  font_loader_ = std::make_unique<FontLoader>(thread_pool_, cache, GetCacheDirectory());
   texture_loader_ = std::make_unique<TextureLoader>(thread_pool_, cache);
   cubemap_loader_ = std::make_unique<CubeMapLoader>(thread_pool_, cache);
 }
@@ -66,13 +70,35 @@ std::future<std::shared_ptr<audio::AudioBuffer>> CachedFileLoader::LoadAudioAsyn
 }
 
 CacheStreambuf CachedFileLoader::LoadFile(const std::string& path) {
+  if (watcher_) {
+    watcher_->Watch(path);
+  }
+
   return file_loader_->LoadFile(path);
 }
 
 std::shared_ptr<const model::Mesh<storage::VertexPacket3D>> CachedFileLoader::LoadModel(const std::string& path) {
+  if (watcher_) {
+    watcher_->Watch(path);
+  }
+
   return model_loader_->LoadFile(path);
 }
 
+std::vector<std::shared_ptr<const model::Mesh<storage::VertexPacket3D>>> CachedFileLoader::LoadModelLODs(const std::string& path) {
+  if (watcher_) {
+    watcher_->Watch(path);
+  }
+
+  auto lods = model_loader_->LoadLODs(path);
+  return std::vector<std::shared_ptr<const model::Mesh<storage::VertexPacket3D>>>(lods.begin(), lods.end());
+}
+
+std::vector<std::shared_ptr<const model::Mesh<storage::VertexPacket3D>>> CachedFileLoader::FindModelLODs(const model::Mesh<storage::VertexPacket3D>* base) {
+  auto lods = model_loader_->FindLODs(base);
+  return std::vector<std::shared_ptr<const model::Mesh<storage::VertexPacket3D>>>(lods.begin(), lods.end());
+}
+
 std::shared_ptr<const font::Font> CachedFileLoader::LoadFont(const std::string& path) {
   return font_loader_->LoadFile(path);
 }
@@ -92,9 +118,46 @@ std::shared_ptr<const shader::CubeMap> CachedFileLoader::LoadCubeMap(const std::
 }
 
 std::shared_ptr<const shader::Texture> CachedFileLoader::LoadTexture(const std::string& image_path) {
+  if (watcher_) {
+    watcher_->Watch(image_path);
+  }
+
   return texture_loader_->LoadFile(image_path);
 }
 
+void CachedFileLoader::EnableHotReload() {
+  if (!FileWatcher::IsSupported()) {
+    BOOST_LOG_TRIVIAL(warning) << "Hot reload isn't supported on this platform";
+    return;
+  }
+
+  watcher_ = std::make_unique<FileWatcher>();
+}
+
+void CachedFileLoader::WatchFile(const std::string& path) {
+  if (watcher_) {
+    watcher_->Watch(path);
+  }
+}
+
+std::vector<std::string> CachedFileLoader::ReloadChangedFiles() {
+  if (!watcher_) {
+    return std::vector<std::string>();
+  }
+
+  auto changed = watcher_->PollChanges();
+  for (auto& path : changed) {
+    BOOST_LOG_TRIVIAL(info) << "Reloading " << path;
+    // a path can be cached by more than one loader
+    file_loader_->ReloadFile(path);
+    model_loader_->ReloadFile(path);
+    texture_loader_->ReloadFile(path);
+  }
+
+  model_loader_->FinishReloads();
+  return changed;
+}
+
 std::vector<cache_record> CachedFileLoader::ReadCacheFileToVector(const std::string& cache_path) {
   std::vector<cache_record> record;
   std::ifstream cache(cache_path, std::ios_base::in | std::ios_base::binary);
@@ -146,6 +209,7 @@ CachedFileLoader::~CachedFileLoader() {
   font_loader_->WaitUntilLoaded();
   texture_loader_->WaitUntilLoaded();
   cubemap_loader_->WaitUntilLoaded();
+  font_loader_->StoreAtlases();
   std::fstream cache_output;
   cache_output.open(cache_path_, std::fstream::in | std::fstream::out | std::fstream::trunc | std::fstream::binary);
   std::vector<cache_record> cache;
@@ -83,6 +83,35 @@ CacheStreambuf FileLoader::LoadFile(const std::string& path) {
   return CacheStreambuf(res);
 }
 
+bool FileLoader::ReloadFile(const std::string& path) {
+  {
+    std::shared_lock<std::shared_timed_mutex> lock(cache_mutex_);
+    if (file_cache_.find(path) == file_cache_.end()) {
+      return false;
+    }
+  }
+
+  std::ifstream source_stream(path, std::ios_base::in | std::ios_base::binary);
+  if (!source_stream.good()) {
+    BOOST_LOG_TRIVIAL(warning) << "could not reload " << path << " -- keeping old contents";
+    return true;
+  }
+
+  auto res = std::make_shared<std::vector<char>>();
+  source_stream.seekg(0, std::ios_base::end);
+  uint64_t size = source_stream.tellg();
+  source_stream.seekg(0, std::ios_base::beg);
+  res->resize(size);
+  source_stream.rdbuf()->sgetn(res->data(), size);
+
+  {
+    std::unique_lock<std::shared_timed_mutex> lock(cache_mutex_);
+    file_cache_[path] = res;
+  }
+
+  return true;
+}
+
 bool FileLoader::IsCached(const std::string& path) {
   auto res = file_cache_.find(path);
   return (res != file_cache_.end());
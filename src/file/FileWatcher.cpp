@@ -0,0 +1,119 @@
+#include <file/FileWatcher.hpp>
+
+#include <boost/log/trivial.hpp>
+
+#include <set>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace monkeysworld {
+namespace file {
+
+#ifdef __linux__
+// editors either write in place, or write elsewhere and move the result over the original
+static const uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_MOVED_TO;
+#endif
+
+FileWatcher::FileWatcher() {
+#ifdef __linux__
+  fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (fd_ < 0) {
+    BOOST_LOG_TRIVIAL(warning) << "Could not create inotify instance -- files won't be watched";
+  }
+#else
+  fd_ = -1;
+#endif
+}
+
+bool FileWatcher::IsSupported() {
+#ifdef __linux__
+  return true;
+#else
+  return false;
+#endif
+}
+
+void FileWatcher::Watch(const std::string& path) {
+  if (fd_ < 0) {
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(watch_lock_);
+  if (!files_.insert(path).second) {
+    return;
+  }
+
+  size_t slash = path.find_last_of('/');
+  std::string prefix = (slash == std::string::npos ? "" : path.substr(0, slash + 1));
+  if (dir_watches_.find(prefix) != dir_watches_.end()) {
+    return;
+  }
+
+#ifdef __linux__
+  int wd = inotify_add_watch(fd_, (prefix.empty() ? "." : prefix.c_str()), WATCH_MASK);
+  if (wd < 0) {
+    BOOST_LOG_TRIVIAL(warning) << "Could not watch directory of " << path;
+    return;
+  }
+
+  dirs_[wd] = prefix;
+  dir_watches_[prefix] = wd;
+#endif
+}
+
+std::vector<std::string> FileWatcher::PollChanges() {
+  std::vector<std::string> res;
+  if (fd_ < 0) {
+    return res;
+  }
+
+#ifdef __linux__
+  // some editors trigger several events per save -- report each file once
+  std::set<std::string> changed;
+  alignas(inotify_event) char buffer[4096];
+  std::unique_lock<std::mutex> lock(watch_lock_);
+  for (;;) {
+    ssize_t len = read(fd_, buffer, sizeof(buffer));
+    if (len <= 0) {
+      // EAGAIN: nothing left to read
+      break;
+    }
+
+    for (char* cur = buffer; cur < buffer + len;) {
+      const inotify_event* event = reinterpret_cast<const inotify_event*>(cur);
+      cur += sizeof(inotify_event) + event->len;
+      if (event->len == 0) {
+        continue;
+      }
+
+      auto dir = dirs_.find(event->wd);
+      if (dir == dirs_.end()) {
+        continue;
+      }
+
+      std::string path = dir->second + event->name;
+      if (files_.count(path)) {
+        changed.insert(path);
+      }
+    }
+  }
+
+  res.assign(changed.begin(), changed.end());
+#endif
+
+  return res;
+}
+
+FileWatcher::~FileWatcher() {
+#ifdef __linux__
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+#endif
+}
+
+}
+}
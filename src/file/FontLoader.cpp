@@ -5,7 +5,8 @@ namespace monkeysworld {
 namespace file {
 
 FontLoader::FontLoader(std::shared_ptr<LoaderThreadPool> thread_pool,
-                       std::vector<cache_record> cache) : CachedLoader(thread_pool) {
+                       std::vector<cache_record> cache,
+                       const std::string& cache_dir) : CachedLoader(thread_pool), atlas_cache_(cache_dir) {
   loader_.bytes_read = 0;
   loader_.bytes_sum = 0;
   for (auto record : cache) {
@@ -22,7 +23,7 @@ std::vector<cache_record> FontLoader::GetCache() {
   cache_record temp;
   for (auto record : font_cache_) {
     temp.path = record.first;
-    temp.file_size = 1;       // placeholder, doesn't really matter
+    temp.file_size = record.second->GetFileSize();
     temp.type = CacheType::FONT;
     result.push_back(temp);
   }
@@ -58,7 +59,7 @@ std::shared_ptr<font::Font> FontLoader::LoadFile(const std::string& path) {
 
   // not catching this exception -- im gonna let it bump up and be public
   // TBA: in the event of an exception from this call, return a shitty default font
-  res = std::make_shared<font::Font>(path);
+  res = std::make_shared<font::Font>(path, font::GlyphMode::SDF, GetThreadPool(), &atlas_cache_);
 
   {
     std::unique_lock<std::shared_timed_mutex> lock(cache_mutex_);
@@ -73,12 +74,22 @@ bool FontLoader::IsCached(const std::string& path) {
   return (res != font_cache_.end());
 }
 
+void FontLoader::StoreAtlases() {
+  std::shared_lock<std::shared_timed_mutex> lock(cache_mutex_);
+  for (auto& record : font_cache_) {
+    if (record.second->StoreAtlas(atlas_cache_)) {
+      BOOST_LOG_TRIVIAL(trace) << "stored glyph atlas for " << record.first;
+    }
+  }
+}
+
 void FontLoader::LoadFontToCache(cache_record& record) {
   auto load_font = [=] {
     std::shared_ptr<font::Font> res;
 
     try {
-      res = std::make_shared<font::Font>(record.path);
+      // already on the pool -- the font pitches in on its own rasterization, so this won't starve
+      res = std::make_shared<font::Font>(record.path, font::GlyphMode::SDF, GetThreadPool(), &atlas_cache_);
     } catch (font::exception::BadFontPathException e) {
       BOOST_LOG_TRIVIAL(trace) << "Could not load font " << record.path;
       return;
@@ -7,7 +7,7 @@ LoaderThreadPool::LoaderThreadPool(int num_threads) {
   threads_ = new std::thread[num_threads];
   flags_ = new std::atomic_flag[num_threads];
   for (int i = 0; i < num_threads; i++) {
-    flags_->test_and_set();
+    flags_[i].test_and_set();
   }
   
   num_threads_ = num_threads;
@@ -25,6 +25,10 @@ void LoaderThreadPool::AddTaskToQueue(std::function<void()> func) {
   task_condvar_.notify_all();
 }
 
+int LoaderThreadPool::GetThreadCount() const {
+  return num_threads_;
+}
+
 void LoaderThreadPool::threadfunc_(std::atomic_flag* flag) {
   std::function<void()> task;
   for (;;) {
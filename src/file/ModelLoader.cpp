@@ -2,6 +2,7 @@
 #include <critter/Model.hpp>
 
 #include <file/exception/FileNotFoundException.hpp>
+#include <model/MeshSimplifier.hpp>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/regex.hpp>
@@ -15,9 +16,12 @@ namespace file {
 
 using exception::FileNotFoundException;
 using model::Mesh;
+using model::MeshSimplifier;
 using storage::VertexPacket3D;
 using boost::lexical_cast;
 
+std::atomic<uint64_t> ModelLoader::reload_count_(0);
+
 /**
  *  Static method used to load OBJ files.
  *  @param path - path to the model being loaded
@@ -29,6 +33,7 @@ ModelLoader::ModelLoader(std::shared_ptr<LoaderThreadPool> thread_pool,
                          std::vector<cache_record> cache) : CachedLoader(thread_pool) {
   loader_.bytes_read = 0;
   loader_.bytes_sum = 0;
+  next_reload_id_ = 0;
   for (auto record : cache) {
     // figure out how many bytes we need to read
     if (record.type == MODEL) {
@@ -56,7 +61,7 @@ std::shared_ptr<model::Mesh<>> ModelLoader::LoadFile(const std::string& path) {
   // insert old method here
 
 
-  model_record record = {mesh, size};
+  model_record record = CreateRecord(mesh, size);
 
   {
     std::unique_lock<std::shared_timed_mutex>(cache_mutex_);
@@ -66,6 +71,120 @@ std::shared_ptr<model::Mesh<>> ModelLoader::LoadFile(const std::string& path) {
   return mesh;
 }
 
+std::vector<std::shared_ptr<Mesh<>>> ModelLoader::LoadLODs(const std::string& path) {
+  auto mesh = LoadFile(path);
+  {
+    std::shared_lock<std::shared_timed_mutex> lock(cache_mutex_);
+    auto i = model_cache_.find(path);
+    if (i != model_cache_.end()) {
+      return i->second.lods;
+    }
+  }
+
+  // shouldn't happen, but fall back on the base mesh
+  return { mesh };
+}
+
+bool ModelLoader::ReloadFile(const std::string& path) {
+  {
+    std::shared_lock<std::shared_timed_mutex> lock(cache_mutex_);
+    if (model_cache_.find(path) == model_cache_.end()) {
+      return false;
+    }
+  }
+
+  uint64_t reload_id;
+  {
+    std::unique_lock<std::mutex> lock(reload_mutex_);
+    reload_id = ++next_reload_id_;
+  }
+
+  // parsing and simplifying can take a while -- keep it off the main thread
+  auto reload_model = [this, path, reload_id] {
+    uint64_t size = 0;
+    std::shared_ptr<Mesh<>> mesh;
+    try {
+      mesh = FromObjFile(path, &size);
+    } catch (FileNotFoundException& e) {
+      // editor might still be writing it
+      BOOST_LOG_TRIVIAL(warning) << "could not reload model " << path << " -- keeping old contents";
+      return;
+    }
+
+    model_record record = CreateRecord(mesh, size);
+    record.reload_id = reload_id;
+    {
+      std::unique_lock<std::mutex> lock(reload_mutex_);
+      // the file may have changed again while we were reading it -- keep whichever read started last
+      auto i = reloads_.find(path);
+      if (i == reloads_.end() || i->second.reload_id < reload_id) {
+        reloads_[path] = record;
+      }
+    }
+  };
+
+  GetThreadPool()->AddTaskToQueue(reload_model);
+  return true;
+}
+
+size_t ModelLoader::FinishReloads() {
+  std::unordered_map<std::string, model_record> finished;
+  {
+    std::unique_lock<std::mutex> lock(reload_mutex_);
+    finished.swap(reloads_);
+  }
+
+  size_t swapped = 0;
+  for (auto& reload : finished) {
+    std::unique_lock<std::shared_timed_mutex> lock(cache_mutex_);
+    auto i = model_cache_.find(reload.first);
+    if (i == model_cache_.end() || i->second.reload_id > reload.second.reload_id) {
+      continue;
+    }
+
+    // move assignment keeps the base mesh's GL context, and marks it dirty for re-upload.
+    // the rest of the chain is replaced outright, since the new one may be a different length.
+    model_record& record = reload.second;
+    *i->second.ptr = std::move(*record.ptr);
+    record.ptr = i->second.ptr;
+    record.lods[0] = record.ptr;
+    i->second = record;
+    swapped++;
+  }
+
+  reload_count_.fetch_add(swapped);
+  return swapped;
+}
+
+std::vector<std::shared_ptr<Mesh<>>> ModelLoader::FindLODs(const Mesh<>* base) {
+  std::shared_lock<std::shared_timed_mutex> lock(cache_mutex_);
+  for (auto& entry : model_cache_) {
+    if (entry.second.ptr.get() == base) {
+      return entry.second.lods;
+    }
+  }
+
+  return std::vector<std::shared_ptr<Mesh<>>>();
+}
+
+uint64_t ModelLoader::GetReloadCount() {
+  return reload_count_.load();
+}
+
+ModelLoader::model_record ModelLoader::CreateRecord(std::shared_ptr<Mesh<>> mesh, uint64_t size) {
+  model_record record;
+  record.ptr = mesh;
+  record.size = size;
+  record.reload_id = 0;
+  record.lods.push_back(mesh);
+  for (auto& lod : MeshSimplifier::BuildLODChain(*mesh, LOD_LEVELS)) {
+    record.lods.push_back(lod);
+  }
+
+  BOOST_LOG_TRIVIAL(trace) << "generated " << (record.lods.size() - 1) << " LODs";
+  return record;
+}
+
 std::vector<cache_record> ModelLoader::GetCache() {
   std::vector<cache_record> result;
   // store something which preserves file size
@@ -110,7 +229,7 @@ void ModelLoader::LoadOBJToCache(cache_record& record) {
     auto result = FromObjFile(record.path, &file_size);
 
     // updates the file size if necessary
-    model_record cache = {result, file_size};
+    model_record cache = CreateRecord(result, file_size);
     {
       std::unique_lock<std::shared_timed_mutex>(cache_mutex_);
       model_cache_.insert(std::make_pair(record.path, cache));
@@ -76,6 +76,25 @@ std::shared_ptr<shader::Texture> TextureLoader::LoadFile(const std::string& path
   return t;
 }
 
+bool TextureLoader::ReloadFile(const std::string& path) {
+  std::shared_ptr<shader::Texture> tex;
+  {
+    std::shared_lock<std::shared_timed_mutex> lock(cache_mutex_);
+    auto i = texture_cache_.find(path);
+    if (i == texture_cache_.end()) {
+      return false;
+    }
+
+    tex = i->second;
+  }
+
+  if (!tex->Reload(path)) {
+    BOOST_LOG_TRIVIAL(warning) << "could not reload texture " << path << " -- keeping old contents";
+  }
+
+  return true;
+}
+
 bool TextureLoader::IsCached(const std::string& path) {
   auto res = texture_cache_.find(path);
   return (res != texture_cache_.end());
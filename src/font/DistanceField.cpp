@@ -0,0 +1,177 @@
+#include <font/DistanceField.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+// SSE2 for the byte to float conversion -- every x86-64 target has it
+#if defined(__SSE2__) || defined(_M_X64)
+#define DISTANCE_FIELD_SSE
+#include <emmintrin.h>
+#endif
+
+namespace monkeysworld {
+namespace font {
+
+// stands in for "no feature in this column" -- squared, still well within float range
+static const float FAR_AWAY = 1e6f;
+
+/**
+ *  Top down step of the vertical pass: zero on features, otherwise one further than the row above.
+ */
+static void ColumnDown(const uint8_t* mask, uint8_t feature, const float* prev, int n, float* cur) {
+  int x = 0;
+#if defined(DISTANCE_FIELD_SSE)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128 f = _mm_set1_ps(static_cast<float>(feature));
+  const __m128 one = _mm_set1_ps(1.0f);
+  for (; x + 4 <= n; x += 4) {
+    int32_t bytes;
+    std::memcpy(&bytes, mask + x, sizeof(bytes));
+    __m128i m = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero), zero);
+    __m128 is_feature = _mm_cmpeq_ps(_mm_cvtepi32_ps(m), f);
+    _mm_storeu_ps(cur + x, _mm_andnot_ps(is_feature, _mm_add_ps(_mm_loadu_ps(prev + x), one)));
+  }
+#endif
+
+  for (; x < n; x++) {
+    cur[x] = (mask[x] == feature ? 0.0f : prev[x] + 1.0f);
+  }
+}
+
+/**
+ *  Bottom up step of the vertical pass: takes the row below's distance, if it's closer.
+ */
+static void ColumnUp(const float* next, int n, float* cur) {
+  int x = 0;
+#if defined(DISTANCE_FIELD_SSE)
+  const __m128 one = _mm_set1_ps(1.0f);
+  for (; x + 4 <= n; x += 4) {
+    __m128 below = _mm_add_ps(_mm_loadu_ps(next + x), one);
+    _mm_storeu_ps(cur + x, _mm_min_ps(_mm_loadu_ps(cur + x), below));
+  }
+#endif
+
+  for (; x < n; x++) {
+    cur[x] = std::min(cur[x], next[x] + 1.0f);
+  }
+}
+
+void DistanceField::Generate(const uint8_t* coverage, glm::ivec2 size, int pitch, glm::ivec2 origin,
+                             int upsample, int spread, glm::ivec2 out_size, uint8_t* out) {
+  grid_size_ = out_size * upsample;
+  mask_.assign(grid_size_.x * grid_size_.y, 0);
+  for (int y = 0; y < size.y; y++) {
+    int grid_y = origin.y + y;
+    if (grid_y < 0 || grid_y >= grid_size_.y) {
+      continue;
+    }
+
+    const uint8_t* src = coverage + y * pitch;
+    uint8_t* dst = &mask_[grid_y * grid_size_.x];
+    int x_min = std::max(0, -origin.x);
+    int x_max = std::min(size.x, grid_size_.x - origin.x);
+    for (int x = x_min; x < x_max; x++) {
+      dst[origin.x + x] = (src[x] >= 128 ? 1 : 0);
+    }
+  }
+
+  Transform(true, upsample, out_size, dist_inside_);
+  Transform(false, upsample, out_size, dist_outside_);
+
+  // distances are measured between pixel centers, so the edge sits half a pixel out
+  float scale = 1.0f / (2.0f * spread * upsample);
+  int count = out_size.x * out_size.y;
+  for (int i = 0; i < count; i++) {
+    float d_in = std::sqrt(dist_inside_[i]);
+    float d_out = std::sqrt(dist_outside_[i]);
+    float dist = (d_in > 0.0f ? d_in - 0.5f : 0.5f - d_out);
+    float value = std::min(std::max(0.5f - dist * scale, 0.0f), 1.0f);
+    out[i] = static_cast<uint8_t>(value * 255.0f + 0.5f);
+  }
+}
+
+void DistanceField::Transform(bool inside, int upsample, glm::ivec2 out_size, std::vector<float>& result) {
+  int width = grid_size_.x;
+  int height = grid_size_.y;
+  uint8_t feature = (inside ? 1 : 0);
+  column_.resize(width * height);
+
+  // vertical distance to the nearest feature -- a row at a time, top down then bottom up
+  float* col = &column_[0];
+  const uint8_t* mask = &mask_[0];
+  for (int x = 0; x < width; x++) {
+    col[x] = (mask[x] == feature ? 0.0f : FAR_AWAY);
+  }
+
+  for (int y = 1; y < height; y++) {
+    float* cur = col + y * width;
+    ColumnDown(mask + y * width, feature, cur - width, width, cur);
+  }
+
+  for (int y = height - 2; y >= 0; y--) {
+    float* cur = col + y * width;
+    ColumnUp(cur + width, width, cur);
+  }
+
+  // horizontal pass, only on rows we sample
+  result.resize(out_size.x * out_size.y);
+  row_.resize(width);
+  row_dist_.resize(width);
+  hull_vertex_.resize(width);
+  hull_bound_.resize(width + 1);
+  int center = upsample / 2;
+  for (int oy = 0; oy < out_size.y; oy++) {
+    const float* src = col + (oy * upsample + center) * width;
+    for (int x = 0; x < width; x++) {
+      row_[x] = static_cast<double>(src[x]) * src[x];
+    }
+
+    Transform1D(&row_[0], width);
+    float* dst = &result[oy * out_size.x];
+    for (int ox = 0; ox < out_size.x; ox++) {
+      dst[ox] = static_cast<float>(row_dist_[ox * upsample + center]);
+    }
+  }
+}
+
+void DistanceField::Transform1D(const double* f, int n) {
+  // lower envelope of parabolas rooted at each sample
+  const double inf = std::numeric_limits<double>::infinity();
+  int k = 0;
+  hull_vertex_[0] = 0;
+  hull_bound_[0] = -inf;
+  hull_bound_[1] = inf;
+  for (int q = 1; q < n; q++) {
+    double s;
+    for (;;) {
+      // where this parabola overtakes the last one on the hull. the first bound is -inf, so this stops.
+      int v = hull_vertex_[k];
+      s = ((f[q] + static_cast<double>(q) * q) - (f[v] + static_cast<double>(v) * v)) / (2.0 * (q - v));
+      if (s > hull_bound_[k]) {
+        break;
+      }
+
+      k--;
+    }
+
+    k++;
+    hull_vertex_[k] = q;
+    hull_bound_[k] = s;
+    hull_bound_[k + 1] = inf;
+  }
+
+  k = 0;
+  for (int q = 0; q < n; q++) {
+    while (hull_bound_[k + 1] < q) {
+      k++;
+    }
+
+    int v = hull_vertex_[k];
+    row_dist_[q] = static_cast<double>(q - v) * (q - v) + f[v];
+  }
+}
+
+}
+}
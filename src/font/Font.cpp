@@ -3,352 +3,915 @@
 
 #include <font/Font.hpp>
 #include <font/exception/BadFontPathException.hpp>
+#include <font/GlyphAtlasCache.hpp>
+#include <font/HarfBuzzShaper.hpp>
+#include <font/KerningShaper.hpp>
+#include <font/UTF8.hpp>
+#include <utils/HashUtils.hpp>
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
 #include <boost/log/trivial.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <limits>
+
 namespace monkeysworld {
 namespace font {
 
 using model::Mesh;
 using storage::VertexPacket2D;
 using exception::BadFontPathException;
+using file::LoaderThreadPool;
+using utils::hashutils::HashCombine;
+
+/**
+ *  Opens a face on the font's file data, at the size glyphs are rasterized at.
+ *  @returns the new face, or nullptr if it couldn't be opened.
+ */
+static FT_Face OpenFace(FTLibWrapper& lib, const std::vector<FT_Byte>& data, int face_size) {
+  FT_Face res;
+  std::lock_guard<std::mutex> lock(lib.lock);
+  if (FT_New_Memory_Face(lib.lib, data.data(), static_cast<FT_Long>(data.size()), 0, &res)) {
+    return nullptr;
+  }
+
+  FT_Set_Char_Size(res, 0, face_size * 64, 72, 72);
+  return res;
+}
+
+/**
+ *  Glyphs being rasterized across a thread pool. Chunks are claimed until there are none left,
+ *  so tasks which get to it late just leave.
+ */
+struct raster_job {
+  std::shared_ptr<const std::vector<FT_Byte>> font_data;
+  int face_size;
+  GlyphMode mode;
+  int upsample;
+  int padding;
+
+  std::vector<FT_UInt> glyphs;
+  std::vector<rendered_glyph> results;
+  size_t chunk_size;
+  size_t chunk_count;
+  std::atomic<size_t> next_chunk;
+
+  std::mutex lock;
+  std::condition_variable done_cond;
+  size_t chunks_done;
+};
+
+/**
+ *  Renders chunks of a job until there are none left.
+ *  @param face - face to render from. If null, one is opened on this thread's library.
+ */
+static void RunRasterJob(raster_job* job, FT_Face face) {
+  std::shared_ptr<FTLibWrapper> lib;
+  if (face == nullptr) {
+    if (job->next_chunk.load() >= job->chunk_count) {
+      // everything's been claimed already
+      return;
+    }
+
+    lib = FTLibWrapper::GetThreadLibrary();
+    face = OpenFace(*lib, *job->font_data, job->face_size);
+    if (face == nullptr) {
+      // whoever's waiting on the job will pick up the slack
+      return;
+    }
+  }
+
+  GlyphRasterizer rasterizer(job->mode, job->upsample, job->padding);
+  size_t chunk;
+  while ((chunk = job->next_chunk++) < job->chunk_count) {
+    size_t end = std::min(job->glyphs.size(), (chunk + 1) * job->chunk_size);
+    for (size_t i = chunk * job->chunk_size; i < end; i++) {
+      rasterizer.Render(face, job->glyphs[i], &job->results[i]);
+    }
+
+    std::lock_guard<std::mutex> lock(job->lock);
+    if (++job->chunks_done == job->chunk_count) {
+      job->done_cond.notify_all();
+    }
+  }
 
-std::mutex Font::ft_lib_lock_;
-std::weak_ptr<FTLibWrapper> Font::lib_singleton_;
+  if (lib != nullptr) {
+    std::lock_guard<std::mutex> lock(lib->lock);
+    FT_Done_Face(face);
+  }
+}
 
-// this scheme requires us to lock on calls to new_face and done_face
-// as well as when we check if the weak_ptr is valid, in case two fonts
-// attempt to create the lib at the same time.
-Font::Font(const std::string& font_path) {
+Font::Font(const std::string& font_path, GlyphMode mode,
+           std::shared_ptr<LoaderThreadPool> pool, const GlyphAtlasCache* atlas_cache) : packer_(glm::ivec2(0)) {
   if (!glfwGetCurrentContext()) {
     BOOST_LOG_TRIVIAL(warning) << "No context exists on this thread!";
   }
 
+  mode_ = mode;
+  if (mode_ == GlyphMode::SDF) {
+    glyph_scale_ = SDF_SCALE;
+    upsample_ = SDF_UPSAMPLE;
+    glyph_padding_ = SDF_SPREAD;
+    atlas_width_ = SDF_ATLAS_WIDTH;
+  } else {
+    glyph_scale_ = BITMAP_SCALE;
+    upsample_ = 1;
+    glyph_padding_ = 0;
+    atlas_width_ = BITMAP_ATLAS_WIDTH;
+  }
+
+  packer_.SetDimensions(glm::ivec2(atlas_width_, MAX_ATLAS_HEIGHT));
   glyph_texture_ = 0;
+  texture_height_ = 0;
+  atlas_height_ = MIN_ATLAS_HEIGHT;
+  use_tick_ = 0;
+  batch_depth_ = 0;
+  generation_ = 0;
+  atlas_changed_ = false;
+  atlas_key_ = 0;
+  atlas_key_valid_ = false;
+  shape_tick_ = 0;
+  dirty_min_ = glm::ivec2(atlas_width_, MAX_ATLAS_HEIGHT);
+  dirty_max_ = glm::ivec2(0);
   FT_Error e;
-  FT_Face face;
 
-  {
-    std::lock_guard<std::mutex> lock(ft_lib_lock_);
-    if (!(ft_lib_ = lib_singleton_.lock())) {
-      ft_lib_ = std::make_shared<FTLibWrapper>();
-      lib_singleton_ = ft_lib_;
+  // read once, so that any faces opened for rasterizing on other threads can share it
+  std::ifstream file(font_path, std::ios::binary);
+  auto data = std::make_shared<std::vector<FT_Byte>>(std::istreambuf_iterator<char>(file),
+                                                     std::istreambuf_iterator<char>());
+  font_data_ = data;
+  ft_lib_ = FTLibWrapper::GetThreadLibrary();
+  BOOST_LOG_TRIVIAL(trace) << font_path;
+  face_ = (file ? OpenFace(*ft_lib_, *font_data_, glyph_scale_ * upsample_) : nullptr);
+  if (face_ == nullptr) {
+    // complain some more :/
+    BOOST_LOG_TRIVIAL(error) << "Could not create new face";
+    throw BadFontPathException("Could not create new face");
+  }
+
+  // metrics are stored at the size glyphs end up at
+  ascent_ = static_cast<float>(face_->size->metrics.ascender) / upsample_;
+  line_height_ = static_cast<float>(face_->size->metrics.height) / upsample_;
+
+  // glyphs are rasterized as they're needed -- we only need the space up front,
+  // for characters which don't draw anything.
+  space_advance_ = 0.0f;
+  e = FT_Load_Glyph(face_, FT_Get_Char_Index(face_, ' '), FT_LOAD_DEFAULT);
+  if (e) {
+    BOOST_LOG_TRIVIAL(warning) << "Could not load space -- skipping...";
+  } else {
+    space_advance_ = static_cast<float>(face_->glyph->advance.x) / upsample_;
+  }
+
+#ifdef MONKEYSWORLD_HARFBUZZ
+  shaper_ = std::make_unique<HarfBuzzShaper>();
+#else
+  shaper_ = std::make_unique<KerningShaper>();
+#endif
+
+  rasterizer_ = std::make_unique<GlyphRasterizer>(mode_, upsample_, glyph_padding_);
+  if (atlas_cache != nullptr && LoadAtlas(*atlas_cache)) {
+    BOOST_LOG_TRIVIAL(trace) << "read " << glyph_cache_.size() << " glyphs from the atlas cache";
+  }
+
+  if (mode_ == GlyphMode::SDF) {
+    // fonts are usually loaded off the main thread -- get the expensive part out of the way here
+    std::vector<FT_UInt> glyphs;
+    for (char c = 0x21; c <= 0x7e; c++) {
+      glyphs.push_back(FT_Get_Char_Index(face_, c));
     }
 
-    e = FT_New_Face(ft_lib_->lib, font_path.c_str(), 0, &face);
-    BOOST_LOG_TRIVIAL(trace) << font_path;
-    if (e) {
-      // complain some more :/
-      BOOST_LOG_TRIVIAL(error) << "Could not create new face";
-      throw BadFontPathException("Could not create new face");
+    RasterizeGlyphs(glyphs, pool);
+  }
+}
+
+void Font::RasterizeGlyphs(const std::vector<FT_UInt>& glyphs, std::shared_ptr<LoaderThreadPool> pool) {
+  std::lock_guard<std::mutex> lock(glyph_lock_);
+  auto job = std::make_shared<raster_job>();
+  job->font_data = font_data_;
+  job->face_size = glyph_scale_ * upsample_;
+  job->mode = mode_;
+  job->upsample = upsample_;
+  job->padding = glyph_padding_;
+  for (auto glyph : glyphs) {
+    if (glyph_cache_.find(glyph) == glyph_cache_.end()) {
+      job->glyphs.push_back(glyph);
     }
+  }
 
+  std::sort(job->glyphs.begin(), job->glyphs.end());
+  job->glyphs.erase(std::unique(job->glyphs.begin(), job->glyphs.end()), job->glyphs.end());
+  if (job->glyphs.empty()) {
+    return;
   }
 
-  ascent_ = static_cast<float>(face->size->metrics.ascender);
+  // a few chunks per thread, so that threads which start late still have something to do
+  size_t threads = (pool != nullptr ? static_cast<size_t>(pool->GetThreadCount()) : 0) + 1;
+  size_t chunks = std::min(job->glyphs.size(), threads * 4);
+  job->chunk_size = (job->glyphs.size() + chunks - 1) / chunks;
+  job->chunk_count = (job->glyphs.size() + job->chunk_size - 1) / job->chunk_size;
+  job->results.resize(job->glyphs.size());
+  job->next_chunk = 0;
+  job->chunks_done = 0;
+
+  for (size_t i = 1; i < std::min(threads, job->chunk_count); i++) {
+    pool->AddTaskToQueue([job] { RunRasterJob(job.get(), nullptr); });
+  }
 
-  // what should char size be?
-  // let's go with 256px for now
-  e = FT_Set_Char_Size(face, 0, bitmap_desired_scale * 64, 72, 72);
-  
-  line_height_ = static_cast<float>(face->size->metrics.height);
+  // work through the job here as well -- the pool might be busy, or we might be one of its tasks
+  RunRasterJob(job.get(), face_);
+  {
+    std::unique_lock<std::mutex> job_lock(job->lock);
+    job->done_cond.wait(job_lock, [&] { return job->chunks_done == job->chunk_count; });
+  }
 
-  // create an array of glyphs we can use from here on out
+  for (auto& rendered : job->results) {
+    glyph_cache_.insert(std::make_pair(rendered.glyph, PackGlyph(rendered)));
+  }
+}
 
-  glyph_cache_ = new glyph_info[glyph_upper_ - glyph_lower_ + 1];
+bool Font::LoadAtlas(const GlyphAtlasCache& cache) {
+  std::lock_guard<std::mutex> lock(glyph_lock_);
+  baked_atlas atlas;
+  if (!cache.ReadAtlas(GetAtlasKey(), &atlas)) {
+    return false;
+  }
 
-  // figure out amount of space needed for chars
-  // wrap, and 1px of space on either side to avoid artefacts of storage method
+  if (atlas.width != atlas_width_ || atlas.height < MIN_ATLAS_HEIGHT || atlas.height > MAX_ATLAS_HEIGHT) {
+    BOOST_LOG_TRIVIAL(warning) << "Cached glyph atlas doesn't fit this font -- rasterizing instead";
+    return false;
+  }
 
+  glyph_cache_.clear();
+  for (auto& glyph : atlas.glyphs) {
+    glyph.second.last_used = use_tick_;
+    glyph_cache_.insert(glyph);
+  }
 
-  unsigned int width_px  = 0;
-  unsigned int height_px = 0;
-  FT_GlyphSlot temp_glyph = nullptr;
-  FT_UInt glyph_index;
-  for (char i = glyph_lower_; i <= glyph_upper_; i++) {
-    glyph_index = FT_Get_Char_Index(face, i);
-    e = FT_Load_Glyph(face, glyph_index, FT_LOAD_DEFAULT);
-    if (e) {
-      BOOST_LOG_TRIVIAL(warning) << "Could not load char " << i << " -- skipping...";
-      continue;
-    }
+  // already laid out the way the texture wants it -- uploaded as is
+  atlas_data_ = std::move(atlas.data);
+  atlas_height_ = atlas.height;
+  packer_.SetShelves(atlas.shelves);
+  MarkDirty(glm::ivec2(0), glm::ivec2(atlas_width_, static_cast<int>(atlas_data_.size() / atlas_width_)));
+  generation_++;
+  return true;
+}
 
-    temp_glyph = face->glyph;
-    height_px = std::max(height_px, temp_glyph->bitmap.rows);
-    width_px += (temp_glyph->bitmap.width + 1);
+uint64_t Font::GetAtlasKey() const {
+  if (!atlas_key_valid_) {
+    atlas_key_ = GlyphAtlasCache::GetAtlasKey(*font_data_, mode_, glyph_scale_, upsample_, glyph_padding_, atlas_width_);
+    atlas_key_valid_ = true;
   }
 
-  // ensure that vertical wrap is not a problem
-  height_px++;
+  return atlas_key_;
+}
 
-  BOOST_LOG_TRIVIAL(trace) << "tex size: " << width_px << " x " << height_px;
-  
-  atlas_width = width_px;
-  atlas_height = height_px;
+glyph_info* Font::GetGlyph(FT_UInt glyph_index) const {
+  auto i = glyph_cache_.find(glyph_index);
+  if (i == glyph_cache_.end()) {
+    i = glyph_cache_.insert(std::make_pair(glyph_index, RasterizeGlyph(glyph_index))).first;
+  }
 
-  // create our in-memory store
-  memory_cache_ = new char[atlas_width * atlas_height];
+  i->second.last_used = use_tick_;
+  return &i->second;
+}
 
-  BOOST_LOG_TRIVIAL(trace) << "allocated " << atlas_width * atlas_height << " bytes for cache";
-  // go through the font list again, this time drawing on to the screen
+glyph_info Font::RasterizeGlyph(FT_UInt glyph_index) const {
+  rasterizer_->Render(face_, glyph_index, &render_scratch_);
+  return PackGlyph(render_scratch_);
+}
 
-  width_px = 0;
+glyph_info Font::PackGlyph(const rendered_glyph& rendered) const {
+  glyph_info res = {};
+  res.last_used = use_tick_;
+  if (!rendered.valid) {
+    BOOST_LOG_TRIVIAL(warning) << "Could not load glyph " << rendered.glyph << " -- skipping...";
+    res.advance = space_advance_;
+    res.valid = false;
+    return res;
+  }
 
-  glyph_info temp_info;
+  res.advance = rendered.advance;
+  res.valid = true;
+  atlas_changed_ = true;
+  if (rendered.size.x == 0 || rendered.size.y == 0) {
+    // nothing to draw
+    return res;
+  }
 
-  for (char i = glyph_lower_; i <= glyph_upper_; i++) {
-    glyph_index = FT_Get_Char_Index(face, i);
-    e = FT_Load_Glyph(face, glyph_index, FT_LOAD_RENDER);
-    if (e) {
-      // should have already been handled.
-      temp_info.valid = false;
-      glyph_cache_[i - glyph_lower_] = temp_info;
-      continue;
+  glm::ivec2 packed_size = rendered.size;
+  res.bearing_x = rendered.bearing_x;
+  res.bearing_y = rendered.bearing_y;
+  res.width = packed_size.x - 2 * glyph_padding_;
+  res.height = packed_size.y - 2 * glyph_padding_;
+
+  glm::ivec2 pos;
+  if (!packer_.Pack(packed_size, &pos)) {
+    if (!EvictGlyphs() || !packer_.Pack(packed_size, &pos)) {
+      BOOST_LOG_TRIVIAL(warning) << "Glyph atlas is full -- skipping glyph " << rendered.glyph << "...";
+      res.width = 0;
+      res.height = 0;
+      res.valid = false;
+      return res;
     }
+  }
 
-    // check bitmap format
-    if (temp_glyph->format != FT_GLYPH_FORMAT_BITMAP) {
-      FT_Render_Glyph(temp_glyph, FT_RENDER_MODE_NORMAL);
-    }
+  res.atlas_x = pos.x + glyph_padding_;
+  res.atlas_y = pos.y + glyph_padding_;
 
-    temp_info.valid = true;
-    temp_glyph = face->glyph;
-   
-    // write to memory store
-    int cursor_x;
-    int cursor_y;
-    if (temp_glyph->bitmap.pitch > 0) {
-      cursor_x = width_px;
-      cursor_y = 0;
-      for (uint32_t i = 0; i < temp_glyph->bitmap.rows; i++, cursor_y++) {
-        for (uint32_t j = 0; j < temp_glyph->bitmap.width; j++) {
-          memory_cache_[cursor_y * atlas_width + cursor_x + j]
-            = temp_glyph->bitmap.buffer[i * temp_glyph->bitmap.pitch + j];
-        }
-      }
-    } else {
-      cursor_x = width_px;
-      cursor_y = height_px - temp_glyph->bitmap.rows;
-      for (int i = 0; cursor_y < atlas_height; cursor_y++, i++) {
-        for (uint32_t j = 0; j < temp_glyph->bitmap.width; j++) {
-          memory_cache_[cursor_y * atlas_width + cursor_x + j]
-            = temp_glyph->bitmap.buffer[j - (i * temp_glyph->bitmap.pitch)];
-        }
-      }
+  int used_height = packer_.GetUsedHeight();
+  if (atlas_data_.size() < static_cast<size_t>(used_height * atlas_width_)) {
+    atlas_data_.resize(used_height * atlas_width_, 0);
+  }
+
+  if (used_height > atlas_height_) {
+    while (atlas_height_ < used_height) {
+      atlas_height_ *= 2;
     }
 
-    // add glyph data to the glyph info
-    temp_info.advance = static_cast<float>(temp_glyph->advance.x);
+    // texcoords are normalized to the atlas height
+    generation_++;
+  }
 
-    temp_info.bearing_x = temp_glyph->bitmap_left;
-    temp_info.bearing_y = temp_glyph->bitmap_top;
+  // write to memory store
+  for (int i = 0; i < packed_size.y; i++) {
+    auto row = rendered.pixels.begin() + i * packed_size.x;
+    std::copy(row, row + packed_size.x, atlas_data_.begin() + (pos.y + i) * atlas_width_ + pos.x);
+  }
 
-    temp_info.width = temp_glyph->bitmap.width;
-    temp_info.height = temp_glyph->bitmap.rows;
+  MarkDirty(pos, pos + packed_size);
+  return res;
+}
 
-    temp_info.origin_x = ((float)width_px / atlas_width);
+bool Font::EvictGlyphs() const {
+  // most recently used first
+  std::vector<std::pair<uint64_t, FT_UInt>> resident;
+  for (auto& g : glyph_cache_) {
+    if (g.second.valid && g.second.width > 0 && g.second.height > 0) {
+      resident.push_back(std::make_pair(g.second.last_used, g.first));
+    }
+  }
 
-    glyph_cache_[i - glyph_lower_] = temp_info;
+  std::sort(resident.begin(), resident.end(), std::greater<std::pair<uint64_t, FT_UInt>>());
+  size_t keep = resident.size() / 2;
+  while (keep < resident.size() && resident[keep].first == use_tick_) {
+    // in use right now
+    keep++;
+  }
 
-    width_px += (temp_glyph->bitmap.width + 1);
+  if (keep == resident.size()) {
+    return false;
   }
 
-  /**
-   * TODO: can we be done with the face after ctor?
-   * If so: we still want to keep the lib shared ptr
-   * because it saves us lib constructions, the point is solely
-   * to ensure that we have a lib to start, and destroy it before we're done.
-   */
-  {
-    std::lock_guard<std::mutex> lock(ft_lib_lock_);
-    FT_Done_Face(face);
+  // plan the repack before touching anything, so that giving up leaves the atlas as it was
+  utils::ShelfPacker repacked = packer_;
+  repacked.Clear();
+  std::vector<glm::ivec2> positions(keep);
+  size_t evicted = resident.size() - keep;
+  for (size_t i = 0; i < keep; i++) {
+    const glyph_info& info = glyph_cache_.find(resident[i].second)->second;
+    glm::ivec2 size(info.width + 2 * glyph_padding_, info.height + 2 * glyph_padding_);
+    if (!repacked.Pack(size, &positions[i])) {
+      if (resident[i].first == use_tick_) {
+        // text being written right now may already point at it
+        return false;
+      }
+
+      positions[i] = glm::ivec2(-1);
+      evicted++;
+    }
   }
-  
+
+  // repack survivors into a fresh buffer
+  std::vector<uint8_t> old_data;
+  old_data.swap(atlas_data_);
+  packer_ = repacked;
+  int used_height = packer_.GetUsedHeight();
+  while (atlas_height_ < used_height) {
+    atlas_height_ *= 2;
+  }
+
+  atlas_data_.resize(static_cast<size_t>(atlas_height_) * atlas_width_, 0);
+  for (size_t i = 0; i < resident.size(); i++) {
+    auto g = glyph_cache_.find(resident[i].second);
+    if (i >= keep || positions[i].x < 0) {
+      glyph_cache_.erase(g);
+      continue;
+    }
+
+    glyph_info& info = g->second;
+    glm::ivec2 size(info.width + 2 * glyph_padding_, info.height + 2 * glyph_padding_);
+    glm::ivec2 pos = positions[i];
+    glm::ivec2 old_pos(info.atlas_x - glyph_padding_, info.atlas_y - glyph_padding_);
+    for (int y = 0; y < size.y; y++) {
+      auto src = old_data.begin() + (old_pos.y + y) * atlas_width_ + old_pos.x;
+      std::copy(src, src + size.x, atlas_data_.begin() + (pos.y + y) * atlas_width_ + pos.x);
+    }
+
+    info.atlas_x = pos.x + glyph_padding_;
+    info.atlas_y = pos.y + glyph_padding_;
+  }
+
+  BOOST_LOG_TRIVIAL(trace) << "evicted " << evicted << " glyphs";
+  // everything moved -- clear out the rest of the atlas too
+  MarkDirty(glm::ivec2(0), glm::ivec2(atlas_width_, atlas_height_));
+  generation_++;
+  atlas_changed_ = true;
+  return true;
+}
+
+void Font::MarkDirty(glm::ivec2 min, glm::ivec2 max) const {
+  dirty_min_ = glm::min(dirty_min_, min);
+  dirty_max_ = glm::max(dirty_max_, max);
 }
 
 // advance is stored in 1/64 pixels
 #define ADVANCE_SCALE 64.0f
 
-model::Mesh<storage::VertexPacket2D> Font::GetTextGeometry(const std::string& text, float size_pt, TextFormat opts) const {
-  // scales our fonts down to screenspace scale (roughly:)
-  const float SCREENSPACE_FAC = (960.0f * bitmap_desired_scale) / size_pt;
-  
-  Mesh<VertexPacket2D> result;
-  float origin_x = 0.0f;
-  float origin_y = 0.0f;
-  // bitmap, bearing are in pixels
-  // advance is in 1/64 pixels.
+static uint64_t FloatBits(float f) {
+  uint32_t res;
+  std::memcpy(&res, &f, sizeof(res));
+  return res;
+}
 
-  // origin of glyph, in object space
-  float glyph_origin_x;
-  float glyph_origin_y;
+static uint64_t HashShape(const std::string& text, float size_pt, const TextFormat& opts) {
+  uint64_t res = std::hash<std::string>()(text);
+  res = HashCombine(res, FloatBits(size_pt));
+  res = HashCombine(res, static_cast<uint64_t>(opts.horiz_align));
+  res = HashCombine(res, static_cast<uint64_t>(opts.vert_align));
+  res = HashCombine(res, FloatBits(opts.char_spacing));
+  return res;
+}
 
-  // texture width and height
-  float tex_width;
-  float tex_height;
+/**
+ *  @returns the end of the bytes which decided the codepoint between `start` and `index`.
+ */
+static size_t ReadEnd(const std::string& text, size_t start, size_t index) {
+  if (index - start == 1 && static_cast<unsigned char>(text[start]) >= 0x80) {
+    // malformed, and may have looked at up to three more bytes to find out
+    return start + 4;
+  }
 
-  // geometry width and height
-  float geom_width;
-  float geom_height;
+  return index;
+}
 
-  // for rearranging lines later
-  float y_min = 0, y_max = 0;
+static bool SameShape(const shaped_text& shaped, const std::string& text, float size_pt, const TextFormat& opts) {
+  return (shaped.size_pt == size_pt
+       && shaped.format.horiz_align == opts.horiz_align
+       && shaped.format.vert_align == opts.vert_align
+       && shaped.format.char_spacing == opts.char_spacing
+       && shaped.text == text);
+}
 
-  glyph_info* info;
+model::Mesh<storage::VertexPacket2D> Font::GetTextGeometry(const std::string& text, float size_pt, TextFormat opts) const {
+  auto shaped = ShapeText(text, size_pt, opts);
+  size_t count = shaped->glyphs.size();
+  std::vector<VertexPacket2D> vertices(count * 4);
+  std::vector<unsigned int> indices(count * 6);
+  WriteTextGeometry(*shaped, vertices.data());
+  for (unsigned int i = 0; i < count; i++) {
+    unsigned int* quad = &indices[i * 6];
+    quad[0] = i * 4;
+    quad[1] = i * 4 + 1;
+    quad[2] = i * 4 + 2;
+    quad[3] = i * 4 + 2;
+    quad[4] = i * 4 + 3;
+    quad[5] = i * 4;
+  }
 
-  // for alignment: determines when the last line began.
-  int last_line_start = 0;
+  Mesh<VertexPacket2D> result;
+  result.SwapData(vertices, indices);
+  return result;
+}
 
-  int cur = 0;
-  for (auto c : text) {
-    if (c == '\n') {
-      origin_x = 0;
-      // center all characters recorded thus far
-      float x_width = 0;
-      if (cur > 0) {
-        x_width = result[(cur - 1) * 4 + 3].position.x;
-      }
+std::shared_ptr<const shaped_text> Font::ShapeText(const std::string& text, float size_pt, TextFormat opts,
+                                                   const shaped_text* hint) const {
+  uint64_t key = HashShape(text, size_pt, opts);
+  std::lock_guard<std::mutex> lock(glyph_lock_);
+  shape_tick_++;
+  auto range = shape_cache_.equal_range(key);
+  for (auto i = range.first; i != range.second; i++) {
+    if (SameShape(*i->second.shaped, text, size_pt, opts)) {
+      i->second.last_used = shape_tick_;
+      return i->second.shaped;
+    }
+  }
 
-      switch (opts.horiz_align) {
-        case CENTER:
-          x_width /= 2;
-        case RIGHT:
-          break;
-        case LEFT:
-        default:
-          x_width = 0;
-          break;
-      }
+  auto res = std::make_shared<shaped_text>();
+  res->text = text;
+  res->size_pt = size_pt;
+  res->format = opts;
+  if (batch_depth_ == 0) {
+    use_tick_++;
+  }
 
-      for (int i = last_line_start * 4; i < cur * 4; i++) {
-        result[i].position.x -= x_width;
-      }
+  Shape(hint, res.get());
 
-      last_line_start = cur;
+  if (shape_cache_.size() >= SHAPE_CACHE_SIZE) {
+    // drop the least recently used half
+    std::vector<uint64_t> ticks;
+    ticks.reserve(shape_cache_.size());
+    for (auto& entry : shape_cache_) {
+      ticks.push_back(entry.second.last_used);
+    }
 
-      origin_y -= (line_height_ / (SCREENSPACE_FAC * ADVANCE_SCALE)); 
-      continue;
-    } else if (c < glyph_lower_ || c > glyph_upper_) {
-      // skip, make space
-      origin_x += (glyph_cache_[0].advance + opts.char_spacing) / (SCREENSPACE_FAC * ADVANCE_SCALE);
-      continue;
+    auto median = ticks.begin() + ticks.size() / 2;
+    std::nth_element(ticks.begin(), median, ticks.end());
+    uint64_t cutoff = *median;
+    for (auto i = shape_cache_.begin(); i != shape_cache_.end();) {
+      if (i->second.last_used < cutoff) {
+        i = shape_cache_.erase(i);
+      } else {
+        i++;
+      }
     }
+  }
 
-    info = &glyph_cache_[c - glyph_lower_];
-    glyph_origin_x = origin_x + (info->bearing_x / SCREENSPACE_FAC);
-    glyph_origin_y = origin_y + (info->bearing_y / SCREENSPACE_FAC);
+  shape_cache_entry entry;
+  entry.shaped = res;
+  entry.last_used = shape_tick_;
+  shape_cache_.insert(std::make_pair(key, entry));
+  return res;
+}
 
-    tex_width = ((float)info->width) / atlas_width;
-    tex_height = ((float)info->height) / atlas_height;
+void Font::Shape(const shaped_text* hint, shaped_text* res) const {
+  // scales our fonts down to screenspace scale (roughly:)
+  const float SCREENSPACE_FAC = (960.0f * glyph_scale_) / res->size_pt;
+  const std::string& text = res->text;
 
-    geom_width = info->width / SCREENSPACE_FAC;
-    geom_height = info->height / SCREENSPACE_FAC;
+  // bitmap, bearing are in pixels
+  // advance is in 1/64 pixels.
+  shape_checkpoint state = {};
 
-    if (glyph_origin_y > y_max) {
-      y_max = glyph_origin_y;
+  if (hint != nullptr && hint->size_pt == res->size_pt && hint->format.char_spacing == res->format.char_spacing) {
+    size_t common = 0;
+    size_t max_common = std::min(text.size(), hint->text.size());
+    while (common < max_common && text[common] == hint->text[common]) {
+      common++;
     }
 
-    if (glyph_origin_y - geom_height < y_min) {
-      y_min = glyph_origin_y;
+    // safe_end only grows, so this finds the last codepoint which couldn't have seen the difference
+    auto end = std::upper_bound(hint->checkpoints.begin(), hint->checkpoints.end(), common,
+                                [](size_t value, const shape_checkpoint& c) { return value < c.safe_end; });
+    if (end != hint->checkpoints.begin()) {
+      state = *(end - 1);
+      res->checkpoints.assign(hint->checkpoints.begin(), end);
+      res->glyphs.assign(hint->glyphs.begin(), hint->glyphs.begin() + state.glyph_count);
     }
+  }
 
-    result.AddVertex({glm::vec2(glyph_origin_x, glyph_origin_y),                            glm::vec2(info->origin_x, 0.0f)});
-    result.AddVertex({glm::vec2(glyph_origin_x, glyph_origin_y - geom_height),              glm::vec2(info->origin_x, tex_height)});
-    result.AddVertex({glm::vec2(glyph_origin_x + geom_width, glyph_origin_y - geom_height), glm::vec2(info->origin_x + tex_width, tex_height)});
-    result.AddVertex({glm::vec2(glyph_origin_x + geom_width, glyph_origin_y),               glm::vec2(info->origin_x + tex_width, 0.0f)});
-    result.AddPolygon(cur * 4, cur * 4 + 1, cur * 4 + 2);
-    result.AddPolygon(cur * 4 + 2, cur * 4 + 3, cur * 4);
-
-    cur++;
+  res->checkpoints.reserve(text.size());
+  size_t index = state.offset;
+  while (index < text.size()) {
+    // gather a run -- everything up to the next control character
+    run_codepoints_.clear();
+    run_ends_.clear();
+    uint32_t c = 0;
+    size_t start = index;
+    while (index < text.size()) {
+      start = index;
+      c = NextCodepoint(text, &index);
+      if (c < 0x20) {
+        break;
+      }
 
-    origin_x += (info->advance / (SCREENSPACE_FAC * ADVANCE_SCALE));
-  }
+      run_codepoints_.push_back(c);
+      run_ends_.push_back(std::make_pair(index, ReadEnd(text, start, index)));
+    }
 
-  if (cur != last_line_start) {
-    float x_width = 0;
-    if (cur > 0) {
-      x_width = result[(cur - 1) * 4 + 3].position.x;
+    if (!run_codepoints_.empty()) {
+      // whatever ends the run has a say in how it ends -- the end of the string included
+      size_t run_end = (c < 0x20 ? start : index);
+      PlaceRun(run_end + 1, res, &state);
     }
 
-    switch (opts.horiz_align) {
-      case CENTER:
-        x_width /= 2;
-      case RIGHT:
-        break;
-      case LEFT:
-      default:
-        x_width = 0;
-        break;
+    if (c >= 0x20) {
+      // string ended on the run
+      break;
     }
 
-    for (int i = last_line_start * 4; i < cur * 4; i++) {
-      result[i].position.x -= x_width;
+    state.offset = index;
+    state.safe_end = std::max(state.safe_end, index);
+    if (c == '\n') {
+      state.pen.x = 0;
+      state.pen.y -= (line_height_ / (SCREENSPACE_FAC * ADVANCE_SCALE));
+      state.line++;
+    } else {
+      // skip, make space
+      state.pen.x += (space_advance_ + res->format.char_spacing) / (SCREENSPACE_FAC * ADVANCE_SCALE);
     }
 
-    last_line_start = cur;
+    res->checkpoints.push_back(state);
+  }
+
+  // lines are aligned on their last glyph
+  res->line_offsets.assign(state.line + 1, 0.0f);
+  if (res->format.horiz_align == CENTER || res->format.horiz_align == RIGHT) {
+    float fac = (res->format.horiz_align == CENTER ? 0.5f : 1.0f);
+    for (auto& glyph : res->glyphs) {
+      res->line_offsets[glyph.line] = (glyph.origin.x + glyph.size.x) * fac;
+    }
   }
 
-  float v_alignment_offset;
-  switch (opts.vert_align) {
+  switch (res->format.vert_align) {
     case TOP:
-      v_alignment_offset = y_max;
+      res->y_offset = state.y_max;
       break;
     case MIDDLE:
-      v_alignment_offset = (y_max + y_min) / 2;
+      res->y_offset = (state.y_max + state.y_min) / 2;
       break;
     case BOTTOM:
-      v_alignment_offset = y_min;
+      res->y_offset = state.y_min;
       break;
     case DEFAULT:
     default:
-      v_alignment_offset = 0;
+      res->y_offset = 0;
   }
+}
 
-  for (int i = 0; i < result.GetVertexCount(); i++) {
-    result[i].position.y -= v_alignment_offset;
+void Font::PlaceRun(size_t context_end, shaped_text* res, shape_checkpoint* state) const {
+  const float SCREENSPACE_FAC = (960.0f * glyph_scale_) / res->size_pt;
+  // shapers work at the size glyphs are rasterized at
+  const float SHAPER_SCALE = 1.0f / (SCREENSPACE_FAC * ADVANCE_SCALE * upsample_);
+  shaper_->ShapeRun(face_, run_codepoints_.data(), run_codepoints_.size(), &run_glyphs_);
+  int lookahead = shaper_->GetLookahead();
+  size_t count = run_codepoints_.size();
+
+  for (size_t i = 0; i < run_glyphs_.size(); i++) {
+    const run_glyph& placed = run_glyphs_[i];
+    glyph_info* info = GetGlyph(placed.glyph);
+    if (info->valid && info->width != 0 && info->height != 0) {
+      shaped_glyph glyph;
+      glyph.glyph = placed.glyph;
+      glyph.origin = glm::vec2(state->pen.x + placed.offset.x * SHAPER_SCALE + (info->bearing_x / SCREENSPACE_FAC),
+                               state->pen.y + placed.offset.y * SHAPER_SCALE + (info->bearing_y / SCREENSPACE_FAC));
+      glyph.size = glm::vec2(info->width / SCREENSPACE_FAC, info->height / SCREENSPACE_FAC);
+      glyph.line = state->line;
+
+      if (glyph.origin.y > state->y_max) {
+        state->y_max = glyph.origin.y;
+      }
+
+      if (glyph.origin.y - glyph.size.y < state->y_min) {
+        state->y_min = glyph.origin.y;
+      }
+
+      res->glyphs.push_back(glyph);
+      state->glyph_count++;
+    }
+
+    if (info->valid) {
+      state->pen.x += placed.advance * SHAPER_SCALE;
+    } else {
+      state->pen.x += (info->advance / (SCREENSPACE_FAC * ADVANCE_SCALE));
+    }
+
+    if (lookahead >= 0) {
+      // one glyph per codepoint -- resumable once the codepoints which could move this one are decided
+      size_t peek = i + static_cast<size_t>(lookahead);
+      state->offset = run_ends_[i].first;
+      state->safe_end = std::max(state->safe_end, run_ends_[i].second);
+      state->safe_end = std::max(state->safe_end, (peek < count ? run_ends_[peek].second : context_end));
+      res->checkpoints.push_back(*state);
+    } else if (i + 1 == run_glyphs_.size() || run_glyphs_[i + 1].cluster > placed.cluster) {
+      // a caret stop at the end of each cluster. the end of the run is just as safe, and comes later,
+      // so shaping never resumes from the middle of a run.
+      size_t next = (i + 1 < run_glyphs_.size() ? run_glyphs_[i + 1].cluster : count);
+      state->offset = run_ends_[next - 1].first;
+      state->safe_end = std::max(state->safe_end, context_end);
+      res->checkpoints.push_back(*state);
+    }
   }
 
-  // account for vertical alignment
+  if (lookahead < 0) {
+    // anything could have moved anything else, so the run is only reusable as a whole
+    state->offset = run_ends_[count - 1].first;
+    state->safe_end = std::max(state->safe_end, context_end);
+  }
+}
 
-  return result;
+void Font::WriteTextGeometry(const shaped_text& shaped, VertexPacket2D* out) const {
+  std::lock_guard<std::mutex> lock(glyph_lock_);
+  if (batch_depth_ == 0) {
+    use_tick_++;
+  }
+
+  // glyphs can move around as the atlas fills up, so texcoords are filled in once they're all in
+  quad_scratch_.resize(shaped.glyphs.size());
+  for (size_t i = 0; i < shaped.glyphs.size(); i++) {
+    quad_scratch_[i] = GetGlyph(shaped.glyphs[i].glyph);
+  }
+
+  for (size_t i = 0; i < shaped.glyphs.size(); i++) {
+    const shaped_glyph& glyph = shaped.glyphs[i];
+    const glyph_info* info = quad_scratch_[i];
+    float left = glyph.origin.x - shaped.line_offsets[glyph.line];
+    float top = glyph.origin.y - shaped.y_offset;
+    float right = left + glyph.size.x;
+    float bottom = top - glyph.size.y;
+
+    float tex_left = static_cast<float>(info->atlas_x) / atlas_width_;
+    float tex_right = static_cast<float>(info->atlas_x + info->width) / atlas_width_;
+    float tex_top = static_cast<float>(info->atlas_y) / atlas_height_;
+    float tex_bottom = static_cast<float>(info->atlas_y + info->height) / atlas_height_;
+
+    VertexPacket2D* quad = out + i * 4;
+    quad[0] = {glm::vec2(left, top),      glm::vec2(tex_left, tex_top)};
+    quad[1] = {glm::vec2(left, bottom),   glm::vec2(tex_left, tex_bottom)};
+    quad[2] = {glm::vec2(right, bottom),  glm::vec2(tex_right, tex_bottom)};
+    quad[3] = {glm::vec2(right, top),     glm::vec2(tex_right, tex_top)};
+  }
+}
+
+void Font::BeginBatch() const {
+  std::lock_guard<std::mutex> lock(glyph_lock_);
+  if (batch_depth_++ == 0) {
+    use_tick_++;
+  }
+}
+
+void Font::EndBatch() const {
+  std::lock_guard<std::mutex> lock(glyph_lock_);
+  batch_depth_--;
+}
+
+text_metrics Font::MeasureText(const shaped_text& shaped) const {
+  text_metrics res;
+  res.line_count = static_cast<uint32_t>(shaped.line_offsets.size());
+  if (shaped.glyphs.empty()) {
+    res.min = glm::vec2(0);
+    res.max = glm::vec2(0);
+    return res;
+  }
+
+  // same corners as WriteTextGeometry
+  res.min = glm::vec2(std::numeric_limits<float>::max());
+  res.max = glm::vec2(std::numeric_limits<float>::lowest());
+  for (auto& glyph : shaped.glyphs) {
+    glm::vec2 top_left(glyph.origin.x - shaped.line_offsets[glyph.line], glyph.origin.y - shaped.y_offset);
+    res.min = glm::min(res.min, glm::vec2(top_left.x, top_left.y - glyph.size.y));
+    res.max = glm::max(res.max, glm::vec2(top_left.x + glyph.size.x, top_left.y));
+  }
+
+  return res;
+}
+
+text_metrics Font::MeasureText(const std::string& text, float size_pt, TextFormat opts) const {
+  return MeasureText(*ShapeText(text, size_pt, opts));
+}
+
+glm::vec2 Font::GetCaretPosition(const shaped_text& shaped, size_t offset) const {
+  // last stop at or before the caret
+  auto stop = std::upper_bound(shaped.checkpoints.begin(), shaped.checkpoints.end(), offset,
+                               [](size_t value, const shape_checkpoint& c) { return value < c.offset; });
+  if (stop == shaped.checkpoints.begin()) {
+    return glm::vec2(-shaped.line_offsets[0], -shaped.y_offset);
+  }
+
+  const shape_checkpoint& c = *(stop - 1);
+  return glm::vec2(c.pen.x - shaped.line_offsets[c.line], c.pen.y - shaped.y_offset);
+}
+
+void Font::FindLineBreaks(const shaped_text& shaped, float max_width, std::vector<size_t>* breaks) const {
+  breaks->clear();
+  const std::string& text = shaped.text;
+  float line_start = 0.0f;
+  // last whitespace on this line, and where the line would start if we broke there
+  size_t candidate = std::string::npos;
+  float candidate_pen = 0.0f;
+  size_t start = 0;
+  for (auto& c : shaped.checkpoints) {
+    char first = text[start];
+    if (first == '\n') {
+      line_start = 0.0f;
+      candidate = std::string::npos;
+    } else if (first == ' ' || first == '\t') {
+      candidate = start;
+      candidate_pen = c.pen.x;
+    } else if (c.pen.x - line_start > max_width && candidate != std::string::npos) {
+      breaks->push_back(candidate);
+      line_start = candidate_pen;
+      candidate = std::string::npos;
+    }
+
+    start = c.offset;
+  }
+}
+
+std::string Font::WrapText(const std::string& text, float size_pt, TextFormat opts, float max_width) const {
+  std::vector<size_t> breaks;
+  FindLineBreaks(*ShapeText(text, size_pt, opts), max_width, &breaks);
+  std::string res = text;
+  for (auto offset : breaks) {
+    res[offset] = '\n';
+  }
+
+  return res;
 }
 
 GLuint Font::GetGlyphAtlas() const {
   // assume that this is being done so that we can performs some action on this value
   // and that someone isn't fucking around with me
+  std::lock_guard<std::mutex> lock(glyph_lock_);
+  if (glyph_texture_ == 0 || texture_height_ != atlas_height_) {
+    // (re)allocate, and upload everything we have
+    if (glyph_texture_ == 0) {
+      glGenTextures(1, &glyph_texture_);
+    }
 
-  // upload the glyph atlas (we need it now, after all)
-  if (memory_cache_ != nullptr) {
-    // hasnt been uploaded yet :)
-    // TBA: i could lock this, but all calls should be on the same thread, so no need.
-    GLuint* glyph_texture = const_cast<GLuint*>(&glyph_texture_);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    glGenTextures(1, glyph_texture);
-    glBindTexture(GL_TEXTURE_2D, *glyph_texture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, atlas_width, atlas_height, 0, GL_RED, GL_UNSIGNED_BYTE, memory_cache_);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glBindTexture(GL_TEXTURE_2D, glyph_texture_);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, atlas_width_, atlas_height_, 0, GL_RED, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    // unbind, not for any good reason but just because it makes me feel better
-    glBindTexture(GL_TEXTURE_2D, 0);
-    delete[] memory_cache_;
-    char** memcache = const_cast<char**>(&memory_cache_);
-    *memcache = nullptr;
+    texture_height_ = atlas_height_;
+    dirty_min_ = glm::ivec2(0);
+    dirty_max_ = glm::ivec2(atlas_width_, static_cast<int>(atlas_data_.size() / atlas_width_));
   }
+
+  if (dirty_min_.x < dirty_max_.x && dirty_min_.y < dirty_max_.y) {
+    // only upload the part which changed
+    glBindTexture(GL_TEXTURE_2D, glyph_texture_);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, atlas_width_);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, dirty_min_.x, dirty_min_.y,
+                    dirty_max_.x - dirty_min_.x, dirty_max_.y - dirty_min_.y,
+                    GL_RED, GL_UNSIGNED_BYTE, atlas_data_.data() + dirty_min_.y * atlas_width_ + dirty_min_.x);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+  }
+
+  dirty_min_ = glm::ivec2(atlas_width_, MAX_ATLAS_HEIGHT);
+  dirty_max_ = glm::ivec2(0);
+  // unbind, not for any good reason but just because it makes me feel better
+  glBindTexture(GL_TEXTURE_2D, 0);
   return glyph_texture_;
 }
 
-Font::~Font() {
-  if (glyph_cache_) {
-    delete[] glyph_cache_;
+uint64_t Font::GetAtlasGeneration() const {
+  std::lock_guard<std::mutex> lock(glyph_lock_);
+  return generation_;
+}
+
+GlyphMode Font::GetGlyphMode() const {
+  return mode_;
+}
+
+glm::ivec2 Font::GetAtlasDimensions() const {
+  std::lock_guard<std::mutex> lock(glyph_lock_);
+  return glm::ivec2(atlas_width_, atlas_height_);
+}
+
+void Font::SetShaper(std::unique_ptr<Shaper> shaper) {
+  std::lock_guard<std::mutex> lock(glyph_lock_);
+  shaper_ = std::move(shaper);
+  shape_cache_.clear();
+}
+
+bool Font::StoreAtlas(const GlyphAtlasCache& cache) const {
+  std::lock_guard<std::mutex> lock(glyph_lock_);
+  if (!atlas_changed_) {
+    return false;
   }
 
-  if (memory_cache_) {
-    delete[] memory_cache_;
+  baked_atlas atlas;
+  atlas.width = atlas_width_;
+  atlas.height = atlas_height_;
+  atlas.data = atlas_data_;
+  atlas.shelves = packer_.GetShelves();
+  for (auto& glyph : glyph_cache_) {
+    // glyphs which failed are tried again next time
+    if (glyph.second.valid) {
+      atlas.glyphs.push_back(glyph);
+    }
+  }
+
+  if (!cache.WriteAtlas(GetAtlasKey(), atlas)) {
+    return false;
+  }
+
+  atlas_changed_ = false;
+  return true;
+}
+
+size_t Font::GetFileSize() const {
+  return font_data_->size();
+}
+
+Font::~Font() {
+  // shapers may hold onto the face
+  shaper_.reset();
+  if (face_ != nullptr) {
+    std::lock_guard<std::mutex> lock(ft_lib_->lock);
+    FT_Done_Face(face_);
   }
 
   if (glyph_texture_ != 0) {
@@ -356,37 +919,61 @@ Font::~Font() {
   }
 }
 
-Font::Font(Font&& other) {
-  ft_lib_ = other.ft_lib_;
-  glyph_cache_ = other.glyph_cache_;
-  other.glyph_cache_ = nullptr;
-  memory_cache_ = other.memory_cache_;
-  other.memory_cache_ = nullptr;
-  glyph_texture_ = other.glyph_texture_;
-  other.glyph_texture_ = 0;
-  atlas_width = other.atlas_width;
-  atlas_height = other.atlas_height;
+Font::Font(Font&& other) : packer_(glm::ivec2(0)) {
+  face_ = nullptr;
+  glyph_texture_ = 0;
+  *this = std::move(other);
 }
 
 Font& Font::operator=(Font&& other) {
-  if (glyph_cache_ != nullptr) {
-    delete[] glyph_cache_;
+  if (this == &other) {
+    return *this;
+  }
+
+  shaper_.reset();
+  if (face_ != nullptr) {
+    std::lock_guard<std::mutex> lock(ft_lib_->lock);
+    FT_Done_Face(face_);
   }
 
   if (glyph_texture_ != 0) {
     glDeleteTextures(1, &glyph_texture_);
   }
 
-  glyph_cache_ = other.glyph_cache_;
-  other.glyph_cache_ = nullptr;
-  memory_cache_ = other.memory_cache_;
-  other.memory_cache_ = nullptr;
+  std::lock_guard<std::mutex> lock(other.glyph_lock_);
+  ft_lib_ = other.ft_lib_;
+  font_data_ = other.font_data_;
+  face_ = other.face_;
+  other.face_ = nullptr;
+  glyph_cache_ = std::move(other.glyph_cache_);
+  atlas_data_ = std::move(other.atlas_data_);
+  packer_ = other.packer_;
+  atlas_height_ = other.atlas_height_;
+  use_tick_ = other.use_tick_;
+  batch_depth_ = other.batch_depth_;
+  generation_ = other.generation_;
+  atlas_changed_ = other.atlas_changed_;
+  atlas_key_ = other.atlas_key_;
+  atlas_key_valid_ = other.atlas_key_valid_;
+  dirty_min_ = other.dirty_min_;
+  dirty_max_ = other.dirty_max_;
   glyph_texture_ = other.glyph_texture_;
   other.glyph_texture_ = 0;
-  atlas_width = other.atlas_width;
-  atlas_height = other.atlas_height;
+  texture_height_ = other.texture_height_;
+  shape_cache_ = std::move(other.shape_cache_);
+  shape_tick_ = other.shape_tick_;
+  shaper_ = std::move(other.shaper_);
+  rasterizer_ = std::move(other.rasterizer_);
+  mode_ = other.mode_;
+  glyph_scale_ = other.glyph_scale_;
+  upsample_ = other.upsample_;
+  glyph_padding_ = other.glyph_padding_;
+  atlas_width_ = other.atlas_width_;
+  space_advance_ = other.space_advance_;
+  line_height_ = other.line_height_;
+  ascent_ = other.ascent_;
   return *this;
 }
 
 }
-}
\ No newline at end of file
+}
@@ -0,0 +1,162 @@
+#include <font/GlyphAtlasCache.hpp>
+#include <utils/FileUtils.hpp>
+#include <utils/HashUtils.hpp>
+
+#include <boost/log/trivial.hpp>
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace monkeysworld {
+namespace font {
+
+using utils::fileutils::GetRemainingLength;
+using utils::fileutils::ReadAsBytes;
+using utils::fileutils::WriteAsBytes;
+using utils::hashutils::FNV_OFFSET;
+using utils::hashutils::HashBytes;
+
+// bytes each shelf and glyph take up on disk
+static const uint64_t SHELF_BYTES = 3 * sizeof(int32_t);
+static const uint64_t GLYPH_BYTES = sizeof(uint32_t) + 6 * sizeof(int32_t) + sizeof(float);
+
+static uint64_t HashInt(uint64_t hash, int32_t value) {
+  return HashBytes(hash, &value, sizeof(int32_t));
+}
+
+GlyphAtlasCache::GlyphAtlasCache(const std::string& cache_dir) {
+  cache_dir_ = cache_dir;
+}
+
+uint64_t GlyphAtlasCache::GetAtlasKey(const std::vector<FT_Byte>& font_data, GlyphMode mode,
+                                      int glyph_scale, int upsample, int padding, int atlas_width) {
+  uint64_t hash = HashBytes(FNV_OFFSET, font_data.data(), font_data.size());
+  hash = HashInt(hash, static_cast<int32_t>(ATLAS_VERSION));
+  hash = HashInt(hash, static_cast<int32_t>(mode));
+  hash = HashInt(hash, glyph_scale);
+  hash = HashInt(hash, upsample);
+  hash = HashInt(hash, padding);
+  hash = HashInt(hash, atlas_width);
+  return hash;
+}
+
+bool GlyphAtlasCache::ReadAtlas(uint64_t key, baked_atlas* atlas) const {
+  std::ifstream input(GetAtlasPath(key), std::ios_base::in | std::ios_base::binary);
+  if (!input.good()) {
+    return false;
+  }
+
+  uint32_t magic = ReadAsBytes<uint32_t>(input);
+  uint64_t key_stored = ReadAsBytes<uint64_t>(input);
+  int32_t width = ReadAsBytes<int32_t>(input);
+  int32_t height = ReadAsBytes<int32_t>(input);
+  int32_t rows = ReadAsBytes<int32_t>(input);
+  uint32_t glyph_count = ReadAsBytes<uint32_t>(input);
+  uint32_t shelf_count = ReadAsBytes<uint32_t>(input);
+  if (!input.good() || magic != ATLAS_MAGIC || key_stored != key
+   || width <= 0 || height > Font::MAX_ATLAS_HEIGHT || rows < 0 || rows > height
+   || shelf_count > static_cast<uint32_t>(height)
+   || glyph_count > static_cast<uint64_t>(width) * height) {
+    BOOST_LOG_TRIVIAL(warning) << "Glyph atlas cache " << GetAtlasPath(key) << " has a bad header";
+    return false;
+  }
+
+  // check the counts against the file before allocating anything for them
+  uint64_t len = static_cast<uint64_t>(width) * rows;
+  uint64_t expected = shelf_count * SHELF_BYTES + glyph_count * GLYPH_BYTES + len;
+  std::streamoff remaining = GetRemainingLength(input);
+  if (remaining < 0 || static_cast<uint64_t>(remaining) < expected) {
+    BOOST_LOG_TRIVIAL(warning) << "Glyph atlas cache " << GetAtlasPath(key) << " is truncated";
+    return false;
+  }
+
+  atlas->width = width;
+  atlas->height = height;
+  atlas->shelves.resize(shelf_count);
+  for (auto& shelf : atlas->shelves) {
+    shelf.y = ReadAsBytes<int32_t>(input);
+    shelf.height = ReadAsBytes<int32_t>(input);
+    shelf.x = ReadAsBytes<int32_t>(input);
+    if (shelf.y < 0 || shelf.height < 0 || shelf.y + shelf.height > height || shelf.x < 0 || shelf.x > width) {
+      BOOST_LOG_TRIVIAL(warning) << "Glyph atlas cache " << GetAtlasPath(key) << " has a shelf outside the atlas";
+      return false;
+    }
+  }
+
+  atlas->glyphs.resize(glyph_count);
+  for (auto& glyph : atlas->glyphs) {
+    glyph_info& info = glyph.second;
+    glyph.first = ReadAsBytes<uint32_t>(input);
+    info = {};
+    info.width = ReadAsBytes<int32_t>(input);
+    info.height = ReadAsBytes<int32_t>(input);
+    info.bearing_x = ReadAsBytes<int32_t>(input);
+    info.bearing_y = ReadAsBytes<int32_t>(input);
+    info.advance = ReadAsBytes<float>(input);
+    info.atlas_x = ReadAsBytes<int32_t>(input);
+    info.atlas_y = ReadAsBytes<int32_t>(input);
+    info.valid = true;
+    bool inside = (info.width >= 0 && info.height >= 0 && info.atlas_x >= 0 && info.atlas_y >= 0
+                && info.atlas_x + info.width <= width && info.atlas_y + info.height <= rows);
+    if (!inside && info.width > 0 && info.height > 0) {
+      BOOST_LOG_TRIVIAL(warning) << "Glyph atlas cache " << GetAtlasPath(key) << " has a glyph outside the atlas";
+      return false;
+    }
+  }
+
+  // straight into the buffer which gets uploaded
+  atlas->data.resize(len);
+  input.read(reinterpret_cast<char*>(atlas->data.data()), len);
+  if (input.gcount() != static_cast<std::streamsize>(len)) {
+    BOOST_LOG_TRIVIAL(warning) << "Glyph atlas cache " << GetAtlasPath(key) << " is truncated";
+    return false;
+  }
+
+  return true;
+}
+
+bool GlyphAtlasCache::WriteAtlas(uint64_t key, const baked_atlas& atlas) const {
+  std::ofstream output(GetAtlasPath(key), std::ios_base::out | std::ios_base::trunc | std::ios_base::binary);
+  if (!output.good()) {
+    BOOST_LOG_TRIVIAL(warning) << "Could not write glyph atlas cache " << GetAtlasPath(key);
+    return false;
+  }
+
+  WriteAsBytes(output, ATLAS_MAGIC);
+  WriteAsBytes(output, key);
+  WriteAsBytes(output, static_cast<int32_t>(atlas.width));
+  WriteAsBytes(output, static_cast<int32_t>(atlas.height));
+  WriteAsBytes(output, static_cast<int32_t>(atlas.data.size() / atlas.width));
+  WriteAsBytes(output, static_cast<uint32_t>(atlas.glyphs.size()));
+  WriteAsBytes(output, static_cast<uint32_t>(atlas.shelves.size()));
+  for (auto& shelf : atlas.shelves) {
+    WriteAsBytes(output, static_cast<int32_t>(shelf.y));
+    WriteAsBytes(output, static_cast<int32_t>(shelf.height));
+    WriteAsBytes(output, static_cast<int32_t>(shelf.x));
+  }
+
+  for (auto& glyph : atlas.glyphs) {
+    const glyph_info& info = glyph.second;
+    WriteAsBytes(output, static_cast<uint32_t>(glyph.first));
+    WriteAsBytes(output, static_cast<int32_t>(info.width));
+    WriteAsBytes(output, static_cast<int32_t>(info.height));
+    WriteAsBytes(output, static_cast<int32_t>(info.bearing_x));
+    WriteAsBytes(output, static_cast<int32_t>(info.bearing_y));
+    WriteAsBytes(output, info.advance);
+    WriteAsBytes(output, static_cast<int32_t>(info.atlas_x));
+    WriteAsBytes(output, static_cast<int32_t>(info.atlas_y));
+  }
+
+  output.write(reinterpret_cast<const char*>(atlas.data.data()), atlas.data.size());
+  return output.good();
+}
+
+std::string GlyphAtlasCache::GetAtlasPath(uint64_t key) const {
+  std::stringstream path;
+  path << cache_dir_ << std::hex << std::setw(16) << std::setfill('0') << key << ".glyphatlas";
+  return path.str();
+}
+
+}
+}
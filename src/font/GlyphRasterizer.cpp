@@ -0,0 +1,83 @@
+#include <font/GlyphRasterizer.hpp>
+
+#include <algorithm>
+
+namespace monkeysworld {
+namespace font {
+
+// rounds toward negative infinity, unlike `/`
+static int FloorDiv(int a, int b) {
+  return (a >= 0 ? a / b : -((-a + b - 1) / b));
+}
+
+static int CeilDiv(int a, int b) {
+  return -FloorDiv(-a, b);
+}
+
+GlyphRasterizer::GlyphRasterizer(GlyphMode mode, int upsample, int padding) {
+  mode_ = mode;
+  upsample_ = upsample;
+  padding_ = padding;
+}
+
+void GlyphRasterizer::Render(FT_Face face, FT_UInt glyph_index, rendered_glyph* out) {
+  out->glyph = glyph_index;
+  out->valid = false;
+  out->advance = 0.0f;
+  out->bearing_x = 0;
+  out->bearing_y = 0;
+  out->size = glm::ivec2(0);
+  FT_Error e = FT_Load_Glyph(face, glyph_index, FT_LOAD_RENDER);
+  if (e) {
+    return;
+  }
+
+  FT_GlyphSlot glyph = face->glyph;
+  // check bitmap format
+  if (glyph->format != FT_GLYPH_FORMAT_BITMAP) {
+    FT_Render_Glyph(glyph, FT_RENDER_MODE_NORMAL);
+  }
+
+  const FT_Bitmap& bitmap = glyph->bitmap;
+  out->advance = static_cast<float>(glyph->advance.x) / upsample_;
+  out->valid = true;
+  if (bitmap.width == 0 || bitmap.rows == 0) {
+    // nothing to draw
+    return;
+  }
+
+  // negative pitch means rows are stored bottom up
+  int pitch = bitmap.pitch;
+  const uint8_t* top_row = bitmap.buffer;
+  if (pitch < 0) {
+    top_row += (bitmap.rows - 1) * -pitch;
+  }
+
+  if (mode_ == GlyphMode::SDF) {
+    // line the output grid up with whole output pixels, with room for the spread on every side
+    int left = FloorDiv(glyph->bitmap_left, upsample_) - padding_;
+    int right = CeilDiv(glyph->bitmap_left + static_cast<int>(bitmap.width), upsample_) + padding_;
+    int top = CeilDiv(glyph->bitmap_top, upsample_) + padding_;
+    int bottom = FloorDiv(glyph->bitmap_top - static_cast<int>(bitmap.rows), upsample_) - padding_;
+    out->size = glm::ivec2(right - left, top - bottom);
+    glm::ivec2 origin(glyph->bitmap_left - left * upsample_, top * upsample_ - glyph->bitmap_top);
+    out->pixels.resize(out->size.x * out->size.y);
+    sdf_.Generate(top_row, glm::ivec2(bitmap.width, bitmap.rows), pitch, origin,
+                  upsample_, padding_, out->size, out->pixels.data());
+    out->bearing_x = left + padding_;
+    out->bearing_y = top - padding_;
+  } else {
+    out->size = glm::ivec2(bitmap.width, bitmap.rows);
+    out->pixels.resize(out->size.x * out->size.y);
+    for (int i = 0; i < out->size.y; i++) {
+      const uint8_t* row = top_row + i * pitch;
+      std::copy(row, row + out->size.x, out->pixels.begin() + i * out->size.x);
+    }
+
+    out->bearing_x = glyph->bitmap_left;
+    out->bearing_y = glyph->bitmap_top;
+  }
+}
+
+}
+}
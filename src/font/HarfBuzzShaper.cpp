@@ -0,0 +1,69 @@
+#include <font/HarfBuzzShaper.hpp>
+
+#ifdef MONKEYSWORLD_HARFBUZZ
+
+#include <hb-ft.h>
+
+namespace monkeysworld {
+namespace font {
+
+HarfBuzzShaper::HarfBuzzShaper() {
+  face_ = nullptr;
+  x_scale_ = 0;
+  y_scale_ = 0;
+  font_ = nullptr;
+  buffer_ = hb_buffer_create();
+}
+
+int HarfBuzzShaper::GetLookahead() const {
+  return -1;
+}
+
+void HarfBuzzShaper::ShapeRun(FT_Face face, const uint32_t* codepoints, size_t count, std::vector<run_glyph>* out) {
+  if (face != face_) {
+    if (font_ != nullptr) {
+      hb_font_destroy(font_);
+    }
+
+    // scaled to the face's current size, so positions come back in 1/64 px
+    font_ = hb_ft_font_create_referenced(face);
+    face_ = face;
+  } else if (face->size->metrics.x_scale != x_scale_ || face->size->metrics.y_scale != y_scale_) {
+    // same face at a new size -- font_ still has the old scale cached
+    hb_ft_font_changed(font_);
+  }
+
+  x_scale_ = face->size->metrics.x_scale;
+  y_scale_ = face->size->metrics.y_scale;
+
+  hb_buffer_clear_contents(buffer_);
+  hb_buffer_add_utf32(buffer_, codepoints, static_cast<int>(count), 0, static_cast<int>(count));
+  hb_buffer_guess_segment_properties(buffer_);
+  hb_shape(font_, buffer_, nullptr, 0);
+
+  unsigned int glyph_count;
+  const hb_glyph_info_t* info = hb_buffer_get_glyph_infos(buffer_, &glyph_count);
+  const hb_glyph_position_t* pos = hb_buffer_get_glyph_positions(buffer_, &glyph_count);
+  out->resize(glyph_count);
+  for (unsigned int i = 0; i < glyph_count; i++) {
+    run_glyph& glyph = (*out)[i];
+    // after shaping, codepoint holds the glyph index
+    glyph.glyph = info[i].codepoint;
+    glyph.cluster = info[i].cluster;
+    glyph.advance = pos[i].x_advance;
+    glyph.offset = glm::ivec2(pos[i].x_offset, pos[i].y_offset);
+  }
+}
+
+HarfBuzzShaper::~HarfBuzzShaper() {
+  if (font_ != nullptr) {
+    hb_font_destroy(font_);
+  }
+
+  hb_buffer_destroy(buffer_);
+}
+
+}
+}
+
+#endif
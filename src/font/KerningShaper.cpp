@@ -0,0 +1,49 @@
+#include <font/KerningShaper.hpp>
+
+#include FT_ADVANCES_H
+
+namespace monkeysworld {
+namespace font {
+
+int KerningShaper::GetLookahead() const {
+  // a pair only moves its first glyph
+  return 1;
+}
+
+void KerningShaper::ShapeRun(FT_Face face, const uint32_t* codepoints, size_t count, std::vector<run_glyph>* out) {
+  out->resize(count);
+  bool kerning = FT_HAS_KERNING(face);
+  for (size_t i = 0; i < count; i++) {
+    run_glyph& glyph = (*out)[i];
+    glyph.glyph = FT_Get_Char_Index(face, codepoints[i]);
+    glyph.cluster = static_cast<uint32_t>(i);
+    glyph.advance = GetAdvance(face, glyph.glyph);
+    glyph.offset = glm::ivec2(0);
+    if (kerning && i > 0) {
+      FT_Vector delta;
+      if (!FT_Get_Kerning(face, (*out)[i - 1].glyph, glyph.glyph, FT_KERNING_DEFAULT, &delta)) {
+        (*out)[i - 1].advance += static_cast<int32_t>(delta.x);
+      }
+    }
+  }
+}
+
+int32_t KerningShaper::GetAdvance(FT_Face face, FT_UInt glyph) {
+  auto i = advances_.find(glyph);
+  if (i != advances_.end()) {
+    return i->second;
+  }
+
+  // same load flags as the rasterizer, so hinting agrees. 16.16 -> 26.6
+  FT_Fixed advance = 0;
+  int32_t res = 0;
+  if (!FT_Get_Advance(face, glyph, FT_LOAD_DEFAULT, &advance)) {
+    res = static_cast<int32_t>(advance >> 10);
+  }
+
+  advances_.insert(std::make_pair(glyph, res));
+  return res;
+}
+
+}
+}
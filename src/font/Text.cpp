@@ -13,6 +13,9 @@ Text::Text(engine::Context* ctx, const std::string& font_path) {
   size_ = 24.0f;
   text_ = "";
   mesh_valid_ = false;
+  layout_valid_ = false;
+  wrap_width_ = 0.0f;
+  atlas_generation_ = 0;
   format_.char_spacing = 0;
   format_.horiz_align = LEFT;
   format_.vert_align = DEFAULT;
@@ -21,15 +24,19 @@ Text::Text(engine::Context* ctx, const std::string& font_path) {
 void Text::SetFont(const std::string& font_path) {
   font_ = ctx_->GetCachedFileLoader()->LoadFont(font_path);
   mesh_valid_ = false;
+  layout_valid_ = false;
+  // layout belongs to the old font
+  shaped_.reset();
 }
 
-std::shared_ptr<const Font> Text::GetFont() {
+std::shared_ptr<const Font> Text::GetFont() const {
   return font_;
 }
 
 void Text::SetText(const std::string& text) {
   text_ = text;
   mesh_valid_ = false;
+  layout_valid_ = false;
 }
 
 std::string Text::GetText() const {
@@ -46,6 +53,7 @@ glm::vec4 Text::GetTextColor() const {
 
 void Text::SetTextSize(float size_pt) {
   mesh_valid_ = false;
+  layout_valid_ = false;
   size_ = size_pt;
 }
 
@@ -55,13 +63,62 @@ float Text::GetTextSize() const {
 
 void Text::SetTextFormat(TextFormat format) {
   format_ = format;
+  mesh_valid_ = false;
+  layout_valid_ = false;
+}
+
+void Text::SetWrapWidth(float width) {
+  wrap_width_ = width;
+  mesh_valid_ = false;
+  layout_valid_ = false;
+}
+
+std::shared_ptr<const shaped_text> Text::GetLayout() const {
+  if (!layout_valid_) {
+    // fonts cache their layouts, and pick up from wherever the last string diverges
+    if (wrap_width_ > 0.0f) {
+      shaped_ = font_->ShapeText(font_->WrapText(text_, size_, format_, wrap_width_), size_, format_, shaped_.get());
+    } else {
+      shaped_ = font_->ShapeText(text_, size_, format_, shaped_.get());
+    }
+
+    layout_valid_ = true;
+  }
+
+  return shaped_;
 }
 
 std::shared_ptr<model::Mesh<storage::VertexPacket2D>> Text::GetGeometry() const {
-  if (!mesh_valid_) {
-    mesh_->operator=(std::move(font_->GetTextGeometry(text_, size_, format_)));
+  // glyphs may have moved in the atlas since we last built our mesh
+  uint64_t generation = font_->GetAtlasGeneration();
+  if (!mesh_valid_ || generation != atlas_generation_) {
+    if (!mesh_valid_) {
+      GetLayout();
+    }
+
+    // only texcoords need to change if the atlas moved, but it's just as quick to write everything
+    size_t count = shaped_->glyphs.size();
+    vertices_.resize(count * 4);
+    font_->WriteTextGeometry(*shaped_, vertices_.data());
+    if (indices_.size() != count * 6) {
+      indices_.resize(count * 6);
+      for (unsigned int i = 0; i < count; i++) {
+        unsigned int* quad = &indices_[i * 6];
+        quad[0] = i * 4;
+        quad[1] = i * 4 + 1;
+        quad[2] = i * 4 + 2;
+        quad[3] = i * 4 + 2;
+        quad[4] = i * 4 + 3;
+        quad[5] = i * 4;
+      }
+    }
+
+    mesh_->SwapData(vertices_, indices_);
     bool* valid_ptr_ = const_cast<bool*>(&mesh_valid_);
     *valid_ptr_ = true;
+    // generation can change while we build
+    uint64_t* generation_ptr_ = const_cast<uint64_t*>(&atlas_generation_);
+    *generation_ptr_ = font_->GetAtlasGeneration();
   }
 
   return mesh_;
@@ -0,0 +1,248 @@
+#include <font/TextBatch.hpp>
+
+#include <GLFW/glfw3.h>
+
+#include <boost/log/trivial.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace monkeysworld {
+namespace font {
+
+using storage::VertexPacket2D;
+
+TextBatch::TextBatch(engine::Context* ctx) : mat_(ctx) {
+  transform_buffer_ = 0;
+  transform_capacity_ = 0;
+  index_buffer_ = 0;
+  index_quads_ = 0;
+}
+
+uint32_t TextBatch::PackColor(const glm::vec4& color) {
+  uint8_t bytes[4];
+  for (int i = 0; i < 4; i++) {
+    float channel = std::min(std::max(color[i], 0.0f), 1.0f);
+    bytes[i] = static_cast<uint8_t>(channel * 255.0f + 0.5f);
+  }
+
+  uint32_t res;
+  std::memcpy(&res, bytes, sizeof(res));
+  return res;
+}
+
+void TextBatch::AppendVertices(const model::Mesh<VertexPacket2D>& mesh, uint32_t color, uint32_t transform,
+                               std::vector<TextBatchPacket>* out) {
+  const VertexPacket2D* data = mesh.GetVertexData();
+  size_t count = mesh.GetVertexCount();
+  size_t start = out->size();
+  out->resize(start + count);
+  TextBatchPacket* dst = out->data() + start;
+  for (size_t v = 0; v < count; v++) {
+    dst[v].position = data[v].position;
+    dst[v].texcoord = data[v].texcoords;
+    dst[v].color = color;
+    dst[v].transform = transform;
+  }
+}
+
+void TextBatch::Add(Text& text, glm::vec2 scale, glm::vec2 offset, glm::vec2 clip_min, glm::vec2 clip_max) {
+  auto font = text.GetFont();
+  atlas_stream& stream = streams_[font.get()];
+  if (!stream.font) {
+    stream.font = font;
+    stream.vao = 0;
+    stream.vbo = 0;
+    stream.capacity = 0;
+    stream.head = 0;
+    stream.idle_flushes = 0;
+  }
+
+  text_transform tf;
+  tf.scale_offset = glm::vec4(scale, offset);
+  tf.clip = glm::vec4(clip_min, clip_max);
+  batch_entry entry;
+  entry.text = &text;
+  entry.transform = static_cast<uint32_t>(transforms_.size());
+  transforms_.push_back(tf);
+  stream.entries.push_back(entry);
+}
+
+bool TextBatch::IsEmpty() const {
+  return transforms_.empty();
+}
+
+size_t TextBatch::Flush() {
+  size_t draws = 0;
+  if (!transforms_.empty()) {
+    if (transform_buffer_ == 0) {
+      glGenBuffers(1, &transform_buffer_);
+    }
+
+    // orphaned every time -- earlier flushes may still be reading the old contents
+    GLsizeiptr size = static_cast<GLsizeiptr>(transforms_.size() * sizeof(text_transform));
+    transform_capacity_ = std::max(transform_capacity_, size);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, transform_buffer_);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, transform_capacity_, NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, size, transforms_.data());
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, TRANSFORM_BINDING, transform_buffer_);
+  }
+
+  for (auto i = streams_.begin(); i != streams_.end();) {
+    atlas_stream& stream = i->second;
+    if (stream.entries.empty()) {
+      if (++stream.idle_flushes > MAX_IDLE_FLUSHES) {
+        if (stream.vao != 0) {
+          glDeleteVertexArrays(1, &stream.vao);
+          glDeleteBuffers(1, &stream.vbo);
+        }
+
+        i = streams_.erase(i);
+      } else {
+        i++;
+      }
+
+      continue;
+    }
+
+    stream.idle_flushes = 0;
+    size_t quads = GatherVertices(stream);
+    stream.entries.clear();
+    if (quads > 0) {
+      ReserveQuads(quads);
+      GLint base = Upload(stream);
+      mat_.SetGlyphTexture(stream.font->GetGlyphAtlas());
+      mat_.SetDistanceField(stream.font->GetGlyphMode() == GlyphMode::SDF);
+      if (mat_.UseMaterial()) {
+        glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(quads * 6), GL_UNSIGNED_INT, (void*)0, base);
+        draws++;
+      }
+    }
+
+    i++;
+  }
+
+  transforms_.clear();
+  return draws;
+}
+
+size_t TextBatch::GatherVertices(atlas_stream& stream) {
+  // rasterizing new glyphs can move old ones around the atlas -- get them all in first,
+  // so that the second pass sees a stable atlas, and only rebuilds what went stale.
+  // the batch keeps later text from evicting glyphs which earlier text is using.
+  stream.font->BeginBatch();
+  for (auto& entry : stream.entries) {
+    entry.text->GetGeometry();
+  }
+
+  vertices_.clear();
+  for (auto& entry : stream.entries) {
+    AppendVertices(*entry.text->GetGeometry(), PackColor(entry.text->GetTextColor()), entry.transform, &vertices_);
+  }
+
+  stream.font->EndBatch();
+  return vertices_.size() / 4;
+}
+
+GLint TextBatch::Upload(atlas_stream& stream) {
+  GLsizeiptr size = static_cast<GLsizeiptr>(vertices_.size() * sizeof(TextBatchPacket));
+  if (stream.vao == 0) {
+    glGenVertexArrays(1, &stream.vao);
+    glGenBuffers(1, &stream.vbo);
+    glBindVertexArray(stream.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, stream.vbo);
+    stream.capacity = std::max(MIN_STREAM_SIZE, size);
+    stream.head = 0;
+    glBufferData(GL_ARRAY_BUFFER, stream.capacity, NULL, GL_STREAM_DRAW);
+    TextBatchPacket::Bind();
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer_);
+  } else {
+    glBindVertexArray(stream.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, stream.vbo);
+  }
+
+  if (size > stream.capacity) {
+    stream.capacity = std::max(size, stream.capacity * 2);
+    glBufferData(GL_ARRAY_BUFFER, stream.capacity, NULL, GL_STREAM_DRAW);
+    stream.head = 0;
+  } else if (stream.head + size > stream.capacity) {
+    // orphan -- the driver hands us fresh storage, and in-flight draws keep the old one
+    glBufferData(GL_ARRAY_BUFFER, stream.capacity, NULL, GL_STREAM_DRAW);
+    stream.head = 0;
+  }
+
+  glBufferSubData(GL_ARRAY_BUFFER, stream.head, size, vertices_.data());
+  GLint base = static_cast<GLint>(stream.head / sizeof(TextBatchPacket));
+  stream.head += size;
+  return base;
+}
+
+void TextBatch::ReserveQuads(size_t quads) {
+  if (quads <= index_quads_) {
+    return;
+  }
+
+  index_quads_ = std::max(quads, index_quads_ * 2);
+  std::vector<GLuint> indices(index_quads_ * 6);
+  for (GLuint i = 0; i < index_quads_; i++) {
+    GLuint* quad = &indices[i * 6];
+    quad[0] = i * 4;
+    quad[1] = i * 4 + 1;
+    quad[2] = i * 4 + 2;
+    quad[3] = i * 4 + 2;
+    quad[4] = i * 4 + 3;
+    quad[5] = i * 4;
+  }
+
+  if (index_buffer_ == 0) {
+    glGenBuffers(1, &index_buffer_);
+  }
+
+  // element array bindings belong to whichever vao is bound -- upload through a target that doesn't
+  glBindBuffer(GL_COPY_WRITE_BUFFER, index_buffer_);
+  glBufferData(GL_COPY_WRITE_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void TextBatch::TextBatchPacket::Bind() {
+  glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(TextBatchPacket), (void*)0);
+  glEnableVertexAttribArray(0);
+
+  glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(TextBatchPacket), (void*)(sizeof(glm::vec2)));
+  glEnableVertexAttribArray(1);
+
+  glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(TextBatchPacket), (void*)(2 * sizeof(glm::vec2)));
+  glEnableVertexAttribArray(2);
+
+  glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, sizeof(TextBatchPacket), (void*)(2 * sizeof(glm::vec2) + sizeof(uint32_t)));
+  glEnableVertexAttribArray(3);
+}
+
+TextBatch::~TextBatch() {
+  if (!glfwGetCurrentContext()) {
+    if (transform_buffer_ != 0 || index_buffer_ != 0 || !streams_.empty()) {
+      BOOST_LOG_TRIVIAL(error) << "could not delete text batch buffers!";
+    }
+
+    return;
+  }
+
+  for (auto& stream : streams_) {
+    if (stream.second.vao != 0) {
+      glDeleteVertexArrays(1, &stream.second.vao);
+      glDeleteBuffers(1, &stream.second.vbo);
+    }
+  }
+
+  if (transform_buffer_ != 0) {
+    glDeleteBuffers(1, &transform_buffer_);
+  }
+
+  if (index_buffer_ != 0) {
+    glDeleteBuffers(1, &index_buffer_);
+  }
+}
+
+}
+}
@@ -23,9 +23,11 @@ void TextObject::RenderMaterial(const engine::RenderContext& rc) {
   mat.SetModelTransforms(GetTransformationMatrix());
   mat.SetCameraTransforms(rc.GetActiveCamera().vp_matrix);
   mat.SetGlyphTexture(GetTexture());
+  mat.SetDistanceField(GetFont()->GetGlyphMode() == GlyphMode::SDF);
   mat.SetTextColor(GetTextColor());
-  mat.UseMaterial();
-  Draw();
+  if (mat.UseMaterial()) {
+    Draw();
+  }
 }
 
 void TextObject::Draw() {
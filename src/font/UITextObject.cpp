@@ -8,8 +8,6 @@
 namespace monkeysworld {
 namespace font {
 
-using storage::VertexPacket2D;
-
 UITextObject::UITextObject(engine::Context* ctx, const std::string& font_path)
   : UIObject(ctx), mat_(ctx), text_(ctx, font_path) { 
     TextFormat format;
@@ -21,10 +19,36 @@ UITextObject::UITextObject(engine::Context* ctx, const std::string& font_path)
 
 void UITextObject::DrawUI(glm::vec2 xMin, glm::vec2 xMax, shader::Canvas canvas) {
   auto text_mesh = text_.GetGeometry();
-  auto format = text_.GetTextFormat();
 
-  glm::mat4 model_mat(1.0);
-  glm::vec3 scale(GetScaleFactor(), 1.0);
+  glm::vec2 scale, offset;
+  GetTextTransform(&scale, &offset);
+  glm::mat4 model_mat = glm::translate(glm::mat4(1.0), glm::vec3(offset, 0.0));
+  model_mat = glm::scale(model_mat, glm::vec3(scale, 1.0));
+
+  text_mesh->PointToVertexAttribs();
+
+  mat_.SetModelTransforms(model_mat);
+  mat_.SetCameraTransforms(glm::mat4(1.0));
+  mat_.SetGlyphTexture(text_.GetTexture());
+  mat_.SetDistanceField(text_.GetFont()->GetGlyphMode() == GlyphMode::SDF);
+  mat_.SetTextColor(text_.GetTextColor());
+  if (!mat_.UseMaterial()) {
+    return;
+  }
+
+  glDrawElements(GL_TRIANGLES, static_cast<uint32_t>(text_mesh->GetIndexCount()), GL_UNSIGNED_INT, (void*)0);
+}
+
+bool UITextObject::DrawBatched(TextBatch& batch, glm::vec2 scale, glm::vec2 offset,
+                               glm::vec2 clip_min, glm::vec2 clip_max) {
+  glm::vec2 text_scale, text_offset;
+  GetTextTransform(&text_scale, &text_offset);
+  batch.Add(text_, text_scale * scale, text_offset * scale + offset, clip_min, clip_max);
+  return true;
+}
+
+void UITextObject::GetTextTransform(glm::vec2* scale, glm::vec2* offset) {
+  auto format = text_.GetTextFormat();
 
   // scale text up to match window scale + correct aspect ratio
 
@@ -38,15 +62,16 @@ void UITextObject::DrawUI(glm::vec2 xMin, glm::vec2 xMax, shader::Canvas canvas)
   // we could use a function call to access it
   // performance should be fine, just dont write an essay
 
-  
+  *scale = GetScaleFactor();
+  *offset = glm::vec2(0.0);
 
   // translate so that our text lines up with top left corner of the framebuffer
   switch (format.horiz_align) {
     case LEFT:
-      model_mat = glm::translate(model_mat, glm::vec3(-1.0, 0.0, 0.0));
+      offset->x = -1.0f;
       break;
     case RIGHT:
-      model_mat = glm::translate(model_mat, glm::vec3(1.0, 0.0, 0.0));
+      offset->x = 1.0f;
       break;
     case CENTER:
       break;
@@ -54,26 +79,16 @@ void UITextObject::DrawUI(glm::vec2 xMin, glm::vec2 xMax, shader::Canvas canvas)
 
   switch (format.vert_align) {
     case TOP:
-      model_mat = glm::translate(model_mat, glm::vec3(0.0, 1.0, 0.0));
+      offset->y = 1.0f;
       break;
     case MIDDLE:
       break;
     case BOTTOM:
-      model_mat = glm::translate(model_mat, glm::vec3(0.0, -1.0, 0.0));
+      offset->y = -1.0f;
+      break;
+    default:
       break;
   }
-
-  model_mat = glm::scale(model_mat, scale);
-
-  text_mesh->PointToVertexAttribs();
-
-  mat_.SetModelTransforms(model_mat);
-  mat_.SetCameraTransforms(glm::mat4(1.0));
-  mat_.SetGlyphTexture(text_.GetTexture());
-  mat_.SetTextColor(text_.GetTextColor());
-  mat_.UseMaterial();
-
-  glDrawElements(GL_TRIANGLES, static_cast<uint32_t>(text_mesh->GetIndexCount()), GL_UNSIGNED_INT, (void*)0);
 }
 
 glm::vec2 UITextObject::GetMinimumBoundingDims() const {
@@ -81,17 +96,9 @@ glm::vec2 UITextObject::GetMinimumBoundingDims() const {
     return glm::vec2(0);
   }
   
-  auto geom_ = text_.GetGeometry();
-  glm::vec2 min(100);
-  glm::vec2 max(-100);
-  const VertexPacket2D* data = geom_->GetVertexData();
-  for (int i = 0; i < geom_->GetVertexCount(); i++) {
-    min = glm::min(min, data->position);
-    max = glm::max(max, data->position);
-    data++;
-  }
-
-  glm::vec2 range(max.x - min.x, max.y - min.y);
+  // measured straight off the layout -- no need to build the mesh
+  text_metrics metrics = text_.GetFont()->MeasureText(*text_.GetLayout());
+  glm::vec2 range(metrics.max.x - metrics.min.x, metrics.max.y - metrics.min.y);
   range *= GetScaleFactor();
   glm::vec2 fb_size = GetDimensions();
   glm::vec2 res(range.x * (fb_size.x / 2), range.y * (fb_size.y / 2));
@@ -0,0 +1,480 @@
+#include <model/MeshSimplifier.hpp>
+
+#include <boost/log/trivial.hpp>
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cinttypes>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+
+namespace monkeysworld {
+namespace model {
+
+using storage::VertexPacket3D;
+
+// don't bother simplifying meshes smaller than this
+static const size_t MIN_LOD_TRIANGLES = 64;
+
+// placements considered for each collapse -- endpoints and midpoint, from keep (0) to drop (1)
+static const float CANDIDATES[3] = { 0.0f, 1.0f, 0.5f };
+
+// levels which remove less than this fraction of triangles are discarded
+static const float MIN_LOD_REDUCTION = 0.1f;
+
+/**
+ *  Symmetric 4x4 error quadric, stored as its upper triangle.
+ */
+struct quadric {
+  double q[10];
+
+  quadric() {
+    std::fill(q, q + 10, 0.0);
+  }
+
+  /**
+   *  Creates the quadric for the plane ax + by + cz + d = 0, scaled by `weight`.
+   */
+  quadric(double a, double b, double c, double d, double weight) {
+    q[0] = a * a * weight; q[1] = a * b * weight; q[2] = a * c * weight; q[3] = a * d * weight;
+    q[4] = b * b * weight; q[5] = b * c * weight; q[6] = b * d * weight;
+    q[7] = c * c * weight; q[8] = c * d * weight;
+    q[9] = d * d * weight;
+  }
+
+  quadric& operator+=(const quadric& rhs) {
+    for (int i = 0; i < 10; i++) {
+      q[i] += rhs.q[i];
+    }
+
+    return *this;
+  }
+
+  /**
+   *  @returns the squared distance error associated with `v`.
+   */
+  double Error(const glm::vec3& v) const {
+    double x = v.x, y = v.y, z = v.z;
+    return q[0] * x * x + 2 * q[1] * x * y + 2 * q[2] * x * z + 2 * q[3] * x
+         + q[4] * y * y + 2 * q[5] * y * z + 2 * q[6] * y
+         + q[7] * z * z + 2 * q[8] * z
+         + q[9];
+  }
+};
+
+/**
+ *  Candidate edge collapse. `keep` survives and is moved to the collapsed position,
+ *  while `drop` is removed.
+ */
+struct collapse_entry {
+  double cost;
+  uint32_t keep;
+  uint32_t drop;
+  uint32_t keep_stamp;
+  uint32_t drop_stamp;
+  // interpolation factor from keep (0) to drop (1)
+  float t;
+};
+
+struct collapse_compare {
+  bool operator()(const collapse_entry& a, const collapse_entry& b) const {
+    return a.cost > b.cost;
+  }
+};
+
+/**
+ *  All of the bookkeeping required while simplifying a single mesh.
+ */
+class SimplifierState {
+ public:
+  SimplifierState(const Mesh<VertexPacket3D>& mesh) {
+    const VertexPacket3D* verts = mesh.GetVertexData();
+    const unsigned int* inds = mesh.GetIndexData();
+    size_t vert_count = mesh.GetVertexCount();
+    size_t tri_count = mesh.GetIndexCount() / 3;
+
+    verts_.assign(verts, verts + vert_count);
+    tris_.assign(inds, inds + tri_count * 3);
+    tri_removed_.assign(tri_count, false);
+    vert_removed_.assign(vert_count, false);
+    locked_.assign(vert_count, false);
+    stamps_.assign(vert_count, 0);
+    marks_.assign(vert_count, 0);
+    quadrics_.resize(vert_count);
+    adjacency_.resize(vert_count);
+    live_tris_ = tri_count;
+    mark_ = 0;
+
+    for (uint32_t t = 0; t < tri_count; t++) {
+      const glm::vec3& a = verts_[tris_[3 * t]].position;
+      const glm::vec3& b = verts_[tris_[3 * t + 1]].position;
+      const glm::vec3& c = verts_[tris_[3 * t + 2]].position;
+      glm::dvec3 n = glm::cross(glm::dvec3(b - a), glm::dvec3(c - a));
+      double len = glm::length(n);
+      if (len > 0.0) {
+        // area-weighted, so that slivers don't dominate
+        n /= len;
+        quadric plane(n.x, n.y, n.z, -glm::dot(n, glm::dvec3(a)), len * 0.5);
+        for (int i = 0; i < 3; i++) {
+          quadrics_[tris_[3 * t + i]] += plane;
+        }
+      }
+
+      for (int i = 0; i < 3; i++) {
+        adjacency_[tris_[3 * t + i]].push_back(t);
+      }
+    }
+
+    // edges which only border a single triangle are open -- lock their vertices
+    std::unordered_map<uint64_t, int> edge_counts;
+    edge_counts.reserve(tri_count * 3);
+    for (uint32_t t = 0; t < tri_count; t++) {
+      for (int i = 0; i < 3; i++) {
+        edge_counts[EdgeKey(tris_[3 * t + i], tris_[3 * t + (i + 1) % 3])]++;
+      }
+    }
+
+    for (auto& edge : edge_counts) {
+      if (edge.second == 1) {
+        locked_[static_cast<uint32_t>(edge.first >> 32)] = true;
+        locked_[static_cast<uint32_t>(edge.first & 0xFFFFFFFF)] = true;
+      }
+    }
+
+    for (uint32_t t = 0; t < tri_count; t++) {
+      for (int i = 0; i < 3; i++) {
+        uint32_t a = tris_[3 * t + i];
+        uint32_t b = tris_[3 * t + (i + 1) % 3];
+        // open edges are locked on both ends, so we only need one direction
+        if (a < b) {
+          QueueEdge(a, b);
+        }
+      }
+    }
+  }
+
+  /**
+   *  Collapses edges until the triangle count reaches `target`, or no valid collapses remain.
+   */
+  void Run(size_t target) {
+    while (live_tris_ > target && !heap_.empty()) {
+      collapse_entry e = heap_.top();
+      heap_.pop();
+      if (vert_removed_[e.keep] || vert_removed_[e.drop]
+       || stamps_[e.keep] != e.keep_stamp || stamps_[e.drop] != e.drop_stamp) {
+        // stale
+        continue;
+      }
+
+      if (!CheckTopology(e.keep, e.drop)) {
+        continue;
+      }
+
+      // the cheapest placement might flip a tri -- fall back on the others
+      float t;
+      double cost;
+      if (!FindTarget(e.keep, e.drop, &t, &cost)) {
+        continue;
+      }
+
+      if (cost > e.cost && !heap_.empty() && cost > heap_.top().cost) {
+        // no longer the cheapest collapse, so put it back
+        e.t = t;
+        e.cost = cost;
+        heap_.push(e);
+        continue;
+      }
+
+      VertexPacket3D target_vert = Interpolate(e.keep, e.drop, t);
+      Collapse(e.keep, e.drop, target_vert);
+    }
+  }
+
+  /**
+   *  Writes the remaining geometry into a new mesh.
+   */
+  std::shared_ptr<Mesh<VertexPacket3D>> Output() {
+    auto mesh = std::make_shared<Mesh<VertexPacket3D>>();
+    std::vector<uint32_t> remap(verts_.size(), std::numeric_limits<uint32_t>::max());
+    uint32_t count = 0;
+    for (uint32_t t = 0; t < tri_removed_.size(); t++) {
+      if (tri_removed_[t]) {
+        continue;
+      }
+
+      for (int i = 0; i < 3; i++) {
+        uint32_t v = tris_[3 * t + i];
+        if (remap[v] == std::numeric_limits<uint32_t>::max()) {
+          remap[v] = count++;
+          mesh->AddVertex(verts_[v]);
+        }
+      }
+
+      mesh->AddPolygon(remap[tris_[3 * t]], remap[tris_[3 * t + 1]], remap[tris_[3 * t + 2]]);
+    }
+
+    return mesh;
+  }
+
+  size_t GetTriangleCount() const {
+    return live_tris_;
+  }
+
+ private:
+  static uint64_t EdgeKey(uint32_t a, uint32_t b) {
+    if (a > b) {
+      std::swap(a, b);
+    }
+
+    return (static_cast<uint64_t>(a) << 32) | b;
+  }
+
+  /**
+   *  Computes the best collapse for edge (a, b) and queues it up.
+   */
+  void QueueEdge(uint32_t a, uint32_t b) {
+    if (locked_[a] && locked_[b]) {
+      return;
+    }
+
+    collapse_entry e;
+    // locked vertex is kept in place
+    e.keep = (locked_[b] ? b : a);
+    e.drop = (locked_[b] ? a : b);
+    e.t = 0.0f;
+    e.cost = std::numeric_limits<double>::max();
+    int count = GetCandidateCount(e.keep, e.drop);
+    quadric q = quadrics_[a];
+    q += quadrics_[b];
+    for (int i = 0; i < count; i++) {
+      double cost = q.Error(glm::mix(verts_[e.keep].position, verts_[e.drop].position, CANDIDATES[i]));
+      if (cost < e.cost) {
+        e.cost = cost;
+        e.t = CANDIDATES[i];
+      }
+    }
+
+    e.keep_stamp = stamps_[e.keep];
+    e.drop_stamp = stamps_[e.drop];
+    heap_.push(e);
+  }
+
+  /**
+   *  @returns the number of entries in CANDIDATES which can be used to collapse this edge.
+   */
+  int GetCandidateCount(uint32_t keep, uint32_t drop) const {
+    return (locked_[keep] || locked_[drop] ? 1 : 3);
+  }
+
+  /**
+   *  Finds the cheapest placement for the collapsed vertex which doesn't flip any triangles.
+   *  @param t - output param for the interpolation factor.
+   *  @param cost - output param for the cost of the collapse.
+   *  @returns true if a valid placement exists, false otherwise.
+   */
+  bool FindTarget(uint32_t keep, uint32_t drop, float* t, double* cost) const {
+    quadric q = quadrics_[keep];
+    q += quadrics_[drop];
+    bool found = false;
+    *cost = std::numeric_limits<double>::max();
+    int count = GetCandidateCount(keep, drop);
+    for (int i = 0; i < count; i++) {
+      glm::vec3 pos = glm::mix(verts_[keep].position, verts_[drop].position, CANDIDATES[i]);
+      double err = q.Error(pos);
+      if (err < *cost && !Flips(keep, drop, pos) && !Flips(drop, keep, pos)) {
+        *cost = err;
+        *t = CANDIDATES[i];
+        found = true;
+      }
+    }
+
+    return found;
+  }
+
+  VertexPacket3D Interpolate(uint32_t keep, uint32_t drop, float t) const {
+    VertexPacket3D res;
+    const VertexPacket3D& a = verts_[keep];
+    const VertexPacket3D& b = verts_[drop];
+    res.position = glm::mix(a.position, b.position, t);
+    res.coords = glm::mix(a.coords, b.coords, t);
+    res.normals = glm::mix(a.normals, b.normals, t);
+    float len = glm::length(res.normals);
+    res.normals = (len > 0.0f ? res.normals / len : a.normals);
+    return res;
+  }
+
+  /**
+   *  Link condition: the vertices shared by a and b's neighborhoods must be exactly
+   *  the ones opposite the edge. Otherwise the collapse pinches the surface.
+   */
+  bool CheckTopology(uint32_t a, uint32_t b) {
+    mark_++;
+    for (uint32_t t : adjacency_[a]) {
+      for (int i = 0; i < 3; i++) {
+        marks_[tris_[3 * t + i]] = mark_;
+      }
+    }
+
+    int shared_tris = 0;
+    for (uint32_t t : adjacency_[b]) {
+      if (tris_[3 * t] == a || tris_[3 * t + 1] == a || tris_[3 * t + 2] == a) {
+        shared_tris++;
+      }
+    }
+
+    // count each shared neighbor once
+    int shared_verts = 0;
+    uint32_t counted = ++mark_;
+    for (uint32_t t : adjacency_[b]) {
+      for (int i = 0; i < 3; i++) {
+        uint32_t v = tris_[3 * t + i];
+        if (v != a && v != b && marks_[v] == counted - 1) {
+          marks_[v] = counted;
+          shared_verts++;
+        }
+      }
+    }
+
+    return (shared_verts <= shared_tris);
+  }
+
+  /**
+   *  @returns true if moving `moved` to `pos` would flip (or degenerate) any triangle
+   *           which doesn't also contain `other`.
+   */
+  bool Flips(uint32_t moved, uint32_t other, const glm::vec3& pos) const {
+    for (uint32_t t : adjacency_[moved]) {
+      const uint32_t* tri = &tris_[3 * t];
+      if (tri[0] == other || tri[1] == other || tri[2] == other) {
+        continue;
+      }
+
+      glm::vec3 p[3];
+      glm::vec3 p_new[3];
+      for (int i = 0; i < 3; i++) {
+        p[i] = verts_[tri[i]].position;
+        p_new[i] = (tri[i] == moved ? pos : p[i]);
+      }
+
+      glm::vec3 n_old = glm::cross(p[1] - p[0], p[2] - p[0]);
+      glm::vec3 n_new = glm::cross(p_new[1] - p_new[0], p_new[2] - p_new[0]);
+      if (glm::dot(n_old, n_new) <= 0.0f) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  void Collapse(uint32_t keep, uint32_t drop, const VertexPacket3D& target) {
+    for (uint32_t t : adjacency_[drop]) {
+      uint32_t* tri = &tris_[3 * t];
+      if (tri[0] == keep || tri[1] == keep || tri[2] == keep) {
+        tri_removed_[t] = true;
+        live_tris_--;
+        // the third vertex still references this tri
+        for (int i = 0; i < 3; i++) {
+          if (tri[i] != keep && tri[i] != drop) {
+            auto& opp = adjacency_[tri[i]];
+            opp.erase(std::find(opp.begin(), opp.end(), t));
+          }
+        }
+      } else {
+        for (int i = 0; i < 3; i++) {
+          if (tri[i] == drop) {
+            tri[i] = keep;
+          }
+        }
+
+        adjacency_[keep].push_back(t);
+      }
+    }
+
+    auto& adj = adjacency_[keep];
+    adj.erase(std::remove_if(adj.begin(), adj.end(), [&](uint32_t t) { return tri_removed_[t]; }), adj.end());
+    adjacency_[drop].clear();
+    adjacency_[drop].shrink_to_fit();
+
+    vert_removed_[drop] = true;
+    verts_[keep] = target;
+    quadrics_[keep] += quadrics_[drop];
+    stamps_[keep]++;
+
+    // requeue every edge touching the moved vertex, as well as the edges opposite it.
+    // the latter may have been rejected earlier for flipping one of our tris.
+    mark_++;
+    marks_[keep] = mark_;
+    for (uint32_t t : adj) {
+      const uint32_t* tri = &tris_[3 * t];
+      for (int i = 0; i < 3; i++) {
+        uint32_t v = tri[i];
+        if (marks_[v] != mark_) {
+          marks_[v] = mark_;
+          QueueEdge(keep, v);
+        }
+
+        uint32_t w = tri[(i + 1) % 3];
+        if (v != keep && w != keep && v < w) {
+          QueueEdge(v, w);
+        }
+      }
+    }
+  }
+
+  std::vector<VertexPacket3D> verts_;
+  std::vector<uint32_t> tris_;
+  std::vector<bool> tri_removed_;
+  std::vector<bool> vert_removed_;
+  std::vector<bool> locked_;
+  std::vector<uint32_t> stamps_;
+  std::vector<quadric> quadrics_;
+
+  // triangles touching each vertex
+  std::vector<std::vector<uint32_t>> adjacency_;
+
+  // scratch space for neighborhood walks
+  std::vector<uint32_t> marks_;
+  uint32_t mark_;
+
+  std::priority_queue<collapse_entry, std::vector<collapse_entry>, collapse_compare> heap_;
+  size_t live_tris_;
+};
+
+std::shared_ptr<Mesh<VertexPacket3D>> MeshSimplifier::Simplify(const Mesh<VertexPacket3D>& mesh, float ratio) {
+  ratio = std::min(std::max(ratio, 0.0f), 1.0f);
+  SimplifierState state(mesh);
+  size_t target = static_cast<size_t>(state.GetTriangleCount() * ratio);
+  state.Run(target);
+  return state.Output();
+}
+
+std::vector<std::shared_ptr<Mesh<VertexPacket3D>>> MeshSimplifier::BuildLODChain(const Mesh<VertexPacket3D>& mesh,
+                                                                                  int levels) {
+  std::vector<std::shared_ptr<Mesh<VertexPacket3D>>> res;
+  const Mesh<VertexPacket3D>* last = &mesh;
+  for (int i = 0; i < levels; i++) {
+    size_t last_tris = last->GetIndexCount() / 3;
+    if (last_tris < MIN_LOD_TRIANGLES) {
+      break;
+    }
+
+    auto lod = Simplify(*last, 0.5f);
+    size_t tris = lod->GetIndexCount() / 3;
+    if (tris > last_tris * (1.0f - MIN_LOD_REDUCTION)) {
+      // probably locked up on seams -- further levels won't be any better
+      BOOST_LOG_TRIVIAL(debug) << "LOD " << (i + 1) << " only reached " << tris << "/" << last_tris << " tris, stopping";
+      break;
+    }
+
+    res.push_back(lod);
+    last = lod.get();
+  }
+
+  return res;
+}
+
+}
+}
@@ -77,9 +77,10 @@ void Canvas::DrawLine(glm::vec2 start, glm::vec2 end, float thickness, glm::vec4
     }
 
     fill_mat->SetColor(color);
-    fill_mat->UseMaterial();
-    geom_cache.PointToVertexAttribs();
-    glDrawElements(GL_TRIANGLES, static_cast<int>(geom_cache.GetIndexCount()), GL_UNSIGNED_INT, reinterpret_cast<void*>(0));
+    if (fill_mat->UseMaterial()) {
+      geom_cache.PointToVertexAttribs();
+      glDrawElements(GL_TRIANGLES, static_cast<int>(geom_cache.GetIndexCount()), GL_UNSIGNED_INT, reinterpret_cast<void*>(0));
+    }
   }
 }
 
@@ -89,7 +90,10 @@ void Canvas::DrawImage(std::shared_ptr<const Texture> tex, glm::vec2 origin, glm
 
   filter_mat->ClearFilters();
   filter_mat->SetTexture(tex->GetTextureDescriptor());
-  filter_mat->UseMaterial();
+  if (!filter_mat->UseMaterial()) {
+    return;
+  }
+
   geom_cache.PointToVertexAttribs();
   glDrawElements(GL_TRIANGLES, static_cast<int>(geom_cache.GetIndexCount()), GL_UNSIGNED_INT, reinterpret_cast<void*>(0));
 }
@@ -108,9 +112,11 @@ void Canvas::DrawImage(std::shared_ptr<const Texture> tex, glm::vec2 origin, glm
   }
 
   filter_mat->SetTexture(tex->GetTextureDescriptor());
-  filter_mat->UseMaterial();
+  if (!filter_mat->UseMaterial()) {
+    return;
+  }
+
   geom_cache.PointToVertexAttribs();
-  
   glDrawElements(GL_TRIANGLES, static_cast<int>(geom_cache.GetIndexCount()), GL_UNSIGNED_INT, reinterpret_cast<void*>(0));
 }
 
@@ -9,10 +9,13 @@
 namespace monkeysworld {
 namespace shader {
 
-Framebuffer::Framebuffer() {
+Framebuffer::Framebuffer() : Framebuffer(nullptr) {}
+
+Framebuffer::Framebuffer(FramebufferPool* pool) {
   fb_ = color_ = depth_stencil_ = 0;
   fb_size_ = glm::ivec2(1);
   fb_size_old_ = glm::ivec2(0);
+  pool_ = pool;
 }
 
 void Framebuffer::SetDimensions(glm::ivec2 size) {
@@ -27,6 +30,14 @@ glm::ivec2 Framebuffer::GetDimensions() const {
   return fb_size_;
 }
 
+glm::ivec2 Framebuffer::GetAllocatedDimensions() const {
+  if (target_) {
+    return target_->size;
+  }
+
+  return fb_size_;
+}
+
 void Framebuffer::BindFramebuffer() {
   BindFramebuffer(FramebufferTarget::DEFAULT);
 }
@@ -62,38 +73,36 @@ GLuint Framebuffer::GetFramebuffer() {
 }
 
 void Framebuffer::GenerateFramebuffer(GLenum target) {
-  glDeleteFramebuffers(1, &fb_);
-  glDeleteTextures(1, &color_);
-  glDeleteTextures(1, &depth_stencil_);
-
-  glGenTextures(1, &color_);
-  glGenTextures(1, &depth_stencil_);
-  glBindTexture(GL_TEXTURE_2D, depth_stencil_);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8,
-                static_cast<uint32_t>(fb_size_.x), static_cast<uint32_t>(fb_size_.y),
-                0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, NULL);
-  glBindTexture(GL_TEXTURE_2D, color_);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA,
-                static_cast<uint32_t>(fb_size_.x), static_cast<uint32_t>(fb_size_.y),
-                0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
-
-  glGenFramebuffers(1, &fb_);
-  glBindFramebuffer(target, fb_);
-  glFramebufferTexture2D(target, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color_, 0);
-  glFramebufferTexture2D(target, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, depth_stencil_, 0);
-  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-
-  if (glCheckFramebufferStatus(target) != GL_FRAMEBUFFER_COMPLETE) {
-    BOOST_LOG_TRIVIAL(error) << "incomplete framebuffer :(";
-    BOOST_LOG_TRIVIAL(error) << GetDimensions().x << ", " << GetDimensions().y;
-  } 
-
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  if (pool_ != nullptr) {
+    if (!target_ || target_->size != FramebufferPool::GetBucket(fb_size_)) {
+      // hand the old target back first, so the pool can count it as idle
+      target_.reset();
+      target_ = pool_->Acquire(fb_size_);
+    }
+
+    fb_ = target_->fb;
+    color_ = target_->color;
+    depth_stencil_ = target_->depth_stencil;
+  } else {
+    if (fb_ != 0) {
+      FramebufferPool::DestroyGLTarget({ fb_, color_, depth_stencil_, fb_size_old_ });
+    }
+
+    render_target res = FramebufferPool::CreateGLTarget(fb_size_);
+    fb_ = res.fb;
+    color_ = res.color;
+    depth_stencil_ = res.depth_stencil;
+  }
+
   fb_size_old_ = fb_size_;
 }
 
 Framebuffer::~Framebuffer() {
+  if (pool_ != nullptr) {
+    // target_ returns to the pool on its own
+    return;
+  }
+
   if (!glfwGetCurrentContext()) {
     BOOST_LOG_TRIVIAL(error) << "could not delete GL components!";
   } else if (fb_ != 0) {
@@ -107,6 +116,7 @@ Framebuffer::Framebuffer(const Framebuffer& other) {
   fb_ = color_ = depth_stencil_ = 0;
   fb_size_ = other.fb_size_;
   fb_size_old_ = glm::ivec2(0, 0);
+  pool_ = other.pool_;
 }
 
 Framebuffer& Framebuffer::operator=(const Framebuffer& other) {
@@ -121,6 +131,8 @@ Framebuffer::Framebuffer(Framebuffer&& other) {
   other.fb_ = other.color_ = other.depth_stencil_ = 0;
   fb_size_ = other.fb_size_;
   fb_size_old_ = other.fb_size_old_;
+  pool_ = other.pool_;
+  target_ = std::move(other.target_);
 }
 
 Framebuffer& Framebuffer::operator=(Framebuffer&& other) {
@@ -130,6 +142,8 @@ Framebuffer& Framebuffer::operator=(Framebuffer&& other) {
   other.fb_ = other.color_ = other.depth_stencil_ = 0;
   fb_size_ = other.fb_size_;
   fb_size_old_ = other.fb_size_old_;
+  pool_ = other.pool_;
+  target_ = std::move(other.target_);
   return *this;
 }
 
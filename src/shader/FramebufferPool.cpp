@@ -0,0 +1,221 @@
+#include <shader/FramebufferPool.hpp>
+
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+#include <boost/log/trivial.hpp>
+
+#include <iterator>
+
+namespace monkeysworld {
+namespace shader {
+
+// enough for a handful of full-screen 4k targets, plus plenty of small ones
+static const size_t DEFAULT_BUDGET = 256 * 1024 * 1024;
+
+// smallest bucket step, in pixels
+static const int MIN_BUCKET_STEP = 32;
+
+FramebufferPool& FramebufferPool::GetInstance() {
+  static FramebufferPool pool(DEFAULT_BUDGET, CreateGLTarget, DestroyGLTarget);
+  return pool;
+}
+
+FramebufferPool::FramebufferPool(size_t budget, alloc_func alloc, free_func free) {
+  state_ = std::make_shared<pool_state>();
+  state_->alloc = alloc;
+  state_->free = free;
+  state_->budget = budget;
+  state_->stats = {};
+}
+
+std::shared_ptr<const render_target> FramebufferPool::Acquire(glm::ivec2 size) {
+  glm::ivec2 bucket = GetBucket(size);
+  render_target* res = nullptr;
+  std::list<render_target> evicted;
+  {
+    std::unique_lock<std::mutex> lock(state_->lock);
+    for (auto i = state_->idle.begin(); i != state_->idle.end(); i++) {
+      if (i->size == bucket) {
+        res = new render_target(*i);
+        state_->idle.erase(i);
+        state_->stats.bytes_idle -= GetTargetBytes(bucket);
+        state_->stats.reuses++;
+        break;
+      }
+    }
+
+    if (res != nullptr) {
+      state_->stats.bytes_in_use += GetTargetBytes(bucket);
+    } else {
+      // make room before we allocate, rather than after
+      state_->stats.bytes_in_use += GetTargetBytes(bucket);
+      evicted = Trim(*state_);
+      state_->stats.allocations++;
+    }
+  }
+
+  for (auto& target : evicted) {
+    state_->free(target);
+  }
+
+  if (res == nullptr) {
+    try {
+      res = new render_target(state_->alloc(bucket));
+    } catch (...) {
+      std::unique_lock<std::mutex> lock(state_->lock);
+      state_->stats.bytes_in_use -= GetTargetBytes(bucket);
+      state_->stats.allocations--;
+      throw;
+    }
+
+    res->size = bucket;
+  }
+
+  std::weak_ptr<pool_state> state = state_;
+  free_func free = state_->free;
+  return std::shared_ptr<const render_target>(res, [state, free](const render_target* target) {
+    Release(state, free, const_cast<render_target*>(target));
+  });
+}
+
+void FramebufferPool::Release(std::weak_ptr<pool_state> state, free_func free, render_target* target) {
+  std::unique_ptr<render_target> owned(target);
+  auto pool = state.lock();
+  if (!pool) {
+    // pool's already gone
+    free(*target);
+    return;
+  }
+
+  std::list<render_target> evicted;
+  {
+    std::unique_lock<std::mutex> lock(pool->lock);
+    size_t bytes = GetTargetBytes(target->size);
+    pool->stats.bytes_in_use -= bytes;
+    pool->stats.bytes_idle += bytes;
+    pool->idle.push_front(*target);
+    evicted = Trim(*pool);
+  }
+
+  for (auto& t : evicted) {
+    free(t);
+  }
+}
+
+std::list<render_target> FramebufferPool::Trim(pool_state& state) {
+  std::list<render_target> res;
+  while (!state.idle.empty() && state.stats.bytes_in_use + state.stats.bytes_idle > state.budget) {
+    state.stats.bytes_idle -= GetTargetBytes(state.idle.back().size);
+    state.stats.evictions++;
+    res.splice(res.end(), state.idle, std::prev(state.idle.end()));
+  }
+
+  return res;
+}
+
+void FramebufferPool::SetBudget(size_t budget) {
+  std::list<render_target> evicted;
+  {
+    std::unique_lock<std::mutex> lock(state_->lock);
+    state_->budget = budget;
+    evicted = Trim(*state_);
+  }
+
+  for (auto& target : evicted) {
+    state_->free(target);
+  }
+}
+
+void FramebufferPool::Clear() {
+  std::list<render_target> evicted;
+  {
+    std::unique_lock<std::mutex> lock(state_->lock);
+    evicted.swap(state_->idle);
+    state_->stats.bytes_idle = 0;
+  }
+
+  for (auto& target : evicted) {
+    state_->free(target);
+  }
+}
+
+pool_stats FramebufferPool::GetStats() {
+  std::unique_lock<std::mutex> lock(state_->lock);
+  return state_->stats;
+}
+
+glm::ivec2 FramebufferPool::GetBucket(glm::ivec2 size) {
+  glm::ivec2 res;
+  for (int i = 0; i < 2; i++) {
+    int dim = (size[i] < 1 ? 1 : size[i]);
+    // step grows with the size, so waste stays under a quarter of each dimension
+    int pow = 1;
+    while (pow < dim) {
+      pow *= 2;
+    }
+
+    int step = (pow / 8 > MIN_BUCKET_STEP ? pow / 8 : MIN_BUCKET_STEP);
+    res[i] = ((dim + step - 1) / step) * step;
+  }
+
+  return res;
+}
+
+size_t FramebufferPool::GetTargetBytes(glm::ivec2 size) {
+  return static_cast<size_t>(size.x) * static_cast<size_t>(size.y) * 8;
+}
+
+render_target FramebufferPool::CreateGLTarget(glm::ivec2 size) {
+  // don't disturb whatever the caller has bound
+  GLint draw_binding, read_binding;
+  glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &draw_binding);
+  glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &read_binding);
+
+  render_target res;
+  res.size = size;
+  glGenTextures(1, &res.color);
+  glGenTextures(1, &res.depth_stencil);
+  glBindTexture(GL_TEXTURE_2D, res.depth_stencil);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8,
+                static_cast<uint32_t>(size.x), static_cast<uint32_t>(size.y),
+                0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, NULL);
+  glBindTexture(GL_TEXTURE_2D, res.color);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8,
+                static_cast<uint32_t>(size.x), static_cast<uint32_t>(size.y),
+                0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+  glGenFramebuffers(1, &res.fb);
+  glBindFramebuffer(GL_FRAMEBUFFER, res.fb);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, res.color, 0);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, res.depth_stencil, 0);
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    BOOST_LOG_TRIVIAL(error) << "incomplete framebuffer :(";
+    BOOST_LOG_TRIVIAL(error) << size.x << ", " << size.y;
+  }
+
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(draw_binding));
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, static_cast<GLuint>(read_binding));
+  return res;
+}
+
+void FramebufferPool::DestroyGLTarget(const render_target& target) {
+  if (!glfwGetCurrentContext()) {
+    BOOST_LOG_TRIVIAL(error) << "could not delete GL components!";
+    return;
+  }
+
+  glDeleteFramebuffers(1, &target.fb);
+  glDeleteTextures(1, &target.color);
+  glDeleteTextures(1, &target.depth_stencil);
+}
+
+FramebufferPool::~FramebufferPool() {
+  Clear();
+}
+
+}
+}
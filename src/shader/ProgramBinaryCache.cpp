@@ -0,0 +1,146 @@
+#include <shader/ProgramBinaryCache.hpp>
+#include <utils/FileUtils.hpp>
+#include <utils/HashUtils.hpp>
+
+#include <boost/log/trivial.hpp>
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace monkeysworld {
+namespace shader {
+
+using utils::fileutils::GetRemainingLength;
+using utils::fileutils::ReadAsBytes;
+using utils::fileutils::WriteAsBytes;
+using utils::hashutils::FNV_OFFSET;
+using utils::hashutils::HashBytes;
+
+static std::string GetGLString(GLenum name) {
+  const GLubyte* res = glGetString(name);
+  return (res != NULL ? std::string(reinterpret_cast<const char*>(res)) : std::string());
+}
+
+ProgramBinaryCache::ProgramBinaryCache(const std::string& cache_dir) {
+  cache_dir_ = cache_dir;
+}
+
+uint64_t ProgramBinaryCache::GetProgramKey(const std::string& driver, const std::vector<std::pair<GLenum, std::string>>& sources) {
+  uint64_t hash = HashBytes(FNV_OFFSET, driver.c_str(), driver.size() + 1);
+  for (auto& source : sources) {
+    uint32_t stage = static_cast<uint32_t>(source.first);
+    hash = HashBytes(hash, &stage, sizeof(uint32_t));
+    // include the terminator, so that moving text between stages changes the hash
+    hash = HashBytes(hash, source.second.c_str(), source.second.size() + 1);
+  }
+
+  return hash;
+}
+
+std::string ProgramBinaryCache::GetDriverString() {
+  return GetGLString(GL_VENDOR) + "|" + GetGLString(GL_RENDERER) + "|" + GetGLString(GL_VERSION);
+}
+
+bool ProgramBinaryCache::IsSupported() {
+  GLint formats = 0;
+  glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+  return (formats > 0);
+}
+
+GLuint ProgramBinaryCache::LoadProgram(uint64_t key) {
+  GLenum format;
+  std::vector<char> data;
+  if (!ReadBinary(key, &format, &data)) {
+    return 0;
+  }
+
+  GLuint prog = glCreateProgram();
+  glProgramBinary(prog, format, data.data(), static_cast<GLsizei>(data.size()));
+
+  GLint success;
+  glGetProgramiv(prog, GL_LINK_STATUS, &success);
+  if (success != GL_TRUE) {
+    // driver probably changed -- we'll overwrite this once it's recompiled
+    BOOST_LOG_TRIVIAL(debug) << "Cached program " << GetBinaryPath(key) << " was rejected by the driver";
+    glDeleteProgram(prog);
+    return 0;
+  }
+
+  return prog;
+}
+
+bool ProgramBinaryCache::StoreProgram(uint64_t key, GLuint prog) {
+  GLint len = 0;
+  glGetProgramiv(prog, GL_PROGRAM_BINARY_LENGTH, &len);
+  if (len <= 0) {
+    return false;
+  }
+
+  std::vector<char> data(len);
+  GLenum format;
+  GLsizei written = 0;
+  glGetProgramBinary(prog, len, &written, &format, data.data());
+  if (written <= 0) {
+    return false;
+  }
+
+  data.resize(written);
+  return WriteBinary(key, format, data);
+}
+
+bool ProgramBinaryCache::ReadBinary(uint64_t key, GLenum* format, std::vector<char>* data) {
+  std::ifstream input(GetBinaryPath(key), std::ios_base::in | std::ios_base::binary);
+  if (!input.good()) {
+    return false;
+  }
+
+  uint32_t magic = ReadAsBytes<uint32_t>(input);
+  uint64_t key_stored = ReadAsBytes<uint64_t>(input);
+  uint32_t format_stored = ReadAsBytes<uint32_t>(input);
+  uint32_t len = ReadAsBytes<uint32_t>(input);
+  if (!input.good() || magic != BINARY_MAGIC || key_stored != key) {
+    BOOST_LOG_TRIVIAL(warning) << "Program cache " << GetBinaryPath(key) << " has a bad header";
+    return false;
+  }
+
+  // check before allocating -- a corrupt length could ask for gigabytes
+  if (GetRemainingLength(input) < static_cast<std::streamoff>(len)) {
+    BOOST_LOG_TRIVIAL(warning) << "Program cache " << GetBinaryPath(key) << " is truncated";
+    return false;
+  }
+
+  data->resize(len);
+  input.read(data->data(), len);
+  if (input.gcount() != static_cast<std::streamsize>(len)) {
+    BOOST_LOG_TRIVIAL(warning) << "Program cache " << GetBinaryPath(key) << " is truncated";
+    return false;
+  }
+
+  *format = static_cast<GLenum>(format_stored);
+  return true;
+}
+
+bool ProgramBinaryCache::WriteBinary(uint64_t key, GLenum format, const std::vector<char>& data) {
+  std::ofstream output(GetBinaryPath(key), std::ios_base::out | std::ios_base::trunc | std::ios_base::binary);
+  if (!output.good()) {
+    BOOST_LOG_TRIVIAL(warning) << "Could not write program cache " << GetBinaryPath(key);
+    return false;
+  }
+
+  WriteAsBytes(output, BINARY_MAGIC);
+  WriteAsBytes(output, key);
+  WriteAsBytes(output, static_cast<uint32_t>(format));
+  WriteAsBytes(output, static_cast<uint32_t>(data.size()));
+  output.write(data.data(), data.size());
+  return output.good();
+}
+
+std::string ProgramBinaryCache::GetBinaryPath(uint64_t key) {
+  std::stringstream path;
+  path << cache_dir_ << std::hex << std::setw(16) << std::setfill('0') << key << ".progbin";
+  return path.str();
+}
+
+}
+}
@@ -0,0 +1,397 @@
+#include <shader/ProgramRegistry.hpp>
+#include <shader/ShaderPreprocessor.hpp>
+#include <engine/Context.hpp>
+
+#include <boost/log/trivial.hpp>
+
+#include <exception>
+#include <set>
+
+namespace monkeysworld {
+namespace shader {
+
+ProgramRegistry& ProgramRegistry::GetInstance() {
+  static ProgramRegistry registry;
+  return registry;
+}
+
+/**
+ *  Builds the program described by `info`.
+ */
+static std::shared_ptr<ShaderProgram> BuildProgram(std::shared_ptr<file::CachedFileLoader> loader,
+                                                   const program_info& info) {
+  ShaderProgramBuilder builder(loader);
+  for (auto& define : info.defines) {
+    builder.WithDefine(define.first, define.second);
+  }
+
+  if (!info.vertex_path.empty()) {
+    builder.WithVertexShader(info.vertex_path);
+  }
+
+  if (!info.geometry_path.empty()) {
+    builder.WithGeometryShader(info.geometry_path);
+  }
+
+  if (!info.fragment_path.empty()) {
+    builder.WithFragmentShader(info.fragment_path);
+  }
+
+  return std::make_shared<ShaderProgram>(builder.Build());
+}
+
+std::shared_ptr<ShaderProgram> ProgramRegistry::GetProgram(engine::Context* ctx, const program_info& info) {
+  std::string key = GetKey(info);
+  if (ctx == nullptr) {
+    RecordSource(key, info, nullptr);
+    return GetOrBuild(key, [&] { return BuildProgram(nullptr, info); });
+  }
+
+  RecordSource(key, info, ctx->GetCachedFileLoader());
+
+  {
+    std::unique_lock<std::mutex> lock(registry_lock_);
+    auto i = programs_.find(key);
+    if (i != programs_.end()) {
+      auto res = i->second.lock();
+      if (res) {
+        return res;
+      }
+    }
+  }
+
+  // all builds happen on the main thread, so the main thread never waits on another thread's build.
+  // requests queued behind a build pick up its result in GetOrBuild.
+  auto loader = ctx->GetCachedFileLoader();
+  std::shared_ptr<ShaderProgram> res;
+  std::exception_ptr error;
+  auto build_func = [&] {
+    try {
+      std::shared_ptr<async_build> pending;
+      {
+        std::unique_lock<std::mutex> lock(registry_lock_);
+        auto i = async_builds_.find(key);
+        if (i != async_builds_.end()) {
+          pending = i->second;
+        }
+      }
+
+      if (pending) {
+        // we can't wait for the poll, so force it to finish now
+        FinishAsync(key, pending);
+        res = pending->future.get();
+      } else {
+        res = GetOrBuild(key, [&] { return BuildProgram(loader, info); });
+      }
+    } catch (...) {
+      // don't let the exception escape into the executor
+      error = std::current_exception();
+    }
+  };
+
+  ctx->GetExecutor()->ScheduleOnMainThread(build_func).wait();
+  if (error) {
+    std::rethrow_exception(error);
+  }
+
+  return res;
+}
+
+std::shared_ptr<ShaderProgram> ProgramRegistry::GetProgram(engine::Context* ctx,
+                                                           const std::string& vertex_path,
+                                                           const std::string& fragment_path) {
+  program_info info;
+  info.vertex_path = vertex_path;
+  info.fragment_path = fragment_path;
+  return GetProgram(ctx, info);
+}
+
+ProgramRegistry::build_future ProgramRegistry::GetProgramAsync(engine::Context* ctx, const program_info& info) {
+  if (ctx == nullptr) {
+    std::promise<std::shared_ptr<ShaderProgram>> res;
+    try {
+      res.set_value(GetProgram(ctx, info));
+    } catch (...) {
+      res.set_exception(std::current_exception());
+    }
+
+    return res.get_future().share();
+  }
+
+  std::string key = GetKey(info);
+  RecordSource(key, info, ctx->GetCachedFileLoader());
+  auto build = std::make_shared<async_build>();
+  {
+    std::unique_lock<std::mutex> lock(registry_lock_);
+    auto i = programs_.find(key);
+    if (i != programs_.end()) {
+      auto prog = i->second.lock();
+      if (prog) {
+        std::promise<std::shared_ptr<ShaderProgram>> res;
+        res.set_value(prog);
+        return res.get_future().share();
+      }
+    }
+
+    auto a = async_builds_.find(key);
+    if (a != async_builds_.end()) {
+      return a->second->future;
+    }
+
+    auto b = builds_.find(key);
+    if (b != builds_.end()) {
+      return b->second;
+    }
+
+    build->info = info;
+    build->loader = ctx->GetCachedFileLoader();
+    build->future = build->promise.get_future().share();
+    build->done = false;
+    async_builds_.insert(std::make_pair(key, build));
+  }
+
+  auto executor = ctx->GetExecutor();
+  auto start_func = [this, key, build, executor] {
+    StartAsync(key, build);
+    executor->PollOnMainThread([this, key, build] {
+      if (!build->done && build->builder->IsBuildComplete()) {
+        FinishAsync(key, build);
+      }
+
+      return build->done;
+    });
+  };
+
+  executor->ScheduleOnMainThread(start_func);
+  return build->future;
+}
+
+void ProgramRegistry::StartAsync(const std::string& key, std::shared_ptr<async_build> build) {
+  if (build->builder || build->done) {
+    return;
+  }
+
+  auto builder = std::make_shared<ShaderProgramBuilder>(build->loader);
+  build->builder = builder;
+  try {
+    for (auto& define : build->info.defines) {
+      builder->WithDefine(define.first, define.second);
+    }
+
+    if (!build->info.vertex_path.empty()) {
+      builder->WithVertexShader(build->info.vertex_path);
+    }
+
+    if (!build->info.geometry_path.empty()) {
+      builder->WithGeometryShader(build->info.geometry_path);
+    }
+
+    if (!build->info.fragment_path.empty()) {
+      builder->WithFragmentShader(build->info.fragment_path);
+    }
+
+    builder->StartBuild();
+  } catch (...) {
+    build->done = true;
+    build->builder.reset();
+    {
+      std::unique_lock<std::mutex> lock(registry_lock_);
+      async_builds_.erase(key);
+    }
+
+    build->promise.set_exception(std::current_exception());
+  }
+}
+
+void ProgramRegistry::FinishAsync(const std::string& key, std::shared_ptr<async_build> build) {
+  StartAsync(key, build);
+  if (build->done) {
+    return;
+  }
+
+  build->done = true;
+  std::shared_ptr<ShaderProgram> res;
+  try {
+    res = std::make_shared<ShaderProgram>(build->builder->FinishBuild());
+  } catch (...) {
+    build->builder.reset();
+    {
+      std::unique_lock<std::mutex> lock(registry_lock_);
+      async_builds_.erase(key);
+    }
+
+    build->promise.set_exception(std::current_exception());
+    return;
+  }
+
+  build->builder.reset();
+  {
+    std::unique_lock<std::mutex> lock(registry_lock_);
+    programs_[key] = res;
+    async_builds_.erase(key);
+  }
+
+  BOOST_LOG_TRIVIAL(debug) << "Registered program " << key;
+  build->promise.set_value(res);
+}
+
+std::shared_ptr<ShaderProgram> ProgramRegistry::GetOrBuild(const std::string& key,
+                                                           const std::function<std::shared_ptr<ShaderProgram>()>& build) {
+  std::promise<std::shared_ptr<ShaderProgram>> promise;
+  {
+    std::unique_lock<std::mutex> lock(registry_lock_);
+    auto i = programs_.find(key);
+    if (i != programs_.end()) {
+      auto res = i->second.lock();
+      if (res) {
+        return res;
+      }
+    }
+
+    auto b = builds_.find(key);
+    if (b != builds_.end()) {
+      build_future pending = b->second;
+      lock.unlock();
+      return pending.get();
+    }
+
+    builds_.insert(std::make_pair(key, promise.get_future().share()));
+  }
+
+  std::shared_ptr<ShaderProgram> res;
+  try {
+    res = build();
+  } catch (...) {
+    {
+      std::unique_lock<std::mutex> lock(registry_lock_);
+      builds_.erase(key);
+    }
+
+    promise.set_exception(std::current_exception());
+    throw;
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(registry_lock_);
+    programs_[key] = res;
+    builds_.erase(key);
+  }
+
+  BOOST_LOG_TRIVIAL(debug) << "Registered program " << key;
+  promise.set_value(res);
+  return res;
+}
+
+size_t ProgramRegistry::ReloadPrograms(const std::vector<std::string>& changed_paths) {
+  // everything which includes a changed file needs to be rebuilt too
+  auto& preprocessor = ShaderPreprocessor::GetInstance();
+  std::set<std::string> stale;
+  for (auto& path : changed_paths) {
+    std::string normalized = ShaderPreprocessor::NormalizePath(path);
+    auto dependents = preprocessor.GetDependents(normalized);
+    stale.insert(dependents.begin(), dependents.end());
+    stale.insert(normalized);
+    preprocessor.Invalidate(normalized);
+  }
+
+  auto is_stale = [&](const std::string& path) {
+    return (!path.empty() && stale.count(ShaderPreprocessor::NormalizePath(path)));
+  };
+
+  std::vector<std::pair<std::shared_ptr<ShaderProgram>, program_source>> targets;
+  {
+    std::unique_lock<std::mutex> lock(registry_lock_);
+    for (auto& entry : programs_) {
+      auto prog = entry.second.lock();
+      auto source = sources_.find(entry.first);
+      if (!prog || source == sources_.end()) {
+        continue;
+      }
+
+      const program_info& info = source->second.info;
+      if (is_stale(info.vertex_path) || is_stale(info.geometry_path) || is_stale(info.fragment_path)) {
+        targets.push_back(std::make_pair(prog, source->second));
+      }
+    }
+  }
+
+  size_t rebuilt = 0;
+  for (auto& target : targets) {
+    try {
+      auto fresh = BuildProgram(target.second.loader.lock(), target.second.info);
+      *target.first = std::move(*fresh);
+      rebuilt++;
+    } catch (std::exception& e) {
+      // probably a typo -- keep drawing with the old program until it's fixed
+      BOOST_LOG_TRIVIAL(error) << "Could not reload program " << GetKey(target.second.info) << ": " << e.what();
+    }
+  }
+
+  return rebuilt;
+}
+
+void ProgramRegistry::RecordSource(const std::string& key,
+                                   const program_info& info,
+                                   std::shared_ptr<file::CachedFileLoader> loader) {
+  {
+    std::unique_lock<std::mutex> lock(registry_lock_);
+    auto i = sources_.find(key);
+    if (i == sources_.end()) {
+      program_source source;
+      source.info = info;
+      source.loader = loader;
+      sources_.insert(std::make_pair(key, source));
+    } else if (loader) {
+      // the scene which first asked for this program may be gone -- rebuild through the newest one
+      i->second.loader = loader;
+    }
+  }
+
+  if (!loader) {
+    return;
+  }
+
+  // cached sources are never read through this loader, so it wouldn't notice them changing
+  auto& preprocessor = ShaderPreprocessor::GetInstance();
+  for (auto path : { &info.vertex_path, &info.geometry_path, &info.fragment_path }) {
+    if (path->empty()) {
+      continue;
+    }
+
+    loader->WatchFile(*path);
+    for (auto& dependency : preprocessor.GetDependencies(*path)) {
+      loader->WatchFile(dependency);
+    }
+  }
+}
+
+size_t ProgramRegistry::GetProgramCount() {
+  std::unique_lock<std::mutex> lock(registry_lock_);
+  size_t count = 0;
+  for (auto i = programs_.begin(); i != programs_.end();) {
+    if (i->second.expired()) {
+      i = programs_.erase(i);
+    } else {
+      count++;
+      i++;
+    }
+  }
+
+  return count;
+}
+
+std::string ProgramRegistry::GetKey(const program_info& info) {
+  // '|' and '\n' won't show up in paths or define names
+  std::string key = info.vertex_path + "|" + info.geometry_path + "|" + info.fragment_path;
+  for (auto& define : info.defines) {
+    key.append("\n");
+    key.append(define.first);
+    key.append("=");
+    key.append(define.second);
+  }
+
+  return key;
+}
+
+}
+}
@@ -0,0 +1,305 @@
+#include <shader/ShaderPreprocessor.hpp>
+#include <shader/exception/InvalidShaderException.hpp>
+
+#include <boost/log/trivial.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+namespace monkeysworld {
+namespace shader {
+
+using exception::InvalidShaderException;
+using file::CachedFileLoader;
+
+static const std::string INCLUDE_DIRECTIVE = "#include";
+
+ShaderPreprocessor& ShaderPreprocessor::GetInstance() {
+  static ShaderPreprocessor preprocessor;
+  return preprocessor;
+}
+
+std::string ShaderPreprocessor::GetSource(const std::string& path,
+                                          const std::string& defines,
+                                          std::shared_ptr<CachedFileLoader> loader) {
+  std::string key = NormalizePath(path);
+  uint64_t epoch;
+  {
+    std::unique_lock<std::mutex> lock(preprocessor_lock_);
+    auto variants = expanded_.find(key);
+    if (variants != expanded_.end()) {
+      auto i = variants->second.find(defines);
+      if (i != variants->second.end()) {
+        return i->second;
+      }
+    }
+
+    epoch = invalidations_;
+  }
+
+  // reading happens without the lock -- other threads can expand what's already cached meanwhile
+  std::string output;
+  std::vector<std::string> stack;
+  Expand(key, loader, epoch, stack, output);
+
+  if (!defines.empty()) {
+    // #version has to come first
+    size_t version = output.find("#version");
+    size_t line_end = (version == std::string::npos ? std::string::npos : output.find('\n', version));
+    if (version == std::string::npos) {
+      output.insert(0, defines);
+    } else if (line_end == std::string::npos) {
+      output.append("\n");
+      output.append(defines);
+    } else {
+      output.insert(line_end + 1, defines);
+    }
+  }
+
+  // don't hold onto failed reads -- the file might show up later
+  if (!output.empty()) {
+    std::unique_lock<std::mutex> lock(preprocessor_lock_);
+    if (invalidations_ == epoch) {
+      // if someone else got here first, theirs is just as good
+      expanded_[key].insert(std::make_pair(defines, output));
+    }
+  }
+
+  return output;
+}
+
+std::set<std::string> ShaderPreprocessor::GetDependencies(const std::string& path) {
+  std::unique_lock<std::mutex> lock(preprocessor_lock_);
+  std::set<std::string> res;
+  std::vector<std::string> queue;
+  queue.push_back(NormalizePath(path));
+  while (!queue.empty()) {
+    std::string cur = queue.back();
+    queue.pop_back();
+    auto file = files_.find(cur);
+    if (file == files_.end()) {
+      continue;
+    }
+
+    for (auto& include : file->second->includes) {
+      if (res.insert(include).second) {
+        queue.push_back(include);
+      }
+    }
+  }
+
+  return res;
+}
+
+std::set<std::string> ShaderPreprocessor::GetDependents(const std::string& path) {
+  std::unique_lock<std::mutex> lock(preprocessor_lock_);
+  std::set<std::string> res;
+  std::vector<std::string> queue;
+  queue.push_back(NormalizePath(path));
+  while (!queue.empty()) {
+    std::string cur = queue.back();
+    queue.pop_back();
+    auto parents = included_by_.find(cur);
+    if (parents == included_by_.end()) {
+      continue;
+    }
+
+    for (auto& parent : parents->second) {
+      if (res.insert(parent).second) {
+        queue.push_back(parent);
+      }
+    }
+  }
+
+  return res;
+}
+
+void ShaderPreprocessor::Invalidate(const std::string& path) {
+  std::string key = NormalizePath(path);
+  std::set<std::string> stale = GetDependents(key);
+  stale.insert(key);
+
+  std::unique_lock<std::mutex> lock(preprocessor_lock_);
+  invalidations_++;
+  // only the changed file needs to be re-read -- its dependents just need to be re-expanded
+  auto file = files_.find(key);
+  if (file != files_.end()) {
+    for (auto& include : file->second->includes) {
+      included_by_[include].erase(key);
+    }
+
+    files_.erase(file);
+  }
+
+  for (auto& stale_path : stale) {
+    expanded_.erase(stale_path);
+  }
+}
+
+std::string ShaderPreprocessor::NormalizePath(const std::string& path) {
+  std::vector<std::string> segments;
+  size_t start = 0;
+  while (start <= path.size()) {
+    size_t end = path.find_first_of("/\\", start);
+    if (end == std::string::npos) {
+      end = path.size();
+    }
+
+    std::string segment = path.substr(start, end - start);
+    if (segment == "..") {
+      if (!segments.empty() && segments.back() != ".." && !segments.back().empty()) {
+        segments.pop_back();
+      } else {
+        segments.push_back(segment);
+      }
+    } else if (segment != "." && !(segment.empty() && !segments.empty())) {
+      // keep a leading empty segment, for absolute paths
+      segments.push_back(segment);
+    }
+
+    start = end + 1;
+  }
+
+  std::string res;
+  for (size_t i = 0; i < segments.size(); i++) {
+    if (i > 0) {
+      res.append("/");
+    }
+
+    res.append(segments[i]);
+  }
+
+  return res;
+}
+
+ShaderPreprocessor::parsed_file ShaderPreprocessor::Tokenize(const std::string& contents, const std::string& local_dir) {
+  parsed_file res;
+  res.text.push_back(std::string());
+  size_t line_start = 0;
+  while (line_start < contents.size()) {
+    size_t line_end = contents.find('\n', line_start);
+    if (line_end == std::string::npos) {
+      line_end = contents.size();
+    }
+
+    // looking for: whitespace, #include, whitespace, "path"
+    size_t cur = contents.find_first_not_of(" \t", line_start);
+    bool is_include = false;
+    if (cur != std::string::npos && cur < line_end && contents.compare(cur, INCLUDE_DIRECTIVE.size(), INCLUDE_DIRECTIVE) == 0) {
+      cur = contents.find_first_not_of(" \t", cur + INCLUDE_DIRECTIVE.size());
+      if (cur != std::string::npos && cur < line_end && contents[cur] == '"') {
+        size_t close = contents.find('"', cur + 1);
+        if (close != std::string::npos && close < line_end) {
+          res.includes.push_back(NormalizePath(local_dir + contents.substr(cur + 1, close - cur - 1)));
+          res.text.push_back(std::string());
+          is_include = true;
+        }
+      }
+    }
+
+    if (!is_include) {
+      res.text.back().append(contents, line_start, line_end - line_start);
+      res.text.back().append("\n");
+    }
+
+    line_start = line_end + 1;
+  }
+
+  return res;
+}
+
+std::shared_ptr<const ShaderPreprocessor::parsed_file> ShaderPreprocessor::GetParsedFile(const std::string& path,
+                                                                                         std::shared_ptr<CachedFileLoader> loader,
+                                                                                         uint64_t epoch) {
+  {
+    std::unique_lock<std::mutex> lock(preprocessor_lock_);
+    auto i = files_.find(path);
+    if (i != files_.end()) {
+      return i->second;
+    }
+  }
+
+  std::string contents;
+  if (!ReadFile(path, loader, &contents)) {
+    BOOST_LOG_TRIVIAL(warning) << "Could not read shader file " << path;
+    return nullptr;
+  }
+
+  size_t dir = path.find_last_of("/\\");
+  std::string local_dir = (dir == std::string::npos ? "" : path.substr(0, dir + 1));
+  auto parsed = std::make_shared<const parsed_file>(Tokenize(contents, local_dir));
+
+  std::unique_lock<std::mutex> lock(preprocessor_lock_);
+  if (invalidations_ != epoch) {
+    // might be from before the file changed -- use it this once, but don't keep it
+    return parsed;
+  }
+
+  auto res = files_.insert(std::make_pair(path, parsed));
+  if (res.second) {
+    for (auto& include : parsed->includes) {
+      included_by_[include].insert(path);
+    }
+  }
+
+  // first read in wins
+  return res.first->second;
+}
+
+void ShaderPreprocessor::Expand(const std::string& path,
+                                std::shared_ptr<CachedFileLoader> loader,
+                                uint64_t epoch,
+                                std::vector<std::string>& stack,
+                                std::string& output) {
+  if (std::find(stack.begin(), stack.end(), path) != stack.end()) {
+    std::string cycle;
+    for (auto& file : stack) {
+      cycle.append(file + " -> ");
+    }
+
+    cycle.append(path);
+    BOOST_LOG_TRIVIAL(error) << "Include cycle in shader: " << cycle;
+    throw InvalidShaderException("Include cycle: " + cycle);
+  }
+
+  std::shared_ptr<const parsed_file> file = GetParsedFile(path, loader, epoch);
+  if (file == nullptr) {
+    return;
+  }
+
+  stack.push_back(path);
+  for (size_t i = 0; i < file->includes.size(); i++) {
+    output.append(file->text[i]);
+    Expand(file->includes[i], loader, epoch, stack, output);
+  }
+
+  output.append(file->text.back());
+  stack.pop_back();
+}
+
+bool ShaderPreprocessor::ReadFile(const std::string& path,
+                                  std::shared_ptr<CachedFileLoader> loader,
+                                  std::string* output) {
+  if (!loader) {
+    std::ifstream file(path, std::ios_base::in | std::ios_base::binary);
+    if (!file.good()) {
+      return false;
+    }
+
+    output->assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+  }
+
+  file::CacheStreambuf buffer = loader->LoadFile(path);
+  std::istream file(&buffer);
+  if (!file.good()) {
+    return false;
+  }
+
+  output->assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  return true;
+}
+
+}
+}
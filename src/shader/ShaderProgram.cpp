@@ -41,6 +41,15 @@ ShaderProgram::ShaderProgram(ShaderProgram&& other) {
 }
 
 ShaderProgram& ShaderProgram::operator=(ShaderProgram&& other) {
+  if (this == &other) {
+    return *this;
+  }
+
+  // programs are swapped in place on reload -- don't leak the old one
+  if (prog_) {
+    glDeleteProgram(prog_);
+  }
+
   prog_ = other.prog_;
   other.prog_ = 0;
   // other was being dtor'd and thus the program disappeared
@@ -1,21 +1,32 @@
 #include <shader/ShaderProgramBuilder.hpp>
+#include <shader/ProgramBinaryCache.hpp>
+#include <shader/ShaderPreprocessor.hpp>
 #include <shader/exception/InvalidShaderException.hpp>
 #include <shader/exception/LinkFailedException.hpp>
 #include <glad/glad.h>
 
 #include <boost/log/trivial.hpp>
-#include <boost/regex.hpp>
 
-#include <fstream>
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+
+#include <cstring>
 
 namespace monkeysworld {
 namespace shader {
 
-using std::ios_base;
 using exception::InvalidShaderException;
 using exception::LinkFailedException;
 using file::CachedFileLoader;
 
+// KHR_parallel_shader_compile isn't part of our glad build
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+typedef void (*max_threads_func)(GLuint count);
+
 
 static std::string GetShaderType(GLint type) {
   switch (type) {
@@ -33,95 +44,231 @@ static std::string GetShaderType(GLint type) {
 ShaderProgramBuilder::ShaderProgramBuilder() : ShaderProgramBuilder(nullptr) {}
 
 ShaderProgramBuilder::ShaderProgramBuilder(std::shared_ptr<CachedFileLoader> loader) {
-  shaders_ = ShaderPacket();
-  prog_ = 0;
   loader_ = loader;
+  prog_ = 0;
+  cache_key_ = 0;
+  cache_supported_ = false;
+  from_cache_ = false;
 }
 
-ShaderProgramBuilder::ShaderProgramBuilder(ShaderProgramBuilder&& other) {
-  shaders_ = std::move(other.shaders_);
-  memset(&other.shaders_, 0, sizeof(ShaderPacket));
-  prog_ = other.prog_;
-  other.prog_ = 0;
-  loader_ = std::move(other.loader_);
+ShaderProgramBuilder::ShaderProgramBuilder(ShaderProgramBuilder&& other) : ShaderProgramBuilder(nullptr) {
+  *this = std::move(other);
 }
 
 ShaderProgramBuilder& ShaderProgramBuilder::operator=(ShaderProgramBuilder&& other) {
+  if (this == &other) {
+    return *this;
+  }
+
+  ReleaseShaders();
+  if (prog_ != 0) {
+    glDeleteProgram(prog_);
+  }
+
+  sources_ = std::move(other.sources_);
+  paths_ = std::move(other.paths_);
+  defines_ = std::move(other.defines_);
+  loader_ = std::move(other.loader_);
   shaders_ = std::move(other.shaders_);
-  memset(&other.shaders_, 0, sizeof(ShaderPacket));
+  other.shaders_.clear();
   prog_ = other.prog_;
   other.prog_ = 0;
-  loader_ = other.loader_;
+  cache_key_ = other.cache_key_;
+  cache_supported_ = other.cache_supported_;
+  from_cache_ = other.from_cache_;
   return *this;
 }
 
 ShaderProgramBuilder& ShaderProgramBuilder::WithVertexShader(const std::string& vertex_path) {
-  shaders_.vertex_shader = CreateShaderFromFile(vertex_path, GL_VERTEX_SHADER);
+  AddStage(vertex_path, GL_VERTEX_SHADER);
   return *this;
 }
 
 ShaderProgramBuilder& ShaderProgramBuilder::WithGeometryShader(const std::string& geometry_path) {
-  shaders_.geometry_shader = CreateShaderFromFile(geometry_path, GL_GEOMETRY_SHADER);
+  AddStage(geometry_path, GL_GEOMETRY_SHADER);
   return *this;
 }
 
 ShaderProgramBuilder& ShaderProgramBuilder::WithFragmentShader(const std::string& fragment_path) {
-  shaders_.fragment_shader = CreateShaderFromFile(fragment_path, GL_FRAGMENT_SHADER);
+  AddStage(fragment_path, GL_FRAGMENT_SHADER);
+  return *this;
+}
+
+ShaderProgramBuilder& ShaderProgramBuilder::WithDefine(const std::string& name, const std::string& value) {
+  defines_.push_back(std::make_pair(name, value));
   return *this;
 }
 
 ShaderProgram ShaderProgramBuilder::Build() {
-  GLuint prog = glCreateProgram();
+  StartBuild();
+  return FinishBuild();
+}
 
-  AttachIfNonZero(prog, shaders_.vertex_shader);
-  AttachIfNonZero(prog, shaders_.fragment_shader);
-  AttachIfNonZero(prog, shaders_.geometry_shader);
-  glLinkProgram(prog);
+void ShaderProgramBuilder::StartBuild() {
+  std::string define_block;
+  for (auto& define : defines_) {
+    define_block.append("#define " + define.first + " " + define.second + "\n");
+  }
 
-  GLint success;
-  glGetProgramiv(prog, GL_LINK_STATUS, &success);
-  if (success != GL_TRUE) {
-    std::string error_msg;
-    error_msg.resize(512);
-    glGetProgramInfoLog(prog, 512, NULL, &error_msg[0]); 
-    BOOST_LOG_TRIVIAL(error) << "Shader link failed: " << error_msg;
-    throw LinkFailedException("Link failed: " + error_msg);
+  auto& preprocessor = ShaderPreprocessor::GetInstance();
+  for (size_t i = 0; i < sources_.size(); i++) {
+    sources_[i].second = preprocessor.GetSource(paths_[i], define_block, loader_);
+  }
+
+  cache_supported_ = ProgramBinaryCache::IsSupported();
+  if (cache_supported_) {
+    cache_key_ = ProgramBinaryCache::GetProgramKey(ProgramBinaryCache::GetDriverString(), sources_);
+    ProgramBinaryCache cache(CachedFileLoader::GetCacheDirectory());
+    GLuint prog = cache.LoadProgram(cache_key_);
+    if (prog != 0) {
+      BOOST_LOG_TRIVIAL(debug) << "Loaded program " << prog << " from cache";
+      prog_ = prog;
+      from_cache_ = true;
+      return;
+    }
+  }
+
+  prog_ = StartProgram();
+}
+
+bool ShaderProgramBuilder::IsBuildComplete() {
+  if (prog_ == 0 || from_cache_ || !IsParallelCompileSupported()) {
+    return true;
   }
 
+  GLint complete;
+  glGetProgramiv(prog_, GL_COMPLETION_STATUS_KHR, &complete);
+  return (complete == GL_TRUE);
+}
+
+ShaderProgram ShaderProgramBuilder::FinishBuild() {
+  GLuint prog = prog_;
+  if (!from_cache_) {
+    FinishProgram();
+    if (cache_supported_) {
+      ProgramBinaryCache cache(CachedFileLoader::GetCacheDirectory());
+      cache.StoreProgram(cache_key_, prog);
+    }
+  }
+
+  // program belongs to the caller now
+  prog_ = 0;
+  from_cache_ = false;
   return ShaderProgram(prog);
 }
 
+bool ShaderProgramBuilder::IsParallelCompileSupported() {
+  // main thread only, so no need to lock
+  static int supported = -1;
+  if (supported < 0) {
+    supported = 0;
+    GLint ext_count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &ext_count);
+    for (GLint i = 0; i < ext_count; i++) {
+      const char* ext = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+      if (ext != nullptr && (std::strcmp(ext, "GL_KHR_parallel_shader_compile") == 0
+                          || std::strcmp(ext, "GL_ARB_parallel_shader_compile") == 0)) {
+        supported = 1;
+        break;
+      }
+    }
+
+    if (supported) {
+      // let the driver use as many threads as it likes
+      auto max_threads = reinterpret_cast<max_threads_func>(glfwGetProcAddress("glMaxShaderCompilerThreadsKHR"));
+      if (max_threads == nullptr) {
+        max_threads = reinterpret_cast<max_threads_func>(glfwGetProcAddress("glMaxShaderCompilerThreadsARB"));
+      }
+
+      if (max_threads != nullptr) {
+        max_threads(0xFFFFFFFF);
+      }
+
+      BOOST_LOG_TRIVIAL(debug) << "Parallel shader compilation supported";
+    }
+  }
+
+  return (supported == 1);
+}
+
 ShaderProgramBuilder::~ShaderProgramBuilder() {
-  DeleteIfNonZero(shaders_.vertex_shader);
-  DeleteIfNonZero(shaders_.fragment_shader);
-  DeleteIfNonZero(shaders_.geometry_shader);
+  // build was started but never finished
+  ReleaseShaders();
+  if (prog_ != 0) {
+    glDeleteProgram(prog_);
+  }
 }
 
-void ShaderProgramBuilder::AttachIfNonZero(GLuint prog, GLuint shader) {
-  // docs: valid shader is non 0
-  if (shader != 0) {
-    BOOST_LOG_TRIVIAL(debug) << "Attached shader to prog " << prog;
+
+void ShaderProgramBuilder::AddStage(const std::string& shader_path, GLenum shader_type) {
+  // sources are expanded once we know all of our defines
+  sources_.push_back(std::make_pair(shader_type, std::string()));
+  paths_.push_back(shader_path);
+}
+
+GLuint ShaderProgramBuilder::StartProgram() {
+  GLuint prog = glCreateProgram();
+  for (size_t i = 0; i < sources_.size(); i++) {
+    GLuint shader = glCreateShader(sources_[i].first);
+    const char* shader_data = sources_[i].second.c_str();
+    glShaderSource(shader, 1, &shader_data, NULL);
+    glCompileShader(shader);
     glAttachShader(prog, shader);
+    shaders_.push_back(shader);
+    BOOST_LOG_TRIVIAL(debug) << "Attached shader to prog " << prog;
   }
+
+  // let us read the binary back out for the cache
+  glProgramParameteri(prog, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+  // don't query any status here -- that would force the driver to finish compiling
+  glLinkProgram(prog);
+  return prog;
 }
 
-void ShaderProgramBuilder::DeleteIfNonZero(GLuint shader) {
-  if (shader != 0) {
-    glDeleteShader(shader);
+void ShaderProgramBuilder::FinishProgram() {
+  GLint success;
+  glGetProgramiv(prog_, GL_LINK_STATUS, &success);
+  if (success != GL_TRUE) {
+    // a stage which failed to compile is the more useful error
+    for (size_t i = 0; i < shaders_.size(); i++) {
+      try {
+        CheckShader(paths_[i], shaders_[i], sources_[i].first);
+      } catch (InvalidShaderException& e) {
+        ReleaseShaders();
+        glDeleteProgram(prog_);
+        prog_ = 0;
+        throw;
+      }
+    }
+
+    std::string error_msg;
+    error_msg.resize(512);
+    glGetProgramInfoLog(prog_, 512, NULL, &error_msg[0]); 
+    BOOST_LOG_TRIVIAL(error) << "Shader link failed: " << error_msg;
+    ReleaseShaders();
+    glDeleteProgram(prog_);
+    prog_ = 0;
+    throw LinkFailedException("Link failed: " + error_msg);
   }
+
+  // shaders are no longer necessary once linked
+  ReleaseShaders();
 }
 
-// todo: separate file reading into a separate class? it's a bit trivial though :/
-GLuint ShaderProgramBuilder::CreateShaderFromFile(const std::string& shader_path, GLenum shader_type) {
-  GLuint shader = glCreateShader(shader_type);
+void ShaderProgramBuilder::ReleaseShaders() {
+  for (auto shader : shaders_) {
+    if (prog_ != 0) {
+      glDetachShader(prog_, shader);
+    }
 
-  std::string contents = GetFileContents(shader_path);
-  // factor this reading part out into a separate method
+    glDeleteShader(shader);
+  }
 
-  const char* shader_data = contents.c_str();
-  glShaderSource(shader, 1, &shader_data, NULL);
+  shaders_.clear();
+}
 
-  glCompileShader(shader);
+void ShaderProgramBuilder::CheckShader(const std::string& shader_path, GLuint shader, GLenum shader_type) {
   GLint success;
   glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
 
@@ -135,63 +282,6 @@ GLuint ShaderProgramBuilder::CreateShaderFromFile(const std::string& shader_path
     BOOST_LOG_TRIVIAL(error) << GetShaderType(shader_type) << " " << shader_path << " failed to compile: " << error_msg;
     throw InvalidShaderException("Shader failed to compile: " + error_msg);
   }
-
-  return shader;
-}
-
-std::string ShaderProgramBuilder::GetFileContents(const std::string& shader_path) {
-  std::string output;
-  std::istream* shader_file;
-  file::CacheStreambuf buffer;
-
-  if (!loader_) {
-    shader_file = new std::ifstream(shader_path);
-  } else {
-    buffer = loader_->LoadFile(shader_path);
-    shader_file = new std::istream(&buffer);
-  }
-
-  if (!shader_file->good()) {
-    // denote failure condition
-    // probably throw an exception
-    return "";
-  }
-
-  // https://github.com/tntmeijs/GLSL-Shader-Includes/blob/master/Shadinclude.hpp
-
-  size_t dir = shader_path.find_last_of("/\\");
-  std::string local_dir = shader_path.substr(0, dir + 1);
-
-  std::string line;
-  std::string include_head = "#include ";
-  while (!shader_file->eof()) {
-    std::getline(*shader_file, line);
-    // check if the line needs to be parsed
-    if (line.find(include_head) != line.npos) {
-      BOOST_LOG_TRIVIAL(trace) << "found";
-      BOOST_LOG_TRIVIAL(trace) << line;
-      // extract path from quotes
-      boost::regex expr("\\s*#include\\s+\\\"(.*)\\\".*");
-      boost::smatch match;
-
-      // if it matches...
-      if (boost::regex_match(line, match, expr)) {
-        BOOST_LOG_TRIVIAL(trace) << "ok!";
-        // extract include path and load it recursively
-        // circular logic will crash it :(
-        // just don't do that
-        std::string relative_path = match[1];
-        output.append(GetFileContents(local_dir + relative_path));
-        continue;
-      }
-    }
-
-    output.append(line);
-    output.append("\n");
-  }
-
-  delete shader_file;
-  return output;
 }
 
 } // namespace shader
@@ -58,30 +58,7 @@ GLuint Texture::GetTextureDescriptor() const {
     GLuint* tex = const_cast<GLuint*>(&tex_);
     glGenTextures(1, tex);
     glBindTexture(GL_TEXTURE_2D, tex_);
-    switch (channels_) {
-      case 1:
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, width_, height_, 0, GL_RED, GL_UNSIGNED_BYTE, tex_cache_);
-        break;
-      case 3:
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width_, height_, 0, GL_RGB, GL_UNSIGNED_BYTE, tex_cache_);
-        break;
-      case 4:
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width_, height_, 0, GL_RGBA, GL_UNSIGNED_BYTE, tex_cache_);
-        break;
-      default:
-        BOOST_LOG_TRIVIAL(error) << "not sure how to load this one tbh";
-        break;
-    }
-
-    // TODO: the best solution would seemingly be to have the loader load all these textures into its own cache,
-    // then our textures will read them from bytes to a texture object.
-
-    // I AM NOT GOING TO DO THIS RIGHT NOW. but i'll do it later :)
-    if (tex_cache_) {
-      stbi_image_free(tex_cache_);
-      const_cast<unsigned char*>(tex_cache_) = nullptr;
-    }
-    
+    UploadImage();
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glBindTexture(GL_TEXTURE_2D, 0);
@@ -90,6 +67,59 @@ GLuint Texture::GetTextureDescriptor() const {
   return tex_;
 }
 
+bool Texture::Reload(const std::string& path) {
+  int width, height, channels;
+  stbi_set_flip_vertically_on_load(true);
+  unsigned char* image = stbi_load(path.c_str(), &width, &height, &channels, 0);
+  if (!image) {
+    return false;
+  }
+
+  if (tex_cache_) {
+    stbi_image_free(tex_cache_);
+  }
+
+  tex_cache_ = image;
+  width_ = width;
+  height_ = height;
+  channels_ = channels;
+
+  // not uploaded yet -- GetTextureDescriptor will pick up the new image
+  if (tex_ != 0) {
+    glBindTexture(GL_TEXTURE_2D, tex_);
+    UploadImage();
+    glBindTexture(GL_TEXTURE_2D, 0);
+  }
+
+  return true;
+}
+
+void Texture::UploadImage() const {
+  switch (channels_) {
+    case 1:
+      glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, width_, height_, 0, GL_RED, GL_UNSIGNED_BYTE, tex_cache_);
+      break;
+    case 3:
+      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width_, height_, 0, GL_RGB, GL_UNSIGNED_BYTE, tex_cache_);
+      break;
+    case 4:
+      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width_, height_, 0, GL_RGBA, GL_UNSIGNED_BYTE, tex_cache_);
+      break;
+    default:
+      BOOST_LOG_TRIVIAL(error) << "not sure how to load this one tbh";
+      break;
+  }
+
+  // TODO: the best solution would seemingly be to have the loader load all these textures into its own cache,
+  // then our textures will read them from bytes to a texture object.
+
+  // I AM NOT GOING TO DO THIS RIGHT NOW. but i'll do it later :)
+  if (tex_cache_) {
+    stbi_image_free(tex_cache_);
+    const_cast<Texture*>(this)->tex_cache_ = nullptr;
+  }
+}
+
 uint64_t Texture::GetTextureSize() const {
   return static_cast<uint64_t>(width_) * height_ * channels_;
 }
@@ -0,0 +1,59 @@
+#include <shader/UniformRing.hpp>
+
+#include <boost/log/trivial.hpp>
+
+namespace monkeysworld {
+namespace shader {
+
+UniformRing::UniformRing(GLsizeiptr size) {
+  buffer_ = 0;
+  size_ = size;
+  head_ = 0;
+  align_ = 0;
+  wrap_count_ = 0;
+}
+
+void UniformRing::Bind(GLuint binding, const void* data, GLsizeiptr size) {
+  if (buffer_ == 0) {
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &align_);
+    if (align_ <= 0) {
+      align_ = 256;
+    }
+
+    glGenBuffers(1, &buffer_);
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer_);
+    glBufferData(GL_UNIFORM_BUFFER, size_, NULL, GL_STREAM_DRAW);
+  } else {
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer_);
+  }
+
+  if (size > size_) {
+    BOOST_LOG_TRIVIAL(error) << "Uniform block of " << size << " bytes does not fit in ring of " << size_ << " bytes";
+    return;
+  }
+
+  if (head_ + size > size_) {
+    // orphan -- the driver hands us fresh storage, and in-flight draws keep the old one
+    glBufferData(GL_UNIFORM_BUFFER, size_, NULL, GL_STREAM_DRAW);
+    head_ = 0;
+    wrap_count_++;
+  }
+
+  glBufferSubData(GL_UNIFORM_BUFFER, head_, size, data);
+  glBindBufferRange(GL_UNIFORM_BUFFER, binding, buffer_, head_, size);
+
+  head_ += ((size + align_ - 1) / align_) * align_;
+}
+
+int UniformRing::GetWrapCount() const {
+  return wrap_count_;
+}
+
+UniformRing::~UniformRing() {
+  if (buffer_ != 0) {
+    glDeleteBuffers(1, &buffer_);
+  }
+}
+
+}
+}
@@ -0,0 +1,335 @@
+#include <shader/light/LightClusters.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+// SSE is part of every x86-64 target
+#if defined(__SSE__) || defined(_M_X64)
+#define LIGHT_CLUSTERS_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace monkeysworld {
+namespace shader {
+namespace light {
+
+using critter::camera_info;
+
+const float LightClusters::MAX_LIGHT_RANGE = 100.0f;
+
+// contributions below this are considered invisible
+static const float LIGHT_CUTOFF = 1.0f / 256.0f;
+
+static const int TILE_COUNT = LightClusters::GRID_X * LightClusters::GRID_Y;
+
+/**
+ *  Writes the squared distance from (cx, cy, cz) to each of `n` boxes into `dist`.
+ */
+static void SphereDistances(const float* lx, const float* ly, const float* lz,
+                            const float* hx, const float* hy, const float* hz,
+                            float cx, float cy, float cz, int n, float* dist) {
+  int i = 0;
+#if defined(LIGHT_CLUSTERS_SSE)
+  __m128 c_x = _mm_set1_ps(cx);
+  __m128 c_y = _mm_set1_ps(cy);
+  __m128 c_z = _mm_set1_ps(cz);
+  __m128 zero = _mm_setzero_ps();
+  for (; i + 4 <= n; i += 4) {
+    // distance past whichever face is nearest, or zero if we're between them
+    __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(lx + i), c_x), _mm_sub_ps(c_x, _mm_loadu_ps(hx + i))), zero);
+    __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(ly + i), c_y), _mm_sub_ps(c_y, _mm_loadu_ps(hy + i))), zero);
+    __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(lz + i), c_z), _mm_sub_ps(c_z, _mm_loadu_ps(hz + i))), zero);
+    __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+    _mm_storeu_ps(dist + i, d);
+  }
+#endif
+
+  for (; i < n; i++) {
+    float dx = std::max(std::max(lx[i] - cx, cx - hx[i]), 0.0f);
+    float dy = std::max(std::max(ly[i] - cy, cy - hy[i]), 0.0f);
+    float dz = std::max(std::max(lz[i] - cz, cz - hz[i]), 0.0f);
+    dist[i] = dx * dx + dy * dy + dz * dz;
+  }
+}
+
+LightClusters::LightClusters() {
+  persp_ = glm::mat4(0.0);
+  near_ = 0.0f;
+  far_ = 0.0f;
+
+  min_x_.resize(CLUSTER_COUNT);
+  min_y_.resize(CLUSTER_COUNT);
+  min_z_.resize(CLUSTER_COUNT);
+  max_x_.resize(CLUSTER_COUNT);
+  max_y_.resize(CLUSTER_COUNT);
+  max_z_.resize(CLUSTER_COUNT);
+
+  clusters_.resize(CLUSTER_COUNT * 2, 0);
+  for (int i = 0; i < 4; i++) {
+    depth_params_[i] = 0.0f;
+  }
+
+  dist_.resize(TILE_COUNT);
+  slice_depth_.resize(GRID_Z + 1);
+
+  for (int i = 0; i < 3; i++) {
+    buffers_[i] = 0;
+    capacities_[i] = 0;
+  }
+}
+
+void LightClusters::Assign(const camera_info& cam, const std::vector<spotlight_info>& lights) {
+  UpdateBounds(cam.persp_matrix);
+
+  lights_.clear();
+  hits_.clear();
+  for (uint32_t l = 0; l < lights.size(); l++) {
+    const spotlight_info& info = lights[l];
+    float range = GetLightRange(info);
+    float half_angle = glm::radians(info.angle * 0.5f);
+    float cos_angle = std::cos(half_angle);
+
+    gpu_spotlight light;
+    light.position = glm::vec4(info.position, range);
+    light.direction = glm::vec4(info.direction, cos_angle);
+    light.color = glm::vec4(info.color, info.intensity_diff);
+    light.attenuation = glm::vec4(info.atten_quad, info.atten_linear, info.atten_const, info.intensity_spec);
+    light.light_matrix = info.spotlight_view_matrix;
+    light.shadow_rect = (info.fd.map != 0 ? info.fd.rect : glm::vec4(0));
+    lights_.push_back(light);
+
+    // bounding sphere of the light's cone
+    glm::vec3 center;
+    float radius;
+    if (half_angle > 0.785398f) {
+      center = info.position + info.direction * (cos_angle * range);
+      radius = std::sin(half_angle) * range;
+    } else {
+      float len = range / (2.0f * cos_angle);
+      center = info.position + info.direction * len;
+      radius = len;
+    }
+
+    glm::vec4 view_center = cam.view_matrix * glm::vec4(center, 1.0);
+    float depth = -view_center.z;
+    if (depth + radius < near_ || depth - radius > far_) {
+      continue;
+    }
+
+    int z_min = GetSlice(std::max(depth - radius, near_));
+    int z_max = GetSlice(std::min(depth + radius, far_));
+    float cx = view_center.x;
+    float cy = view_center.y;
+    float cz = view_center.z;
+    float r2 = radius * radius;
+    for (int z = z_min; z <= z_max; z++) {
+      // conservative screen-space bounds of the sphere within this slice, so we only test nearby tiles
+      float d_near = slice_depth_[z];
+      float d_far = slice_depth_[z + 1];
+      int x_min = GetTile(std::min((cx - radius) / d_near, (cx - radius) / d_far) * persp_[0][0], GRID_X);
+      int x_max = GetTile(std::max((cx + radius) / d_near, (cx + radius) / d_far) * persp_[0][0], GRID_X);
+      int y_min = GetTile(std::min((cy - radius) / d_near, (cy - radius) / d_far) * persp_[1][1], GRID_Y);
+      int y_max = GetTile(std::max((cy + radius) / d_near, (cy + radius) / d_far) * persp_[1][1], GRID_Y);
+
+      int base = z * TILE_COUNT;
+      int start = y_min * GRID_X;
+      int end = (y_max + 1) * GRID_X;
+      // squared distance from the sphere's center to each cluster in the rows we touch
+      int first = base + start;
+      SphereDistances(&min_x_[first], &min_y_[first], &min_z_[first], &max_x_[first], &max_y_[first], &max_z_[first],
+                      cx, cy, cz, end - start, &dist_[start]);
+      const float* dist = &dist_[0];
+
+      for (int y = y_min; y <= y_max; y++) {
+        for (int x = x_min; x <= x_max; x++) {
+          int i = y * GRID_X + x;
+          if (dist[i] <= r2) {
+            hits_.push_back(static_cast<uint32_t>(base + i));
+            hits_.push_back(l);
+          }
+        }
+      }
+    }
+  }
+
+  // counting sort hits into clusters
+  for (int i = 0; i < CLUSTER_COUNT; i++) {
+    clusters_[2 * i + 1] = 0;
+  }
+
+  for (size_t i = 0; i < hits_.size(); i += 2) {
+    clusters_[2 * hits_[i] + 1]++;
+  }
+
+  uint32_t offset = 0;
+  for (int i = 0; i < CLUSTER_COUNT; i++) {
+    clusters_[2 * i] = offset;
+    offset += clusters_[2 * i + 1];
+    // reset the count, we'll use it as a cursor while filling
+    clusters_[2 * i + 1] = 0;
+  }
+
+  indices_.resize(offset);
+  for (size_t i = 0; i < hits_.size(); i += 2) {
+    uint32_t cluster = hits_[i];
+    indices_[clusters_[2 * cluster] + clusters_[2 * cluster + 1]++] = hits_[i + 1];
+  }
+
+  depth_params_[0] = near_;
+  depth_params_[1] = far_;
+  depth_params_[2] = GRID_Z / std::log(far_ / near_);
+  depth_params_[3] = -std::log(near_) * depth_params_[2];
+}
+
+void LightClusters::Upload() {
+  if (buffers_[0] == 0) {
+    glGenBuffers(3, buffers_);
+  }
+
+  // glsl won't accept zero-length buffers -- keep at least one entry around
+  gpu_spotlight empty_light = {};
+  uint32_t empty_index = 0;
+
+  if (lights_.size() > 0) {
+    UploadBuffer(buffers_[0], &capacities_[0], lights_.data(), lights_.size() * sizeof(gpu_spotlight));
+  } else {
+    UploadBuffer(buffers_[0], &capacities_[0], &empty_light, sizeof(gpu_spotlight));
+  }
+
+  UploadBuffer(buffers_[1], &capacities_[1], clusters_.data(), clusters_.size() * sizeof(uint32_t));
+
+  if (indices_.size() > 0) {
+    UploadBuffer(buffers_[2], &capacities_[2], indices_.data(), indices_.size() * sizeof(uint32_t));
+  } else {
+    UploadBuffer(buffers_[2], &capacities_[2], &empty_index, sizeof(uint32_t));
+  }
+
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, LIGHT_BINDING, buffers_[0]);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CLUSTER_BINDING, buffers_[1]);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, INDEX_BINDING, buffers_[2]);
+}
+
+void LightClusters::GetFrameUniforms(frame_uniforms* frame) const {
+  frame->cluster_grid[0] = GRID_X;
+  frame->cluster_grid[1] = GRID_Y;
+  frame->cluster_grid[2] = GRID_Z;
+  frame->cluster_grid[3] = static_cast<uint32_t>(lights_.size());
+  for (int i = 0; i < 4; i++) {
+    frame->cluster_depth[i] = depth_params_[i];
+  }
+}
+
+uint32_t LightClusters::GetLightCount(int x, int y, int z) const {
+  return clusters_[2 * GetClusterIndex(x, y, z) + 1];
+}
+
+uint32_t LightClusters::GetLight(int x, int y, int z, uint32_t n) const {
+  return indices_[clusters_[2 * GetClusterIndex(x, y, z)] + n];
+}
+
+size_t LightClusters::GetIndexCount() const {
+  return indices_.size();
+}
+
+float LightClusters::GetLightRange(const spotlight_info& light) {
+  // solve intensity / (q * d^2 + l * d + c) = cutoff for d
+  float q = light.atten_quad;
+  float l = light.atten_linear;
+  float c = light.atten_const - std::max(light.intensity_diff, light.intensity_spec) / LIGHT_CUTOFF;
+  float range = MAX_LIGHT_RANGE;
+  if (q > 0.0f) {
+    float disc = l * l - 4.0f * q * c;
+    if (disc >= 0.0f) {
+      range = (-l + std::sqrt(disc)) / (2.0f * q);
+    }
+  } else if (l > 0.0f) {
+    range = -c / l;
+  }
+
+  return std::min(std::max(range, 0.0f), MAX_LIGHT_RANGE);
+}
+
+void LightClusters::UpdateBounds(const glm::mat4& persp) {
+  if (persp == persp_) {
+    return;
+  }
+
+  persp_ = persp;
+
+  // pull near + far back out of the projection matrix
+  near_ = persp[3][2] / (persp[2][2] - 1.0f);
+  far_ = persp[3][2] / (persp[2][2] + 1.0f);
+  if (!(near_ > 0.0f)) {
+    near_ = 0.01f;
+  }
+
+  if (!(far_ > near_)) {
+    // infinite projection
+    far_ = near_ * 100000.0f;
+  }
+
+  float slice_ratio = far_ / near_;
+  for (int z = 0; z <= GRID_Z; z++) {
+    slice_depth_[z] = near_ * std::pow(slice_ratio, static_cast<float>(z) / GRID_Z);
+  }
+
+  for (int z = 0; z < GRID_Z; z++) {
+    float d_near = slice_depth_[z];
+    float d_far = slice_depth_[z + 1];
+    for (int y = 0; y < GRID_Y; y++) {
+      float ndc_y0 = -1.0f + (2.0f * y) / GRID_Y;
+      float ndc_y1 = -1.0f + (2.0f * (y + 1)) / GRID_Y;
+      for (int x = 0; x < GRID_X; x++) {
+        float ndc_x0 = -1.0f + (2.0f * x) / GRID_X;
+        float ndc_x1 = -1.0f + (2.0f * (x + 1)) / GRID_X;
+        int i = GetClusterIndex(x, y, z);
+
+        // tile edges in view space, at the near and far depths of the slice
+        min_x_[i] = std::min(ndc_x0 * d_near, ndc_x0 * d_far) / persp[0][0];
+        max_x_[i] = std::max(ndc_x1 * d_near, ndc_x1 * d_far) / persp[0][0];
+        min_y_[i] = std::min(ndc_y0 * d_near, ndc_y0 * d_far) / persp[1][1];
+        max_y_[i] = std::max(ndc_y1 * d_near, ndc_y1 * d_far) / persp[1][1];
+        min_z_[i] = -d_far;
+        max_z_[i] = -d_near;
+      }
+    }
+  }
+}
+
+int LightClusters::GetClusterIndex(int x, int y, int z) {
+  return (z * GRID_Y + y) * GRID_X + x;
+}
+
+int LightClusters::GetSlice(float depth) const {
+  int slice = static_cast<int>(std::floor(std::log(depth / near_) * GRID_Z / std::log(far_ / near_)));
+  return std::min(std::max(slice, 0), GRID_Z - 1);
+}
+
+int LightClusters::GetTile(float ndc, int count) {
+  int tile = static_cast<int>(std::floor((ndc * 0.5f + 0.5f) * count));
+  return std::min(std::max(tile, 0), count - 1);
+}
+
+void LightClusters::UploadBuffer(GLuint buffer, GLsizeiptr* capacity, const void* data, GLsizeiptr size) {
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+  if (*capacity < size) {
+    // grow geometrically so we don't reallocate every time a light is added
+    GLsizeiptr new_size = std::max(size, *capacity * 2);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, new_size, NULL, GL_STREAM_DRAW);
+    *capacity = new_size;
+  }
+
+  glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, size, data);
+}
+
+LightClusters::~LightClusters() {
+  if (buffers_[0] != 0) {
+    glDeleteBuffers(3, buffers_);
+  }
+}
+
+}
+}
+}
@@ -0,0 +1,218 @@
+#include <shader/light/ShadowAtlas.hpp>
+#include <utils/Frustum.hpp>
+#include <utils/HashUtils.hpp>
+
+#include <boost/log/trivial.hpp>
+
+#include <cstring>
+
+namespace monkeysworld {
+namespace shader {
+namespace light {
+
+using critter::Model;
+using utils::Frustum;
+using utils::hashutils::HashCombine;
+
+/**
+ *  Hashes the state of a caster which affects its shadow.
+ */
+static uint64_t HashCaster(Model& caster) {
+  uint64_t res = reinterpret_cast<uintptr_t>(&caster);
+  res = HashCombine(res, reinterpret_cast<uintptr_t>(caster.GetMesh().get()));
+  res = HashCombine(res, static_cast<uint64_t>(caster.GetLODLevel()));
+  glm::mat4 tf = caster.GetTransformationMatrix();
+  for (int i = 0; i < 4; i++) {
+    for (int j = 0; j < 4; j++) {
+      uint32_t bits;
+      std::memcpy(&bits, &tf[i][j], sizeof(uint32_t));
+      res = HashCombine(res, bits);
+    }
+  }
+
+  return res;
+}
+
+ShadowAtlas::ShadowAtlas(int atlas_size, int tile_size) {
+  atlas_size_ = atlas_size;
+  tile_size_ = tile_size;
+  tiles_per_row_ = atlas_size / tile_size;
+  full_warned_ = false;
+
+  tile_record empty;
+  empty.light_id = 0;
+  empty.in_use = false;
+  empty.seen = false;
+  empty.valid = false;
+  empty.light_matrix = glm::mat4(0.0);
+  empty.signature = 0;
+  tiles_.resize(tiles_per_row_ * tiles_per_row_, empty);
+
+  glGenTextures(1, &map_);
+  glBindTexture(GL_TEXTURE_2D, map_);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, atlas_size_, atlas_size_, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+  // linear + compare mode gives us 2x2 PCF for free when sampled as a sampler2DShadow
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+
+  glGenFramebuffers(1, &fb_);
+  glBindFramebuffer(GL_FRAMEBUFFER, fb_);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, map_, 0);
+  glDrawBuffer(GL_NONE);
+  glReadBuffer(GL_NONE);
+
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    BOOST_LOG_TRIVIAL(warning) << "Shadow atlas framebuffer not complete!";
+  }
+
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+int ShadowAtlas::Update(const std::vector<std::shared_ptr<SpotLight>>& lights,
+                        const std::vector<std::shared_ptr<Model>>& casters,
+                        std::vector<spotlight_info>& infos) {
+  for (auto& tile : tiles_) {
+    tile.seen = false;
+  }
+
+  int rendered = 0;
+  float tile_uv = static_cast<float>(tile_size_) / atlas_size_;
+  for (size_t i = 0; i < lights.size() && i < infos.size(); i++) {
+    auto& light = lights[i];
+    int tile = GetTile(light->GetId());
+    if (tile < 0) {
+      continue;
+    }
+
+    tile_record& record = tiles_[tile];
+    record.seen = true;
+
+    // hang onto the tile, but cast no shadow until the light's program has compiled
+    if (!light->GetShadowProgram().IsReady()) {
+      continue;
+    }
+
+    glm::mat4 light_matrix = infos[i].spotlight_view_matrix;
+    Frustum frustum(light_matrix);
+
+    // cull casters, and hash the ones which remain
+    visible_.clear();
+    uint64_t signature = 0;
+    for (auto& caster : casters) {
+      if (caster->GetMesh() == nullptr) {
+        continue;
+      }
+
+      glm::vec3 center;
+      float radius = caster->GetWorldBoundingSphere(&center);
+      if (frustum.IntersectsSphere(center, radius)) {
+        visible_.push_back(caster);
+        signature = HashCombine(signature, HashCaster(*caster));
+      }
+    }
+
+    if (!record.valid || record.signature != signature || record.light_matrix != light_matrix) {
+      RenderTile(tile, *light, light_matrix, visible_);
+      record.valid = true;
+      record.signature = signature;
+      record.light_matrix = light_matrix;
+      rendered++;
+    }
+
+    frame_info& fd = infos[i].fd;
+    fd.width = tile_size_;
+    fd.height = tile_size_;
+    fd.map = map_;
+    fd.rect = glm::vec4((tile % tiles_per_row_) * tile_uv, (tile / tiles_per_row_) * tile_uv, tile_uv, tile_uv);
+  }
+
+  // free up tiles whose lights have left the scene
+  for (int i = 0; i < static_cast<int>(tiles_.size()); i++) {
+    if (tiles_[i].in_use && !tiles_[i].seen) {
+      light_tiles_.erase(tiles_[i].light_id);
+      tiles_[i].in_use = false;
+      tiles_[i].valid = false;
+    }
+  }
+
+  visible_.clear();
+  return rendered;
+}
+
+GLuint ShadowAtlas::GetTexture() const {
+  return map_;
+}
+
+int ShadowAtlas::GetTileCount() const {
+  return static_cast<int>(tiles_.size());
+}
+
+int ShadowAtlas::GetTile(uint64_t light_id) {
+  auto i = light_tiles_.find(light_id);
+  if (i != light_tiles_.end()) {
+    return i->second;
+  }
+
+  for (int t = 0; t < static_cast<int>(tiles_.size()); t++) {
+    if (!tiles_[t].in_use) {
+      tiles_[t].in_use = true;
+      tiles_[t].valid = false;
+      tiles_[t].light_id = light_id;
+      light_tiles_.insert(std::make_pair(light_id, t));
+      return t;
+    }
+  }
+
+  if (!full_warned_) {
+    BOOST_LOG_TRIVIAL(warning) << "Shadow atlas is full (" << tiles_.size() << " tiles) -- some lights won't cast shadows";
+    full_warned_ = true;
+  }
+
+  return -1;
+}
+
+void ShadowAtlas::RenderTile(int tile,
+                             SpotLight& light,
+                             const glm::mat4& light_matrix,
+                             const std::vector<std::shared_ptr<Model>>& visible) {
+  int x = (tile % tiles_per_row_) * tile_size_;
+  int y = (tile / tiles_per_row_) * tile_size_;
+
+  glBindFramebuffer(GL_FRAMEBUFFER, fb_);
+  glViewport(x, y, tile_size_, tile_size_);
+  glEnable(GL_SCISSOR_TEST);
+  glScissor(x, y, tile_size_, tile_size_);
+  glClear(GL_DEPTH_BUFFER_BIT);
+
+  // push depth back a bit to avoid acne
+  glEnable(GL_POLYGON_OFFSET_FILL);
+  glPolygonOffset(2.0f, 4.0f);
+
+  auto& mat = light.GetShadowProgram();
+  mat.SetCameraTransforms(light_matrix);
+  for (auto& caster : visible) {
+    mat.SetModelTransforms(caster->GetTransformationMatrix());
+    if (!mat.UseMaterial()) {
+      break;
+    }
+
+    caster->PrepareAttributes();
+    caster->DrawShadow();
+  }
+
+  glDisable(GL_POLYGON_OFFSET_FILL);
+  glDisable(GL_SCISSOR_TEST);
+}
+
+ShadowAtlas::~ShadowAtlas() {
+  glDeleteFramebuffers(1, &fb_);
+  glDeleteTextures(1, &map_);
+}
+
+}
+}
+}
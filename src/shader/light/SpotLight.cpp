@@ -16,21 +16,7 @@ using materials::ShadowMapMaterial;
 
 SpotLight::SpotLight(Context* ctx) : GameObject(ctx), Light(), mat_(ctx) {
   angle_ = 45.0f; // simple default
-  // setup the framebuffer
-  glGenTextures(1, &map_);
-
-  ChangeMapSize(1024);
-
-  glGenFramebuffers(1, &shadow_fb_);
-  glBindFramebuffer(GL_FRAMEBUFFER, shadow_fb_);
-  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, map_, 0);
-
-  // if (!glCheckFramebufferStatus(GL_FRAMEBUFFER_COMPLETE)) {
-  //   BOOST_LOG_TRIVIAL(warning) << "Framebuffer not complete!";
-  // }
-
-  glDrawBuffer(GL_NONE);
-  glReadBuffer(GL_NONE);
+  // shadow maps live in the engine's shadow atlas -- see ShadowAtlas
 }
 
 void SpotLight::Accept(Visitor& v) {
@@ -56,6 +42,8 @@ spotlight_info SpotLight::GetSpotLightInfo() {
   res.intensity_spec = GetSpecularIntensity();
   res.intensity_diff = GetDiffuseIntensity();
 
+  res.angle = angle_;
+
   res.atten_quad = GetAttenuationQuad();
   res.atten_linear = GetAttenuationLinear();
   res.atten_const = GetAttenuationConst();
@@ -71,36 +59,14 @@ spotlight_info SpotLight::GetSpotLightInfo() {
     res.position = GetPosition();
   }
 
-  res.fd.height = GetMapSize();
-  res.fd.width = GetMapSize();
-  res.fd.map = GetMapDesc();
+  res.fd.height = 0;
+  res.fd.width = 0;
+  res.fd.map = 0;
+  res.fd.rect = glm::vec4(0);
 
   return res;
 }
 
-void SpotLight::ChangeMapSize(int px) {
-  map_size_ = px;
-  glBindTexture(GL_TEXTURE_2D, map_);
-
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, map_size_, map_size_, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-}
-
-GLuint SpotLight::GetMapDesc() {
-  return map_;
-}
-
-GLuint SpotLight::GetFramebuffer() {
-  return shadow_fb_;
-}
-
-int SpotLight::GetMapSize() {
-  return map_size_;
-}
-
 ShadowMapMaterial& SpotLight::GetShadowProgram() {
   return mat_;
 }
@@ -1,6 +1,6 @@
 #include <shader/materials/FillMaterial.hpp>
 
-#include <shader/ShaderProgramBuilder.hpp>
+#include <shader/ProgramRegistry.hpp>
 
 #include <glm/gtc/type_ptr.hpp>
 
@@ -9,30 +9,23 @@ namespace shader {
 namespace materials {
 using engine::Context;
 FillMaterial::FillMaterial() {
-  fill_prog_ = ShaderProgramBuilder()
-                 .WithVertexShader("resources/glsl/fill-mat/fill-mat.vert")
-                 .WithFragmentShader("resources/glsl/fill-mat/fill-mat.frag")
-                 .Build();
+  fill_prog_ = ProgramRegistry::GetInstance().GetProgram(nullptr,
+                                                         "resources/glsl/fill-mat/fill-mat.vert",
+                                                         "resources/glsl/fill-mat/fill-mat.frag");
   color_cache_ = glm::vec4(glm::vec3(0.0), 1.0);
   use_gradient_ = false;
 }
 FillMaterial::FillMaterial(Context* context) {
-  auto exec = context->GetExecutor();
-  auto prog_func = [&] {
-    fill_prog_ = ShaderProgramBuilder(context->GetCachedFileLoader())
-                  .WithVertexShader("resources/glsl/fill-mat/fill-mat.vert")
-                  .WithFragmentShader("resources/glsl/fill-mat/fill-mat.frag")
-                  .Build();
-  };
-
-  exec->ScheduleOnMainThread(prog_func).wait();
+  fill_prog_ = ProgramRegistry::GetInstance().GetProgram(context,
+                                                         "resources/glsl/fill-mat/fill-mat.vert",
+                                                         "resources/glsl/fill-mat/fill-mat.frag");
 
   color_cache_ = glm::vec4(glm::vec3(0.0), 1.0);
   use_gradient_ = false;
 }
 
-void FillMaterial::UseMaterial() {
-  glUseProgram(fill_prog_.GetProgramDescriptor());
+bool FillMaterial::UseMaterial() {
+  glUseProgram(fill_prog_->GetProgramDescriptor());
   if (use_gradient_) {
     // upload the gradient we have on record
     // use line for now
@@ -50,6 +43,8 @@ void FillMaterial::UseMaterial() {
     glUniform1i(32, -1);
     glUniform4fv(0, 1, glm::value_ptr(color_cache_));
   }
+
+  return true;
 }
 
 void FillMaterial::SetColor(const glm::vec4& col) {
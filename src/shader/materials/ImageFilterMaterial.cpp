@@ -1,16 +1,15 @@
 #include <shader/materials/ImageFilterMaterial.hpp>
 
-#include <shader/ShaderProgramBuilder.hpp>
+#include <shader/ProgramRegistry.hpp>
 
 namespace monkeysworld {
 namespace shader {
 namespace materials {
 
 ImageFilterMaterial::ImageFilterMaterial() {
-  prog_ = ShaderProgramBuilder()
-            .WithVertexShader("resources/glsl/image-filter/image-filter-material.vert")
-            .WithFragmentShader("resources/glsl/image-filter/image-filter-material.frag")
-            .Build();
+  prog_ = ProgramRegistry::GetInstance().GetProgram(nullptr,
+                                                    "resources/glsl/image-filter/image-filter-material.vert",
+                                                    "resources/glsl/image-filter/image-filter-material.frag");
   filter_count_ = 0;
   hsl_filters_count_ = 0;
 }
@@ -31,8 +30,8 @@ void ImageFilterMaterial::ClearFilters() {
   hsl_filters_count_ = 0;
 }
 
-void ImageFilterMaterial::UseMaterial() {
-  glUseProgram(prog_.GetProgramDescriptor());
+bool ImageFilterMaterial::UseMaterial() {
+  glUseProgram(prog_->GetProgramDescriptor());
 
   for (int i = 0; i < FILTER_COUNT; i++) {
     glUniform1f(3 * i, hsl_filters_[i].hue);
@@ -45,6 +44,7 @@ void ImageFilterMaterial::UseMaterial() {
   glActiveTexture(GL_TEXTURE0);
   glBindTexture(GL_TEXTURE_2D, tex_);
   glUniform1i(35, 0);
+  return true;
 }
 
 }
@@ -1,7 +1,7 @@
 #include <file/CachedFileLoader.hpp>
 #include <shader/materials/MatteMaterial.hpp>
 #include <shader/ShaderProgram.hpp>
-#include <shader/ShaderProgramBuilder.hpp>
+#include <shader/ProgramRegistry.hpp>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
@@ -10,6 +10,8 @@
 
 #include <boost/log/trivial.hpp>
 
+#include <chrono>
+
 namespace monkeysworld {
 namespace shader {
 namespace materials {
@@ -19,73 +21,67 @@ using file::CachedFileLoader;
 using shader::light::spotlight_info;
 
 MatteMaterial::MatteMaterial(Context* context) {
-  std::shared_ptr<CachedFileLoader> loader = std::static_pointer_cast<CachedFileLoader>(context->GetCachedFileLoader());
-  auto exec_func = [&] {
-    matte_prog_ = ShaderProgramBuilder(loader)
-                  .WithVertexShader("resources/glsl/matte-material/matte-material.vert")
-                  .WithFragmentShader("resources/glsl/matte-material/matte-material.frag")
-                  .Build();
-  };
-
-  auto f = context->GetExecutor()->ScheduleOnMainThread(exec_func);
-  f.wait();
+  shadow_map_ = 0;
+  ring_ = context->GetUniformRing();
+  data_.model_matrix = glm::mat4(1.0);
+  data_.normal_matrix = glm::mat4(1.0);
+  data_.vp_matrix = glm::mat4(1.0);
+  data_.color = glm::vec4(1.0);
+  // don't wait on the driver -- we'll skip drawing until the program is ready
+  program_info info;
+  info.vertex_path = "resources/glsl/matte-material/matte-material.vert";
+  info.fragment_path = "resources/glsl/matte-material/matte-material.frag";
+  prog_future_ = ProgramRegistry::GetInstance().GetProgramAsync(context, info);
 }
 
-// GL 4.1 provides glProgramUniform which allows us to bind uniforms
-// without having to worry about rebinding the old program
-void MatteMaterial::UseMaterial() {
-  glUseProgram(matte_prog_.GetProgramDescriptor());
+// per-draw data goes up in one block, instead of a glProgramUniform call for each field
+bool MatteMaterial::UseMaterial() {
+  if (!IsReady()) {
+    return false;
+  }
+
+  glUseProgram(matte_prog_->GetProgramDescriptor());
+  ring_->Bind(OBJECT_BLOCK_BINDING, data_);
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, shadow_map_);
+  return true;
 }
 
-void MatteMaterial::SetCameraTransforms(const glm::mat4& vp_matrix) {
-  glProgramUniformMatrix4fv(matte_prog_.GetProgramDescriptor(),
-                            1,
-                            1,
-                            GL_FALSE,
-                            glm::value_ptr(vp_matrix));
+bool MatteMaterial::IsReady() {
+  if (!matte_prog_) {
+    if (prog_future_.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+      return false;
+    }
+
+    // rethrows if the build failed
+    matte_prog_ = prog_future_.get();
+  }
+
+  return true;
 }
 
-void MatteMaterial::SetModelTransforms(const glm::mat4& model_matrix) {
-  glProgramUniformMatrix4fv(matte_prog_.GetProgramDescriptor(),
-                            0,
-                            1,
-                            GL_FALSE,
-                            glm::value_ptr(model_matrix));
-  glm::mat3 normal_matrix = glm::inverseTranspose(glm::mat3(model_matrix));
-  glProgramUniformMatrix3fv(matte_prog_.GetProgramDescriptor(),
-                            2,
-                            1,
-                            GL_FALSE,
-                            glm::value_ptr(normal_matrix));
+void MatteMaterial::SetCameraTransforms(const glm::mat4& vp_matrix) {
+  data_.vp_matrix = vp_matrix;
 }
 
-void MatteMaterial::SetLights(const std::vector<light::LightData>& lights) {
-  if (lights.size() > 0) {
-    const light::LightData& light = lights[0];
-    GLuint prog = matte_prog_.GetProgramDescriptor();
-    glProgramUniform4fv(prog, 4, 1, glm::value_ptr(light.position));
-    glProgramUniform1f(prog, 5, light.intensity);
-    glProgramUniform4fv(prog, 6, 1, glm::value_ptr(light.diffuse));
-    glProgramUniform4fv(prog, 7, 1, glm::value_ptr(light.ambient));
-  }
+void MatteMaterial::SetModelTransforms(const glm::mat4& model_matrix) {
+  data_.model_matrix = model_matrix;
+  data_.normal_matrix = glm::mat4(glm::inverseTranspose(glm::mat3(model_matrix)));
 }
 
 void MatteMaterial::SetSpotlights(const std::vector<spotlight_info>& lights) {
-  // well now i need to rewrite the material to do this
-  // let's just use the setlights code again
-  if (lights.size() > 0) {
-    spotlight_info info = lights[0];
-    GLuint prog = matte_prog_.GetProgramDescriptor();
-    glm::vec4 ambient(0);
-    glProgramUniform4fv(prog, 4, 1, glm::value_ptr(info.position));
-    glProgramUniform1f(prog, 5, info.intensity_diff);
-    glProgramUniform4fv(prog, 6, 1, glm::value_ptr(info.color));
-    glProgramUniform4fv(prog, 7, 1, glm::value_ptr(ambient));
+  // light data is read from the cluster buffers -- we just need to know where the shadows are
+  shadow_map_ = 0;
+  for (auto& info : lights) {
+    if (info.fd.map != 0) {
+      shadow_map_ = info.fd.map;
+      break;
+    }
   }
 }
 
 void MatteMaterial::SetSurfaceColor(const glm::vec4& color) {
-  glProgramUniform4fv(matte_prog_.GetProgramDescriptor(), 3, 1, glm::value_ptr(color));
+  data_.color = color;
 }
 
 } // namespace materials
@@ -1,10 +1,12 @@
 #include <shader/materials/ShadowMapMaterial.hpp>
-#include <shader/ShaderProgramBuilder.hpp>
+#include <shader/ProgramRegistry.hpp>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtc/matrix_inverse.hpp>
 
+#include <chrono>
+
 namespace monkeysworld {
 namespace shader {
 namespace materials {
@@ -12,36 +14,47 @@ namespace materials {
 using engine::Context;
 
 ShadowMapMaterial::ShadowMapMaterial(Context* ctx) {
-  auto exec_func = [&] {
-    shadow_prog_ = ShaderProgramBuilder(ctx->GetCachedFileLoader())
-                    .WithVertexShader("resources/glsl/shadow-map/shadow-map.vert")
-                    .WithFragmentShader("resources/glsl/shadow-map/shadow-map.frag")
-                    .Build();
-    
-  };
-
-  auto f = ctx->GetExecutor()->ScheduleOnMainThread(exec_func);
-  f.wait();
+  ring_ = ctx->GetUniformRing();
+  data_.model_matrix = glm::mat4(1.0);
+  data_.normal_matrix = glm::mat4(1.0);
+  data_.vp_matrix = glm::mat4(1.0);
+  data_.color = glm::vec4(1.0);
+  // don't wait on the driver -- we'll skip drawing until the program is ready
+  program_info info;
+  info.vertex_path = "resources/glsl/shadow-map/shadow-map.vert";
+  info.fragment_path = "resources/glsl/shadow-map/shadow-map.frag";
+  prog_future_ = ProgramRegistry::GetInstance().GetProgramAsync(ctx, info);
+}
+
+bool ShadowMapMaterial::UseMaterial() {
+  if (!IsReady()) {
+    return false;
+  }
+
+  glUseProgram(shadow_prog_->GetProgramDescriptor());
+  ring_->Bind(OBJECT_BLOCK_BINDING, data_);
+  return true;
 }
 
-void ShadowMapMaterial::UseMaterial() {
-  glUseProgram(shadow_prog_.GetProgramDescriptor());
+bool ShadowMapMaterial::IsReady() {
+  if (!shadow_prog_) {
+    if (prog_future_.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+      return false;
+    }
+
+    // rethrows if the build failed
+    shadow_prog_ = prog_future_.get();
+  }
+
+  return true;
 }
 
 void ShadowMapMaterial::SetCameraTransforms(const glm::mat4& vp_matrix) {
-  glProgramUniformMatrix4fv(shadow_prog_.GetProgramDescriptor(),
-                            1,
-                            1,
-                            GL_FALSE,
-                            glm::value_ptr(vp_matrix));
+  data_.vp_matrix = vp_matrix;
 }
 
 void ShadowMapMaterial::SetModelTransforms(const glm::mat4& model_matrix) {
-  glProgramUniformMatrix4fv(shadow_prog_.GetProgramDescriptor(),
-                            0,
-                            1,
-                            GL_FALSE,
-                            glm::value_ptr(model_matrix));
+  data_.model_matrix = model_matrix;
 }
 
 }
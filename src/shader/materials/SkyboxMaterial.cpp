@@ -1,6 +1,6 @@
 #include <shader/materials/SkyboxMaterial.hpp>
 
-#include <shader/ShaderProgramBuilder.hpp>
+#include <shader/ProgramRegistry.hpp>
 
 #include <glm/gtc/type_ptr.hpp>
 
@@ -9,28 +9,28 @@ namespace shader {
 namespace materials {
 
 SkyboxMaterial::SkyboxMaterial(engine::Context* context) {
-  auto loader = context->GetCachedFileLoader();
-
-  auto exec_func = [&] {
-    skybox_prog_ = ShaderProgramBuilder(loader)
-                    .WithVertexShader("resources/glsl/skybox-material/skybox-material.vert")
-                    .WithFragmentShader("resources/glsl/skybox-material/skybox-material.frag")
-                    .Build();
-  };
-
-  auto f = context->GetExecutor()->ScheduleOnMainThread(exec_func);
-  f.wait();
+  ring_ = context->GetUniformRing();
+  view_mat_ = glm::mat4(1.0);
+  persp_mat_ = glm::mat4(1.0);
+  cube_map_ = 0;
+  skybox_prog_ = ProgramRegistry::GetInstance().GetProgram(context,
+                                                           "resources/glsl/skybox-material/skybox-material.vert",
+                                                           "resources/glsl/skybox-material/skybox-material.frag");
 }
 
-void SkyboxMaterial::UseMaterial() {
-  auto prog = skybox_prog_.GetProgramDescriptor();
-  glUseProgram(prog);
-  glProgramUniformMatrix4fv(prog, 0, 1, GL_FALSE, glm::value_ptr(view_mat_));
-  glProgramUniformMatrix4fv(prog, 1, 1, GL_FALSE, glm::value_ptr(model_mat_));
+bool SkyboxMaterial::UseMaterial() {
+  glUseProgram(skybox_prog_->GetProgramDescriptor());
+
+  object_uniforms data;
+  data.model_matrix = glm::mat4(1.0);
+  data.normal_matrix = glm::mat4(1.0);
+  data.vp_matrix = persp_mat_ * view_mat_;
+  data.color = glm::vec4(1.0);
+  ring_->Bind(OBJECT_BLOCK_BINDING, data);
 
   glActiveTexture(GL_TEXTURE0);
   glBindTexture(GL_TEXTURE_CUBE_MAP, cube_map_);
-  glProgramUniform1i(prog, 2, 0);
+  return true;
 }
 
 void SkyboxMaterial::SetCameraView(const glm::mat4& view_mat) {
@@ -38,8 +38,8 @@ void SkyboxMaterial::SetCameraView(const glm::mat4& view_mat) {
   view_mat_ = glm::mat4(glm::mat3(view_mat));
 }
 
-void SkyboxMaterial::SetCameraPersp(const glm::mat4& model_mat) {
-  model_mat_ = model_mat;
+void SkyboxMaterial::SetCameraPersp(const glm::mat4& persp_mat) {
+  persp_mat_ = persp_mat;
 }
 
 void SkyboxMaterial::SetCubeMap(GLuint cube_map) {
@@ -0,0 +1,44 @@
+#include <shader/materials/TextBatchMaterial.hpp>
+
+#include <shader/ProgramRegistry.hpp>
+
+
+namespace monkeysworld {
+namespace shader {
+namespace materials {
+
+TextBatchMaterial::TextBatchMaterial(engine::Context* ctx) {
+  ctx_ = ctx;
+  prog_ = ProgramRegistry::GetInstance().GetProgram(ctx,
+                                                    "resources/glsl/text-material/text-batch.vert",
+                                                    "resources/glsl/text-material/text-batch.frag");
+  sdf_ = false;
+  texture_ = 0;
+}
+
+void TextBatchMaterial::SetGlyphTexture(GLuint texture) {
+  texture_ = texture;
+}
+
+void TextBatchMaterial::SetDistanceField(bool sdf) {
+  if (sdf && !sdf_prog_) {
+    program_info info;
+    info.vertex_path = "resources/glsl/text-material/text-batch.vert";
+    info.fragment_path = "resources/glsl/text-material/text-batch.frag";
+    info.defines["DISTANCE_FIELD"] = "1";
+    sdf_prog_ = ProgramRegistry::GetInstance().GetProgram(ctx_, info);
+  }
+
+  sdf_ = sdf;
+}
+
+bool TextBatchMaterial::UseMaterial() {
+  glUseProgram((sdf_ ? sdf_prog_ : prog_)->GetProgramDescriptor());
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, texture_);
+  return true;
+}
+
+}
+}
+}
@@ -1,4 +1,5 @@
 #include <shader/materials/TextMaterial.hpp>
+#include <shader/ProgramRegistry.hpp>
 
 #include <glad/glad.h>
 
@@ -13,54 +14,53 @@ using file::CachedFileLoader;
 using engine::Context;
 
 TextMaterial::TextMaterial(Context* context) {
-  std::shared_ptr<CachedFileLoader> loader = std::static_pointer_cast<CachedFileLoader>(context->GetCachedFileLoader());
-
-  auto exec_func = [&] {
-    text_prog_ = ShaderProgramBuilder(loader)
-                  .WithVertexShader("resources/glsl/text-material/text-material.vert")
-                  .WithFragmentShader("resources/glsl/text-material/text-material.frag")
-                  .Build();
-  };
-
-  auto f = context->GetExecutor()->ScheduleOnMainThread(exec_func);
-  f.wait();
+  ctx_ = context;
+  sdf_ = false;
+  ring_ = context->GetUniformRing();
+  texture_ = 0;
+  data_.model_matrix = glm::mat4(1.0);
+  data_.normal_matrix = glm::mat4(1.0);
+  data_.vp_matrix = glm::mat4(1.0);
+  data_.color = glm::vec4(1.0);
+  text_prog_ = ProgramRegistry::GetInstance().GetProgram(context,
+                                                         "resources/glsl/text-material/text-material.vert",
+                                                         "resources/glsl/text-material/text-material.frag");
 }
 
-void TextMaterial::UseMaterial() {
+bool TextMaterial::UseMaterial() {
   glActiveTexture(GL_TEXTURE0);
   glBindTexture(GL_TEXTURE_2D, texture_);
-  glProgramUniform1i(text_prog_.GetProgramDescriptor(), 2, 0);
-  glUseProgram(text_prog_.GetProgramDescriptor());
+  glUseProgram((sdf_ ? sdf_prog_ : text_prog_)->GetProgramDescriptor());
+  ring_->Bind(OBJECT_BLOCK_BINDING, data_);
+  return true;
 }
 
 void TextMaterial::SetCameraTransforms(const glm::mat4& vp_matrix) {
-  glProgramUniformMatrix4fv(text_prog_.GetProgramDescriptor(),
-                            1,
-                            1,
-                            GL_FALSE,
-                            glm::value_ptr(vp_matrix));
+  data_.vp_matrix = vp_matrix;
 }
 
 void TextMaterial::SetModelTransforms(const glm::mat4& model_matrix) {
-  glProgramUniformMatrix4fv(text_prog_.GetProgramDescriptor(),
-                            0,
-                            1,
-                            GL_FALSE,
-                            glm::value_ptr(model_matrix));
+  data_.model_matrix = model_matrix;
 }
 
 void TextMaterial::SetTextColor(const glm::vec4& color) {
-  glProgramUniform4fv(text_prog_.GetProgramDescriptor(),
-                      3,
-                      1,
-                      glm::value_ptr(color));
+  data_.color = color;
 }
 
 void TextMaterial::SetGlyphTexture(GLuint tex) {
   texture_ = tex;
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, texture_);
-  glProgramUniform1i(text_prog_.GetProgramDescriptor(), 2, 0);
+}
+
+void TextMaterial::SetDistanceField(bool sdf) {
+  if (sdf && !sdf_prog_) {
+    program_info info;
+    info.vertex_path = "resources/glsl/text-material/text-material.vert";
+    info.fragment_path = "resources/glsl/text-material/text-material.frag";
+    info.defines["DISTANCE_FIELD"] = "1";
+    sdf_prog_ = ProgramRegistry::GetInstance().GetProgram(ctx_, info);
+  }
+
+  sdf_ = sdf;
 }
 
 }
@@ -1,32 +1,26 @@
 #include <shader/materials/TextureXferMaterial.hpp>
 
-#include <shader/ShaderProgramBuilder.hpp>
+#include <shader/ProgramRegistry.hpp>
 
 namespace monkeysworld {
 namespace shader {
 namespace materials {
 
 TextureXferMaterial::TextureXferMaterial(engine::Context* context) {
-  auto loader = context->GetCachedFileLoader();
-  auto exec_func = [&] {
-    xfer_prog_ = ShaderProgramBuilder(loader)
-                  .WithVertexShader("resources/glsl/texture-xfer/texture-xfer.vert")
-                  .WithFragmentShader("resources/glsl/texture-xfer/texture-xfer.frag")
-                  .Build();
-  };
-
-  auto f = context->GetExecutor()->ScheduleOnMainThread(exec_func);
-  f.wait();
+  xfer_prog_ = ProgramRegistry::GetInstance().GetProgram(context,
+                                                         "resources/glsl/texture-xfer/texture-xfer.vert",
+                                                         "resources/glsl/texture-xfer/texture-xfer.frag");
 
   opac_ = 1.0f;
 }
 
-void TextureXferMaterial::UseMaterial() {
-  glUseProgram(xfer_prog_.GetProgramDescriptor());
+bool TextureXferMaterial::UseMaterial() {
+  glUseProgram(xfer_prog_->GetProgramDescriptor());
   glActiveTexture(GL_TEXTURE0);
   glBindTexture(GL_TEXTURE_2D, tex_);
   glUniform1i(0, 0);
   glUniform1f(1, opac_);
+  return true;
 }
 
 void TextureXferMaterial::SetTexture(GLuint tex) {
@@ -1,6 +1,6 @@
 #include <shader/materials/UIGroupMaterial.hpp>
 
-#include <shader/ShaderProgramBuilder.hpp>
+#include <shader/ProgramRegistry.hpp>
 
 
 namespace monkeysworld {
@@ -8,54 +8,24 @@ namespace shader {
 namespace materials {
 
 UIGroupMaterial::UIGroupMaterial(engine::Context* ctx) {
-  auto loader = ctx->GetCachedFileLoader();
-  auto exec_func = [&] {
-    prog_ = ShaderProgramBuilder(loader)
-              .WithVertexShader("resources/glsl/ui-group-mat/ui-group-mat.vert")
-              .WithFragmentShader("resources/glsl/ui-group-mat/ui-group-mat.frag")
-              .Build();
-  };
-
-  auto f = ctx->GetExecutor()->ScheduleOnMainThread(exec_func);
-  f.wait();
-
-  for (int i = 0; i < TEXTURES_PER_CALL; i++) {
-    opacities_[i] = 1.0f;
-  }
+  prog_ = ProgramRegistry::GetInstance().GetProgram(ctx,
+                                                    "resources/glsl/ui-group-mat/ui-group-mat.vert",
+                                                    "resources/glsl/ui-group-mat/ui-group-mat.frag");
+  texture_ = 0;
 }
 
-void UIGroupMaterial::SetTextures(GLuint textures[TEXTURES_PER_CALL]) {
-  for (int i = 0; i < TEXTURES_PER_CALL; i++) {
-    textures_[i] = textures[i];
-  }
+void UIGroupMaterial::SetTexture(GLuint texture) {
+  texture_ = texture;
 }
 
-void UIGroupMaterial::SetOpacity(float opacities[TEXTURES_PER_CALL]) {
-  for (int i = 0; i < TEXTURES_PER_CALL; i++) {
-    if (opacities[i] < 0.0f) {
-      opacities_[i] = 0.0f;
-    } else if (opacities[i] > 1.0f) {
-      opacities_[i] = 1.0f;
-    } else {
-      opacities_[i] = opacities[i];
-    }
-  }
+bool UIGroupMaterial::UseMaterial() {
+  glUseProgram(prog_->GetProgramDescriptor());
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, texture_);
+  glUniform1i(0, 0);
+  return true;
 }
 
-void UIGroupMaterial::UseMaterial() {
-  glUseProgram(prog_.GetProgramDescriptor());
-  
-  // prepare textures
-  for (int i = 0; i < TEXTURES_PER_CALL; i++) {
-    // todo: deal with this
-    glActiveTexture(GL_TEXTURE0 + i);
-    glBindTexture(GL_TEXTURE_2D, textures_[i]);
-    glUniform1i(i, i);
-  }
-
-  glUniform1fv(4, 4, opacities_);
 }
-
 }
 }
-}
\ No newline at end of file
@@ -44,6 +44,19 @@ uint32_t CalculateCRCHash(std::istream& input, std::streamoff offset) {
   return ~crc;
 }
 
+std::streamoff GetRemainingLength(std::istream& input) {
+  std::streampos pos_initial = input.tellg();
+  if (pos_initial == std::streampos(-1)) {
+    return -1;
+  }
+
+  input.seekg(0, std::ios_base::end);
+  std::streampos pos_end = input.tellg();
+  input.clear();
+  input.seekg(pos_initial);
+  return (pos_end == std::streampos(-1) ? -1 : pos_end - pos_initial);
+}
+
 } // namespace fileutils
 } // namespace utils
 } // namespace monkeysworld
\ No newline at end of file
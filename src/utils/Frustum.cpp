@@ -0,0 +1,40 @@
+#include <utils/Frustum.hpp>
+
+namespace monkeysworld {
+namespace utils {
+
+Frustum::Frustum(const glm::mat4& vp_matrix) {
+  // gribb-hartmann: planes are sums + differences of the matrix rows.
+  // glm is column major, so row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+  glm::vec4 rows[4];
+  for (int i = 0; i < 4; i++) {
+    rows[i] = glm::vec4(vp_matrix[0][i], vp_matrix[1][i], vp_matrix[2][i], vp_matrix[3][i]);
+  }
+
+  planes_[0] = rows[3] + rows[0];
+  planes_[1] = rows[3] - rows[0];
+  planes_[2] = rows[3] + rows[1];
+  planes_[3] = rows[3] - rows[1];
+  planes_[4] = rows[3] + rows[2];
+  planes_[5] = rows[3] - rows[2];
+
+  for (int i = 0; i < 6; i++) {
+    float len = glm::length(glm::vec3(planes_[i]));
+    if (len > 0.0f) {
+      planes_[i] /= len;
+    }
+  }
+}
+
+bool Frustum::IntersectsSphere(const glm::vec3& center, float radius) const {
+  for (int i = 0; i < 6; i++) {
+    if (glm::dot(glm::vec3(planes_[i]), center) + planes_[i].w < -radius) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+}
+}
@@ -1,103 +1,152 @@
 #include <utils/ObjectGraph.hpp>
 
-#include <queue>
-
-#include <boost/log/trivial.hpp>
+#include <algorithm>
 
 namespace monkeysworld {
 namespace utils {
 
 ObjectGraph::ObjectGraph() {
-
+  rows_dirty_ = false;
+  row_start_.push_back(0);
 }
 
 void ObjectGraph::AddNode(uint64_t node) {
-  auto p = nodes_.find(node);
-  if (p == nodes_.end()) {
-    // im a bit worried about managing all these sets -- but i guess its what we need
-    nodes_.insert(std::make_pair(node, std::unordered_set<uint64_t>()));
-  }
+  GetIndex(node);
 }
 
 void ObjectGraph::AddEdge(uint64_t parent, uint64_t child) {
-  if (!ContainsNode(parent)) {
-    AddNode(parent);
-  }
-
-  if (!ContainsNode(child)) {
-    AddNode(child);
-  }
-
-  nodes_.at(parent).insert(child);
+  uint32_t parent_index = GetIndex(parent);
+  uint32_t child_index = GetIndex(child);
+  // duplicates are weeded out when the rows are built
+  edges_.push_back(std::make_pair(parent_index, child_index));
+  rows_dirty_ = true;
 }
 
 bool ObjectGraph::ContainsNode(uint64_t node) {
-  auto p = nodes_.find(node);
-  return (p != nodes_.end());
+  auto p = index_.find(node);
+  return (p != index_.end());
 }
 
 std::size_t ObjectGraph::GetNodeCount() {
-  return nodes_.size();
+  return ids_.size();
 }
 
 std::size_t ObjectGraph::GetEdgeCount() {
-  std::size_t res = 0;
-  for (auto p : nodes_) {
-    res += p.second.size();
+  BuildRows();
+  return children_.size();
+}
+
+uint32_t ObjectGraph::GetIndex(uint64_t node) {
+  auto p = index_.find(node);
+  if (p != index_.end()) {
+    return p->second;
   }
 
+  uint32_t res = static_cast<uint32_t>(ids_.size());
+  index_.insert(std::make_pair(node, res));
+  ids_.push_back(node);
+  rows_dirty_ = true;
   return res;
 }
 
-std::vector<uint64_t> ObjectGraph::TopoSort() {
-  std::unordered_map<uint64_t, std::size_t> in_deg;
-  std::queue<uint64_t> visit_queue;
-  std::vector<uint64_t> res;
+void ObjectGraph::BuildRows() {
+  if (!rows_dirty_) {
+    return;
+  }
 
-  for (auto p : nodes_) {
-    in_deg.insert(std::make_pair(p.first, 0));
+  size_t n = ids_.size();
+  // count children per node, then prefix sum into row offsets
+  row_start_.assign(n + 1, 0);
+  for (auto& e : edges_) {
+    row_start_[e.first + 1]++;
   }
 
-  for (auto p : nodes_) {
-    for (auto n : p.second) {
-      in_deg.at(n)++;
-    }
+  for (size_t i = 0; i < n; i++) {
+    row_start_[i + 1] += row_start_[i];
   }
-  auto itr = in_deg.begin();
-  while (itr != in_deg.end()) {
-    if (itr->second == 0) {
-      visit_queue.push(itr->first);
-      itr = in_deg.erase(itr);
+
+  // in_degree_ doubles as the write cursor for each row
+  in_degree_.assign(row_start_.begin(), row_start_.end() - 1);
+  children_.resize(edges_.size());
+  for (auto& e : edges_) {
+    children_[in_degree_[e.first]++] = e.second;
+  }
+
+  // drop duplicate edges, compacting rows as we go
+  uint32_t write = 0;
+  for (size_t i = 0; i < n; i++) {
+    auto begin = children_.begin() + row_start_[i];
+    auto end = children_.begin() + row_start_[i + 1];
+    std::sort(begin, end);
+    end = std::unique(begin, end);
+    uint32_t start = row_start_[i];
+    row_start_[i] = write;
+    if (write == start) {
+      // nothing dropped so far -- the row is already in place
+      write += static_cast<uint32_t>(end - begin);
     } else {
-      itr++;
+      // rows only ever shift left, which std::copy allows
+      write = static_cast<uint32_t>(std::copy(begin, end, children_.begin() + write) - children_.begin());
+    }
+  }
+
+  row_start_[n] = write;
+  children_.resize(write);
+
+  // keep the edge list deduplicated too, so it doesn't grow without bound
+  edges_.resize(write);
+  for (size_t i = 0; i < n; i++) {
+    for (uint32_t j = row_start_[i]; j < row_start_[i + 1]; j++) {
+      edges_[j] = std::make_pair(static_cast<uint32_t>(i), children_[j]);
     }
   }
 
-  while (!visit_queue.empty()) {
-    // grab a node from the visit queue, add it to res.
-    uint64_t node = visit_queue.front();
-    visit_queue.pop();
-    res.push_back(node);
-    // guaranteed to exist
-    // for each of its children in nodes:
-    for (uint64_t node : nodes_.find(node)->second) {
-      size_t& np = in_deg.at(node);
-    // decrement that child in in_deg, if it is present.
-      np--;
-    // if its visit count is 0, remove it from in_deg, and add it to visit_queue.
-      if (np <= 0) {
-        in_deg.erase(node);
-        visit_queue.push(node);
+  rows_dirty_ = false;
+}
+
+std::vector<uint64_t> ObjectGraph::TopoSort() {
+  std::vector<uint64_t> res;
+  TopoSort(res);
+  return res;
+}
+
+bool ObjectGraph::TopoSort(std::vector<uint64_t>& out) {
+  BuildRows();
+  out.clear();
+  size_t n = ids_.size();
+  in_degree_.assign(n, 0);
+  for (uint32_t child : children_) {
+    in_degree_[child]++;
+  }
+
+  // kahn's algorithm -- queue_ holds every node we've visited, in order
+  queue_.clear();
+  for (uint32_t i = 0; i < n; i++) {
+    if (in_degree_[i] == 0) {
+      queue_.push_back(i);
+    }
+  }
+
+  for (size_t head = 0; head < queue_.size(); head++) {
+    uint32_t node = queue_[head];
+    for (uint32_t i = row_start_[node]; i < row_start_[node + 1]; i++) {
+      if (--in_degree_[children_[i]] == 0) {
+        queue_.push_back(children_[i]);
       }
     }
   }
 
-  // a valid topo sort exists if the size of res is the same as nodes_.
-  if (res.size() == nodes_.size()) {
-    return res;
+  // a valid topo sort exists if every node was visited.
+  if (queue_.size() != n) {
+    return false;
+  }
+
+  out.reserve(n);
+  for (uint32_t node : queue_) {
+    out.push_back(ids_[node]);
   }
 
-  return std::vector<uint64_t>();
+  return true;
 }
 
 }
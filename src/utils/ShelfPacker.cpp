@@ -0,0 +1,72 @@
+#include <utils/ShelfPacker.hpp>
+
+namespace monkeysworld {
+namespace utils {
+
+ShelfPacker::ShelfPacker(glm::ivec2 size, int padding) : size_(size), padding_(padding) {}
+
+bool ShelfPacker::Pack(glm::ivec2 size, glm::ivec2* pos) {
+  if (size.x <= 0 || size.y <= 0) {
+    return false;
+  }
+
+  int width = size.x + padding_;
+  int height = size.y + padding_;
+  // pick the shortest shelf which fits, so short rects don't eat up tall shelves
+  shelf* best = nullptr;
+  for (auto& s : shelves_) {
+    if (s.height >= height && s.x + width <= size_.x && (best == nullptr || s.height < best->height)) {
+      best = &s;
+    }
+  }
+
+  if (best == nullptr) {
+    int top = GetUsedHeight();
+    if (top + height > size_.y || padding_ + width > size_.x) {
+      return false;
+    }
+
+    shelf s;
+    s.y = top;
+    s.height = height;
+    s.x = padding_;
+    shelves_.push_back(s);
+    best = &shelves_.back();
+  }
+
+  *pos = glm::ivec2(best->x, best->y);
+  best->x += width;
+  return true;
+}
+
+void ShelfPacker::Clear() {
+  shelves_.clear();
+}
+
+void ShelfPacker::SetDimensions(glm::ivec2 size) {
+  size_ = size;
+  Clear();
+}
+
+glm::ivec2 ShelfPacker::GetDimensions() const {
+  return size_;
+}
+
+int ShelfPacker::GetUsedHeight() const {
+  if (shelves_.empty()) {
+    return padding_;
+  }
+
+  return shelves_.back().y + shelves_.back().height;
+}
+
+const std::vector<ShelfPacker::shelf>& ShelfPacker::GetShelves() const {
+  return shelves_;
+}
+
+void ShelfPacker::SetShelves(const std::vector<shelf>& shelves) {
+  shelves_ = shelves;
+}
+
+}
+}
@@ -1,5 +1,6 @@
  #include <audio/AudioBuffer.hpp>
  #include <audio/AudioBufferOgg.hpp>
+ #include <audio/AudioDecodePool.hpp>
 
  #include <_stb_libs/stb_vorbis.h>
 
@@ -7,6 +8,7 @@
 
  using ::monkeysworld::audio::AudioBuffer;
  using ::monkeysworld::audio::AudioBufferOgg;
+ using ::monkeysworld::audio::AudioDecodePool;
 
  #define EPS 0.000001
 
@@ -46,10 +48,11 @@
  
 
 TEST(OggBufferTest, CheckThreadFunc) {
-  AudioBufferOgg oggers(4096, "resources/flap_jack_scream.ogg");
+  AudioDecodePool pool(1, 44100);
+  auto oggers = std::make_shared<AudioBufferOgg>(4096, "resources/flap_jack_scream.ogg");
   float* output_l = new float[131072];
   float* output_r = new float[131072];
-  oggers.StartWriteThread();
+  pool.AddBuffer(oggers);
   int cur = 0;
   int targ = 0;
   while (true) {
@@ -58,10 +61,10 @@ TEST(OggBufferTest, CheckThreadFunc) {
 
     // solution: build in a mechanism which ensures that write bytes are not advanced
     //           until we are ready.
-    targ = oggers.Read(64, &output_l[cur], &output_r[cur]);
+    targ = oggers->Read(64, &output_l[cur], &output_r[cur]);
     if (targ > 0) {
       cur += targ;
-    } else if (oggers.EndOfFile()) {
+    } else if (oggers->EndOfFile()) {
       break;
     }
   }
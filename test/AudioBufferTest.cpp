@@ -1,12 +1,20 @@
 #include <audio/AudioBuffer.hpp>
+#include <audio/AudioDecodePool.hpp>
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
 #include <thread>
 
 #define EPS 0.001
 
 using ::monkeysworld::audio::AudioBuffer;
+using ::monkeysworld::audio::AudioBufferPacket;
+using ::monkeysworld::audio::AudioDecodePool;
 
 class DummyAudioBuffer : public AudioBuffer {
  public:
@@ -173,4 +181,198 @@ TEST(AudioBufferTests, ReadWriteThreads) {
     ASSERT_NEAR(output_l[i], i, EPS);
     ASSERT_NEAR(output_r[i], SIZE - i, EPS);
   }
-}
\ No newline at end of file
+}
+
+TEST(AudioBufferTests, CapacityRoundsUp) {
+  DummyAudioBuffer test(24);
+  float test_buffer_l[64] = {};
+  float test_buffer_r[64] = {};
+  ASSERT_EQ(test.Write(64, test_buffer_l, test_buffer_r), 32);
+}
+
+TEST(AudioBufferTests, ReadAddInterleavedWraps) {
+  DummyAudioBuffer test(32);
+  float test_buffer_l[32];
+  float test_buffer_r[32];
+  for (int i = 0; i < 32; i++) {
+    test_buffer_l[i] = i;
+    test_buffer_r[i] = 32 - i;
+  }
+
+  // read head ends up partway through the ring, so the next read wraps
+  ASSERT_EQ(test.Write(21, test_buffer_l, test_buffer_r), 21);
+  float discard_l[32];
+  float discard_r[32];
+  ASSERT_EQ(test.Read(21, discard_l, discard_r), 21);
+  ASSERT_EQ(test.Write(30, test_buffer_l, test_buffer_r), 30);
+
+  test.SetGain(-6.0f);
+  float gain = std::pow(10.0f, -6.0f / 20.0f);
+  float output[64];
+  for (int i = 0; i < 64; i++) {
+    output[i] = 1.0f;
+  }
+
+  ASSERT_EQ(test.ReadAddInterleaved(32, output), 30);
+  for (int i = 0; i < 30; i++) {
+    ASSERT_NEAR(1.0f + test_buffer_l[i] * gain, output[2 * i], EPS);
+    ASSERT_NEAR(1.0f + test_buffer_r[i] * gain, output[2 * i + 1], EPS);
+  }
+
+  // past what was read
+  for (int i = 60; i < 64; i++) {
+    ASSERT_NEAR(1.0f, output[i], EPS);
+  }
+}
+
+/**
+ *  "Decodes" a ramp, `length` samples long.
+ */
+class RampAudioBuffer : public AudioBuffer {
+ public:
+  RampAudioBuffer(int capacity, int length) : AudioBuffer(capacity), length_(length) {
+    next_ = 0;
+  }
+
+  int WriteFromFile(int n) override {
+    int written = 0;
+    while (written < n && next_ < length_) {
+      AudioBufferPacket packet = GetBufferSpace(std::min(n - written, length_ - next_));
+      if (packet.capacity == 0) {
+        break;
+      }
+
+      for (int i = 0; i < static_cast<int>(packet.capacity); i++) {
+        packet.left[i] = static_cast<float>(next_ + i);
+        packet.right[i] = static_cast<float>(-(next_ + i));
+      }
+
+      IncrementWriteHead(static_cast<int>(packet.capacity));
+      next_ += static_cast<int>(packet.capacity);
+      written += static_cast<int>(packet.capacity);
+    }
+
+    return written;
+  }
+
+  bool EndOfFile() override {
+    return (next_ >= length_);
+  }
+
+ protected:
+  void SeekFileToWriteHead() override {
+    // nop
+  }
+
+ private:
+  std::atomic<int> next_;
+  int length_;
+};
+
+TEST(AudioBufferTests, DecodePoolRefills) {
+  // we read far faster than real time -- say so, or refills are paced for playback
+  AudioDecodePool pool(2, 44100 * 16);
+  std::vector<std::shared_ptr<RampAudioBuffer>> buffers;
+  for (int i = 0; i < 8; i++) {
+    buffers.push_back(std::make_shared<RampAudioBuffer>(256, SIZE));
+    pool.AddBuffer(buffers.back());
+  }
+
+  // more buffers than workers -- each one should still come out in order
+  std::vector<float> output_l(SIZE);
+  std::vector<float> output_r(SIZE);
+  for (auto& buffer : buffers) {
+    int ctr = 0;
+    while (ctr < SIZE) {
+      ctr += buffer->Read(std::min(64, SIZE - ctr), &output_l[ctr], &output_r[ctr]);
+    }
+
+    for (int i = 0; i < SIZE; i++) {
+      ASSERT_NEAR(output_l[i], i, EPS);
+      ASSERT_NEAR(output_r[i], -i, EPS);
+    }
+  }
+}
+
+TEST(AudioBufferTests, DecodePoolDropsExhaustedBuffers) {
+  AudioDecodePool pool(1, 44100);
+  auto buffer = std::make_shared<RampAudioBuffer>(256, 1000);
+  pool.AddBuffer(buffer);
+  ASSERT_EQ(1u, pool.GetBufferCount());
+
+  float output_l[64];
+  float output_r[64];
+  int ctr = 0;
+  while (ctr < 1000) {
+    ctr += buffer->Read(64, output_l, output_r);
+  }
+
+  // one last request finds the file empty
+  auto start = std::chrono::steady_clock::now();
+  while (pool.GetBufferCount() > 0 && std::chrono::steady_clock::now() - start < std::chrono::seconds(1)) {
+    buffer->Read(64, output_l, output_r);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  ASSERT_EQ(0u, pool.GetBufferCount());
+  ASSERT_EQ(0, buffer->Read(64, output_l, output_r));
+}
+
+// takes a while to "decode", and notes the most workers ever writing to it at once
+class SlowAudioBuffer : public AudioBuffer {
+ public:
+  SlowAudioBuffer(int capacity) : AudioBuffer(capacity), writers_(0), max_writers_(0), refills_(0) {}
+  int WriteFromFile(int n) override {
+    int writers = ++writers_;
+    int max = max_writers_.load();
+    while (writers > max && !max_writers_.compare_exchange_weak(max, writers)) {}
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    writers_--;
+    refills_++;
+    return n;
+  }
+
+  bool EndOfFile() override {
+    return false;
+  }
+
+  bool IsWriting() const { return writers_.load() > 0; }
+  int GetMaxWriters() const { return max_writers_.load(); }
+  int GetRefillCount() const { return refills_.load(); }
+
+ protected:
+  void SeekFileToWriteHead() override {
+    // nop
+  }
+
+ private:
+  std::atomic<int> writers_;
+  std::atomic<int> max_writers_;
+  std::atomic<int> refills_;
+};
+
+TEST(AudioBufferTests, DecodePoolReaddWaitsForRefill) {
+  AudioDecodePool pool(2, 44100);
+  auto buffer = std::make_shared<SlowAudioBuffer>(256);
+  pool.AddBuffer(buffer);
+
+  auto start = std::chrono::steady_clock::now();
+  while (!buffer->IsWriting() && std::chrono::steady_clock::now() - start < std::chrono::seconds(1)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  ASSERT_TRUE(buffer->IsWriting());
+
+  // the second registration's request comes in while the first refill is still going
+  pool.RemoveBuffer(buffer.get());
+  pool.AddBuffer(buffer);
+
+  start = std::chrono::steady_clock::now();
+  while (buffer->GetRefillCount() < 2 && std::chrono::steady_clock::now() - start < std::chrono::seconds(1)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  ASSERT_EQ(2, buffer->GetRefillCount());
+  ASSERT_EQ(1, buffer->GetMaxWriters());
+  ASSERT_EQ(1u, pool.GetBufferCount());
+}
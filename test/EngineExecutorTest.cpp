@@ -97,4 +97,36 @@ TEST(EngineExecutorTests, MultiThreadTests) {
   for (int i = 0; i < 16; i++) {
     ASSERT_EQ(futures[i].get(), i);
   }
-}
\ No newline at end of file
+}
+
+TEST(EngineExecutorTests, PollsUntilDone) {
+  EngineExecutor exec;
+  int calls = 0;
+  exec.PollOnMainThread([&]() -> bool {
+    return (++calls >= 3);
+  });
+
+  for (int i = 0; i < 5; i++) {
+    exec.RunTasks(0.01);
+  }
+
+  ASSERT_EQ(calls, 3);
+}
+
+TEST(EngineExecutorTests, PollsCanQueuePolls) {
+  EngineExecutor exec;
+  bool inner_ran = false;
+  exec.PollOnMainThread([&]() -> bool {
+    exec.PollOnMainThread([&]() -> bool {
+      inner_ran = true;
+      return true;
+    });
+
+    return true;
+  });
+
+  exec.RunTasks(0.01);
+  ASSERT_FALSE(inner_ran);
+  exec.RunTasks(0.01);
+  ASSERT_TRUE(inner_ran);
+}
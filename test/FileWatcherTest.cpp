@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+#include <file/FileWatcher.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+using ::monkeysworld::file::FileWatcher;
+
+static void WriteFile(const std::string& path, const std::string& contents) {
+  std::ofstream file(path, std::ios_base::out | std::ios_base::trunc);
+  file << contents;
+}
+
+TEST(FileWatcherTests, ReportsModifiedFiles) {
+  if (!FileWatcher::IsSupported()) {
+    return;
+  }
+
+  WriteFile("watch_a.txt", "a");
+  WriteFile("watch_b.txt", "b");
+
+  FileWatcher watcher;
+  watcher.Watch("watch_a.txt");
+  ASSERT_TRUE(watcher.PollChanges().empty());
+
+  WriteFile("watch_a.txt", "aa");
+  WriteFile("watch_a.txt", "aaa");
+  // not watched
+  WriteFile("watch_b.txt", "bb");
+
+  auto changes = watcher.PollChanges();
+  ASSERT_EQ(1, changes.size());
+  ASSERT_EQ("watch_a.txt", changes[0]);
+
+  // already reported
+  ASSERT_TRUE(watcher.PollChanges().empty());
+
+  std::remove("watch_a.txt");
+  std::remove("watch_b.txt");
+}
+
+TEST(FileWatcherTests, ReportsReplacedFiles) {
+  if (!FileWatcher::IsSupported()) {
+    return;
+  }
+
+  WriteFile("watch_c.txt", "c");
+
+  FileWatcher watcher;
+  watcher.Watch("watch_c.txt");
+
+  // how most editors save
+  WriteFile("watch_c.txt.tmp", "cc");
+  std::rename("watch_c.txt.tmp", "watch_c.txt");
+
+  auto changes = watcher.PollChanges();
+  ASSERT_EQ(1, changes.size());
+  ASSERT_EQ("watch_c.txt", changes[0]);
+
+  std::remove("watch_c.txt");
+}
@@ -10,7 +10,8 @@ using ::monkeysworld::file::cache_record;
 
 TEST(FontLoaderTests, LoadFontSimple) {
   auto threads = std::make_shared<LoaderThreadPool>(2);
-  FontLoader loader(threads, std::vector<cache_record>());
+  // atlases are stored in the working directory
+  FontLoader loader(threads, std::vector<cache_record>(), "");
   auto font = loader.LoadFile("resources/Montserrat-Light.ttf");
   ASSERT_NE(nullptr, font.get());
   auto mesh = font->GetTextGeometry("mario", 32.0f);
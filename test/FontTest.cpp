@@ -0,0 +1,586 @@
+#include <file/LoaderThreadPool.hpp>
+#include <font/DistanceField.hpp>
+#include <font/Font.hpp>
+#include <font/GlyphAtlasCache.hpp>
+#include <font/KerningShaper.hpp>
+#include <font/UTF8.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <tuple>
+#include <memory>
+#include <random>
+
+using ::monkeysworld::file::LoaderThreadPool;
+using ::monkeysworld::font::Font;
+using ::monkeysworld::font::GlyphAtlasCache;
+using ::monkeysworld::font::KerningShaper;
+using ::monkeysworld::font::run_glyph;
+using ::monkeysworld::font::NextCodepoint;
+using ::monkeysworld::font::REPLACEMENT_CHAR;
+using ::monkeysworld::font::shaped_text;
+using ::monkeysworld::font::text_metrics;
+using ::monkeysworld::font::TextFormat;
+using ::monkeysworld::storage::VertexPacket2D;
+using ::monkeysworld::font::LEFT;
+using ::monkeysworld::font::CENTER;
+using ::monkeysworld::font::DEFAULT;
+using ::monkeysworld::font::MIDDLE;
+
+static std::vector<uint32_t> Decode(const std::string& text) {
+  std::vector<uint32_t> res;
+  size_t index = 0;
+  while (index < text.size()) {
+    res.push_back(NextCodepoint(text, &index));
+  }
+
+  return res;
+}
+
+/**
+ *  Encodes a codepoint as UTF-8.
+ */
+static std::string Encode(uint32_t c) {
+  std::string res;
+  if (c < 0x80) {
+    res += static_cast<char>(c);
+  } else if (c < 0x800) {
+    res += static_cast<char>(0xC0 | (c >> 6));
+    res += static_cast<char>(0x80 | (c & 0x3F));
+  } else {
+    res += static_cast<char>(0xE0 | (c >> 12));
+    res += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+    res += static_cast<char>(0x80 | (c & 0x3F));
+  }
+
+  return res;
+}
+
+TEST(FontTests, DecodeUTF8) {
+  // a, e acute, euro, g clef
+  auto res = Decode("a\xC3\xA9\xE2\x82\xAC\xF0\x9D\x84\x9E");
+  ASSERT_EQ(4, res.size());
+  ASSERT_EQ(0x61, res[0]);
+  ASSERT_EQ(0xE9, res[1]);
+  ASSERT_EQ(0x20AC, res[2]);
+  ASSERT_EQ(0x1D11E, res[3]);
+}
+
+TEST(FontTests, DecodeMalformedUTF8) {
+  // stray continuation, overlong slash, truncated euro, surrogate.
+  // each bad byte is replaced on its own.
+  auto res = Decode("\x80" "\xC0\xAF" "\xE2\x82" "\xED\xA0\x80" "z");
+  ASSERT_EQ(9, res.size());
+  for (size_t i = 0; i < 8; i++) {
+    ASSERT_EQ(REPLACEMENT_CHAR, res[i]);
+  }
+
+  ASSERT_EQ('z', res[8]);
+}
+
+TEST(FontTests, NonAsciiGlyphs) {
+  Font f("resources/Montserrat-Light.ttf");
+  // every character gets a quad, not just the ascii ones
+  auto mesh = f.GetTextGeometry("\xC3\xB1" "and\xC3\xBA", 32.0f);
+  ASSERT_EQ(20, mesh.GetVertexCount());
+  ASSERT_EQ(30, mesh.GetIndexCount());
+
+  // spaces and control characters just move the cursor
+  mesh = f.GetTextGeometry("a b\tc", 32.0f);
+  ASSERT_EQ(12, mesh.GetVertexCount());
+}
+
+TEST(FontTests, AtlasGrowsOnDemand) {
+  Font f("resources/Montserrat-Light.ttf");
+  auto mesh = f.GetTextGeometry("mario", 32.0f);
+  uint64_t generation = f.GetAtlasGeneration();
+
+  // same glyphs again shouldn't disturb the atlas
+  f.GetTextGeometry("oiram", 32.0f);
+  ASSERT_EQ(generation, f.GetAtlasGeneration());
+
+  // lots of new glyphs -- atlas has to grow, so old texcoords are stale
+  std::string text;
+  for (uint32_t c = 0x21; c < 0x17F; c++) {
+    text += Encode(c);
+  }
+
+  mesh = f.GetTextGeometry(text, 32.0f);
+  ASSERT_NE(generation, f.GetAtlasGeneration());
+  ASSERT_LT(0, mesh.GetVertexCount());
+  for (size_t i = 0; i < mesh.GetVertexCount(); i++) {
+    glm::vec2 tex = mesh[i].texcoords;
+    ASSERT_LE(0.0f, tex.x);
+    ASSERT_LE(0.0f, tex.y);
+    ASSERT_GE(1.0f, tex.x);
+    ASSERT_GE(1.0f, tex.y);
+  }
+}
+
+TEST(FontTests, DistanceFieldSigns) {
+  using ::monkeysworld::font::DistanceField;
+  // 16x16 square, at 4x -- output is 4x4 px of glyph with 2px of margin
+  std::vector<uint8_t> square(16 * 16, 255);
+  std::vector<uint8_t> out(8 * 8);
+  DistanceField sdf;
+  sdf.Generate(square.data(), glm::ivec2(16), 16, glm::ivec2(8), 4, 2, glm::ivec2(8), out.data());
+  for (int y = 0; y < 8; y++) {
+    for (int x = 0; x < 8; x++) {
+      bool inside = (x >= 2 && x < 6 && y >= 2 && y < 6);
+      if (inside) {
+        ASSERT_LT(128, out[y * 8 + x]);
+      } else {
+        ASSERT_GT(128, out[y * 8 + x]);
+      }
+    }
+  }
+
+  // saturates past the spread, and deeper pixels are further in
+  ASSERT_EQ(0, out[0]);
+  ASSERT_LT(out[2 * 8 + 2], out[3 * 8 + 3]);
+}
+
+TEST(FontTests, DistanceFieldAtlasIsSmaller) {
+  using ::monkeysworld::font::GlyphMode;
+  Font bitmap("resources/Montserrat-Light.ttf", GlyphMode::BITMAP);
+  Font sdf("resources/Montserrat-Light.ttf", GlyphMode::SDF);
+  ASSERT_EQ(GlyphMode::BITMAP, bitmap.GetGlyphMode());
+  ASSERT_EQ(GlyphMode::SDF, sdf.GetGlyphMode());
+
+  std::string text;
+  for (char c = 0x21; c <= 0x7e; c++) {
+    text += c;
+  }
+
+  auto bitmap_mesh = bitmap.GetTextGeometry(text, 32.0f);
+  auto sdf_mesh = sdf.GetTextGeometry(text, 32.0f);
+  ASSERT_EQ(bitmap_mesh.GetVertexCount(), sdf_mesh.GetVertexCount());
+
+  glm::ivec2 bitmap_dims = bitmap.GetAtlasDimensions();
+  glm::ivec2 sdf_dims = sdf.GetAtlasDimensions();
+  ASSERT_GT(bitmap_dims.x * bitmap_dims.y, 8 * sdf_dims.x * sdf_dims.y);
+
+  // glyphs should land in about the same place, whatever they're stored as
+  for (size_t i = 0; i < sdf_mesh.GetVertexCount(); i++) {
+    glm::vec2 a = bitmap_mesh[i].position;
+    glm::vec2 b = sdf_mesh[i].position;
+    ASSERT_NEAR(a.x, b.x, 0.01f);
+    ASSERT_NEAR(a.y, b.y, 0.01f);
+  }
+}
+
+static void ExpectSameLayout(const shaped_text& a, const shaped_text& b) {
+  ASSERT_EQ(a.glyphs.size(), b.glyphs.size());
+  for (size_t i = 0; i < a.glyphs.size(); i++) {
+    ASSERT_EQ(a.glyphs[i].glyph, b.glyphs[i].glyph);
+    ASSERT_EQ(a.glyphs[i].line, b.glyphs[i].line);
+    ASSERT_FLOAT_EQ(a.glyphs[i].origin.x, b.glyphs[i].origin.x);
+    ASSERT_FLOAT_EQ(a.glyphs[i].origin.y, b.glyphs[i].origin.y);
+  }
+
+  ASSERT_EQ(a.line_offsets, b.line_offsets);
+  ASSERT_FLOAT_EQ(a.y_offset, b.y_offset);
+}
+
+TEST(FontTests, ShapeCacheSharesLayouts) {
+  Font f("resources/Montserrat-Light.ttf");
+  TextFormat format = {LEFT, DEFAULT, 0.0f};
+  auto a = f.ShapeText("60 FPS", 32.0f, format);
+  ASSERT_EQ(a, f.ShapeText("60 FPS", 32.0f, format));
+  ASSERT_NE(a, f.ShapeText("60 FPS", 24.0f, format));
+
+  format.horiz_align = CENTER;
+  auto centered = f.ShapeText("60 FPS", 32.0f, format);
+  ASSERT_NE(a, centered);
+  ASSERT_LT(0.0f, centered->line_offsets[0]);
+
+  // geometry matches what GetTextGeometry builds
+  std::vector<VertexPacket2D> verts(a->glyphs.size() * 4);
+  f.WriteTextGeometry(*a, verts.data());
+  auto mesh = f.GetTextGeometry("60 FPS", 32.0f);
+  ASSERT_EQ(verts.size(), mesh.GetVertexCount());
+  for (size_t i = 0; i < verts.size(); i++) {
+    ASSERT_EQ(verts[i].position, mesh[i].position);
+    ASSERT_EQ(verts[i].texcoords, mesh[i].texcoords);
+  }
+}
+
+TEST(FontTests, ShapePrefixMatchesFreshLayout) {
+  Font f("resources/Montserrat-Light.ttf");
+  Font fresh("resources/Montserrat-Light.ttf");
+  TextFormat format = {CENTER, MIDDLE, 0.0f};
+  auto old_text = f.ShapeText("123 FPS\nframe time", 32.0f, format);
+  auto res = f.ShapeText("124 FPS\nframe", 32.0f, format, old_text.get());
+  // resumed after "12"
+  ASSERT_EQ(old_text->glyphs[0].glyph, res->glyphs[0].glyph);
+  ExpectSameLayout(*fresh.ShapeText("124 FPS\nframe", 32.0f, format), *res);
+
+  // a truncated sequence decodes differently once it's completed
+  old_text = f.ShapeText("ab\xE2\x82", 32.0f, format);
+  res = f.ShapeText("ab\xE2\x82\xAC", 32.0f, format, old_text.get());
+  ExpectSameLayout(*fresh.ShapeText("ab\xE2\x82\xAC", 32.0f, format), *res);
+}
+
+/**
+ *  Pulls 'V' in a pixel closer after an 'A', like a kerning pair would, and counts its runs.
+ */
+class PairShaper : public KerningShaper {
+ public:
+  PairShaper(int* runs) : runs_(runs) {}
+
+  void ShapeRun(FT_Face face, const uint32_t* codepoints, size_t count, std::vector<run_glyph>* out) override {
+    (*runs_)++;
+    KerningShaper::ShapeRun(face, codepoints, count, out);
+    for (size_t i = 1; i < count; i++) {
+      if (codepoints[i - 1] == 'A' && codepoints[i] == 'V') {
+        (*out)[i - 1].advance -= 64 * face->size->metrics.x_ppem / 48;
+      }
+    }
+  }
+
+ private:
+  int* runs_;
+};
+
+TEST(FontTests, ShaperPlacesGlyphs) {
+  int runs = 0;
+  Font plain("resources/Montserrat-Light.ttf");
+  Font kerned("resources/Montserrat-Light.ttf");
+  kerned.SetShaper(std::unique_ptr<PairShaper>(new PairShaper(&runs)));
+  TextFormat format = {LEFT, DEFAULT, 0.0f};
+
+  // one run per line
+  auto a = plain.ShapeText("AV\nAV", 48.0f, format);
+  auto b = kerned.ShapeText("AV\nAV", 48.0f, format);
+  ASSERT_EQ(2, runs);
+  ASSERT_EQ(4, b->glyphs.size());
+  ASSERT_FLOAT_EQ(a->glyphs[0].origin.x, b->glyphs[0].origin.x);
+  ASSERT_LT(b->glyphs[1].origin.x, a->glyphs[1].origin.x);
+  ASSERT_FLOAT_EQ(b->glyphs[1].origin.x, b->glyphs[3].origin.x);
+
+  // static text is only shaped once
+  ASSERT_EQ(b, kerned.ShapeText("AV\nAV", 48.0f, format));
+  ASSERT_EQ(2, runs);
+}
+
+TEST(FontTests, ShapePrefixWaitsForKerning) {
+  int runs = 0;
+  Font f("resources/Montserrat-Light.ttf");
+  Font fresh("resources/Montserrat-Light.ttf");
+  f.SetShaper(std::unique_ptr<PairShaper>(new PairShaper(&runs)));
+  fresh.SetShaper(std::unique_ptr<PairShaper>(new PairShaper(&runs)));
+  TextFormat format = {LEFT, DEFAULT, 0.0f};
+
+  // the 'A' can't be reused until we know what follows it
+  auto old_text = f.ShapeText("xA", 32.0f, format);
+  auto res = f.ShapeText("xAV", 32.0f, format, old_text.get());
+  ExpectSameLayout(*fresh.ShapeText("xAV", 32.0f, format), *res);
+
+  old_text = f.ShapeText("xAX", 32.0f, format);
+  res = f.ShapeText("xAVX", 32.0f, format, old_text.get());
+  ExpectSameLayout(*fresh.ShapeText("xAVX", 32.0f, format), *res);
+}
+
+TEST(FontTests, PooledLoadMatchesSerial) {
+  using ::monkeysworld::font::GlyphMode;
+  auto pool = std::make_shared<LoaderThreadPool>(4);
+  Font serial("resources/Montserrat-Light.ttf");
+  Font pooled("resources/Montserrat-Light.ttf", GlyphMode::SDF, pool);
+  std::string text;
+  for (char c = 0x21; c <= 0x7e; c++) {
+    text += c;
+  }
+
+  // prewarmed glyphs shouldn't have to be rasterized again
+  uint64_t generation = pooled.GetAtlasGeneration();
+  auto a = serial.GetTextGeometry(text, 32.0f);
+  auto b = pooled.GetTextGeometry(text, 32.0f);
+  ASSERT_EQ(generation, pooled.GetAtlasGeneration());
+  ASSERT_EQ(a.GetVertexCount(), b.GetVertexCount());
+  for (size_t i = 0; i < a.GetVertexCount(); i++) {
+    ASSERT_EQ(a[i].position, b[i].position);
+  }
+}
+
+TEST(FontTests, PooledLoadFromPoolTasks) {
+  using ::monkeysworld::font::GlyphMode;
+  // every worker is busy loading a font, and waiting on its glyphs
+  auto pool = std::make_shared<LoaderThreadPool>(2);
+  std::vector<std::future<bool>> loads;
+  for (int i = 0; i < 6; i++) {
+    auto done = std::make_shared<std::promise<bool>>();
+    loads.push_back(done->get_future());
+    pool->AddTaskToQueue([=] {
+      Font f((i % 2 ? "resources/Montserrat-Light.ttf" : "resources/8bitoperator_jve.ttf"), GlyphMode::SDF, pool);
+      done->set_value(f.GetTextGeometry("loaded", 32.0f).GetVertexCount() == 24);
+    });
+  }
+
+  for (auto& load : loads) {
+    ASSERT_TRUE(load.get());
+  }
+}
+
+TEST(FontTests, MeasureMatchesGeometry) {
+  Font f("resources/Montserrat-Light.ttf");
+  TextFormat format = {CENTER, MIDDLE, 0.0f};
+  auto mesh = f.GetTextGeometry("measure\nme, please", 32.0f, format);
+  glm::vec2 min(1000.0f);
+  glm::vec2 max(-1000.0f);
+  for (size_t i = 0; i < mesh.GetVertexCount(); i++) {
+    min = glm::min(min, mesh[i].position);
+    max = glm::max(max, mesh[i].position);
+  }
+
+  text_metrics metrics = f.MeasureText("measure\nme, please", 32.0f, format);
+  ASSERT_EQ(2, metrics.line_count);
+  ASSERT_FLOAT_EQ(min.x, metrics.min.x);
+  ASSERT_FLOAT_EQ(min.y, metrics.min.y);
+  ASSERT_FLOAT_EQ(max.x, metrics.max.x);
+  ASSERT_FLOAT_EQ(max.y, metrics.max.y);
+
+  // nothing drawn, nothing measured
+  metrics = f.MeasureText("   ", 32.0f, format);
+  ASSERT_EQ(metrics.min, metrics.max);
+}
+
+TEST(FontTests, CaretPositions) {
+  Font f("resources/Montserrat-Light.ttf");
+  TextFormat format = {LEFT, DEFAULT, 0.0f};
+  auto shaped = f.ShapeText("ab\n\xC3\xA9z", 32.0f, format);
+  glm::vec2 start = f.GetCaretPosition(*shaped, 0);
+  ASSERT_EQ(glm::vec2(0.0f), start);
+  ASSERT_LT(start.x, f.GetCaretPosition(*shaped, 1).x);
+  ASSERT_LT(f.GetCaretPosition(*shaped, 1).x, f.GetCaretPosition(*shaped, 2).x);
+
+  // next line, back at the start
+  glm::vec2 line = f.GetCaretPosition(*shaped, 3);
+  ASSERT_EQ(0.0f, line.x);
+  ASSERT_GT(start.y, line.y);
+
+  // halfway through a codepoint is still before it
+  ASSERT_EQ(line, f.GetCaretPosition(*shaped, 4));
+  ASSERT_LT(line.x, f.GetCaretPosition(*shaped, 5).x);
+}
+
+TEST(FontTests, WrapBreaksAtSpaces) {
+  Font f("resources/Montserrat-Light.ttf");
+  TextFormat format = {LEFT, DEFAULT, 0.0f};
+  // lines are as wide as their pen travels
+  auto a = f.ShapeText("the quick", 32.0f, format);
+  auto b = f.ShapeText("brown fox", 32.0f, format);
+  float width = std::max(f.GetCaretPosition(*a, 9).x, f.GetCaretPosition(*b, 9).x) + 0.001f;
+  ASSERT_EQ("the quick\nbrown fox\njumps", f.WrapText("the quick brown fox jumps", 32.0f, format, width));
+
+  // existing breaks start a new line, and long words overflow
+  ASSERT_EQ("the\nquick brown\nsupercalifragilistic\nfox",
+            f.WrapText("the\nquick brown supercalifragilistic fox", 32.0f, format, width * 1.5f));
+}
+
+static std::vector<FT_Byte> ReadFontFile(const std::string& path) {
+  std::ifstream input(path, std::ios_base::binary);
+  return std::vector<FT_Byte>((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+}
+
+TEST(FontTests, AtlasKeyChangesWithInputs) {
+  using ::monkeysworld::font::GlyphMode;
+  auto data = ReadFontFile("resources/Montserrat-Light.ttf");
+  uint64_t key = GlyphAtlasCache::GetAtlasKey(data, GlyphMode::SDF, 48, 4, 4, 512);
+  ASSERT_EQ(key, GlyphAtlasCache::GetAtlasKey(data, GlyphMode::SDF, 48, 4, 4, 512));
+  ASSERT_NE(key, GlyphAtlasCache::GetAtlasKey(data, GlyphMode::BITMAP, 48, 4, 4, 512));
+  ASSERT_NE(key, GlyphAtlasCache::GetAtlasKey(data, GlyphMode::SDF, 32, 4, 4, 512));
+  ASSERT_NE(key, GlyphAtlasCache::GetAtlasKey(data, GlyphMode::SDF, 48, 4, 2, 512));
+
+  // font file changed on disk
+  data.back() ^= 1;
+  ASSERT_NE(key, GlyphAtlasCache::GetAtlasKey(data, GlyphMode::SDF, 48, 4, 4, 512));
+}
+
+TEST(FontTests, AtlasCacheRoundTrip) {
+  using ::monkeysworld::font::GlyphMode;
+  GlyphAtlasCache cache("");
+  uint64_t key = GlyphAtlasCache::GetAtlasKey(ReadFontFile("resources/Montserrat-Light.ttf"), GlyphMode::SDF, 48, 4, 4, 512);
+  std::stringstream path;
+  path << std::hex << std::setw(16) << std::setfill('0') << key << ".glyphatlas";
+  std::remove(path.str().c_str());
+
+  Font baked("resources/Montserrat-Light.ttf", GlyphMode::SDF, nullptr, &cache);
+  auto a = baked.GetTextGeometry("AVAWAY, \xc3\xa9t\xc3\xa9", 32.0f);
+  ASSERT_TRUE(baked.StoreAtlas(cache));
+  // nothing new since
+  ASSERT_FALSE(baked.StoreAtlas(cache));
+
+  // everything it needs is in the atlas already
+  Font loaded("resources/Montserrat-Light.ttf", GlyphMode::SDF, nullptr, &cache);
+  auto b = loaded.GetTextGeometry("AVAWAY, \xc3\xa9t\xc3\xa9", 32.0f);
+  ASSERT_FALSE(loaded.StoreAtlas(cache));
+  ASSERT_EQ(baked.GetAtlasDimensions(), loaded.GetAtlasDimensions());
+  ASSERT_EQ(a.GetVertexCount(), b.GetVertexCount());
+  for (size_t i = 0; i < a.GetVertexCount(); i++) {
+    ASSERT_EQ(a[i].position, b[i].position);
+    ASSERT_EQ(a[i].texcoords, b[i].texcoords);
+  }
+
+  // chop off the end of the file -- should fall back on rasterizing
+  {
+    std::ifstream input(path.str(), std::ios_base::binary);
+    std::vector<char> contents((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    contents.resize(contents.size() - 16);
+    input.close();
+    std::ofstream output(path.str(), std::ios_base::trunc | std::ios_base::binary);
+    output.write(contents.data(), contents.size());
+  }
+
+  Font truncated("resources/Montserrat-Light.ttf", GlyphMode::SDF, nullptr, &cache);
+  auto c = truncated.GetTextGeometry("AVAWAY, \xc3\xa9t\xc3\xa9", 32.0f);
+  ASSERT_EQ(a.GetVertexCount(), c.GetVertexCount());
+  ASSERT_TRUE(truncated.StoreAtlas(cache));
+
+  std::remove(path.str().c_str());
+}
+
+/**
+ *  Overwrites a 32 bit field in a stored atlas.
+ */
+static void PatchAtlas(const std::string& path, std::streamoff offset, uint32_t value) {
+  std::fstream file(path, std::ios_base::in | std::ios_base::out | std::ios_base::binary);
+  file.seekp(offset);
+  file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+TEST(FontTests, AtlasCacheRejectsBadCounts) {
+  using ::monkeysworld::font::baked_atlas;
+  using ::monkeysworld::font::GlyphMode;
+  GlyphAtlasCache cache("");
+  uint64_t key = GlyphAtlasCache::GetAtlasKey(ReadFontFile("resources/Montserrat-Light.ttf"), GlyphMode::SDF, 48, 4, 4, 512);
+  std::stringstream path;
+  path << std::hex << std::setw(16) << std::setfill('0') << key << ".glyphatlas";
+
+  Font baked("resources/Montserrat-Light.ttf", GlyphMode::SDF, nullptr, &cache);
+  ASSERT_TRUE(baked.StoreAtlas(cache));
+
+  // header: magic, key, width, height, rows, glyph count, shelf count
+  const std::streamoff HEIGHT = 16;
+  const std::streamoff GLYPH_COUNT = 24;
+  const std::streamoff SHELF_COUNT = 28;
+  baked_atlas atlas;
+  ASSERT_TRUE(cache.ReadAtlas(key, &atlas));
+  uint32_t height = atlas.height;
+  uint32_t glyphs = static_cast<uint32_t>(atlas.glyphs.size());
+  uint32_t shelves = static_cast<uint32_t>(atlas.shelves.size());
+
+  // each is rejected before anything is allocated for it
+  PatchAtlas(path.str(), GLYPH_COUNT, 0xFFFFFFFF);
+  baked_atlas bad;
+  ASSERT_FALSE(cache.ReadAtlas(key, &bad));
+  ASSERT_EQ(0, bad.glyphs.capacity());
+  PatchAtlas(path.str(), GLYPH_COUNT, glyphs);
+
+  PatchAtlas(path.str(), SHELF_COUNT, 0xFFFFFFFF);
+  ASSERT_FALSE(cache.ReadAtlas(key, &bad));
+  ASSERT_EQ(0, bad.shelves.capacity());
+  PatchAtlas(path.str(), SHELF_COUNT, shelves);
+
+  PatchAtlas(path.str(), HEIGHT, Font::MAX_ATLAS_HEIGHT * 2);
+  ASSERT_FALSE(cache.ReadAtlas(key, &bad));
+  PatchAtlas(path.str(), HEIGHT, height);
+
+  // counts which fit the header, but not the file
+  PatchAtlas(path.str(), GLYPH_COUNT, glyphs + 1000);
+  ASSERT_FALSE(cache.ReadAtlas(key, &bad));
+  ASSERT_EQ(0, bad.glyphs.capacity());
+  ASSERT_EQ(0, bad.data.capacity());
+  PatchAtlas(path.str(), GLYPH_COUNT, glyphs);
+
+  ASSERT_TRUE(cache.ReadAtlas(key, &bad));
+  std::remove(path.str().c_str());
+}
+
+TEST(FontTests, EvictionKeepsGlyphsInUse) {
+  using ::monkeysworld::font::GlyphMode;
+  std::vector<uint32_t> codepoints;
+  for (uint32_t c = 0x21; c < 0x2000; c++) {
+    codepoints.push_back(c);
+  }
+
+  // whether the glyphs in use can be repacked depends on the order they came in, so try a few
+  std::mt19937 gen(1234);
+  for (int attempt = 0; attempt < 8; attempt++) {
+    Font f("resources/Montserrat-Light.ttf", GlyphMode::BITMAP);
+    // something older to evict
+    f.GetTextGeometry("mario", 32.0f);
+    uint64_t generation = f.GetAtlasGeneration();
+
+    // more glyphs than a bitmap atlas can hold, all written at once
+    std::shuffle(codepoints.begin(), codepoints.end(), gen);
+    std::string text;
+    for (auto c : codepoints) {
+      text += Encode(c);
+    }
+
+    auto mesh = f.GetTextGeometry(text, 32.0f);
+    ASSERT_NE(generation, f.GetAtlasGeneration());
+    ASSERT_LT(0, mesh.GetVertexCount());
+
+    // every quad has to point at a glyph which is still in the atlas -- so distinct glyphs never overlap
+    std::vector<glm::vec4> rects;
+    for (size_t i = 0; i + 3 < mesh.GetVertexCount(); i += 4) {
+      glm::vec2 min = glm::min(mesh[i].texcoords, mesh[i + 2].texcoords);
+      glm::vec2 max = glm::max(mesh[i].texcoords, mesh[i + 2].texcoords);
+      ASSERT_LE(0.0f, min.x);
+      ASSERT_LE(0.0f, min.y);
+      ASSERT_GE(1.0f, max.x);
+      ASSERT_GE(1.0f, max.y);
+      if (min.x < max.x && min.y < max.y) {
+        rects.push_back(glm::vec4(min, max));
+      }
+    }
+
+    std::sort(rects.begin(), rects.end(), [](const glm::vec4& a, const glm::vec4& b) {
+      return std::tie(a.x, a.y, a.z, a.w) < std::tie(b.x, b.y, b.z, b.w);
+    });
+
+    rects.erase(std::unique(rects.begin(), rects.end()), rects.end());
+    for (size_t i = 0; i < rects.size(); i++) {
+      for (size_t j = i + 1; j < rects.size() && rects[j].x < rects[i].z; j++) {
+        bool overlap = (rects[j].y < rects[i].w && rects[i].y < rects[j].w);
+        ASSERT_FALSE(overlap);
+      }
+    }
+  }
+}
+
+TEST(FontTests, BatchKeepsEarlierGlyphs) {
+  using ::monkeysworld::font::GlyphMode;
+  std::string text;
+  for (uint32_t c = 0x21; c < 0x2000; c++) {
+    text += Encode(c);
+  }
+
+  // none of these are in `text`, so nothing else marks them as used
+  std::string small = Encode(0x20AC) + Encode(0x2122) + Encode(0x2026) + Encode(0x201C) + Encode(0x201D);
+
+  Font f("resources/Montserrat-Light.ttf", GlyphMode::BITMAP);
+  f.BeginBatch();
+  auto first = f.GetTextGeometry(small, 32.0f);
+  // overflows the atlas, but can't evict anything from earlier in the batch
+  f.GetTextGeometry(text, 32.0f);
+  uint64_t generation = f.GetAtlasGeneration();
+
+  // so rewriting the first text finds its glyphs where they are
+  auto again = f.GetTextGeometry(small, 32.0f);
+  f.EndBatch();
+  ASSERT_EQ(generation, f.GetAtlasGeneration());
+  ASSERT_EQ(first.GetVertexCount(), again.GetVertexCount());
+  for (size_t i = 0; i + 2 < again.GetVertexCount(); i += 4) {
+    ASSERT_LT(again[i].texcoords.x, again[i + 2].texcoords.x);
+    ASSERT_LT(again[i].texcoords.y, again[i + 2].texcoords.y);
+  }
+}
@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+
+#include <shader/FramebufferPool.hpp>
+
+#include <set>
+
+using ::monkeysworld::shader::FramebufferPool;
+using ::monkeysworld::shader::render_target;
+
+/**
+ *  Hands out fake descriptors, and keeps track of which ones are live.
+ */
+class FakeTargets {
+ public:
+  FramebufferPool::alloc_func Alloc() {
+    return [this](glm::ivec2 size) {
+      render_target res;
+      res.fb = ++next_;
+      res.color = res.depth_stencil = 0;
+      res.size = size;
+      live_.insert(res.fb);
+      return res;
+    };
+  }
+
+  FramebufferPool::free_func Free() {
+    return [this](const render_target& target) {
+      ASSERT_EQ(1, live_.erase(target.fb));
+    };
+  }
+
+  size_t GetLiveCount() {
+    return live_.size();
+  }
+
+ private:
+  GLuint next_ = 0;
+  std::set<GLuint> live_;
+};
+
+TEST(FramebufferPoolTests, BucketSizes) {
+  glm::ivec2 small = FramebufferPool::GetBucket(glm::ivec2(1, 33));
+  ASSERT_EQ(32, small.x);
+  ASSERT_EQ(64, small.y);
+
+  // buckets never shrink the target, and never waste much of it
+  for (int i = 1; i < 5000; i += 7) {
+    int bucket = FramebufferPool::GetBucket(glm::ivec2(i, i)).x;
+    ASSERT_GE(bucket, i);
+    ASSERT_LE(bucket, i + (i / 4) + 32);
+  }
+}
+
+TEST(FramebufferPoolTests, ReuseReleasedTargets) {
+  FakeTargets fake;
+  FramebufferPool pool(1 << 30, fake.Alloc(), fake.Free());
+  GLuint first;
+  {
+    auto target = pool.Acquire(glm::ivec2(300, 200));
+    first = target->fb;
+    ASSERT_GE(target->size.x, 300);
+    ASSERT_GE(target->size.y, 200);
+  }
+
+  // a little smaller, but same bucket
+  auto target = pool.Acquire(glm::ivec2(290, 195));
+  ASSERT_EQ(first, target->fb);
+
+  auto other = pool.Acquire(glm::ivec2(290, 195));
+  ASSERT_NE(first, other->fb);
+
+  auto stats = pool.GetStats();
+  ASSERT_EQ(2, stats.allocations);
+  ASSERT_EQ(1, stats.reuses);
+  ASSERT_EQ(0, stats.bytes_idle);
+  ASSERT_EQ(2 * FramebufferPool::GetTargetBytes(target->size), stats.bytes_in_use);
+}
+
+TEST(FramebufferPoolTests, EvictLeastRecentlyUsed) {
+  FakeTargets fake;
+  size_t bytes = FramebufferPool::GetTargetBytes(FramebufferPool::GetBucket(glm::ivec2(64, 64)));
+  FramebufferPool pool(bytes * 2, fake.Alloc(), fake.Free());
+  GLuint a_fb, b_fb;
+  {
+    auto a = pool.Acquire(glm::ivec2(64, 64));
+    auto b = pool.Acquire(glm::ivec2(64, 64));
+    a_fb = a->fb;
+    b_fb = b->fb;
+    // a is released last, so b is the older of the two
+    b.reset();
+  }
+
+  ASSERT_EQ(2, fake.GetLiveCount());
+
+  // a third target puts us over budget -- b should be the one to go
+  auto c = pool.Acquire(glm::ivec2(1, 1));
+  ASSERT_EQ(1, pool.GetStats().evictions);
+  auto a = pool.Acquire(glm::ivec2(64, 64));
+  ASSERT_EQ(a_fb, a->fb);
+  ASSERT_NE(b_fb, a->fb);
+}
+
+TEST(FramebufferPoolTests, BorrowedTargetsAreNeverEvicted) {
+  FakeTargets fake;
+  FramebufferPool pool(0, fake.Alloc(), fake.Free());
+  auto a = pool.Acquire(glm::ivec2(128, 128));
+  auto b = pool.Acquire(glm::ivec2(128, 128));
+  ASSERT_EQ(2, fake.GetLiveCount());
+  ASSERT_EQ(0, pool.GetStats().evictions);
+
+  // over budget as soon as they come back
+  a.reset();
+  b.reset();
+  ASSERT_EQ(0, fake.GetLiveCount());
+  ASSERT_EQ(2, pool.GetStats().evictions);
+}
+
+TEST(FramebufferPoolTests, OutliveThePool) {
+  FakeTargets fake;
+  std::shared_ptr<const render_target> target;
+  {
+    FramebufferPool pool(1 << 30, fake.Alloc(), fake.Free());
+    target = pool.Acquire(glm::ivec2(10, 10));
+    auto idle = pool.Acquire(glm::ivec2(10, 10));
+  }
+
+  // pool destroyed its idle target on the way out
+  ASSERT_EQ(1, fake.GetLiveCount());
+  target.reset();
+  ASSERT_EQ(0, fake.GetLiveCount());
+}
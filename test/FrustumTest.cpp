@@ -0,0 +1,36 @@
+#include <gtest/gtest.h>
+#include <utils/Frustum.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+using ::monkeysworld::utils::Frustum;
+
+static glm::mat4 GetTestMatrix() {
+  // camera at the origin, looking down -z
+  glm::mat4 persp = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 100.0f);
+  glm::mat4 view = glm::lookAt(glm::vec3(0, 0, 0), glm::vec3(0, 0, -1), glm::vec3(0, 1, 0));
+  return persp * view;
+}
+
+TEST(FrustumTests, SphereInside) {
+  Frustum f(GetTestMatrix());
+  ASSERT_TRUE(f.IntersectsSphere(glm::vec3(0, 0, -10), 1.0f));
+  ASSERT_TRUE(f.IntersectsSphere(glm::vec3(5, 5, -10), 1.0f));
+}
+
+TEST(FrustumTests, SphereOutside) {
+  Frustum f(GetTestMatrix());
+  // behind the camera
+  ASSERT_FALSE(f.IntersectsSphere(glm::vec3(0, 0, 10), 1.0f));
+  // off to the side
+  ASSERT_FALSE(f.IntersectsSphere(glm::vec3(30, 0, -10), 1.0f));
+  // past the far plane
+  ASSERT_FALSE(f.IntersectsSphere(glm::vec3(0, 0, -200), 1.0f));
+}
+
+TEST(FrustumTests, SphereStraddlesPlane) {
+  Frustum f(GetTestMatrix());
+  // center is outside, but the sphere pokes into the frustum
+  ASSERT_TRUE(f.IntersectsSphere(glm::vec3(11, 0, -10), 2.0f));
+  ASSERT_FALSE(f.IntersectsSphere(glm::vec3(11, 0, -10), 0.5f));
+}
@@ -0,0 +1,195 @@
+#include <gtest/gtest.h>
+
+#include <critter/ui/layout/LayoutGraph.hpp>
+
+#include <vector>
+
+using ::monkeysworld::critter::ui::layout::LayoutGraph;
+using ::monkeysworld::critter::ui::layout::UILayoutParams;
+using ::monkeysworld::critter::ui::layout::BoundingBox;
+using ::monkeysworld::critter::ui::layout::Face;
+using ::monkeysworld::critter::ui::layout::MarginType;
+
+static const uint64_t GROUP = 100;
+
+/**
+ *  Anchors a node's top to the bottom of `above`, and its left to the group's left.
+ */
+static UILayoutParams Below(uint64_t above, float dist) {
+  UILayoutParams res = UILayoutParams();
+  res.top.anchor_id = above;
+  res.top.anchor_face = (above == GROUP ? Face::TOP : Face::BOTTOM);
+  res.top.margin = dist;
+  res.left.anchor_id = GROUP;
+  res.left.anchor_face = Face::LEFT;
+  res.left.margin = dist;
+  return res;
+}
+
+/**
+ *  Stands in for a group -- feeds its nodes to the graph, and applies the results.
+ */
+struct TestGroup {
+  LayoutGraph graph;
+  std::vector<UILayoutParams> params;
+  std::vector<glm::vec2> pos;
+  std::vector<glm::vec2> dims;
+
+  TestGroup(size_t count, glm::vec2 group_dims) : params(count), pos(count, glm::vec2(0)), dims(count, glm::vec2(10)) {
+    std::vector<uint64_t> ids;
+    for (size_t i = 0; i < count; i++) {
+      ids.push_back(i + 1);
+    }
+
+    graph.SetNodes(GROUP, ids);
+    graph.SetGroupDimensions(group_dims);
+  }
+
+  int Layout() {
+    for (size_t i = 0; i < params.size(); i++) {
+      graph.SetNode(i, params[i], pos[i], dims[i]);
+    }
+
+    int res = graph.Solve();
+    for (size_t i : graph.GetChangedNodes()) {
+      const BoundingBox& b = graph.GetBoundingBox(i);
+      pos[i] = glm::vec2(b.left, b.top);
+      dims[i] = glm::vec2(b.right - b.left, b.bottom - b.top);
+    }
+
+    return res;
+  }
+};
+
+/**
+ *  Stacks `count` nodes, each 50x10, below one another.
+ */
+static TestGroup MakeColumn(size_t count) {
+  TestGroup g(count, glm::vec2(200, 1000));
+  for (size_t i = 0; i < count; i++) {
+    g.params[i] = Below(i == 0 ? GROUP : i, 5);
+    g.dims[i] = glm::vec2(50, 10);
+  }
+
+  return g;
+}
+
+TEST(LayoutGraphTests, SolveColumn) {
+  TestGroup g = MakeColumn(4);
+  ASSERT_EQ(4, g.Layout());
+  ASSERT_EQ(4, g.graph.GetChangedNodes().size());
+  for (size_t i = 0; i < 4; i++) {
+    const BoundingBox& b = g.graph.GetBoundingBox(i);
+    ASSERT_EQ(5, b.left);
+    ASSERT_EQ(55, b.right);
+    ASSERT_EQ(5 + 15 * i, b.top);
+    ASSERT_EQ(15 + 15 * i, b.bottom);
+  }
+}
+
+TEST(LayoutGraphTests, SolveOutOfOrder) {
+  // node 0 hangs off of node 1, which is declared after it
+  TestGroup g(2, glm::vec2(100, 100));
+  g.params[0] = Below(2, 0);
+  g.params[1] = Below(GROUP, 20);
+  ASSERT_EQ(2, g.Layout());
+  ASSERT_EQ(30, g.pos[0].y);
+  ASSERT_EQ(20, g.pos[1].y);
+}
+
+TEST(LayoutGraphTests, AutoMarginsCenter) {
+  TestGroup g(1, glm::vec2(100, 60));
+  UILayoutParams& p = g.params[0];
+  p.top.anchor_id = GROUP;
+  p.top.anchor_face = Face::TOP;
+  p.top.margin = MarginType::AUTO;
+  p.bottom.anchor_id = GROUP;
+  p.bottom.anchor_face = Face::BOTTOM;
+  p.bottom.margin = MarginType::AUTO;
+  g.dims[0] = glm::vec2(20, 20);
+  ASSERT_EQ(1, g.Layout());
+  ASSERT_EQ(20, g.pos[0].y);
+  ASSERT_EQ(20, g.dims[0].y);
+}
+
+TEST(LayoutGraphTests, FractionalInputsRoundOnce) {
+  // only the top is anchored -- left and width come straight from the node
+  TestGroup g(1, glm::vec2(100, 100));
+  g.params[0].top.anchor_id = GROUP;
+  g.params[0].top.anchor_face = Face::TOP;
+  g.params[0].top.margin = 5.4f;
+  g.pos[0] = glm::vec2(10.6f, 0);
+  g.dims[0] = glm::vec2(20.6f, 10.3f);
+  ASSERT_EQ(1, g.Layout());
+  const BoundingBox& b = g.graph.GetBoundingBox(0);
+  ASSERT_EQ(11, b.left);
+  ASSERT_EQ(31, b.right);
+  ASSERT_EQ(5, b.top);
+  ASSERT_EQ(16, b.bottom);
+  ASSERT_EQ(0, g.Layout());
+}
+
+TEST(LayoutGraphTests, NothingChanged) {
+  TestGroup g = MakeColumn(16);
+  ASSERT_EQ(16, g.Layout());
+  // applying the results shouldn't cause another solve
+  ASSERT_EQ(0, g.Layout());
+  ASSERT_EQ(0, g.graph.GetChangedNodes().size());
+  g.graph.SetGroupDimensions(glm::vec2(200, 1000));
+  ASSERT_EQ(0, g.Layout());
+}
+
+TEST(LayoutGraphTests, OnlyDownstreamResolved) {
+  TestGroup g = MakeColumn(16);
+  ASSERT_EQ(16, g.Layout());
+
+  // growing node 10 pushes down everything after it, and nothing before
+  g.dims[10].y = 20;
+  ASSERT_EQ(6, g.Layout());
+  // node 10 already has the size it asked for
+  ASSERT_EQ(5, g.graph.GetChangedNodes().size());
+  ASSERT_EQ(155, g.pos[10].y);
+  ASSERT_EQ(20, g.dims[10].y);
+  ASSERT_EQ(180, g.pos[11].y);
+  ASSERT_EQ(140, g.pos[9].y);
+}
+
+TEST(LayoutGraphTests, UnchangedBoxStopsPropagation) {
+  TestGroup g = MakeColumn(16);
+  ASSERT_EQ(16, g.Layout());
+
+  // width doesn't affect anyone below
+  g.dims[3].x = 80;
+  ASSERT_EQ(2, g.Layout());
+  ASSERT_EQ(0, g.graph.GetChangedNodes().size());
+  ASSERT_EQ(80, g.graph.GetBoundingBox(3).right - g.graph.GetBoundingBox(3).left);
+}
+
+TEST(LayoutGraphTests, GroupResizeSolvesDependents) {
+  TestGroup g(2, glm::vec2(100, 100));
+  g.params[0].bottom.anchor_id = GROUP;
+  g.params[0].bottom.anchor_face = Face::BOTTOM;
+  ASSERT_EQ(2, g.Layout());
+  ASSERT_EQ(90, g.pos[0].y);
+
+  g.graph.SetGroupDimensions(glm::vec2(100, 200));
+  ASSERT_EQ(1, g.Layout());
+  ASSERT_EQ(190, g.pos[0].y);
+}
+
+TEST(LayoutGraphTests, CycleIsInvalid) {
+  TestGroup g(2, glm::vec2(100, 100));
+  g.params[0] = Below(2, 0);
+  g.params[1] = Below(1, 0);
+  ASSERT_EQ(-1, g.Layout());
+
+  // breaking the cycle fixes it
+  g.params[1] = Below(GROUP, 0);
+  ASSERT_EQ(2, g.Layout());
+}
+
+TEST(LayoutGraphTests, MissingAnchorIsInvalid) {
+  TestGroup g(1, glm::vec2(100, 100));
+  g.params[0] = Below(7, 0);
+  ASSERT_EQ(-1, g.Layout());
+}
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include <shader/light/LightClusters.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+using ::monkeysworld::critter::camera_info;
+using ::monkeysworld::shader::light::LightClusters;
+using ::monkeysworld::shader::light::spotlight_info;
+
+static camera_info GetTestCamera() {
+  // camera at the origin, looking down -z
+  camera_info res;
+  res.position = glm::vec3(0);
+  res.view_matrix = glm::lookAt(glm::vec3(0, 0, 0), glm::vec3(0, 0, -1), glm::vec3(0, 1, 0));
+  res.persp_matrix = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 100.0f);
+  res.vp_matrix = res.persp_matrix * res.view_matrix;
+  return res;
+}
+
+static spotlight_info GetTestLight(glm::vec3 position, glm::vec3 direction) {
+  spotlight_info res = {};
+  res.position = position;
+  res.direction = direction;
+  res.angle = 30.0f;
+  res.color = glm::vec3(1);
+  res.intensity_diff = 1.0f;
+  res.intensity_spec = 1.0f;
+  // reaches about 4 units
+  res.atten_quad = 16.0f;
+  return res;
+}
+
+TEST(LightClustersTests, NoLights) {
+  LightClusters clusters;
+  clusters.Assign(GetTestCamera(), std::vector<spotlight_info>());
+  ASSERT_EQ(0, clusters.GetIndexCount());
+}
+
+TEST(LightClustersTests, LightRange) {
+  spotlight_info light = GetTestLight(glm::vec3(0), glm::vec3(0, 0, -1));
+  // 1 / (16 * d^2) = 1 / 256
+  ASSERT_NEAR(4.0f, LightClusters::GetLightRange(light), 0.001f);
+
+  light.atten_quad = 0.0f;
+  ASSERT_NEAR(LightClusters::MAX_LIGHT_RANGE, LightClusters::GetLightRange(light), 0.001f);
+}
+
+TEST(LightClustersTests, LightInFrontOfCamera) {
+  LightClusters clusters;
+  std::vector<spotlight_info> lights;
+  lights.push_back(GetTestLight(glm::vec3(0, 0, -10), glm::vec3(0, 0, -1)));
+  clusters.Assign(GetTestCamera(), lights);
+
+  ASSERT_LT(0, clusters.GetIndexCount());
+
+  // something in the center of the screen, a bit past the light, should be lit
+  bool found = false;
+  for (int z = 0; z < LightClusters::GRID_Z; z++) {
+    int x = LightClusters::GRID_X / 2;
+    int y = LightClusters::GRID_Y / 2;
+    if (clusters.GetLightCount(x, y, z) > 0) {
+      ASSERT_EQ(0, clusters.GetLight(x, y, z, 0));
+      found = true;
+    }
+  }
+
+  ASSERT_TRUE(found);
+
+  // nearest slice + screen corners are nowhere near the light
+  ASSERT_EQ(0, clusters.GetLightCount(LightClusters::GRID_X / 2, LightClusters::GRID_Y / 2, 0));
+  ASSERT_EQ(0, clusters.GetLightCount(0, 0, LightClusters::GRID_Z - 1));
+}
+
+TEST(LightClustersTests, LightBehindCamera) {
+  LightClusters clusters;
+  std::vector<spotlight_info> lights;
+  lights.push_back(GetTestLight(glm::vec3(0, 0, 10), glm::vec3(0, 0, 1)));
+  clusters.Assign(GetTestCamera(), lights);
+
+  ASSERT_EQ(0, clusters.GetIndexCount());
+}
+
+TEST(LightClustersTests, ManyLights) {
+  LightClusters clusters;
+  std::vector<spotlight_info> lights;
+  for (int i = 0; i < 64; i++) {
+    lights.push_back(GetTestLight(glm::vec3(0, 0, -5.0f - i), glm::vec3(0, 0, -1)));
+  }
+
+  clusters.Assign(GetTestCamera(), lights);
+
+  // lights within a cluster are in ascending order
+  for (int z = 0; z < LightClusters::GRID_Z; z++) {
+    uint32_t count = clusters.GetLightCount(LightClusters::GRID_X / 2, LightClusters::GRID_Y / 2, z);
+    for (uint32_t i = 1; i < count; i++) {
+      ASSERT_LT(clusters.GetLight(LightClusters::GRID_X / 2, LightClusters::GRID_Y / 2, z, i - 1),
+                clusters.GetLight(LightClusters::GRID_X / 2, LightClusters::GRID_Y / 2, z, i));
+    }
+  }
+}
@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+#include <engine/Context.hpp>
+#include <engine/EngineExecutor.hpp>
+#include <shader/materials/MatteMaterial.hpp>
+#include <shader/materials/ShadowMapMaterial.hpp>
+
+#include <memory>
+#include <thread>
+
+using ::monkeysworld::audio::AudioManager;
+using ::monkeysworld::engine::Context;
+using ::monkeysworld::engine::EngineExecutor;
+using ::monkeysworld::engine::Executor;
+using ::monkeysworld::engine::Scene;
+using ::monkeysworld::engine::SceneSwap;
+using ::monkeysworld::file::CachedFileLoader;
+using ::monkeysworld::input::EventManager;
+using ::monkeysworld::shader::Framebuffer;
+using ::monkeysworld::shader::UniformRing;
+using ::monkeysworld::shader::materials::MatteMaterial;
+using ::monkeysworld::shader::materials::ShadowMapMaterial;
+
+// the executor is never run, so programs never start compiling, and no GL calls are made
+class UnreadyContext : public Context {
+ public:
+  UnreadyContext() {
+    // the executor runs tasks inline on the thread which created it -- so create it somewhere else
+    std::thread([this] { executor_ = std::make_shared<EngineExecutor>(); }).join();
+  }
+
+  std::shared_ptr<CachedFileLoader> GetCachedFileLoader() override { return nullptr; }
+  std::shared_ptr<EventManager> GetEventManager() override { return nullptr; }
+  std::shared_ptr<AudioManager> GetAudioManager() override { return nullptr; }
+  std::shared_ptr<Executor<EngineExecutor>> GetExecutor() override { return executor_; }
+  std::shared_ptr<UniformRing> GetUniformRing() override { return nullptr; }
+  std::shared_ptr<Framebuffer> GetLastFrame() override { return nullptr; }
+  void GetFramebufferSize(int* width, int* height) override { *width = *height = 0; }
+  glm::ivec2 GetFramebufferSize() override { return glm::ivec2(0); }
+  std::shared_ptr<SceneSwap> SwapScene(Scene* scene) override { return nullptr; }
+  Scene* GetScene() override { return nullptr; }
+  double GetDeltaTime() override { return 0.0; }
+
+ private:
+  std::shared_ptr<EngineExecutor> executor_;
+};
+
+TEST(MaterialTests, MatteNotReadyWhileCompiling) {
+  UnreadyContext ctx;
+  MatteMaterial mat(&ctx);
+  ASSERT_FALSE(mat.IsReady());
+  // nothing bound -- callers have to skip their draw
+  ASSERT_FALSE(mat.UseMaterial());
+  ASSERT_FALSE(mat.UseMaterial());
+}
+
+TEST(MaterialTests, ShadowMapNotReadyWhileCompiling) {
+  UnreadyContext ctx;
+  ShadowMapMaterial mat(&ctx);
+  ASSERT_FALSE(mat.IsReady());
+  ASSERT_FALSE(mat.UseMaterial());
+}
@@ -0,0 +1,42 @@
+#ifndef MESH_FIXTURES_H_
+#define MESH_FIXTURES_H_
+
+#include <model/Mesh.hpp>
+#include <storage/VertexPacketTypes.hpp>
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <memory>
+
+/**
+ *  Creates a wavy grid with `res` x `res` quads.
+ *  @param res - number of quads along each side.
+ *  @param ripple - how many waves run along u and v -- higher makes the grid harder to simplify.
+ */
+inline std::shared_ptr<::monkeysworld::model::Mesh<>> CreateGrid(int res, glm::vec2 ripple = glm::vec2(6.0f)) {
+  auto mesh = std::make_shared<::monkeysworld::model::Mesh<>>();
+  ::monkeysworld::storage::VertexPacket3D temp;
+  for (int y = 0; y <= res; y++) {
+    for (int x = 0; x <= res; x++) {
+      float u = static_cast<float>(x) / res;
+      float v = static_cast<float>(y) / res;
+      temp.position = glm::vec3(u, 0.05f * std::sin(u * ripple.x) * std::cos(v * ripple.y), v);
+      temp.coords = glm::vec2(u, v);
+      temp.normals = glm::vec3(0, 1, 0);
+      mesh->AddVertex(temp);
+    }
+  }
+
+  for (int y = 0; y < res; y++) {
+    for (int x = 0; x < res; x++) {
+      unsigned int i = y * (res + 1) + x;
+      mesh->AddPolygon(i, i + res + 1, i + 1);
+      mesh->AddPolygon(i + 1, i + res + 1, i + res + 2);
+    }
+  }
+
+  return mesh;
+}
+
+#endif  // MESH_FIXTURES_H_
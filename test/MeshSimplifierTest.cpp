@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include "MeshFixtures.hpp"
+
+#include <model/Mesh.hpp>
+#include <model/MeshSimplifier.hpp>
+#include <storage/VertexPacketTypes.hpp>
+
+#include <glm/glm.hpp>
+
+#include <memory>
+
+using ::monkeysworld::model::Mesh;
+using ::monkeysworld::model::MeshSimplifier;
+using ::monkeysworld::storage::VertexPacket3D;
+
+TEST(MeshSimplifierTests, ReachesTarget) {
+  auto grid = CreateGrid(32);
+  ASSERT_EQ(32 * 32 * 2 * 3, grid->GetIndexCount());
+  auto res = MeshSimplifier::Simplify(*grid, 0.25f);
+  ASSERT_LE(res->GetIndexCount() / 3, 32 * 32 * 2 / 4);
+  ASSERT_GT(res->GetIndexCount(), 0);
+  ASSERT_LT(res->GetVertexCount(), grid->GetVertexCount());
+}
+
+TEST(MeshSimplifierTests, IndicesInBounds) {
+  auto grid = CreateGrid(16);
+  auto res = MeshSimplifier::Simplify(*grid, 0.1f);
+  const unsigned int* inds = res->GetIndexData();
+  for (size_t i = 0; i < res->GetIndexCount(); i++) {
+    ASSERT_LT(inds[i], res->GetVertexCount());
+  }
+
+  // no degenerate triangles
+  for (size_t i = 0; i < res->GetIndexCount(); i += 3) {
+    ASSERT_NE(inds[i], inds[i + 1]);
+    ASSERT_NE(inds[i + 1], inds[i + 2]);
+    ASSERT_NE(inds[i], inds[i + 2]);
+  }
+}
+
+TEST(MeshSimplifierTests, BorderIsPreserved) {
+  auto grid = CreateGrid(16);
+  auto res = MeshSimplifier::Simplify(*grid, 0.1f);
+  // every border vertex is locked, so all of them should survive
+  int border_verts = 0;
+  const VertexPacket3D* verts = res->GetVertexData();
+  for (size_t i = 0; i < res->GetVertexCount(); i++) {
+    glm::vec3 p = verts[i].position;
+    if (p.x <= 0.0f || p.x >= 1.0f || p.z <= 0.0f || p.z >= 1.0f) {
+      border_verts++;
+    }
+  }
+
+  ASSERT_EQ(16 * 4, border_verts);
+}
+
+TEST(MeshSimplifierTests, BuildChain) {
+  auto grid = CreateGrid(32);
+  auto chain = MeshSimplifier::BuildLODChain(*grid, 3);
+  ASSERT_EQ(3, chain.size());
+  size_t last = grid->GetIndexCount();
+  for (auto& lod : chain) {
+    ASSERT_LT(lod->GetIndexCount(), last);
+    last = lod->GetIndexCount();
+  }
+}
+
+TEST(MeshSimplifierTests, TinyMeshesArentSimplified) {
+  auto grid = CreateGrid(2);
+  auto chain = MeshSimplifier::BuildLODChain(*grid, 3);
+  ASSERT_EQ(0, chain.size());
+}
@@ -1,9 +1,31 @@
 #include <file/ModelLoader.hpp>
 #include <gtest/gtest.h>
 
+#include <cstdio>
+#include <fstream>
+
 using ::monkeysworld::file::ModelLoader;
 using ::monkeysworld::file::LoaderThreadPool;
 
+/**
+ *  Writes a flat `res` x `res` grid of quads to an OBJ file.
+ */
+static void WriteGridObj(const std::string& path, int res) {
+  std::ofstream file(path, std::ios_base::out | std::ios_base::trunc);
+  for (int z = 0; z <= res; z++) {
+    for (int x = 0; x <= res; x++) {
+      file << "v " << x << " 0 " << z << "\n";
+    }
+  }
+
+  for (int z = 0; z < res; z++) {
+    for (int x = 0; x < res; x++) {
+      int i = z * (res + 1) + x + 1;
+      file << "f " << i << "// " << (i + res + 1) << "// " << (i + res + 2) << "// " << (i + 1) << "//\n";
+    }
+  }
+}
+
 TEST(ModelLoaderTests, CreateModelLoader) {
   auto threadpool = std::make_shared<LoaderThreadPool>(4);
   ModelLoader m(threadpool, std::vector<::monkeysworld::file::cache_record>());
@@ -22,4 +44,41 @@ TEST(ModelLoaderTests, TestAsync) {
   auto res = future.get();
   ASSERT_NE(nullptr, res.get());
   ASSERT_EQ(47194, res->GetVertexCount());
-}
\ No newline at end of file
+}
+
+TEST(ModelLoaderTests, ReloadReplacesLODChain) {
+  WriteGridObj("reload_grid.obj", 32);
+  auto threadpool = std::make_shared<LoaderThreadPool>(2);
+  ModelLoader m(threadpool, std::vector<::monkeysworld::file::cache_record>());
+  ASSERT_FALSE(m.ReloadFile("not_cached.obj"));
+
+  auto lods = m.LoadLODs("reload_grid.obj");
+  ASSERT_GT(lods.size(), 1);
+  auto base = lods[0];
+
+  // too small to simplify -- the new chain is just the base mesh
+  WriteGridObj("reload_grid.obj", 1);
+  uint64_t reloads = ModelLoader::GetReloadCount();
+  ASSERT_TRUE(m.ReloadFile("reload_grid.obj"));
+  // nothing changes until the reload is swapped in
+  ASSERT_EQ(lods.size(), m.LoadLODs("reload_grid.obj").size());
+
+  size_t swapped = 0;
+  for (int i = 0; i < 500 && swapped == 0; i++) {
+    swapped = m.FinishReloads();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  ASSERT_EQ(1, swapped);
+  ASSERT_EQ(reloads + 1, ModelLoader::GetReloadCount());
+
+  // the base mesh is updated in place, and the old LODs are gone
+  auto reloaded = m.LoadLODs("reload_grid.obj");
+  ASSERT_EQ(1, reloaded.size());
+  ASSERT_EQ(base, reloaded[0]);
+  ASSERT_EQ(4, base->GetVertexCount());
+  ASSERT_EQ(reloaded, m.FindLODs(base.get()));
+  ASSERT_TRUE(m.FindLODs(lods[1].get()).empty());
+
+  std::remove("reload_grid.obj");
+}
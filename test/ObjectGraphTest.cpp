@@ -55,3 +55,43 @@ TEST(ObjectGraphTests, TopoSort2) {
   ASSERT_EQ(4, res[3]);
   ASSERT_EQ(5, res[4]);
 }
+
+TEST(ObjectGraphTests, DuplicateEdges) {
+  ObjectGraph o;
+  o.AddEdge(1, 2);
+  o.AddEdge(1, 2);
+  ASSERT_EQ(1, o.GetEdgeCount());
+  o.AddEdge(2, 3);
+  o.AddEdge(1, 2);
+  ASSERT_EQ(2, o.GetEdgeCount());
+  ASSERT_EQ(3, o.TopoSort().size());
+}
+
+TEST(ObjectGraphTests, TopoSortCycle) {
+  ObjectGraph o;
+  o.AddEdge(1, 2);
+  o.AddEdge(2, 3);
+  o.AddEdge(3, 1);
+  o.AddEdge(4, 1);
+  ASSERT_EQ(0, o.TopoSort().size());
+
+  std::vector<uint64_t> res(4, 0);
+  ASSERT_FALSE(o.TopoSort(res));
+  ASSERT_EQ(0, res.size());
+}
+
+TEST(ObjectGraphTests, TopoSortReuse) {
+  ObjectGraph o;
+  o.AddEdge(1, 2);
+  std::vector<uint64_t> res;
+  ASSERT_TRUE(o.TopoSort(res));
+  ASSERT_EQ(2, res.size());
+
+  // sorting again after the graph grows picks up the new edge
+  o.AddEdge(0, 1);
+  ASSERT_TRUE(o.TopoSort(res));
+  ASSERT_EQ(3, res.size());
+  ASSERT_EQ(0, res[0]);
+  ASSERT_EQ(1, res[1]);
+  ASSERT_EQ(2, res[2]);
+}
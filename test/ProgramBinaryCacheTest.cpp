@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include <shader/ProgramBinaryCache.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+using ::monkeysworld::shader::ProgramBinaryCache;
+
+typedef std::vector<std::pair<GLenum, std::string>> source_list;
+
+static source_list GetTestSources() {
+  source_list res;
+  res.push_back(std::make_pair(GL_VERTEX_SHADER, std::string("void main() {}")));
+  res.push_back(std::make_pair(GL_FRAGMENT_SHADER, std::string("void main() { discard; }")));
+  return res;
+}
+
+TEST(ProgramBinaryCacheTests, KeyIsStable) {
+  auto sources = GetTestSources();
+  ASSERT_EQ(ProgramBinaryCache::GetProgramKey("driver", sources),
+            ProgramBinaryCache::GetProgramKey("driver", sources));
+}
+
+TEST(ProgramBinaryCacheTests, KeyChangesWithInputs) {
+  auto sources = GetTestSources();
+  uint64_t key = ProgramBinaryCache::GetProgramKey("driver", sources);
+
+  // new driver
+  ASSERT_NE(key, ProgramBinaryCache::GetProgramKey("driver 2", sources));
+
+  // new source
+  auto modified = sources;
+  modified[1].second += " ";
+  ASSERT_NE(key, ProgramBinaryCache::GetProgramKey("driver", modified));
+
+  // same source, different stage
+  modified = sources;
+  modified[0].first = GL_GEOMETRY_SHADER;
+  ASSERT_NE(key, ProgramBinaryCache::GetProgramKey("driver", modified));
+}
+
+TEST(ProgramBinaryCacheTests, ReadWriteBinary) {
+  ProgramBinaryCache cache("");
+  std::vector<char> data = { 'm', 'o', 'n', 'k', 'e', 'y', 0, 1, 2, 3 };
+  ASSERT_TRUE(cache.WriteBinary(0x1234, 0x5678, data));
+
+  GLenum format;
+  std::vector<char> res;
+  ASSERT_TRUE(cache.ReadBinary(0x1234, &format, &res));
+  ASSERT_EQ(0x5678, format);
+  ASSERT_EQ(data, res);
+
+  std::remove("0000000000001234.progbin");
+}
+
+TEST(ProgramBinaryCacheTests, MissingBinary) {
+  ProgramBinaryCache cache("");
+  GLenum format;
+  std::vector<char> res;
+  ASSERT_FALSE(cache.ReadBinary(0xdeadbeef, &format, &res));
+}
+
+TEST(ProgramBinaryCacheTests, TruncatedBinary) {
+  ProgramBinaryCache cache("");
+  std::vector<char> data(64, 'a');
+  ASSERT_TRUE(cache.WriteBinary(0x4321, 0, data));
+
+  // chop off the end of the file
+  {
+    std::ifstream input("0000000000004321.progbin", std::ios_base::binary);
+    std::vector<char> contents((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    contents.resize(contents.size() - 16);
+    input.close();
+    std::ofstream output("0000000000004321.progbin", std::ios_base::trunc | std::ios_base::binary);
+    output.write(contents.data(), contents.size());
+  }
+
+  GLenum format;
+  std::vector<char> res;
+  ASSERT_FALSE(cache.ReadBinary(0x4321, &format, &res));
+
+  std::remove("0000000000004321.progbin");
+}
+
+TEST(ProgramBinaryCacheTests, OversizedBinary) {
+  ProgramBinaryCache cache("");
+  std::vector<char> data(16, 'a');
+  ASSERT_TRUE(cache.WriteBinary(0x5432, 0, data));
+
+  // claim the binary is nearly 4gb -- should be caught before anything's allocated
+  {
+    std::fstream file("0000000000005432.progbin", std::ios_base::in | std::ios_base::out | std::ios_base::binary);
+    file.seekp(sizeof(uint32_t) + sizeof(uint64_t) + sizeof(uint32_t));
+    uint32_t len = 0xFFFFFFF0;
+    file.write(reinterpret_cast<const char*>(&len), sizeof(uint32_t));
+  }
+
+  GLenum format;
+  std::vector<char> res;
+  ASSERT_FALSE(cache.ReadBinary(0x5432, &format, &res));
+  ASSERT_EQ(0, res.capacity());
+
+  std::remove("0000000000005432.progbin");
+}
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include <shader/ProgramRegistry.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using ::monkeysworld::shader::ProgramRegistry;
+using ::monkeysworld::shader::ShaderProgram;
+using ::monkeysworld::shader::program_info;
+
+// programs are never given a descriptor, so no GL calls are made
+
+TEST(ProgramRegistryTests, KeyIncludesDefines) {
+  program_info info;
+  info.vertex_path = "a.vert";
+  info.fragment_path = "a.frag";
+  std::string key = ProgramRegistry::GetKey(info);
+
+  program_info swapped;
+  swapped.vertex_path = "a.frag";
+  swapped.fragment_path = "a.vert";
+  ASSERT_NE(key, ProgramRegistry::GetKey(swapped));
+
+  info.defines["SHADOWS"] = "1";
+  ASSERT_NE(key, ProgramRegistry::GetKey(info));
+
+  program_info same = info;
+  ASSERT_EQ(ProgramRegistry::GetKey(info), ProgramRegistry::GetKey(same));
+}
+
+TEST(ProgramRegistryTests, SharesLivePrograms) {
+  auto& registry = ProgramRegistry::GetInstance();
+  int builds = 0;
+  auto build = [&] {
+    builds++;
+    return std::make_shared<ShaderProgram>();
+  };
+
+  auto first = registry.GetOrBuild("share", build);
+  auto second = registry.GetOrBuild("share", build);
+  ASSERT_EQ(first, second);
+  ASSERT_EQ(1, builds);
+
+  // rebuilt once every handle is gone
+  first.reset();
+  second.reset();
+  auto third = registry.GetOrBuild("share", build);
+  ASSERT_EQ(2, builds);
+}
+
+TEST(ProgramRegistryTests, DeduplicatesConcurrentBuilds) {
+  auto& registry = ProgramRegistry::GetInstance();
+  std::atomic<int> builds(0);
+  auto build = [&] {
+    builds++;
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    return std::make_shared<ShaderProgram>();
+  };
+
+  const int THREADS = 8;
+  std::vector<std::shared_ptr<ShaderProgram>> results(THREADS);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < THREADS; i++) {
+    threads.push_back(std::thread([&, i] {
+      results[i] = registry.GetOrBuild("concurrent", build);
+    }));
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  ASSERT_EQ(1, builds.load());
+  for (int i = 1; i < THREADS; i++) {
+    ASSERT_EQ(results[0], results[i]);
+  }
+}
+
+TEST(ProgramRegistryTests, FailedBuildsAreRetried) {
+  auto& registry = ProgramRegistry::GetInstance();
+  auto fail = []() -> std::shared_ptr<ShaderProgram> {
+    throw std::runtime_error("no good");
+  };
+
+  ASSERT_THROW(registry.GetOrBuild("retry", fail), std::runtime_error);
+
+  auto prog = registry.GetOrBuild("retry", [] { return std::make_shared<ShaderProgram>(); });
+  ASSERT_NE(nullptr, prog);
+}
+
+TEST(ProgramRegistryTests, CountsLivePrograms) {
+  auto& registry = ProgramRegistry::GetInstance();
+  size_t base = registry.GetProgramCount();
+  auto a = registry.GetOrBuild("count-a", [] { return std::make_shared<ShaderProgram>(); });
+  auto b = registry.GetOrBuild("count-b", [] { return std::make_shared<ShaderProgram>(); });
+  ASSERT_EQ(base + 2, registry.GetProgramCount());
+
+  a.reset();
+  ASSERT_EQ(base + 1, registry.GetProgramCount());
+}
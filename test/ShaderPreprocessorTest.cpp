@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include <shader/ShaderPreprocessor.hpp>
+#include <shader/exception/InvalidShaderException.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+using ::monkeysworld::shader::ShaderPreprocessor;
+using ::monkeysworld::shader::exception::InvalidShaderException;
+
+static void WriteFile(const std::string& path, const std::string& contents) {
+  std::ofstream file(path, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+  file << contents;
+}
+
+TEST(ShaderPreprocessorTests, NormalizesPaths) {
+  ASSERT_EQ("resources/glsl/common/a.glsl", ShaderPreprocessor::NormalizePath("resources/glsl/matte/../common/./a.glsl"));
+  ASSERT_EQ("a/b", ShaderPreprocessor::NormalizePath("a//b"));
+  ASSERT_EQ("../a", ShaderPreprocessor::NormalizePath("../a"));
+  ASSERT_EQ("/a", ShaderPreprocessor::NormalizePath("/b/../a"));
+}
+
+TEST(ShaderPreprocessorTests, TokenizesIncludes) {
+  auto file = ShaderPreprocessor::Tokenize("#version 430\n  #include \"../common/a.glsl\" // comment\nvoid main() {}\n", "glsl/matte/");
+  ASSERT_EQ(1, file.includes.size());
+  ASSERT_EQ(2, file.text.size());
+  ASSERT_EQ("glsl/common/a.glsl", file.includes[0]);
+  ASSERT_EQ("#version 430\n", file.text[0]);
+  ASSERT_EQ("void main() {}\n", file.text[1]);
+
+  // not a directive
+  auto no_include = ShaderPreprocessor::Tokenize("// #include \"a.glsl\"\n#include <a.glsl>\n", "");
+  ASSERT_EQ(0, no_include.includes.size());
+}
+
+TEST(ShaderPreprocessorTests, ExpandsAndMemoizes) {
+  WriteFile("pp_common.glsl", "float Common() { return 1.0; }\n");
+  WriteFile("pp_main.frag", "#version 430\n#include \"pp_common.glsl\"\nvoid main() {}\n");
+
+  ShaderPreprocessor pp;
+  std::string src = pp.GetSource("pp_main.frag", "", nullptr);
+  ASSERT_EQ("#version 430\nfloat Common() { return 1.0; }\nvoid main() {}\n", src);
+
+  std::string defined = pp.GetSource("pp_main.frag", "#define SHADOWS 1\n", nullptr);
+  ASSERT_EQ("#version 430\n#define SHADOWS 1\nfloat Common() { return 1.0; }\nvoid main() {}\n", defined);
+
+  // cached -- changes on disk aren't seen until invalidated
+  WriteFile("pp_common.glsl", "float Common() { return 2.0; }\n");
+  ASSERT_EQ(src, pp.GetSource("pp_main.frag", "", nullptr));
+
+  pp.Invalidate("pp_common.glsl");
+  ASSERT_EQ("#version 430\nfloat Common() { return 2.0; }\nvoid main() {}\n", pp.GetSource("pp_main.frag", "", nullptr));
+
+  std::remove("pp_common.glsl");
+  std::remove("pp_main.frag");
+}
+
+TEST(ShaderPreprocessorTests, TracksDependencies) {
+  WriteFile("pp_leaf.glsl", "\n");
+  WriteFile("pp_mid.glsl", "#include \"pp_leaf.glsl\"\n");
+  WriteFile("pp_top.vert", "#include \"pp_mid.glsl\"\n");
+
+  ShaderPreprocessor pp;
+  pp.GetSource("pp_top.vert", "", nullptr);
+
+  auto deps = pp.GetDependencies("pp_top.vert");
+  ASSERT_EQ(2, deps.size());
+  ASSERT_EQ(1, deps.count("pp_leaf.glsl"));
+  ASSERT_EQ(1, deps.count("pp_mid.glsl"));
+
+  auto dependents = pp.GetDependents("pp_leaf.glsl");
+  ASSERT_EQ(2, dependents.size());
+  ASSERT_EQ(1, dependents.count("pp_top.vert"));
+
+  std::remove("pp_leaf.glsl");
+  std::remove("pp_mid.glsl");
+  std::remove("pp_top.vert");
+}
+
+TEST(ShaderPreprocessorTests, DetectsCycles) {
+  WriteFile("pp_cycle_a.glsl", "#include \"pp_cycle_b.glsl\"\n");
+  WriteFile("pp_cycle_b.glsl", "#include \"pp_cycle_a.glsl\"\n");
+
+  ShaderPreprocessor pp;
+  ASSERT_THROW(pp.GetSource("pp_cycle_a.glsl", "", nullptr), InvalidShaderException);
+
+  std::remove("pp_cycle_a.glsl");
+  std::remove("pp_cycle_b.glsl");
+}
+
+TEST(ShaderPreprocessorTests, ConcurrentExpansionsAgree) {
+  WriteFile("pp_shared.glsl", "float Shared() { return 1.0; }\n");
+  WriteFile("pp_concurrent.frag", "#version 430\n#include \"pp_shared.glsl\"\nvoid main() {}\n");
+
+  // files are read outside the lock, so several threads can race to cache the same one
+  ShaderPreprocessor pp;
+  std::vector<std::string> results(8);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < results.size(); i++) {
+    threads.emplace_back([&pp, &results, i] {
+      std::string defines = (i % 2 == 0 ? "" : "#define SHADOWS 1\n");
+      results[i] = pp.GetSource("pp_concurrent.frag", defines, nullptr);
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (size_t i = 0; i < results.size(); i++) {
+    std::string defines = (i % 2 == 0 ? "" : "#define SHADOWS 1\n");
+    ASSERT_EQ("#version 430\n" + defines + "float Shared() { return 1.0; }\nvoid main() {}\n", results[i]);
+  }
+
+  auto deps = pp.GetDependencies("pp_concurrent.frag");
+  ASSERT_EQ(1, deps.size());
+  ASSERT_EQ(1, pp.GetDependents("pp_shared.glsl").size());
+
+  std::remove("pp_shared.glsl");
+  std::remove("pp_concurrent.frag");
+}
@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+
+#include <utils/ShelfPacker.hpp>
+
+#include <vector>
+
+using ::monkeysworld::utils::ShelfPacker;
+
+static bool Overlaps(glm::ivec2 a_pos, glm::ivec2 a_size, glm::ivec2 b_pos, glm::ivec2 b_size) {
+  return (a_pos.x < b_pos.x + b_size.x && b_pos.x < a_pos.x + a_size.x
+       && a_pos.y < b_pos.y + b_size.y && b_pos.y < a_pos.y + a_size.y);
+}
+
+TEST(ShelfPackerTests, PackWithoutOverlap) {
+  ShelfPacker p(glm::ivec2(256, 256));
+  std::vector<glm::ivec2> positions;
+  std::vector<glm::ivec2> sizes;
+  for (int i = 0; i < 40; i++) {
+    glm::ivec2 size(10 + (i * 7) % 30, 8 + (i * 13) % 24);
+    glm::ivec2 pos;
+    ASSERT_TRUE(p.Pack(size, &pos));
+    ASSERT_GE(pos.x, 0);
+    ASSERT_GE(pos.y, 0);
+    ASSERT_LE(pos.x + size.x, 256);
+    ASSERT_LE(pos.y + size.y, 256);
+    for (size_t j = 0; j < positions.size(); j++) {
+      ASSERT_FALSE(Overlaps(pos, size, positions[j], sizes[j]));
+    }
+
+    positions.push_back(pos);
+    sizes.push_back(size);
+  }
+}
+
+TEST(ShelfPackerTests, RejectWhenFull) {
+  ShelfPacker p(glm::ivec2(64, 64), 0);
+  glm::ivec2 pos;
+  ASSERT_FALSE(p.Pack(glm::ivec2(65, 1), &pos));
+  for (int i = 0; i < 4; i++) {
+    ASSERT_TRUE(p.Pack(glm::ivec2(32, 32), &pos));
+  }
+
+  ASSERT_FALSE(p.Pack(glm::ivec2(1, 1), &pos));
+
+  p.Clear();
+  ASSERT_TRUE(p.Pack(glm::ivec2(64, 64), &pos));
+  ASSERT_EQ(glm::ivec2(0, 0), pos);
+}
+
+TEST(ShelfPackerTests, ReuseShelves) {
+  ShelfPacker p(glm::ivec2(128, 128), 0);
+  glm::ivec2 tall, short_a, short_b;
+  ASSERT_TRUE(p.Pack(glm::ivec2(16, 32), &tall));
+  ASSERT_TRUE(p.Pack(glm::ivec2(16, 8), &short_a));
+  ASSERT_TRUE(p.Pack(glm::ivec2(16, 8), &short_b));
+  // short rects should share the first shelf instead of opening new ones
+  ASSERT_EQ(tall.y, short_a.y);
+  ASSERT_EQ(tall.y, short_b.y);
+  ASSERT_EQ(32, p.GetUsedHeight());
+}
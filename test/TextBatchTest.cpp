@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+#include <font/TextBatch.hpp>
+
+#include <cstring>
+#include <vector>
+
+using ::monkeysworld::font::TextBatch;
+using ::monkeysworld::model::Mesh;
+using ::monkeysworld::storage::VertexPacket2D;
+
+static std::vector<uint8_t> ColorBytes(uint32_t color) {
+  std::vector<uint8_t> res(4);
+  std::memcpy(res.data(), &color, sizeof(color));
+  return res;
+}
+
+TEST(TextBatchTests, PackColorIsRGBAInMemoryOrder) {
+  auto bytes = ColorBytes(TextBatch::PackColor(glm::vec4(1.0f, 0.0f, 0.5f, 0.2f)));
+  ASSERT_EQ(255, bytes[0]);
+  ASSERT_EQ(0, bytes[1]);
+  ASSERT_EQ(128, bytes[2]);
+  ASSERT_EQ(51, bytes[3]);
+}
+
+TEST(TextBatchTests, PackColorClamps) {
+  auto bytes = ColorBytes(TextBatch::PackColor(glm::vec4(-1.0f, 2.0f, 0.0f, 1.0f)));
+  ASSERT_EQ(0, bytes[0]);
+  ASSERT_EQ(255, bytes[1]);
+  ASSERT_EQ(0, bytes[2]);
+  ASSERT_EQ(255, bytes[3]);
+}
+
+TEST(TextBatchTests, AppendVerticesKeepsEarlierText) {
+  Mesh<VertexPacket2D> quad;
+  for (int i = 0; i < 4; i++) {
+    VertexPacket2D v;
+    v.position = glm::vec2(static_cast<float>(i), 1.0f);
+    v.texcoords = glm::vec2(0.25f * i, 0.5f);
+    quad.AddVertex(v);
+  }
+
+  quad.AddPolygon(0, 1, 2);
+  quad.AddPolygon(2, 3, 0);
+
+  std::vector<TextBatch::TextBatchPacket> vertices;
+  TextBatch::AppendVertices(quad, 0x11223344, 0, &vertices);
+  TextBatch::AppendVertices(quad, 0xAABBCCDD, 7, &vertices);
+  ASSERT_EQ(8, vertices.size());
+  for (int i = 0; i < 8; i++) {
+    auto& packet = vertices[i];
+    ASSERT_EQ(glm::vec2(static_cast<float>(i % 4), 1.0f), packet.position);
+    ASSERT_EQ(glm::vec2(0.25f * (i % 4), 0.5f), packet.texcoord);
+    ASSERT_EQ((i < 4 ? 0x11223344u : 0xAABBCCDDu), packet.color);
+    ASSERT_EQ((i < 4 ? 0u : 7u), packet.transform);
+  }
+
+  // nothing to draw, nothing added
+  Mesh<VertexPacket2D> empty;
+  TextBatch::AppendVertices(empty, 0, 8, &vertices);
+  ASSERT_EQ(8, vertices.size());
+}
@@ -0,0 +1,113 @@
+// starts N sounds at once, and times how long each takes to get its first samples decoded --
+// first through a decode pool, then with a thread spawned for each sound, as buffers used to.
+// usage: audio-decode-bench [sounds]
+
+#include <audio/AudioBufferOgg.hpp>
+#include <audio/AudioDecodePool.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using ::monkeysworld::audio::AudioBufferOgg;
+using ::monkeysworld::audio::AudioDecodePool;
+
+static const int CAPACITY = 4096;
+static const int SAMPLE_RATE = 44100;
+static const char* SOUND_PATH = "resources/flap_jack_scream.ogg";
+
+typedef std::chrono::high_resolution_clock Clock;
+
+struct latency {
+  double submit;    // time spent on the calling thread, per sound
+  double mean;
+  double worst;
+};
+
+/**
+ *  Waits until every buffer has samples, and records when each one got there.
+ */
+static latency WaitForSamples(const std::vector<std::shared_ptr<AudioBufferOgg>>& buffers,
+                              const std::vector<Clock::time_point>& started, double submit) {
+  std::vector<double> ready(buffers.size(), -1.0);
+  size_t remaining = buffers.size();
+  while (remaining > 0) {
+    for (size_t i = 0; i < buffers.size(); i++) {
+      if (ready[i] < 0.0 && buffers[i]->GetBytesWritten() > 0) {
+        ready[i] = std::chrono::duration<double, std::micro>(Clock::now() - started[i]).count();
+        remaining--;
+      }
+    }
+
+    // leave the cores to the decoders
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+
+  latency res;
+  res.submit = submit / buffers.size();
+  res.mean = 0.0;
+  res.worst = 0.0;
+  for (double r : ready) {
+    res.mean += r / buffers.size();
+    res.worst = std::max(res.worst, r);
+  }
+
+  return res;
+}
+
+static std::vector<std::shared_ptr<AudioBufferOgg>> MakeBuffers(int count) {
+  std::vector<std::shared_ptr<AudioBufferOgg>> res;
+  for (int i = 0; i < count; i++) {
+    res.push_back(std::make_shared<AudioBufferOgg>(CAPACITY, SOUND_PATH));
+  }
+
+  return res;
+}
+
+static void Print(const char* name, int threads, latency l) {
+  std::cout << name << " (" << threads << " threads): submitted in " << l.submit << "us per sound, "
+            << "first samples after " << l.mean << "us (worst " << l.worst << "us)" << std::endl;
+}
+
+int main(int argc, char** argv) {
+  int count = (argc > 1 ? std::atoi(argv[1]) : 100);
+  std::vector<Clock::time_point> started(count);
+
+  AudioDecodePool pool(AudioDecodePool::GetDefaultThreadCount(), SAMPLE_RATE);
+  auto buffers = MakeBuffers(count);
+  auto start = Clock::now();
+  for (int i = 0; i < count; i++) {
+    started[i] = Clock::now();
+    pool.AddBuffer(buffers[i]);
+  }
+
+  double submit = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+  latency pooled = WaitForSamples(buffers, started, submit);
+  for (auto& buffer : buffers) {
+    pool.RemoveBuffer(buffer.get());
+  }
+
+  buffers = MakeBuffers(count);
+  std::vector<std::thread> threads;
+  start = Clock::now();
+  for (int i = 0; i < count; i++) {
+    started[i] = Clock::now();
+    auto buffer = buffers[i];
+    threads.push_back(std::thread([buffer] { buffer->WriteFromFile(CAPACITY); }));
+  }
+
+  submit = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+  latency spawned = WaitForSamples(buffers, started, submit);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::cout << count << " sounds started at once" << std::endl;
+  Print("decode pool", pool.GetThreadCount(), pooled);
+  Print("thread per sound", count, spawned);
+  return 0;
+}
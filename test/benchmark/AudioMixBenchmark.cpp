@@ -0,0 +1,89 @@
+// mixes N voices into an interleaved stereo buffer, the way the audio callback does, without
+// opening a PortAudio stream. voices are topped back up between callbacks, outside of the timing.
+// usage: audio-mix-bench [voices]
+
+#include <audio/AudioBuffer.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using ::monkeysworld::audio::AudioBuffer;
+
+static const int CAPACITY = 16384;
+static const int FRAMES = 512;
+static const int CALLBACKS = 2000;
+static const int SAMPLE_RATE = 44100;
+
+typedef std::chrono::high_resolution_clock Clock;
+
+/**
+ *  Voice which is written to by hand, in place of a file.
+ */
+class BenchAudioBuffer : public AudioBuffer {
+ public:
+  BenchAudioBuffer(int capacity) : AudioBuffer(capacity) {}
+  int WriteFromFile(int n) override {
+    return 0;
+  }
+
+  bool EndOfFile() override {
+    return false;
+  }
+
+ protected:
+  void SeekFileToWriteHead() override {
+    // nop
+  }
+};
+
+int main(int argc, char** argv) {
+  int voice_count = (argc > 1 ? std::atoi(argv[1]) : 256);
+  std::vector<float> source_l(CAPACITY);
+  std::vector<float> source_r(CAPACITY);
+  for (int i = 0; i < CAPACITY; i++) {
+    source_l[i] = static_cast<float>(i % 200) / 200.0f - 0.5f;
+    source_r[i] = -source_l[i];
+  }
+
+  std::vector<std::unique_ptr<BenchAudioBuffer>> voices;
+  for (int i = 0; i < voice_count; i++) {
+    voices.push_back(std::make_unique<BenchAudioBuffer>(CAPACITY));
+    voices.back()->SetGain(-6.0f - (i % 12));
+    voices.back()->Write(CAPACITY, source_l.data(), source_r.data());
+  }
+
+  std::vector<float> output(2 * FRAMES);
+  double total = 0.0;
+  double worst = 0.0;
+  float sum = 0.0f;
+  for (int c = 0; c < CALLBACKS; c++) {
+    auto start = Clock::now();
+    std::fill(output.begin(), output.end(), 0.0f);
+    for (auto& voice : voices) {
+      voice->ReadAddInterleaved(FRAMES, output.data());
+    }
+
+    double elapsed = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    total += elapsed;
+    worst = std::max(worst, elapsed);
+    sum += output[c % output.size()];
+
+    // stand-in for the decoder
+    for (auto& voice : voices) {
+      voice->Write(FRAMES, source_l.data(), source_r.data());
+    }
+  }
+
+  double budget = 1000000.0 * FRAMES / SAMPLE_RATE;
+  std::cout << voice_count << " voices, " << FRAMES << " frames per callback" << std::endl;
+  std::cout << "mixed: " << (total / CALLBACKS) << "us per callback (worst " << worst << "us, budget "
+            << budget << "us)" << std::endl;
+  std::cout << "per voice: " << (1000.0 * total / CALLBACKS / std::max(voice_count, 1)) << "ns" << std::endl;
+  // keeps the mix from being optimized out
+  std::cout << "checksum: " << sum << std::endl;
+  return 0;
+}
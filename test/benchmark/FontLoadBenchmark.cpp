@@ -0,0 +1,85 @@
+// loads distance field fonts -- one at a time, then 16 at once through a FontLoader's pool, as a
+// cache would on startup. each is timed with glyphs rasterized on the loading thread, then split
+// across the pool.
+// usage: font-load-bench [threads]
+
+#include <file/LoaderThreadPool.hpp>
+#include <font/Font.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using ::monkeysworld::file::LoaderThreadPool;
+using ::monkeysworld::font::Font;
+using ::monkeysworld::font::GlyphMode;
+
+static const int FONTS = 16;
+static const int REPEATS = 5;
+static const char* FONT_PATHS[] = {"resources/Montserrat-Light.ttf", "resources/8bitoperator_jve.ttf"};
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double Millis(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/**
+ *  Loads FONTS fonts as tasks on the pool, and waits on all of them.
+ *  @param split - whether fonts split their rasterization across the pool.
+ */
+static double LoadMany(std::shared_ptr<LoaderThreadPool> pool, bool split) {
+  std::vector<std::future<void>> loads;
+  auto start = Clock::now();
+  for (int i = 0; i < FONTS; i++) {
+    auto done = std::make_shared<std::promise<void>>();
+    loads.push_back(done->get_future());
+    pool->AddTaskToQueue([=] {
+      Font font(FONT_PATHS[i % 2], GlyphMode::SDF, (split ? pool : nullptr));
+      done->set_value();
+    });
+  }
+
+  for (auto& load : loads) {
+    load.wait();
+  }
+
+  return Millis(start);
+}
+
+int main(int argc, char** argv) {
+  int threads = (argc > 1 ? std::atoi(argv[1]) : 8);
+  auto pool = std::make_shared<LoaderThreadPool>(threads);
+  std::cout << threads << " loader threads" << std::endl;
+
+  double single = 0.0;
+  double single_split = 0.0;
+  double many = 0.0;
+  double many_split = 0.0;
+  for (int r = 0; r < REPEATS; r++) {
+    auto start = Clock::now();
+    {
+      Font font(FONT_PATHS[0], GlyphMode::SDF);
+    }
+
+    single += Millis(start);
+
+    start = Clock::now();
+    {
+      Font font(FONT_PATHS[0], GlyphMode::SDF, pool);
+    }
+
+    single_split += Millis(start);
+    many += LoadMany(pool, false);
+    many_split += LoadMany(pool, true);
+  }
+
+  std::cout << "one font, one thread:     " << (single / REPEATS) << "ms" << std::endl;
+  std::cout << "one font, split:          " << (single_split / REPEATS) << "ms" << std::endl;
+  std::cout << FONTS << " fonts, one thread each: " << (many / REPEATS) << "ms" << std::endl;
+  std::cout << FONTS << " fonts, split:           " << (many_split / REPEATS) << "ms" << std::endl;
+  return 0;
+}
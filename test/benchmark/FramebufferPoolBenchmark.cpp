@@ -0,0 +1,76 @@
+// simulates a window resize dragging every UI element through a range of sizes,
+// and counts how many render targets get created with and without the pool.
+// usage: framebuffer-pool-bench
+
+#include <shader/FramebufferPool.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+using ::monkeysworld::shader::FramebufferPool;
+using ::monkeysworld::shader::render_target;
+
+static const int FRAMES = 600;
+static const int ELEMENTS = 64;
+
+/**
+ *  Size of element `index` on a given frame, as the window grows and shrinks.
+ */
+static glm::ivec2 GetSize(int frame, int index) {
+  // window oscillates between roughly 800x600 and 1920x1080 -- elements are a fraction of it
+  float t = 0.5f + 0.5f * std::sin(frame * 0.05f);
+  glm::vec2 window = glm::vec2(800, 600) + t * glm::vec2(1120, 480);
+  float share = 0.05f + 0.9f * static_cast<float>(index) / ELEMENTS;
+  return glm::max(glm::ivec2(window * share), glm::ivec2(1));
+}
+
+int main(int argc, char** argv) {
+  size_t pooled_allocs = 0;
+  size_t pooled_frees = 0;
+  FramebufferPool pool(256 * 1024 * 1024,
+                       [&](glm::ivec2 size) {
+                         pooled_allocs++;
+                         render_target res = {};
+                         res.size = size;
+                         return res;
+                       },
+                       [&](const render_target& target) { pooled_frees++; });
+
+  // without the pool, every change in size recreates the target
+  size_t naive_allocs = 0;
+  std::vector<glm::ivec2> naive_sizes(ELEMENTS, glm::ivec2(0));
+  std::vector<std::shared_ptr<const render_target>> targets(ELEMENTS);
+
+  auto start = std::chrono::high_resolution_clock::now();
+  for (int frame = 0; frame < FRAMES; frame++) {
+    for (int i = 0; i < ELEMENTS; i++) {
+      glm::ivec2 size = GetSize(frame, i);
+      if (size != naive_sizes[i]) {
+        naive_sizes[i] = size;
+        naive_allocs++;
+      }
+
+      // same check Framebuffer does before going back to the pool
+      if (!targets[i] || targets[i]->size != FramebufferPool::GetBucket(size)) {
+        targets[i].reset();
+        targets[i] = pool.Acquire(size);
+      }
+    }
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  double usecs = std::chrono::duration<double, std::micro>(end - start).count() / FRAMES;
+
+  auto stats = pool.GetStats();
+  std::cout << ELEMENTS << " elements, " << FRAMES << " frames" << std::endl;
+  std::cout << "without pool: " << naive_allocs << " allocations" << std::endl;
+  std::cout << "with pool:    " << pooled_allocs << " allocations, " << stats.reuses << " reuses, "
+            << stats.evictions << " evictions (" << pooled_frees << " frees)" << std::endl;
+  std::cout << "avoided " << (naive_allocs - pooled_allocs) << " allocations ("
+            << (100.0 * (naive_allocs - pooled_allocs) / naive_allocs) << "%)" << std::endl;
+  std::cout << "memory: " << (stats.bytes_in_use / (1024 * 1024)) << "MB in use, "
+            << (stats.bytes_idle / (1024 * 1024)) << "MB idle" << std::endl;
+  std::cout << "bookkeeping: " << usecs << "us per frame" << std::endl;
+  return 0;
+}
@@ -0,0 +1,152 @@
+// lays out a 10k element UI -- a grid of columns, each element anchored below the last --
+// with the old per-frame graph rebuild, and with the persistent layout graph.
+// usage: layout-bench
+
+#include <critter/ui/layout/LayoutGraph.hpp>
+#include <utils/ObjectGraph.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+using ::monkeysworld::critter::ui::layout::LayoutGraph;
+using ::monkeysworld::critter::ui::layout::UILayoutParams;
+using ::monkeysworld::critter::ui::layout::BoundingBox;
+using ::monkeysworld::critter::ui::layout::Face;
+using ::monkeysworld::utils::ObjectGraph;
+
+static const int COLUMNS = 100;
+static const int ROWS = 100;
+static const int FRAMES = 100;
+static const uint64_t GROUP = 1;
+
+static uint64_t GetId(int col, int row) {
+  return 2 + col * ROWS + row;
+}
+
+static std::vector<UILayoutParams> MakeParams() {
+  std::vector<UILayoutParams> res;
+  for (int col = 0; col < COLUMNS; col++) {
+    for (int row = 0; row < ROWS; row++) {
+      UILayoutParams p = UILayoutParams();
+      p.top.anchor_id = (row == 0 ? GROUP : GetId(col, row - 1));
+      p.top.anchor_face = (row == 0 ? Face::TOP : Face::BOTTOM);
+      p.top.margin = 2.0f;
+      p.left.anchor_id = (col == 0 ? GROUP : GetId(col - 1, row));
+      p.left.anchor_face = (col == 0 ? Face::LEFT : Face::RIGHT);
+      p.left.margin = 2.0f;
+      res.push_back(p);
+    }
+  }
+
+  return res;
+}
+
+/**
+ *  What UIGroup::Layout used to do every frame -- rebuild the graph, sort it, and walk it with map lookups.
+ *  Only the top/left anchors are solved, which is all this UI uses.
+ */
+static void OldLayout(const std::vector<uint64_t>& ids, const std::vector<UILayoutParams>& params,
+                      std::vector<glm::vec2>& dims) {
+  ObjectGraph o;
+  std::unordered_map<uint64_t, size_t> index;
+  for (size_t i = 0; i < ids.size(); i++) {
+    index[ids[i]] = i;
+    o.AddEdge(params[i].top.anchor_id, ids[i]);
+    o.AddEdge(params[i].left.anchor_id, ids[i]);
+  }
+
+  std::unordered_map<uint64_t, BoundingBox> boxes;
+  boxes[GROUP] = { 0, 4096, 0, 4096 };
+  for (auto id : o.TopoSort()) {
+    if (id == GROUP) {
+      continue;
+    }
+
+    size_t i = index.at(id);
+    const BoundingBox& above = boxes.at(params[i].top.anchor_id);
+    const BoundingBox& beside = boxes.at(params[i].left.anchor_id);
+    BoundingBox b;
+    b.top = (params[i].top.anchor_face == Face::TOP ? above.top : above.bottom) + params[i].top.margin.dist;
+    b.left = (params[i].left.anchor_face == Face::LEFT ? beside.left : beside.right) + params[i].left.margin.dist;
+    b.bottom = b.top + dims[i].y;
+    b.right = b.left + dims[i].x;
+    boxes[id] = b;
+  }
+}
+
+int main(int argc, char** argv) {
+  std::vector<UILayoutParams> params = MakeParams();
+  size_t count = params.size();
+  std::vector<uint64_t> ids;
+  for (int col = 0; col < COLUMNS; col++) {
+    for (int row = 0; row < ROWS; row++) {
+      ids.push_back(GetId(col, row));
+    }
+  }
+
+  std::vector<glm::vec2> pos(count, glm::vec2(0));
+  std::vector<glm::vec2> dims(count, glm::vec2(30, 16));
+
+  auto start = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < FRAMES; i++) {
+    OldLayout(ids, params, dims);
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  double old_usecs = std::chrono::duration<double, std::micro>(end - start).count() / FRAMES;
+
+  LayoutGraph graph;
+  auto Frame = [&]() {
+    graph.SetGroupDimensions(glm::vec2(4096, 4096));
+    for (size_t i = 0; i < count; i++) {
+      graph.SetNode(i, params[i], pos[i], dims[i]);
+    }
+
+    int solved = graph.Solve();
+    for (size_t i : graph.GetChangedNodes()) {
+      const BoundingBox& b = graph.GetBoundingBox(i);
+      pos[i] = glm::vec2(b.left, b.top);
+      dims[i] = glm::vec2(b.right - b.left, b.bottom - b.top);
+    }
+
+    return solved;
+  };
+
+  // children added/removed every frame
+  int rebuild_solved = 0;
+  start = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < FRAMES; i++) {
+    graph.SetNodes(GROUP, ids);
+    rebuild_solved = Frame();
+  }
+  end = std::chrono::high_resolution_clock::now();
+  double rebuild_usecs = std::chrono::duration<double, std::micro>(end - start).count() / FRAMES;
+
+  // nothing changes
+  int idle_solved = 0;
+  start = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < FRAMES; i++) {
+    idle_solved = Frame();
+  }
+  end = std::chrono::high_resolution_clock::now();
+  double idle_usecs = std::chrono::duration<double, std::micro>(end - start).count() / FRAMES;
+
+  // one element in the middle of the grid grows and shrinks
+  size_t target = (COLUMNS / 2) * ROWS + ROWS / 2;
+  int single_solved = 0;
+  start = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < FRAMES; i++) {
+    dims[target].y = static_cast<float>(16 + (i % 2) * 8);
+    single_solved = Frame();
+  }
+  end = std::chrono::high_resolution_clock::now();
+  double single_usecs = std::chrono::duration<double, std::micro>(end - start).count() / FRAMES;
+
+  std::cout << count << " elements, " << FRAMES << " frames" << std::endl;
+  std::cout << "old per-frame rebuild: " << old_usecs << "us per frame" << std::endl;
+  std::cout << "graph, full rebuild:   " << rebuild_usecs << "us per frame (" << rebuild_solved << " solved)" << std::endl;
+  std::cout << "graph, no changes:     " << idle_usecs << "us per frame (" << idle_solved << " solved)" << std::endl;
+  std::cout << "graph, one change:     " << single_usecs << "us per frame (" << single_solved << " solved)" << std::endl;
+  return 0;
+}
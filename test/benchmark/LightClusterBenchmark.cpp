@@ -0,0 +1,271 @@
+// measures how frame time grows with the light count, from 1 to 256 lights.
+// a frame is binning lights into clusters, plus shading a fixed set of fragments the way
+// clustered-lights.glsl does. the same fragments are also shaded against every light, as a
+// forward renderer would, for comparison.
+// two scenes: "lamps" spreads lights out in a grid, so each spot sees about the same number of
+// them as the count grows -- clustered frame time should stay flat here. "room" piles every light
+// into the same room, so lights per cluster (and shading) grow with the count.
+// usage: cluster-bench [fragments]
+
+#include <shader/UniformBlocks.hpp>
+#include <shader/light/LightClusters.hpp>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using ::monkeysworld::critter::camera_info;
+using ::monkeysworld::shader::frame_uniforms;
+using ::monkeysworld::shader::light::LightClusters;
+using ::monkeysworld::shader::light::spotlight_info;
+
+static const int ITERATIONS = 50;
+
+typedef std::chrono::high_resolution_clock Clock;
+
+/**
+ *  Light, in the form the shader sees it.
+ */
+struct bench_light {
+  glm::vec3 position;
+  float range;
+  glm::vec3 direction;
+  float cos_angle;
+  glm::vec3 atten;
+};
+
+struct fragment {
+  glm::vec3 position;
+  glm::vec3 normal;
+  int cluster_x;
+  int cluster_y;
+  int cluster_z;
+};
+
+static spotlight_info CreateLight(glm::vec3 position, glm::vec3 direction) {
+  spotlight_info light = {};
+  light.position = position;
+  light.direction = glm::normalize(direction);
+  light.angle = 45.0f;
+  light.color = glm::vec3(1);
+  light.intensity_diff = 1.0f;
+  light.atten_quad = 2.0f;
+  light.atten_const = 1.0f;
+  return light;
+}
+
+/**
+ *  Scatters `count` spotlights through a 60 x 60 unit room in front of the camera.
+ */
+static std::vector<spotlight_info> CreateRoomLights(int count) {
+  std::mt19937 gen(1234);
+  std::uniform_real_distribution<float> pos(-30.0f, 30.0f);
+  std::uniform_real_distribution<float> dir(-1.0f, 1.0f);
+  std::vector<spotlight_info> res;
+  for (int i = 0; i < count; i++) {
+    glm::vec3 position(pos(gen), pos(gen) * 0.25f, pos(gen) - 35.0f);
+    res.push_back(CreateLight(position, glm::vec3(dir(gen), -1.0f, dir(gen))));
+  }
+
+  return res;
+}
+
+/**
+ *  Hangs `count` spotlights over the floor in a grid, spaced further apart than they reach,
+ *  spreading out from in front of the camera as the count grows.
+ */
+static std::vector<spotlight_info> CreateLampLights(int count) {
+  const float spacing = 12.0f;
+  int side = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(count))));
+  std::vector<spotlight_info> res;
+  for (int i = 0; i < count; i++) {
+    float x = (i % side - (side - 1) * 0.5f) * spacing;
+    float z = -6.0f - (i / side) * spacing;
+    res.push_back(CreateLight(glm::vec3(x, 3.0f, z), glm::vec3(0, -1, 0)));
+  }
+
+  return res;
+}
+
+static std::vector<bench_light> ToBenchLights(const std::vector<spotlight_info>& lights) {
+  std::vector<bench_light> res;
+  for (auto& info : lights) {
+    bench_light light;
+    light.position = info.position;
+    light.range = LightClusters::GetLightRange(info);
+    light.direction = info.direction;
+    light.cos_angle = std::cos(glm::radians(info.angle * 0.5f));
+    light.atten = glm::vec3(info.atten_quad, info.atten_linear, info.atten_const);
+    res.push_back(light);
+  }
+
+  return res;
+}
+
+/**
+ *  Scatters `count` visible fragments through the same room, and finds the cluster each lands in.
+ */
+static std::vector<fragment> CreateFragments(const camera_info& cam, const LightClusters& clusters, int count) {
+  frame_uniforms frame = {};
+  clusters.GetFrameUniforms(&frame);
+
+  std::mt19937 gen(5678);
+  std::uniform_real_distribution<float> pos(-30.0f, 30.0f);
+  std::uniform_real_distribution<float> dir(-1.0f, 1.0f);
+  std::vector<fragment> res;
+  while (static_cast<int>(res.size()) < count) {
+    glm::vec4 world(pos(gen), pos(gen) * 0.25f, pos(gen) - 35.0f, 1.0f);
+    glm::vec4 clip = cam.vp_matrix * world;
+    float depth = -(cam.view_matrix * world).z;
+    glm::vec2 ndc = glm::vec2(clip.x, clip.y) / clip.w;
+    if (depth <= frame.cluster_depth[0] || std::abs(ndc.x) > 1.0f || std::abs(ndc.y) > 1.0f) {
+      continue;
+    }
+
+    // same lookup as GetCluster in clustered-lights.glsl
+    fragment f;
+    f.position = glm::vec3(world);
+    f.normal = glm::normalize(glm::vec3(dir(gen), 1.0f, dir(gen)));
+    f.cluster_x = std::min(static_cast<int>((ndc.x * 0.5f + 0.5f) * LightClusters::GRID_X), LightClusters::GRID_X - 1);
+    f.cluster_y = std::min(static_cast<int>((ndc.y * 0.5f + 0.5f) * LightClusters::GRID_Y), LightClusters::GRID_Y - 1);
+    int z = static_cast<int>(std::floor(std::log(depth) * frame.cluster_depth[2] + frame.cluster_depth[3]));
+    f.cluster_z = std::min(std::max(z, 0), LightClusters::GRID_Z - 1);
+    res.push_back(f);
+  }
+
+  return res;
+}
+
+/**
+ *  GetSpotLightDiffuse from clustered-lights.glsl, less the shadow lookup.
+ */
+static float GetDiffuse(const bench_light& light, const fragment& f) {
+  glm::vec3 light_vector = light.position - f.position;
+  float dist = glm::length(light_vector);
+  if (dist > light.range) {
+    return 0.0f;
+  }
+
+  light_vector /= dist;
+  float cos_angle = glm::dot(-light_vector, light.direction);
+  float edge = light.cos_angle + (1.0f - light.cos_angle) * 0.1f;
+  float t = std::min(std::max((cos_angle - light.cos_angle) / (edge - light.cos_angle), 0.0f), 1.0f);
+  float cone = t * t * (3.0f - 2.0f * t);
+  if (cone <= 0.0f) {
+    return 0.0f;
+  }
+
+  float falloff = glm::dot(light.atten, glm::vec3(dist * dist, dist, 1.0f));
+  float atten = (falloff > 0.0f ? 1.0f / falloff : 1.0f);
+  atten *= std::min(std::max((light.range - dist) / (0.1f * light.range), 0.0f), 1.0f);
+  return std::max(glm::dot(light_vector, f.normal), 0.0f) * cone * atten;
+}
+
+static float ShadeClustered(const LightClusters& clusters, const std::vector<bench_light>& lights,
+                            const std::vector<fragment>& frags) {
+  float sum = 0.0f;
+  for (auto& f : frags) {
+    uint32_t count = clusters.GetLightCount(f.cluster_x, f.cluster_y, f.cluster_z);
+    for (uint32_t i = 0; i < count; i++) {
+      sum += GetDiffuse(lights[clusters.GetLight(f.cluster_x, f.cluster_y, f.cluster_z, i)], f);
+    }
+  }
+
+  return sum;
+}
+
+static float ShadeForward(const std::vector<bench_light>& lights, const std::vector<fragment>& frags) {
+  float sum = 0.0f;
+  for (auto& f : frags) {
+    for (auto& light : lights) {
+      sum += GetDiffuse(light, f);
+    }
+  }
+
+  return sum;
+}
+
+int main(int argc, char** argv) {
+  int frag_count = (argc > 1 ? std::atoi(argv[1]) : 160 * 90);
+
+  camera_info cam;
+  cam.position = glm::vec3(0, 2, 0);
+  cam.view_matrix = glm::lookAt(cam.position, glm::vec3(0, 0, -20), glm::vec3(0, 1, 0));
+  cam.persp_matrix = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 200.0f);
+  cam.vp_matrix = cam.persp_matrix * cam.view_matrix;
+
+  LightClusters clusters;
+  // sets up the depth slices, so fragments can find their clusters
+  clusters.Assign(cam, CreateRoomLights(1));
+  auto frags = CreateFragments(cam, clusters, frag_count);
+
+  std::cout << frag_count << " fragments shaded per frame" << std::endl;
+  float checksum = 0.0f;
+  for (int scene = 0; scene < 2; scene++) {
+    std::cout << (scene == 0 ? "lamps:" : "room:") << std::endl;
+    double first_frame = 0.0;
+    for (int count = 1; count <= 256; count *= 2) {
+      auto lights = (scene == 0 ? CreateLampLights(count) : CreateRoomLights(count));
+      auto shaded = ToBenchLights(lights);
+      clusters.Assign(cam, lights);
+
+      double assign = 0.0;
+      double shade = 0.0;
+      for (int i = 0; i < ITERATIONS; i++) {
+        auto start = Clock::now();
+        clusters.Assign(cam, lights);
+        auto binned = Clock::now();
+        checksum += ShadeClustered(clusters, shaded, frags);
+        auto end = Clock::now();
+        assign += std::chrono::duration<double, std::micro>(binned - start).count();
+        shade += std::chrono::duration<double, std::micro>(end - binned).count();
+      }
+
+      assign /= ITERATIONS;
+      shade /= ITERATIONS;
+
+      auto start = Clock::now();
+      for (int i = 0; i < ITERATIONS; i++) {
+        checksum += ShadeForward(shaded, frags);
+      }
+
+      double forward = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / ITERATIONS;
+
+      uint32_t max_lights = 0;
+      std::vector<bool> visible(lights.size(), false);
+      for (int z = 0; z < LightClusters::GRID_Z; z++) {
+        for (int y = 0; y < LightClusters::GRID_Y; y++) {
+          for (int x = 0; x < LightClusters::GRID_X; x++) {
+            uint32_t cluster_lights = clusters.GetLightCount(x, y, z);
+            max_lights = std::max(max_lights, cluster_lights);
+            for (uint32_t i = 0; i < cluster_lights; i++) {
+              visible[clusters.GetLight(x, y, z, i)] = true;
+            }
+          }
+        }
+      }
+
+      double frame = assign + shade;
+      if (count == 1) {
+        first_frame = frame;
+      }
+
+      double avg_lights = static_cast<double>(clusters.GetIndexCount()) / LightClusters::CLUSTER_COUNT;
+      std::cout << "  " << count << " lights: frame " << frame << "us (" << (frame / first_frame) << "x 1 light) = "
+                << assign << "us binning + " << shade << "us shading, forward " << forward << "us; "
+                << std::count(visible.begin(), visible.end(), true) << " in view, "
+                << avg_lights << " avg / " << max_lights << " max lights per cluster" << std::endl;
+    }
+  }
+
+  // keeps the shading from being optimized out
+  std::cout << "checksum: " << checksum << std::endl;
+  return 0;
+}
@@ -0,0 +1,50 @@
+// measures how quickly we can generate LOD chains.
+// usage: simplifier-bench [path/to/model.obj]
+
+#include <file/LoaderThreadPool.hpp>
+#include <file/ModelLoader.hpp>
+#include <model/Mesh.hpp>
+#include <model/MeshSimplifier.hpp>
+#include <storage/VertexPacketTypes.hpp>
+
+#include "../MeshFixtures.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+
+using ::monkeysworld::file::LoaderThreadPool;
+using ::monkeysworld::file::ModelLoader;
+using ::monkeysworld::model::Mesh;
+using ::monkeysworld::model::MeshSimplifier;
+
+static void RunBenchmark(const std::string& name, const Mesh<>& mesh) {
+  auto start = std::chrono::high_resolution_clock::now();
+  auto chain = MeshSimplifier::BuildLODChain(mesh, 3);
+  auto end = std::chrono::high_resolution_clock::now();
+  double secs = std::chrono::duration<double>(end - start).count();
+
+  size_t tris = mesh.GetIndexCount() / 3;
+  std::cout << name << ": " << tris << " tris";
+  for (auto& lod : chain) {
+    std::cout << " -> " << (lod->GetIndexCount() / 3);
+  }
+
+  std::cout << " in " << (secs * 1000.0) << "ms ("
+            << static_cast<uint64_t>(tris / secs) << " input tris/s)" << std::endl;
+}
+
+int main(int argc, char** argv) {
+  for (int res : { 64, 128, 256, 512 }) {
+    auto grid = CreateGrid(res, glm::vec2(23.0f, 17.0f));
+    RunBenchmark("grid " + std::to_string(res), *grid);
+  }
+
+  if (argc > 1) {
+    ModelLoader loader(std::make_shared<LoaderThreadPool>(1), {});
+    auto mesh = loader.LoadFile(argv[1]);
+    RunBenchmark(argv[1], *mesh);
+  }
+
+  return 0;
+}
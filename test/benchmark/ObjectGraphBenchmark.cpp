@@ -0,0 +1,147 @@
+// builds and sorts random DAGs with 1k to 1M edges, using the hash map graph
+// ObjectGraph used to be, and the packed graph it is now.
+// usage: graph-bench
+
+#include <utils/ObjectGraph.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+using ::monkeysworld::utils::ObjectGraph;
+
+/**
+ *  The old ObjectGraph, kept here as a baseline.
+ */
+class HashObjectGraph {
+ public:
+  void AddEdge(uint64_t parent, uint64_t child) {
+    nodes_[parent].insert(child);
+    nodes_[child];
+  }
+
+  std::vector<uint64_t> TopoSort() {
+    std::unordered_map<uint64_t, std::size_t> in_deg;
+    std::queue<uint64_t> visit_queue;
+    std::vector<uint64_t> res;
+    for (auto p : nodes_) {
+      in_deg.insert(std::make_pair(p.first, 0));
+    }
+
+    for (auto p : nodes_) {
+      for (auto n : p.second) {
+        in_deg.at(n)++;
+      }
+    }
+
+    auto itr = in_deg.begin();
+    while (itr != in_deg.end()) {
+      if (itr->second == 0) {
+        visit_queue.push(itr->first);
+        itr = in_deg.erase(itr);
+      } else {
+        itr++;
+      }
+    }
+
+    while (!visit_queue.empty()) {
+      uint64_t node = visit_queue.front();
+      visit_queue.pop();
+      res.push_back(node);
+      for (uint64_t child : nodes_.find(node)->second) {
+        size_t& np = in_deg.at(child);
+        np--;
+        if (np <= 0) {
+          in_deg.erase(child);
+          visit_queue.push(child);
+        }
+      }
+    }
+
+    if (res.size() == nodes_.size()) {
+      return res;
+    }
+
+    return std::vector<uint64_t>();
+  }
+
+ private:
+  std::unordered_map<uint64_t, std::unordered_set<uint64_t>> nodes_;
+};
+
+/**
+ *  Random DAG -- edges always point from a lower node to a higher one.
+ *  IDs are scattered, like object IDs would be.
+ */
+static std::vector<std::pair<uint64_t, uint64_t>> MakeEdges(size_t edge_count) {
+  std::mt19937_64 rng(edge_count);
+  size_t node_count = edge_count / 4 + 2;
+  std::uniform_int_distribution<size_t> pick(0, node_count - 2);
+  std::vector<std::pair<uint64_t, uint64_t>> res;
+  for (size_t i = 0; i < edge_count; i++) {
+    size_t a = pick(rng);
+    size_t b = a + 1 + pick(rng) % (node_count - a - 1);
+    res.push_back(std::make_pair(a * 2654435761ULL + 1, b * 2654435761ULL + 1));
+  }
+
+  return res;
+}
+
+template <typename F>
+static double Time(F func, int runs) {
+  auto start = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < runs; i++) {
+    func();
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count() / runs;
+}
+
+int main(int argc, char** argv) {
+  std::cout << "edges\tbuild (old)\tbuild (new)\tsort (old)\tsort (new)\tsort (new, reused)" << std::endl;
+  for (size_t edge_count = 1000; edge_count <= 1000000; edge_count *= 10) {
+    auto edges = MakeEdges(edge_count);
+    int runs = static_cast<int>(1000000 / edge_count);
+
+    HashObjectGraph old_graph;
+    ObjectGraph new_graph;
+    double old_build = Time([&]() {
+      old_graph = HashObjectGraph();
+      for (auto& e : edges) {
+        old_graph.AddEdge(e.first, e.second);
+      }
+    }, runs);
+
+    double new_build = Time([&]() {
+      new_graph = ObjectGraph();
+      for (auto& e : edges) {
+        new_graph.AddEdge(e.first, e.second);
+      }
+
+      // pack the rows, so the sorts below are measured on their own
+      new_graph.GetEdgeCount();
+    }, runs);
+
+    size_t old_size = 0;
+    size_t new_size = 0;
+    double old_sort = Time([&]() { old_size = old_graph.TopoSort().size(); }, runs);
+    double new_sort = Time([&]() { new_size = new_graph.TopoSort().size(); }, runs);
+    std::vector<uint64_t> out;
+    double reused_sort = Time([&]() { new_graph.TopoSort(out); }, runs);
+
+    if (old_size != new_size || new_size != out.size() || new_size == 0) {
+      std::cout << "sort mismatch at " << edge_count << " edges!" << std::endl;
+      return 1;
+    }
+
+    std::cout << edge_count << "\t" << old_build << "ms\t" << new_build << "ms\t"
+              << old_sort << "ms\t" << new_sort << "ms\t" << reused_sort << "ms" << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,105 @@
+// shapes 400 labels of static text -- the first time through, every frame after that, and
+// with a character typed onto the end of each. static text should cost next to nothing.
+// then measures and word wraps a block of text made of all of them, without building geometry.
+// usage: shaping-bench
+
+#include <font/Font.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using ::monkeysworld::font::Font;
+using ::monkeysworld::font::shaped_text;
+using ::monkeysworld::font::text_metrics;
+using ::monkeysworld::font::TextFormat;
+using ::monkeysworld::font::LEFT;
+using ::monkeysworld::font::DEFAULT;
+
+static const int LABELS = 400;
+static const int FRAMES = 200;
+static const int REPEATS = 10;
+static const int LAYOUTS = 1000;
+static const char* FONT_PATH = "resources/Montserrat-Light.ttf";
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double Micros(Clock::time_point start) {
+  return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+  std::vector<std::string> labels;
+  for (int i = 0; i < LABELS; i++) {
+    labels.push_back("AVAWAY To Wa -- label #" + std::to_string(i) + ", with some kerning pairs");
+  }
+
+  TextFormat format = {LEFT, DEFAULT, 0.0f};
+  double cold = 0.0;
+  double cached = 0.0;
+  double typed = 0.0;
+  for (int r = 0; r < REPEATS; r++) {
+    // fresh font each time, so the shaping cache starts out empty
+    Font font(FONT_PATH);
+    std::vector<std::shared_ptr<const shaped_text>> shaped(LABELS);
+
+    auto start = Clock::now();
+    for (int i = 0; i < LABELS; i++) {
+      shaped[i] = font.ShapeText(labels[i], 16.0f, format);
+    }
+
+    cold += Micros(start);
+
+    start = Clock::now();
+    for (int f = 0; f < FRAMES; f++) {
+      for (int i = 0; i < LABELS; i++) {
+        font.ShapeText(labels[i], 16.0f, format);
+      }
+    }
+
+    cached += Micros(start) / FRAMES;
+
+    start = Clock::now();
+    for (int i = 0; i < LABELS; i++) {
+      font.ShapeText(labels[i] + "!", 16.0f, format, shaped[i].get());
+    }
+
+    typed += Micros(start);
+  }
+
+  // one big paragraph
+  std::string block;
+  for (auto& label : labels) {
+    block += label + " ";
+  }
+
+  Font font(FONT_PATH);
+  auto shaped = font.ShapeText(block, 16.0f, format);
+  std::vector<size_t> breaks;
+  float width = 0.0f;
+  auto start = Clock::now();
+  for (int i = 0; i < LAYOUTS; i++) {
+    text_metrics metrics = font.MeasureText(*shaped);
+    width += metrics.max.x - metrics.min.x;
+  }
+
+  double measure = Micros(start) / LAYOUTS;
+  width /= (LAYOUTS * 50.0f);
+  start = Clock::now();
+  for (int i = 0; i < LAYOUTS; i++) {
+    font.FindLineBreaks(*shaped, width, &breaks);
+  }
+
+  double wrap = Micros(start) / LAYOUTS;
+
+  std::cout << LABELS << " labels" << std::endl;
+  std::cout << "first shaped:   " << (cold / REPEATS) << "us" << std::endl;
+  std::cout << "static, cached: " << (cached / REPEATS) << "us per frame" << std::endl;
+  std::cout << "one char typed: " << (typed / REPEATS) << "us (resumed from the old layout)" << std::endl;
+  std::cout << block.size() << " byte block" << std::endl;
+  std::cout << "measured:       " << measure << "us" << std::endl;
+  std::cout << "wrapped:        " << wrap << "us (" << (breaks.size() + 1) << " lines)" << std::endl;
+  return 0;
+}
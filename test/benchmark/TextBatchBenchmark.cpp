@@ -0,0 +1,153 @@
+// redraws 5,000 labels in a single UI group every frame -- first with one draw call
+// per label, then batched into one draw call per glyph atlas. needs a display.
+// usage: text-batch-bench
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <engine/BaseEngine.hpp>
+#include <engine/EngineContext.hpp>
+#include <engine/Scene.hpp>
+
+#include <critter/ui/UIGroup.hpp>
+#include <critter/ui/Window.hpp>
+#include <font/UITextObject.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using ::monkeysworld::engine::Context;
+using ::monkeysworld::engine::EngineContext;
+using ::monkeysworld::engine::Scene;
+using ::monkeysworld::critter::ui::UIGroup;
+using ::monkeysworld::critter::ui::layout::Face;
+using ::monkeysworld::font::UITextObject;
+
+using namespace ::monkeysworld::engine::baseengine;
+
+static const int COLUMNS = 100;
+static const int ROWS = 50;
+static const int WARMUP_FRAMES = 30;
+static const int FRAMES = 300;
+static const char* FONT_PATH = "resources/Montserrat-Light.ttf";
+
+/**
+ *  Invalidates every label each frame, and times the frames -- unbatched, then batched.
+ */
+class LabelGrid : public UIGroup {
+ public:
+  LabelGrid(Context* ctx, GLFWwindow* window) : UIGroup(ctx), window_(window) {
+    frame_ = 0;
+    SetTextBatching(false);
+  }
+
+  void AddLabel(std::shared_ptr<UITextObject> label) {
+    labels_.push_back(label);
+    AddChild(label);
+  }
+
+  void Update() override {
+    // wait on the last frame, so that GPU time is counted
+    glFinish();
+    auto now = std::chrono::high_resolution_clock::now();
+    int phase_frame = frame_ % (WARMUP_FRAMES + FRAMES);
+    if (phase_frame == WARMUP_FRAMES) {
+      start_ = now;
+    } else if (phase_frame == 0 && frame_ > 0) {
+      double ms = std::chrono::duration<double, std::milli>(now - start_).count() / FRAMES;
+      bool batched = (frame_ > WARMUP_FRAMES + FRAMES);
+      std::cout << (batched ? "batched:   " : "unbatched: ") << ms << "ms per frame ("
+                << (batched ? "one draw per atlas" : "one draw per label") << ")" << std::endl;
+      if (batched) {
+        glfwSetWindowShouldClose(window_, GLFW_TRUE);
+      } else {
+        SetTextBatching(true);
+      }
+    }
+
+    for (auto& label : labels_) {
+      label->Invalidate();
+    }
+
+    frame_++;
+  }
+
+ private:
+  GLFWwindow* window_;
+  std::vector<std::shared_ptr<UITextObject>> labels_;
+  int frame_;
+  std::chrono::high_resolution_clock::time_point start_;
+};
+
+class LabelScene : public Scene {
+ public:
+  LabelScene(GLFWwindow* window) : window_(window) {}
+
+  std::string GetSceneIdentifier() override {
+    return "text-batch-bench";
+  }
+
+  void Initialize(Context* ctx) override {
+    auto grid = std::make_shared<LabelGrid>(ctx, window_);
+    auto margins = grid->GetLayoutParams();
+    margins.bottom.anchor_id = GetWindow()->GetId();
+    margins.bottom.anchor_face = Face::BOTTOM;
+    margins.bottom.margin = 0;
+    margins.top.anchor_id = GetWindow()->GetId();
+    margins.top.anchor_face = Face::TOP;
+    margins.top.margin = 0;
+    margins.left.anchor_id = GetWindow()->GetId();
+    margins.left.anchor_face = Face::LEFT;
+    margins.left.margin = 0;
+    margins.right.anchor_id = GetWindow()->GetId();
+    margins.right.anchor_face = Face::RIGHT;
+    margins.right.margin = 0;
+    grid->SetLayoutParams(margins);
+    grid->SetPosition(glm::vec2(0));
+    grid->SetDimensions(glm::vec2(1280, 720));
+
+    glm::vec2 cell(1280.0f / COLUMNS, 720.0f / ROWS);
+    for (int y = 0; y < ROWS; y++) {
+      for (int x = 0; x < COLUMNS; x++) {
+        auto label = std::make_shared<UITextObject>(ctx, FONT_PATH);
+        label->SetPosition(glm::vec2(x, y) * cell);
+        label->SetDimensions(cell);
+        label->SetTextSize(8.0f);
+        label->SetTextColor(glm::vec4(static_cast<float>(x) / COLUMNS, static_cast<float>(y) / ROWS, 1.0f, 1.0f));
+        label->SetText(std::to_string(y * COLUMNS + x));
+        grid->AddLabel(label);
+      }
+    }
+
+    GetWindow()->AddChild(grid);
+  }
+
+ private:
+  GLFWwindow* window_;
+};
+
+int main(int argc, char** argv) {
+  GLFWwindow* main_win = InitializeGLFW(1280, 720, "text-batch-bench");
+  std::cout << (COLUMNS * ROWS) << " labels, " << FRAMES << " frames each" << std::endl;
+  auto scene = new LabelScene(main_win);
+  {
+    auto ctx = std::make_shared<EngineContext>(main_win, scene);
+    while (true) {
+      auto prog = ctx->GetCachedFileLoader()->GetLoaderProgress();
+      if (prog.bytes_read == prog.bytes_sum) {
+        break;
+      }
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    GameLoop(ctx, main_win);
+  }
+
+  glfwDestroyWindow(main_win);
+  glfwTerminate();
+  return 0;
+}
@@ -100,7 +100,11 @@ class RatModel2 : public Model {
     m.SetModelTransforms(tf_matrix);
     m.SetCameraTransforms(cam.vp_matrix);
     m.SetSurfaceColor(glm::vec4(0.0, 1.0, 0.0, 1.0));
-    m.UseMaterial();
+    // still compiling
+    if (!m.UseMaterial()) {
+      return;
+    }
+
     Draw();
   }
  private:
@@ -110,7 +114,7 @@ class RatModel2 : public Model {
 class RatModel : public Model {
  public:
   RatModel(Context* ctx) : Model(ctx), rot_(0), m(ctx) {
-    SetMesh(ctx->GetCachedFileLoader()->LoadModel("resources/test/rat/Rat.obj"));
+    SetMeshLODs(ctx->GetCachedFileLoader()->LoadModelLODs("resources/test/rat/Rat.obj"));
     ctx->GetAudioManager()->AddFileToBuffer("resources/igor.ogg", AudioFiletype::OGG);
     // create a key listener which accomplishes rat motion
     // or just rotate consistently with time
@@ -131,7 +135,11 @@ class RatModel : public Model {
     m.SetModelTransforms(tf_matrix);
     m.SetCameraTransforms(cam.vp_matrix);
     m.SetSurfaceColor(glm::vec4(1.0, 0.6, 0.0, 1.0));
-    m.UseMaterial();
+    // still compiling
+    if (!m.UseMaterial()) {
+      return;
+    }
+
     Draw();
   }
 